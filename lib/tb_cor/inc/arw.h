@@ -0,0 +1,160 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+/*
+ * The arrow library exposes stored level data through
+ * the Arrow C data interface, so that columnar tools
+ * can consume it without copying it.
+ *
+ * A time range of an index is exported as a stream
+ * of struct arrays, one per block : the whole range
+ * is a chunked array, each chunk being the block
+ * arrays restricted to the range.
+ * Chunk buffers are the mapped block arrays themselves.
+ * A chunk keeps its block loaded until it is released.
+ *
+ * The storage system is not thread-safe : the stream
+ * and all its chunks must be released by the thread
+ * that owns the storage system.
+ */
+
+#ifndef TB_COR_ARW_H
+#define TB_COR_ARW_H
+
+/******************************
+ * Arrow C data interface ABI *
+ ******************************/
+
+/*
+ * Those definitions are mandated by the Arrow
+ * specification and must not be altered.
+ */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	const char *format;
+	const char *name;
+	const char *metadata;
+	s64 flags;
+	s64 n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+	void (*release)(struct ArrowSchema *);
+	void *private_data;
+};
+
+struct ArrowArray {
+	s64 length;
+	s64 null_count;
+	s64 offset;
+	s64 n_buffers;
+	s64 n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+	void (*release)(struct ArrowArray *);
+	void *private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream {
+	int (*get_schema)(struct ArrowArrayStream *, struct ArrowSchema *out);
+	int (*get_next)(struct ArrowArrayStream *, struct ArrowArray *out);
+	const char *(*get_last_error)(struct ArrowArrayStream *);
+	void (*release)(struct ArrowArrayStream *);
+	void *private_data;
+};
+
+#endif /* ARROW_C_STREAM_INTERFACE */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_arw_stm,
+	tb_arw_chk
+);
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Export stream private data.
+ */
+struct tb_arw_stm {
+
+	/* Exported index. */
+	tb_stg_idx *idx;
+
+	/* Exported time range [stt, end]. */
+	u64 stt;
+	u64 end;
+
+	/* Next block to export, 0 if none. */
+	tb_stg_blk *blk;
+
+};
+
+/*
+ * Chunk private data.
+ * Shared by the chunk and its children.
+ */
+struct tb_arw_chk {
+
+	/* Exported block. */
+	tb_stg_blk *blk;
+
+	/* Number of live arrays (chunk and children). */
+	u32 ref;
+
+	/* Number of columns. */
+	u8 col_nbr;
+
+	/* Children. */
+	struct ArrowArray cols[TB_ANB_MAX];
+
+	/* Children pointers. */
+	struct ArrowArray *chds[TB_ANB_MAX];
+
+	/* Buffers, two per column and one for the chunk. */
+	const void *bufs[2 * TB_ANB_MAX + 1];
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Initialize @sch with the schema of level @lvl.
+ */
+void tb_arw_sch(
+	u8 lvl,
+	struct ArrowSchema *sch
+);
+
+/*
+ * Initialize @stm to export elements of @idx in
+ * [@stt, @end].
+ * @idx must not be closed before @stm and all its
+ * chunks are released.
+ */
+void tb_arw_exp(
+	tb_stg_idx *idx,
+	u64 stt,
+	u64 end,
+	struct ArrowArrayStream *stm
+);
+
+#endif /* TB_COR_ARW_H */
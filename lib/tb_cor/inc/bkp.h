@@ -0,0 +1,336 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_BKP_H
+#define TB_BKP_H
+
+/*
+ * The broker protocol library provides a binary
+ * protocol between bots and local broker bridges, as
+ * a low latency alternative to the json protocol.
+ *
+ * Messages have a fixed layout, and are exchanged
+ * through a pair of single producer single consumer
+ * rings located in a shared segment created by the
+ * bridge : one for requests, one for responses.
+ * Each request receives exactly one response, that
+ * echoes its sequence number.
+ * Neither side allocates or blocks in the kernel :
+ * both poll the rings.
+ *
+ * Batched requests are sent as consecutive messages of
+ * at most TB_BKP_BAT_MAX, published at once so that the
+ * bridge never waits for the rest of a batch, forwarded
+ * to the broker as a single batch, and answered by as
+ * many responses, published at once too.
+ *
+ * A session starts when a client opens the bridge.
+ * Instruments are sent once per session by class,
+ * marketplace symbol and share or currency symbol,
+ * along with an identifier chosen by the sender, then
+ * by that identifier only. Each direction has its own
+ * identifiers.
+ *
+ * The bridge writes the protocol it serves at the start
+ * of the segment once it is ready. A client that finds
+ * no segment, or another protocol, fails to open so
+ * that the bot can fall back to the json protocol.
+ *
+ * A single client uses the bridge at a time, holding
+ * the write privilege of the segment. A new client
+ * recovers it if its holder died, and drops responses
+ * to the requests of its predecessor.
+ *
+ * A client waits at most TB_BKP_TMO for the bridge to
+ * progress, and fails if the bridge stops serving.
+ * A failed client sends no more requests, and reports
+ * the orders it was asked about as cancelled.
+ * The bridge waits at most TB_BKP_TMO for the client
+ * to free space for responses, then drops them, the
+ * client being considered dead.
+ *
+ * The client implements the broker interface, each
+ * operation being a round trip. The bridge forwards
+ * requests to any broker, the simulation broker being
+ * the reference.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_bkp_ist,
+	tb_bkp_ses,
+	tb_bkp_msg,
+	tb_bkp_rng,
+	tb_bkp_hdr,
+	tb_bkp_cln,
+	tb_bkp_srv
+);
+
+/*************
+ * Constants *
+ *************/
+
+/* Binary protocol identifier, version 2. */
+#define TB_BKP_PRT_BIN 0x32504b42
+
+/* Number of messages of a ring, power of 2. */
+#define TB_BKP_RNG_NB 64
+
+/* Message types. */
+#define TB_BKP_MSG_TIM_RST 0
+#define TB_BKP_MSG_TIM_SET 1
+#define TB_BKP_MSG_SHT 2
+#define TB_BKP_MSG_ORD_PAS 3
+#define TB_BKP_MSG_ORD_CCL 4
+#define TB_BKP_MSG_ORD_STS 5
+#define TB_BKP_MSG_ORD_PAS_N 6
+#define TB_BKP_MSG_ORD_CCL_N 7
+#define TB_BKP_MSG_ORD_STS_N 8
+#define TB_BKP_MSG_ORD_RPL 9
+#define TB_BKP_MSG_SES 10
+#define TB_BKP_MSG_NB 11
+
+/* Maximal number of messages of a batch. */
+#define TB_BKP_BAT_MAX (TB_BKP_RNG_NB / 2)
+
+/* Maximal time a side waits for the other one to
+ * progress, in nanoseconds. */
+#define TB_BKP_TMO 1000000000
+
+/* Number of polls between checks of the bridge,
+ * power of 2. */
+#define TB_BKP_SPN_NB 1024
+
+/* Maximal number of instruments per session and per
+ * direction. */
+#define TB_BKP_SES_MAX 4096
+
+/* Number of slots of the sent instruments table. */
+#define TB_BKP_SES_SLT_NB (2 * TB_BKP_SES_MAX)
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Instrument.
+ */
+struct tb_bkp_ist {
+
+	/* Session identifier. */
+	u32 id;
+
+	/* Set <=> the fields below describe the instrument,
+	 * sent for the first time in the session. */
+	u8 dsc;
+
+	/* Class. */
+	u8 cls;
+
+	/* Marketplace symbol. */
+	tb_str mkp;
+
+	/* Share or currency symbol. */
+	tb_str sym;
+
+};
+
+/*
+ * Session instruments of one side.
+ */
+struct tb_bkp_ses {
+
+	/* Sent instruments, open addressed by address,
+	 * null if free. */
+	tb_ist *snd_ists[TB_BKP_SES_SLT_NB];
+
+	/* Session identifiers of sent instruments, indexed
+	 * like @snd_ists. */
+	u32 snd_ids[TB_BKP_SES_SLT_NB];
+
+	/* Number of sent instruments. */
+	u32 snd_nbr;
+
+	/* Received instruments, indexed by session
+	 * identifier. */
+	tb_ist *rcvs[TB_BKP_SES_MAX];
+
+	/* Number of received instruments. */
+	u32 rcv_nbr;
+
+};
+
+/*
+ * Message.
+ * Requests and responses share the same layout, fields
+ * being used depending on the type.
+ */
+struct tb_bkp_msg {
+
+	/* Type. */
+	u8 typ;
+
+	/* Order type. */
+	u8 ord_typ;
+
+	/* Order status. */
+	u8 ord_sts;
+
+	/* Number of messages following in the same batch. */
+	u16 bat;
+
+	/* Sequence number, echoed by the response. */
+	u64 seq;
+
+	/* Time or order index. */
+	u64 arg;
+
+	/* Order instruments. */
+	tb_bkp_ist prm;
+	tb_bkp_ist sec;
+
+	/* Order volumes and prices. */
+	f64 req_vol_prm;
+	f64 req_prc_lim;
+	f64 req_prc_stp;
+	f64 rsp_vol_prm;
+	f64 rsp_vol_sec;
+
+};
+
+/*
+ * Single producer single consumer ring.
+ */
+struct tb_bkp_rng {
+
+	/* Number of messages written. */
+	volatile a64 wrt;
+
+	/* Separate cache lines. */
+	u64 pad0[7];
+
+	/* Number of messages read. */
+	volatile a64 red;
+
+	/* Separate cache lines. */
+	u64 pad1[7];
+
+	/* Messages. */
+	tb_bkp_msg msgs[TB_BKP_RNG_NB];
+
+};
+
+/*
+ * Segment header.
+ */
+struct tb_bkp_hdr {
+
+	/* Protocol served by the bridge, 0 if none. */
+	volatile a64 prt;
+
+	/* Separate cache lines. */
+	u64 pad[7];
+
+	/* Requests. */
+	tb_bkp_rng req;
+
+	/* Responses. */
+	tb_bkp_rng rsp;
+
+};
+
+/*
+ * Client.
+ */
+struct tb_bkp_cln {
+
+	/* Broker interface. */
+	spb_bkr bkr;
+
+	/* Segment. */
+	tb_sgm *sgm;
+
+	/* Header. */
+	tb_bkp_hdr *hdr;
+
+	/* Last sequence number. */
+	u64 seq;
+
+	/* Set <=> the bridge failed to respond. */
+	u8 err;
+
+	/* Session instruments. */
+	tb_bkp_ses ses;
+
+};
+
+/*
+ * Bridge.
+ */
+struct tb_bkp_srv {
+
+	/* Segment. */
+	tb_sgm *sgm;
+
+	/* Header. */
+	tb_bkp_hdr *hdr;
+
+	/* Broker requests are forwarded to. */
+	spb_bkr *bkr;
+
+	/* Session instruments. */
+	tb_bkp_ses ses;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Open the binary protocol bridge at @pth, and return
+ * a broker forwarding to it, simulated if @sim is set.
+ * If it does not exist, does not serve the binary
+ * protocol or is used by another live client, return 0.
+ */
+spb_bkr *tb_bkp_cln_opn(
+	const char *pth,
+	u8 sim
+);
+
+/*
+ * Return 1 if the bridge of the client @bkr failed to
+ * respond, 0 otherwise.
+ */
+u8 tb_bkp_cln_err(
+	spb_bkr *bkr
+);
+
+/*
+ * Construct and return a binary protocol bridge at
+ * @pth, forwarding requests to @bkr.
+ */
+tb_bkp_srv *tb_bkp_srv_ctr(
+	const char *pth,
+	spb_bkr *bkr
+);
+
+/*
+ * Stop serving, delete @srv.
+ * Its broker is not deleted.
+ */
+void tb_bkp_srv_dtr(
+	tb_bkp_srv *srv
+);
+
+/*
+ * Process all pending requests of @srv, return their
+ * number.
+ */
+u64 tb_bkp_srv_stp(
+	tb_bkp_srv *srv
+);
+
+#endif /* TB_BKP_H */
@@ -110,6 +110,57 @@ struct spb_bkrt {
 		tb_ord *dst
 	);
 
+	/*
+	 * Pass the @nbr orders described by @ords, save
+	 * their descriptors at @dsts.
+	 * @ords and @dsts may be the same.
+	 */
+	void (*ord_pas_n)(
+		spb_bkr *bkr,
+		u64 nbr,
+		tb_ord *ords,
+		tb_ord *dsts
+	);
+
+	/*
+	 * Send a cancel request for the @nbr orders at
+	 * indices @idxs.
+	 * If bad index, abort.
+	 */
+	void (*ord_ccl_n)(
+		spb_bkr *bkr,
+		u64 nbr,
+		const u64 *idxs
+	);
+
+	/*
+	 * Save the descriptors of the @nbr orders at
+	 * indices @idxs at @dsts.
+	 * If bad index, abort.
+	 */
+	void (*ord_sts_n)(
+		spb_bkr *bkr,
+		u64 nbr,
+		const u64 *idxs,
+		tb_ord *dsts
+	);
+
+	/*
+	 * Cancel the order at index @idx and pass the order
+	 * described by @ord in its place, return its
+	 * descriptor.
+	 * Both requests reach the market together. The
+	 * volume filled on the order at @idx is deducted from
+	 * the replacement's, which is cancelled if nothing
+	 * remains or if the order at @idx is complete by then.
+	 * If bad index, abort.
+	 */
+	tb_ord (*ord_rpl)(
+		spb_bkr *bkr,
+		u64 idx,
+		tb_ord *ord
+	);
+
 };
 
 /*
@@ -197,4 +248,55 @@ static inline void tb_bkr_ord_sts(
 	tb_ord *dst
 ) {return (*(bkr->bkrt->ord_sts))(bkr, idx, dst);}
 
+/*
+ * Pass the @nbr orders described by @ords, save
+ * their descriptors at @dsts.
+ * @ords and @dsts may be the same.
+ */
+static inline void tb_bkr_ord_pas_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	tb_ord *ords,
+	tb_ord *dsts
+) {return (*(bkr->bkrt->ord_pas_n))(bkr, nbr, ords, dsts);}
+
+/*
+ * Send a cancel request for the @nbr orders at
+ * indices @idxs.
+ * If bad index, abort.
+ */
+static inline void tb_bkr_ord_ccl_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	const u64 *idxs
+) {return (*(bkr->bkrt->ord_ccl_n))(bkr, nbr, idxs);}
+
+/*
+ * Save the descriptors of the @nbr orders at
+ * indices @idxs at @dsts.
+ * If bad index, abort.
+ */
+static inline void tb_bkr_ord_sts_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	const u64 *idxs,
+	tb_ord *dsts
+) {return (*(bkr->bkrt->ord_sts_n))(bkr, nbr, idxs, dsts);}
+
+/*
+ * Cancel the order at index @idx and pass the order
+ * described by @ord in its place, return its
+ * descriptor.
+ * Both requests reach the market together. The
+ * volume filled on the order at @idx is deducted from
+ * the replacement's, which is cancelled if nothing
+ * remains or if the order at @idx is complete by then.
+ * If bad index, abort.
+ */
+static inline tb_ord tb_bkr_ord_rpl(
+	spb_bkr *bkr,
+	u64 idx,
+	tb_ord *ord
+) {return (*(bkr->bkrt->ord_rpl))(bkr, idx, ord);}
+
 #endif /* TB_BKR_H */
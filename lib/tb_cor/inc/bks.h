@@ -0,0 +1,158 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_BKS_H
+#define TB_BKS_H
+
+/*
+ * The simulation broker executes orders in process
+ * against the level 1 state of a history, so that
+ * backtests run at replay speed.
+ *
+ * The history is driven by the caller, which sets the
+ * broker's time after each history update. The broker
+ * only observes the history at those times.
+ *
+ * Prices are converted in ticks using a constant tick
+ * size. Prices on a tick, up to floating point errors,
+ * map to it. Others are rounded so that orders are
+ * never more aggressive : buy limits and sell stops
+ * down, sell limits and buy stops up. Fills never
+ * happen beyond the limit price.
+ *
+ * Requests (passing and cancellation) reach the market
+ * after a constant latency. Orders are then matched
+ * as follows :
+ * - market orders fill at the best opposite tick.
+ * - stop orders trigger when the best opposite tick
+ *   reaches their stop tick (the best ask rises to it
+ *   for a buy, the best bid falls to it for a sell),
+ *   and then behave as market or limit orders.
+ * - marketable limit orders fill at the best opposite
+ *   tick.
+ * - resting limit orders join the queue of their tick,
+ *   behind its current volume. Decrements of the tick's
+ *   volume are assumed to consume the queue from the
+ *   front, so that they first reduce the volume ahead of
+ *   the order, then fill it. If the opposite side
+ *   crosses the order's tick, it fills completely.
+ * Market depth is not modeled : fills do not consume
+ * the level 1 volumes.
+ *
+ * A replacement reaches the market with the cancellation
+ * of the order it replaces. It is cancelled if that
+ * order completed first.
+ *
+ * Orders are stored in a flat array indexed by their
+ * identifier, which is their passing index.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_bks_ord,
+	tb_bks
+);
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Simulated order.
+ */
+struct tb_bks_ord {
+
+	/* Descriptor. */
+	tb_ord ord;
+
+	/* Time at which the order reaches the market. */
+	u64 act_tim;
+
+	/* Time at which the cancellation reaches the
+	 * market, -1 if none. */
+	u64 ccl_tim;
+
+	/* Limit tick. */
+	u64 lim_tck;
+
+	/* Stop tick. */
+	u64 stp_tck;
+
+	/* Set <=> the stop was triggered, or no stop. */
+	u8 trg;
+
+	/* Set <=> resting at its limit tick. */
+	u8 rst;
+
+	/* Volume ahead in the queue. */
+	f64 que;
+
+	/* Volume of the limit tick at the last observation. */
+	f64 lvl;
+
+	/* Index of the order replaced, -1 if none. */
+	u64 rpl;
+
+};
+
+/*
+ * Simulation broker.
+ */
+struct tb_bks {
+
+	/* Broker interface. */
+	spb_bkr bkr;
+
+	/* History. */
+	tb_lv1_hst *hst;
+
+	/* Tick size. */
+	f64 tck_siz;
+
+	/* Request latency. */
+	u64 lat;
+
+	/* Current time. */
+	u64 tim;
+
+	/* Index of the first order that may not be
+	 * cancelled or complete. */
+	u64 ord_stt;
+
+	/* Number of orders. */
+	u64 ord_nbr;
+
+	/* Maximal number of orders. */
+	u64 ord_max;
+
+	/* Orders indexed by identifier. */
+	tb_bks_ord *ords;
+
+};
+
+/*******
+ * Log *
+ *******/
+
+tb_lib_log_dec(cor, bks);
+#define tb_bks_log(...) tb_log_lib(cor, bks, __VA_ARGS__)
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a simulation broker of at most
+ * @ord_max orders, matching against @hst with tick size
+ * @tck_siz and request latency @lat.
+ */
+spb_bkr *tb_bks_ctr(
+	tb_lv1_hst *hst,
+	f64 tck_siz,
+	u64 lat,
+	u64 ord_max
+);
+
+#endif /* TB_BKS_H */
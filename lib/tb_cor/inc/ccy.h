@@ -23,24 +23,36 @@ types(
  */
 struct tb_ccy {
 
-	/* Currencies. */
-	ns_mapn_str ccys;
-
 	/* Symbol. */
 	const char *sym;
 
 	/* Name. */
 	const char *nam;
 
+	/* Dense identifier. */
+	u32 id;
+
 };
 
+/*
+ * Currencies system.
+ * Currencies are indexed by a perfect hash of their
+ * symbols, built once under the lock. Lookups then
+ * take no lock.
+ */
 struct tb_ccy_sys {
 
-	/* Lock. */
+	/* Lock, taken to initialize. */
 	nh_spn lck;
 
-	/* Currencies map. */
-	ns_map_str ccys;
+	/* Set <=> initialized. */
+	volatile a64 rdy;
+
+	/* Perfect hash of symbols. */
+	tb_phf phf;
+
+	/* Currencies indexed by slot. */
+	tb_ccy **ccys;
 
 };
 
@@ -48,6 +60,16 @@ struct tb_ccy_sys {
  * Declarations *
  ****************/
 
+/*
+ * Currency identifiers, in declaration order.
+ */
+#define TB_CCY(nam, sym) TB_CCY_ID_##sym,
+enum {
+#include <tb_cor/ccys.h>
+	TB_CCY_NB
+};
+#undef TB_CCY
+
 /*
  * Declare all currencies.
  */
@@ -84,6 +106,7 @@ void tb_ccy_log(
 
 /*
  * Lookup a currency by symbol.
+ * Wait-free once initialized.
  */
 tb_ccy *tb_ccy_sch(
 	const char *sym
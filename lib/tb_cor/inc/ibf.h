@@ -0,0 +1,128 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+/*
+ * The ingest buffer library combines small writes
+ * to a storage index into larger batches.
+ *
+ * Every storage write acquires the segment write
+ * privilege, publishes a new element count and
+ * updates the index table, all of which are atomic
+ * operations on lines that readers poll.
+ * Feed connectors that receive tiny batches at a
+ * high rate can instead append to an ingest buffer,
+ * which publishes its content in a single write when
+ * either :
+ * - it holds @elm_max elements; or
+ * - its oldest element was buffered more than @lat_max
+ *   nanoseconds ago.
+ * A null @lat_max selects the write-through mode,
+ * where every write is published immediately, for
+ * consumers that need the lowest latency.
+ *
+ * Latency is only checked on writes and polls : a
+ * connector that may stay idle must poll its buffers.
+ */
+
+#ifndef TB_COR_IBF_H
+#define TB_COR_IBF_H
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_ibf
+);
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Ingest buffer.
+ */
+struct tb_ibf {
+
+	/* Destination index. */
+	tb_stg_idx *idx;
+
+	/* Number of arrays. */
+	u8 arr_nbr;
+
+	/* Element sizes. */
+	const u8 *sizs;
+
+	/* Maximal number of buffered elements. */
+	u64 elm_max;
+
+	/* Maximal buffering latency. 0 : write-through. */
+	u64 lat_max;
+
+	/* Number of buffered elements. */
+	u64 elm_nbr;
+
+	/* Time at which the oldest element was buffered. */
+	u64 tim_fst;
+
+	/* Block validation function and its argument. */
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg);
+	void *val_arg;
+
+	/* Buffer arrays. [elm_max] each. */
+	void *arrs[TB_ANB_MAX];
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return an ingest buffer for @idx,
+ * publishing writes according to @elm_max and @lat_max.
+ * @idx must be opened with write privileges and
+ * must not be written to by other means while the
+ * buffer exists.
+ */
+tb_ibf *tb_ibf_ctr(
+	tb_stg_idx *idx,
+	u64 elm_max,
+	u64 lat_max,
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg),
+	void *val_arg
+);
+
+/*
+ * Publish @ibf's content and delete it.
+ */
+void tb_ibf_dtr(
+	tb_ibf *ibf
+);
+
+/*
+ * Publish @ibf's content.
+ */
+void tb_ibf_fls(
+	tb_ibf *ibf
+);
+
+/*
+ * Buffer @nb elements located at @srcs.
+ * Publish if required by the flush policy.
+ */
+void tb_ibf_wrt(
+	tb_ibf *ibf,
+	u64 nb,
+	const void **srcs
+);
+
+/*
+ * If @ibf's oldest element exceeded its latency,
+ * publish its content and return 1.
+ * Otherwise, return 0.
+ */
+u8 tb_ibf_pol(
+	tb_ibf *ibf
+);
+
+#endif /* TB_COR_IBF_H */
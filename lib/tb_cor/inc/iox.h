@@ -17,23 +17,42 @@
  *********/
 
 types(
-	tb_dr1
+	tb_dr1,
+	tb_io1_rec
 );
 
 /**************
  * Structures *
  **************/
 
+/*
+ * Level 1 bulk import record.
+ * Import files are packed arrays of records
+ * sorted by time.
+ */
+struct tb_io1_rec {
+
+	/* Time. */
+	u64 tim;
+
+	/* Price tick. */
+	u64 tck;
+
+	/* Volume. */
+	f64 vol;
+
+};
+
 /*
  * Level 1 data reconstructor.
  */
 struct tb_dr1 {
 
-	/* Marketplace. */
-	tb_str mkp;
+	/* Marketplace symbol. */
+	u32 mkp;
 
-	/* Instrument. */
-	tb_str ist;
+	/* Instrument symbol. */
+	u32 ist;
 
 	/* Storage. */
 	tb_stg_sys *stg;
@@ -83,6 +102,8 @@ struct tb_dr1 {
  * read through @sys, initialized with data up to @tim_cur.
  * The reconstructor has the entire heatmap data
  * populated until @tim_cur. 
+ * Heatmaps and curves are published through @buf_nbr
+ * buffers.
  */
 tb_dr1 *tb_dr1_ctr(
 	tb_stg_sys *sys,
@@ -92,6 +113,7 @@ tb_dr1 *tb_dr1_ctr(
 	u64 hmp_dim_tck,
 	u64 hmp_dim_tim,
 	u64 bac_nb,
+	u8 buf_nbr,
 	u64 tim_cur
 );
 
@@ -130,6 +152,14 @@ static inline f64 *tb_dr1_hmp(
 	tb_dr1 *dr1
 ) {return tb_lv1_hmp(dr1->hst);}
 
+/*
+ * Return @dr1's history, to read its published frames
+ * from other threads.
+ */
+static inline tb_lv1_hst *tb_dr1_hst(
+	tb_dr1 *dr1
+) {return dr1->hst;}
+
 /*
  * If @dr1 supports it, return its bid curve.
  * If not return 0.
@@ -179,6 +209,68 @@ void tb_io1_wrt(
 	const f64 *vol,
 	f64 *gos
 );
+
+/*
+ * Construct and return a level 1 ingest buffer
+ * for @idx. See ibf.h for @elm_max and @lat_max.
+ * Receives a giga orderbook snapshot to compute the
+ * new blocks' orderbook snapshots.
+ */
+tb_ibf *tb_io1_ibf(
+	tb_stg_idx *idx,
+	u64 elm_max,
+	u64 lat_max,
+	f64 *gos
+);
+
+/*
+ * Level 1 buffered data write.
+ */
+static inline void tb_io1_bwr(
+	tb_ibf *ibf,
+	u64 nb,
+	const u64 *tim,
+	const f64 *prc,
+	const f64 *vol
+)
+{
+	assert(ibf->idx->lvl == 1);
+	tb_ibf_wrt(
+		ibf,
+		nb,
+		(const void *[]) {
+			(const void *) tim,
+			(const void *) prc,
+			(const void *) vol,
+		}
+	);
+}
+
+/*
+ * Level 1 recovery.
+ * See tb_stg_rcv.
+ * Receives a giga orderbook snapshot to compute the
+ * orderbook snapshots of the revalidated blocks.
+ */
+void tb_io1_rcv(
+	tb_stg_idx *idx,
+	f64 *gos
+);
+
+/*
+ * Level 1 bulk import.
+ * Append all records of the memory-mapped import
+ * file at @pth to @idx, building blocks with
+ * @thr_nbr threads.
+ * Receives a giga orderbook snapshot to compute the
+ * new blocks' orderbook snapshots.
+ */
+void tb_io1_imp(
+	tb_stg_idx *idx,
+	const char *pth,
+	u8 thr_nbr,
+	f64 *gos
+);
 	
 /*
  * Level 2 data write.
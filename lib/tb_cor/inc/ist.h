@@ -7,6 +7,22 @@
  * An instrument is something that can be traded.
  * The instrument library identifies instruments in a
  * unique manner which allows their efficient indexing.
+ *
+ * Instruments receive dense identifiers in creation
+ * order, so that per-instrument data can be stored in
+ * flat arrays.
+ *
+ * Instruments are never freed, so they are indexed by
+ * name symbol in registries, whose entries are published
+ * once the instrument is complete. Lookups take no lock,
+ * only creations do.
+ *
+ * There is no fixed number of instruments. The table of
+ * instruments is made of chunks of doubling sizes that
+ * never move once allocated. Registries double when half
+ * full and are replaced, the previous ones being kept
+ * for concurrent lookups, that fall back to the locked
+ * path if they miss.
  */
 
 /*********
@@ -15,6 +31,7 @@
 
 types(
 	tb_ist,
+	tb_ist_reg,
 	tb_ist_sys
 );
 
@@ -35,41 +52,50 @@ types(
 /* Number of classes. */
 #define TB_IST_CLS_NB 2
 
+/* Order of the number of instruments of the first
+ * chunk of the instrument table. The chunk of index
+ * @k holds 1 << (TB_IST_CHK_ORD + k) instruments. */
+#define TB_IST_CHK_ORD 8
+
+/* Number of chunks of the instrument table, so that
+ * it covers 32 bits identifiers. */
+#define TB_IST_CHK_NB (32 - TB_IST_CHK_ORD)
+
+/* Minimal number of slots of registries. */
+#define TB_IST_REG_MIN 64
+
 /*
  * Instrument.
  * Once created, an instrument is never fred.
  */
 struct tb_ist {
 
-	/* Name. */
-	tb_str nam;
+	/* Name symbol. */
+	u32 nam;
 
 	/* Class. */
 	u8 cls;
 
+	/* Dense identifier. */
+	u32 id;
+
 	/* Per-class data. */
 	union {
 
 		/* Share data. */
 		struct {
 
-			/* Shares instruments of the same system. */
-			ns_mapn_str shrs;
-
 			/* Marketplace. */
 			tb_mkp *mkp;
 
 			/* Symbol. */
-			tb_str sym; 
+			u32 sym;
 
 		} shr;
 
 		/* Currency data. */
 		struct {
 
-			/* Currency instruments of the same system. */
-			ns_mapn_str ccys;
-
 			/* Marketplace. */
 			tb_mkp *mkp;
 
@@ -85,19 +111,46 @@ struct tb_ist {
 
 };
 
+/*
+ * Instrument registry.
+ */
+struct tb_ist_reg {
+
+	/* Registry it replaced, 0 if none. */
+	tb_ist_reg *prv;
+
+	/* Number of slots, a power of two. */
+	u64 slt_nbr;
+
+	/* Number of entries. */
+	u64 ent_nbr;
+
+	/* Slots. Entries are tagged by name symbol,
+	 * their values are identifiers plus one. */
+	volatile a64 slts[];
+
+};
+
 /*
  * Instrument tracker.
  */
 struct tb_ist_sys {
 
-	/* Lock. */
+	/* Lock, taken to create instruments. */
 	nh_spn lck;
 
-	/* Share instruments. */
-	ns_map_str shrs;
+	/* Share instruments registry, 0 if none. */
+	volatile a64 shrs;
+
+	/* Currency instruments registry, 0 if none. */
+	volatile a64 ccys;
+
+	/* Number of instruments. */
+	volatile a64 ist_nbr;
 
-	/* Currency instruments. */
-	ns_map_str ccys;
+	/* Chunks of the table of instruments indexed
+	 * by identifier, allocated on demand. */
+	tb_ist **chks[TB_IST_CHK_NB];
 
 };
 
@@ -116,6 +169,7 @@ void tb_ist_cln(
 
 /*
  * Return a share instrument identifier.
+ * Wait-free if it exists.
  */
 tb_ist *tb_ist_ctr_shr(
 	tb_mkp *mkp,
@@ -124,12 +178,28 @@ tb_ist *tb_ist_ctr_shr(
 
 /*
  * Return a currency instrument identifier.
+ * Wait-free if it exists.
  */
 tb_ist *tb_ist_ctr_ccy(
 	tb_mkp *mkp,
 	tb_ccy *ccy
 );
 
+/*
+ * Return the number of instruments, every identifier
+ * being lower.
+ */
+u32 tb_ist_nbr(
+	void
+);
+
+/*
+ * Return the instrument of identifier @id.
+ */
+tb_ist *tb_ist_get(
+	u32 id
+);
+
 /*
  * Print log data for an instrument.
  */
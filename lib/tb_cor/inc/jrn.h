@@ -0,0 +1,294 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_JRN_H
+#define TB_JRN_H
+
+/*
+ * The journal durably records order lifecycle events and
+ * wallet movements, so that the state of a wallet can be
+ * recovered after a crash by a sequential scan instead
+ * of broker queries.
+ *
+ * It is an append only segment of fixed size records,
+ * written in place in shared memory, so that records
+ * survive the death of the writer.
+ *
+ * Instruments are identified by journal indices, defined
+ * by instrument records written before their first use,
+ * as instrument identifiers are not stable across runs.
+ *
+ * An order is identified by the index of its request
+ * record. Its updates reference it.
+ *
+ * A journal has a single writer : it takes the segment's
+ * write privileges when opened, recovering them from a
+ * dead writer.
+ *
+ * A journal has a fixed capacity. Recording an event
+ * takes one record, plus one per instrument it uses
+ * that is not defined yet. If they do not fit, nothing
+ * is recorded and the writer is told so, and must stop
+ * trading on the journal before its state diverges.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_jrn_rec,
+	tb_jrn
+);
+
+/*************
+ * Constants *
+ *************/
+
+/*
+ * Record types.
+ */
+
+/* Instrument definition. */
+#define TB_JRN_TYP_IST 0
+
+/* Order request. */
+#define TB_JRN_TYP_REQ 1
+
+/* Order acknowledged by the broker. */
+#define TB_JRN_TYP_ACK 2
+
+/* Order partially filled. */
+#define TB_JRN_TYP_FIL 3
+
+/* Order cancelled. */
+#define TB_JRN_TYP_CCL 4
+
+/* Order complete. */
+#define TB_JRN_TYP_CPL 5
+
+/* Wallet movement. */
+#define TB_JRN_TYP_MOV 6
+
+/* Number of record types. */
+#define TB_JRN_TYP_NB 7
+
+/* Size of instrument record strings. */
+#define TB_JRN_STR_SIZ 24
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Journal record.
+ * 64 bytes.
+ */
+struct tb_jrn_rec {
+
+	/* Time in nanoseconds. */
+	u64 tim;
+
+	/* Type. */
+	u8 typ;
+
+	/* Order type. */
+	u8 ord_typ;
+
+	/* Order status after the event. */
+	u8 sts;
+
+	/* Instrument class. */
+	u8 cls;
+
+	/* Instrument index : defined instrument for
+	 * instrument records, primary for order records,
+	 * moved instrument for movements. */
+	u32 ist;
+
+	/* Per-type data. */
+	union {
+
+		/* Order request. */
+		struct {
+
+			/* Secondary instrument index. */
+			u32 sec;
+
+			/* Broker identifier. */
+			u64 id;
+
+			/* Requested volume of primary. */
+			f64 vol;
+
+			/* Limit price. */
+			f64 lim;
+
+			/* Stop price. */
+			f64 stp;
+
+		} req;
+
+		/* Order update. */
+		struct {
+
+			/* Index of the request record. */
+			u64 req;
+
+			/* Broker identifier. */
+			u64 id;
+
+			/* Volume of primary traded so far. */
+			f64 vol_prm;
+
+			/* Volume of secondary traded so far. */
+			f64 vol_sec;
+
+		} upd;
+
+		/* Wallet movement. */
+		struct {
+
+			/* Amount. */
+			f64 amt;
+
+		} mov;
+
+		/* Instrument definition. */
+		struct {
+
+			/* Marketplace symbol. */
+			char mkp[TB_JRN_STR_SIZ];
+
+			/* Share or currency symbol. */
+			char sym[TB_JRN_STR_SIZ];
+
+		} def;
+
+	};
+
+};
+_Static_assert(sizeof(tb_jrn_rec) == 64, "journal records must be 64 bytes.");
+
+/*
+ * Journal.
+ */
+struct tb_jrn {
+
+	/* Segment. */
+	tb_sgm *sgm;
+
+	/* Records. */
+	tb_jrn_rec *recs;
+
+	/* Number of instruments defined. */
+	u32 ist_nbr;
+
+	/* Capacity of the journal index array. */
+	u32 jid_max;
+
+	/* Journal indices of instruments plus one,
+	 * 0 if not defined, indexed by identifier. */
+	u32 *jids;
+
+	/* Capacity of the instrument array. */
+	u32 ist_max;
+
+	/* Instruments indexed by journal index. */
+	tb_ist **ists;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Open the journal at @pth, create it with a capacity of
+ * @rec_max records if it does not exist, take its write
+ * privileges and return it.
+ * If a live process has them or if a recorded instrument
+ * is invalid or cannot be resolved, return 0.
+ */
+tb_jrn *tb_jrn_ctr(
+	const char *pth,
+	u64 rec_max
+);
+
+/*
+ * Release @jrn's write privileges and close it.
+ */
+void tb_jrn_dtr(
+	tb_jrn *jrn
+);
+
+/*
+ * Return the number of records of @jrn.
+ */
+static inline u64 tb_jrn_rec_nbr(
+	tb_jrn *jrn
+) {return tb_sgm_elm_nbr(jrn->sgm);}
+
+/*
+ * Return the record at index @idx of @jrn.
+ */
+static inline const tb_jrn_rec *tb_jrn_rec_get(
+	tb_jrn *jrn,
+	u64 idx
+) {check(idx < tb_jrn_rec_nbr(jrn)); return jrn->recs + idx;}
+
+/*
+ * Record the request of @ord and save at @req the index
+ * of its record, identifying the order in the journal.
+ * If @jrn is full, record nothing and return 1.
+ */
+uerr tb_jrn_req(
+	tb_jrn *jrn,
+	const tb_ord *ord,
+	u64 *req
+);
+
+/*
+ * Record the event of type @typ of the order of request
+ * index @req, whose state is now @ord.
+ * If @jrn is full, record nothing and return 1.
+ */
+uerr tb_jrn_upd(
+	tb_jrn *jrn,
+	u8 typ,
+	u64 req,
+	const tb_ord *ord
+);
+
+/*
+ * Record the addition of @amt of @ist to the wallet.
+ * If @jrn is full, record nothing and return 1.
+ */
+uerr tb_jrn_mov(
+	tb_jrn *jrn,
+	tb_ist *ist,
+	f64 amt
+);
+
+/*
+ * Replay @jrn into @wlt : apply movements, take the
+ * resources of requested orders, and collect those of
+ * cancelled and complete orders.
+ * Then call @opn_fnc with each order that is still
+ * open, in its last recorded state, and its request
+ * index.
+ * If a record is invalid, references an unknown
+ * instrument or updates a settled order, or if a
+ * reservation or a collection fails, return 1.
+ */
+uerr tb_jrn_rpl(
+	tb_jrn *jrn,
+	tb_wlt *wlt,
+	void (*opn_fnc)(
+		u64 req,
+		const tb_ord *ord,
+		void *arg
+	),
+	void *arg
+);
+
+#endif /* TB_JRN_H */
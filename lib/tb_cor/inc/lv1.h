@@ -21,9 +21,12 @@
  *   range in the form of [start + K * delta, start + (K + 1) * delta[,
  *   K being an integer, and start and delta being two construction-time
  *   constants.
- * - 2 : non-tick-gathering : each pixel row represents a
- *   single tick level. No aggregation is made accross tick
- *   levels.
+ * - 2 : tick-gathering : each pixel row represents a
+ *   fixed number of consecutive tick levels, 1 by default,
+ *   its value being the sum of their volumes. Rows are
+ *   aligned on multiples of this number, so that the
+ *   vertical re-anchoring is a shift of an integer number
+ *   of rows.
  * - 3 : synchronous re-anchoring : the heatmap must
  *   represent a relevant orderbook fraction. Consequence
  *   of 1 is that we only re-anchor horizontally once every
@@ -62,6 +65,46 @@
  * aid = (u64) ((u64) time / (u64) resolution).
  * A reanchoring always does a shift of an integer > 0
  * number of aids.
+ *
+ * A history can maintain several heatmaps, or views,
+ * of different resolutions and dimensions, from the
+ * same updates : each view has its own time grid, tick
+ * reference and re-anchoring, and is updated during
+ * the same processing pass. The primary view is the
+ * one provided at construction, and shares its time
+ * resolution with the bid-ask curves.
+ * Updates are kept until they exit all views.
+ *
+ * Each view stores its heatmap in its own cell format,
+ * so that consumers can use it without converting it :
+ * - f64 or f32 : the scaled value.
+ * - u16 or u8 : the scaled value clamped to [-1, 1]
+ *   and quantized over the whole integer range, 0 being
+ *   represented by the middle value.
+ * The scaled value is the volume multiplied by a scale,
+ * or with the logarithmic flag, the signed base 2
+ * logarithm of (1 + |volume|) multiplied by a scale.
+ * The conversion is made when cells are written, not
+ * as a separate pass.
+ *
+ * Heatmaps and bid-ask curves can be published to
+ * readers of other threads through up to three buffers.
+ * Each processing pass is an epoch : it generates
+ * heatmaps in the back buffer of each view, starting
+ * from the previously published one, then publishes
+ * them, and a copy of the curves, by incrementing the
+ * published epoch.
+ * A reader reads the published epoch, reads the frame
+ * of this epoch in place, and then validates it : the
+ * frame is consistent if the generation of the epoch
+ * that reuses its buffers has not started yet. With
+ * N buffers, this leaves readers N - 1 processing
+ * passes to complete. The producer is never blocked.
+ * With a single buffer, curves are published in place,
+ * and preparations and additions modify them : the
+ * generation of an epoch starts with the first of
+ * these, or with processing, after the previous
+ * publication.
  */
 
 #ifndef TB_COR_LV1_H
@@ -74,9 +117,25 @@
 types(
 	tb_lv1_upd,
 	tb_lv1_tck,
+	tb_lv1_viw,
 	tb_lv1_hst
 );
 
+/* Maximal number of views of a history. */
+#define TB_LV1_VIW_MAX 8
+
+/* Heatmap cell formats. */
+#define TB_LV1_FMT_F64 0
+#define TB_LV1_FMT_F32 1
+#define TB_LV1_FMT_U16 2
+#define TB_LV1_FMT_U8 3
+
+/* Logarithmic scale flag, or'ed with a cell format. */
+#define TB_LV1_FMT_LOG 0x80
+
+/* Maximal number of publication buffers. */
+#define TB_LV1_BUF_MAX 3
+
 /***********
  * History *
  ***********/
@@ -133,6 +192,86 @@ struct tb_lv1_tck {
 
 };
 
+/*
+ * Heatmap view.
+ */
+struct tb_lv1_viw {
+
+	/*
+	 * Dimensions.
+	 */
+
+	/* Time resolution. Used as time cell width and anchor. */
+	u64 tim_res;
+
+	/* Heatmap number of columns. */
+	u64 hmp_dim_tim;
+
+	/* Heatmap number of rows. Must be even. */
+	u64 hmp_dim_tck;
+
+	/* Heatmap time (x) cell width is the time anchor. */
+
+	/* Heatmap tick (Y) cell width, number of ticks per row. */
+	u64 tck_agg;
+
+	/* Heatmap time span (= tim_nb * tim_wid). */ 
+	u64 hmp_tim_spn;
+
+	/*
+	 * Format.
+	 */
+
+	/* Heatmap cell format, and scale flag. */
+	u8 hmp_fmt;
+
+	/* Heatmap volume scale. */
+	f64 hmp_scl;
+
+	/*
+	 * Times.
+	 */
+
+	/* Time below (<) which an order belongs to the heatmap.
+	 * = tim_cur aligned up to time anchor. */
+	u64 tim_hmp;
+
+	/* Last reanchoring time. */
+	u64 tim_rnc;
+
+	/*
+	 * Ticks.
+	 */
+
+	/* Current heatmap tick reference. Multiple of @tck_agg. */
+	u64 tck_ref;
+
+	/* Current heatmap tick range [min, max[. */
+	u64 hmp_tck_min;
+	u64 hmp_tck_max;
+
+	/*
+	 * Re-anchoring.
+	 */
+
+	/* Number of new columns in the heatmap at next gen. */
+	u64 hmp_shf_tim;
+
+	/*
+	 * Arrays.
+	 */
+
+	/* Heatmap. [hmp_dim_tim][hmp_dim_tck] cells of @hmp_fmt. */
+	void *hmp;
+
+	/* Heatmap buffers, @hmp being the last generated one. */
+	void *hmps[TB_LV1_BUF_MAX];
+
+	/* Aggregation row, 0 if one tick per row. [hmp_dim_tim]. */
+	f64 *row;
+
+};
+
 /*
  * Level 1 history.
  */
@@ -151,26 +290,14 @@ struct tb_lv1_hst {
 	 * Dimensions.
 	 */
 
-	/* Time resolution. Used as time cell width and anchor. */
+	/* Time resolution of the bid / ask curves and of the
+	 * primary view. */
 	u64 tim_res;
 
-	/* Heatmap number of columns. */
-	u64 hmp_dim_tim;
-
-	/* Heatmap number of rows. Must be even. */
-	u64 hmp_dim_tck;
-
-	/* Heatmap time (x) cell width is the time anchor. */
-
-	/* Heatmap tick (Y) cell width is 1. */
-
 	/* Number of elements of the bid / ask curves.
 	 * 0 : not supported. */
 	u64 bac_nb;
 
-	/* Heatmap time span (= (tim_nb + 1) * tim_wid). */ 
-	u64 hmp_tim_spn;
-
 	/* Bid / ask curves time span. */
 	u64 bac_tim_spn;
 
@@ -181,10 +308,8 @@ struct tb_lv1_hst {
 	/* Current time. */
 	u64 tim_cur;
 
-	/* Reanchoring time. */
-	u64 tim_rnc;
-
-	/* Time below (<) which an order belongs to the heatmap.
+	/* Primary heatmap end time, anchor of the bid / ask
+	 * curves.
 	 * = tim_cur aligned up to time anchor. */
 	u64 tim_hmp;
 
@@ -207,13 +332,6 @@ struct tb_lv1_hst {
 	/* Best (<) ask at current time. */
 	tb_lv1_tck *bst_cur_ask;
 
-	/* Current heatmap tick reference. */
-	u64 tck_ref;
-
-	/* Current heatmap tick range [min, max[. */
-	u64 hmp_tck_min;
-	u64 hmp_tck_max;
-
 	/*
 	 * Bid-ask curve metadata.
 	 */
@@ -234,18 +352,36 @@ struct tb_lv1_hst {
 	u64 ask_aid;
 
 	/*
-	 * Re-anchoring.
+	 * Views.
 	 */
 
-	/* Number of new columns in the heatmap at next gen. */
-	u64 hmp_shf_tim;
+	/* Number of views. */
+	u8 viw_nbr;
+
+	/* Views, the primary one first. */
+	tb_lv1_viw viws[TB_LV1_VIW_MAX];
 
 	/*
-	 * Arrays.
+	 * Publication.
 	 */
 
-	/* Heatmap. [hmp_dim_tck][hmp_dim_tim]. */
-	f64 *hmp;
+	/* Number of buffers. */
+	u8 buf_nbr;
+
+	/* Last published epoch, 0 if none. */
+	volatile a64 pub_epc;
+
+	/* Last epoch whose generation started, written
+	 * before any write to a published buffer. */
+	volatile a64 pub_wrt;
+
+	/* Published curves if more than one buffer. [bac_nb] */
+	u64 *pub_bids[TB_LV1_BUF_MAX];
+	u64 *pub_asks[TB_LV1_BUF_MAX];
+
+	/*
+	 * Arrays.
+	 */
 
 	/* Bid curve if supported. [bac_nb] */
 	u64 *bid_crv;
@@ -270,12 +406,43 @@ tb_lib_log_dec(cor, lv1);
  * Construct and return an empty history with a
  * current time of 0.
  * If @bac is set, generate the bid-ask curve.
+ * The primary heatmap uses the cell format @hmp_fmt
+ * and the volume scale @hmp_scl.
  */
 tb_lv1_hst *tb_lv1_ctr(
 	u64 tim_res,
 	u64 hmp_dim_tck,
 	u64 hmp_dim_tim,
-	u64 bac_nb
+	u64 bac_nb,
+	u8 hmp_fmt,
+	f64 hmp_scl
+);
+
+/*
+ * Add a view to @hst and return its index.
+ * Each row of its heatmap aggregates @tck_agg ticks.
+ * Its heatmap uses the cell format @hmp_fmt and the
+ * volume scale @hmp_scl.
+ * Must be called before the first preparation.
+ */
+u8 tb_lv1_viw_add(
+	tb_lv1_hst *hst,
+	u64 tim_res,
+	u64 hmp_dim_tim,
+	u64 hmp_dim_tck,
+	u64 tck_agg,
+	u8 hmp_fmt,
+	f64 hmp_scl
+);
+
+/*
+ * Use @buf_nbr buffers to publish @hst's heatmaps
+ * and curves.
+ * Must be called before the first preparation.
+ */
+void tb_lv1_buf_set(
+	tb_lv1_hst *hst,
+	u8 buf_nbr
 );
 
 /*
@@ -335,11 +502,177 @@ void tb_lv1_cln(
 );
 
 /*
- * Return @hst's heatmap.
+ * Return @hst's @viw_id-th view.
+ */
+static inline tb_lv1_viw *tb_lv1_viw_get(
+	tb_lv1_hst *hst,
+	u8 viw_id
+)
+{
+	assert(viw_id < hst->viw_nbr);
+	return hst->viws + viw_id;
+}
+
+/*
+ * Return the heatmap of @hst's @viw_id-th view.
+ * Cells are in the view's format.
+ */
+static inline void *tb_lv1_viw_hmp(
+	tb_lv1_hst *hst,
+	u8 viw_id
+) {return tb_lv1_viw_get(hst, viw_id)->hmp;}
+
+/*
+ * Return @hst's primary heatmap.
+ * Cells are in the primary view's format.
+ */
+static inline void *tb_lv1_hmp(
+	tb_lv1_hst *hst
+) {return hst->viws[0].hmp;}
+
+/*
+ * Return the last epoch published by @hst, 0 if none.
+ * Callable from any thread.
  */
-static inline f64 *tb_lv1_hmp(
+static inline u64 tb_lv1_pub_acq(
 	tb_lv1_hst *hst
-) {return hst->hmp;}
+) {return ns_atm(a64, red, acq, &hst->pub_epc);}
+
+/*
+ * Return the heatmap of @hst's @viw_id-th view
+ * published at epoch @epc.
+ * Callable from any thread.
+ */
+static inline const void *tb_lv1_pub_hmp(
+	tb_lv1_hst *hst,
+	u64 epc,
+	u8 viw_id
+) {return tb_lv1_viw_get(hst, viw_id)->hmps[epc % hst->buf_nbr];}
+
+/*
+ * If @hst supports it, return its bid curve published
+ * at epoch @epc.
+ * If not return 0.
+ * Callable from any thread.
+ */
+static inline const u64 *tb_lv1_pub_bid(
+	tb_lv1_hst *hst,
+	u64 epc
+) {return (hst->buf_nbr == 1) ? hst->bid_crv : hst->pub_bids[epc % hst->buf_nbr];}
+
+/*
+ * If @hst supports it, return its ask curve published
+ * at epoch @epc.
+ * If not return 0.
+ * Callable from any thread.
+ */
+static inline const u64 *tb_lv1_pub_ask(
+	tb_lv1_hst *hst,
+	u64 epc
+) {return (hst->buf_nbr == 1) ? hst->ask_crv : hst->pub_asks[epc % hst->buf_nbr];}
+
+/*
+ * Return 1 if all reads made from the frame of @hst
+ * published at epoch @epc read consistent data.
+ * Return 0 if the frame may have been overwritten.
+ * Callable from any thread.
+ */
+static inline u8 tb_lv1_pub_vld(
+	tb_lv1_hst *hst,
+	u64 epc
+)
+{
+
+	/* Order the frame reads before reading the
+	 * generated epoch. */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	const u64 wrt = ns_atm(a64, red, acq, &hst->pub_wrt);
+	return wrt < epc + hst->buf_nbr;
+
+}
+
+/*
+ * Return the size of a cell of format @fmt.
+ */
+static inline u8 tb_lv1_fmt_siz(
+	u8 fmt
+)
+{
+	switch (fmt & ~TB_LV1_FMT_LOG) {
+		case TB_LV1_FMT_F64: return sizeof(f64);
+		case TB_LV1_FMT_F32: return sizeof(f32);
+		case TB_LV1_FMT_U16: return sizeof(u16);
+		case TB_LV1_FMT_U8: return sizeof(u8);
+		default: assert(0, "unknown heatmap format %u.\n", fmt);
+	}
+	return 0;
+}
+
+/*
+ * Return the scaled value of @vol for format @fmt
+ * and scale @scl, clamped to [-1, 1] for integer
+ * formats.
+ * The logarithm is approximated with a relative
+ * error below 1e-6.
+ */
+static inline f64 tb_lv1_fmt_val(
+	u8 fmt,
+	f64 scl,
+	f64 vol
+)
+{
+
+	/* Apply the scale. */
+	f64 val;
+	if (fmt & TB_LV1_FMT_LOG) {
+
+		/* Decompose (1 + |@vol|) in man * 2 ^ exp,
+		 * man in [1, 2[. */
+		union {f64 flt; u64 bin;} dec = {.flt = 1 + ((vol < 0) ? -vol : vol)};
+		const s64 exp = (s64) ((dec.bin >> 52) & 0x7ff) - 1023;
+		dec.bin = (dec.bin & ((1ULL << 52) - 1)) | (1023ULL << 52);
+		const f64 man = dec.flt;
+
+		/* ln(man) = 2 * atanh(t), t = (man - 1) / (man + 1) <= 1 / 3. */
+		const f64 t = (man - 1) / (man + 1);
+		const f64 t2 = t * t;
+		const f64 lnm = 2 * t * (1 + t2 * (1. / 3 + t2 * (1. / 5 + t2 * (1. / 7 + t2 * (1. / 9 + t2 * (1. / 11))))));
+		const f64 lg2 = (f64) exp + lnm * 1.4426950408889634;
+		val = ((vol < 0) ? -lg2 : lg2) * scl;
+
+	} else {
+		val = vol * scl;
+	}
+
+	/* Clamp for integer formats. */
+	const u8 typ = fmt & ~TB_LV1_FMT_LOG;
+	if ((typ == TB_LV1_FMT_U16) || (typ == TB_LV1_FMT_U8)) {
+		if (val < -1) val = -1;
+		if (val > 1) val = 1;
+	}
+	return val;
+
+}
+
+/*
+ * Return the scaled value stored in the @idx-th cell
+ * of @hmp, of format @fmt.
+ */
+static inline f64 tb_lv1_fmt_get(
+	u8 fmt,
+	const void *hmp,
+	u64 idx
+)
+{
+	switch (fmt & ~TB_LV1_FMT_LOG) {
+		case TB_LV1_FMT_F64: return ((const f64 *) hmp)[idx];
+		case TB_LV1_FMT_F32: return (f64) ((const f32 *) hmp)[idx];
+		case TB_LV1_FMT_U16: return (f64) ((const u16 *) hmp)[idx] * (2. / 65535) - 1;
+		case TB_LV1_FMT_U8: return (f64) ((const u8 *) hmp)[idx] * (2. / 255) - 1;
+		default: assert(0, "unknown heatmap format %u.\n", fmt);
+	}
+	return 0;
+}
 
 /*
  * If @hst supports it, return its bid curve.
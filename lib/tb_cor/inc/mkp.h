@@ -23,9 +23,6 @@ types(
  */
 struct tb_mkp {
 
-	/* Marketplaces. */
-	ns_mapn_str mkps;
-
 	/* Symbol. */
 	const char *sym;
 
@@ -41,13 +38,25 @@ struct tb_mkp {
 
 };
 
+/*
+ * Marketplaces system.
+ * Marketplaces are indexed by a perfect hash of their
+ * symbols, built once under the lock. Lookups then
+ * take no lock.
+ */
 struct tb_mkp_sys {
 
-	/* Lock. */
+	/* Lock, taken to initialize. */
 	nh_spn lck;
 
-	/* Marketplaces map. */
-	ns_map_str mkps;
+	/* Set <=> initialized. */
+	volatile a64 rdy;
+
+	/* Perfect hash of symbols. */
+	tb_phf phf;
+
+	/* Marketplaces indexed by slot. */
+	tb_mkp **mkps;
 
 };
 
@@ -98,6 +107,7 @@ void tb_mkp_log(
 
 /*
  * Lookup a marketplace by symbol.
+ * Wait-free once initialized.
  */
 tb_mkp *tb_mkp_sch(
 	const char *sym
@@ -0,0 +1,138 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+/*
+ * The merge library provides a single time-ordered
+ * stream over several storage indexes.
+ *
+ * Each source is read block by block, in place : no
+ * element is ever copied. Sources are ordered in a
+ * binary min-heap keyed on the time of their next
+ * element, ties being broken by source index so that
+ * the output order is deterministic.
+ *
+ * The merger yields batches : a batch is a run of
+ * consecutive elements of a single source sharing
+ * the same time. Since batches never span blocks,
+ * elements of a source sharing the same time may be
+ * reported in two consecutive batches if they sit
+ * on a block boundary.
+ */
+
+#ifndef TB_COR_MRG_H
+#define TB_COR_MRG_H
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_mrg_src,
+	tb_mrg
+);
+
+/* Maximal number of sources of a merger. */
+#define TB_MRG_SRC_MAX 255
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Merge source.
+ */
+struct tb_mrg_src {
+
+	/* Index. */
+	tb_stg_idx *idx;
+
+	/* Current block, 0 if the source is exhausted. */
+	tb_stg_blk *blk;
+
+	/* Block arrays. */
+	const void *dats[TB_ANB_MAX];
+
+	/* Element sizes. */
+	const u8 *sizs;
+
+	/* Number of arrays. */
+	u8 dat_nbr;
+
+	/* Index of the next element to read in @blk. */
+	u64 elm_idx;
+
+	/* Number of readable elements in @blk. */
+	u64 elm_nbr;
+
+	/* Time of the next element. */
+	u64 tim;
+
+};
+
+/*
+ * Merger.
+ */
+struct tb_mrg {
+
+	/* Time after which (>) reading stops. */
+	u64 end;
+
+	/* Number of sources. */
+	u8 src_nbr;
+
+	/* Number of non-exhausted sources. */
+	u8 hep_nbr;
+
+	/* Sources. */
+	tb_mrg_src *srcs;
+
+	/* Min-heap of source indices. */
+	u8 *hep;
+
+	/* Number of elements of the last provided batch,
+	 * consumed at the next call. */
+	u64 lst_nbr;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a merger reading the elements
+ * of @idxs in [@stt, @end].
+ * Indexes must not be closed before the merger is
+ * deleted.
+ */
+tb_mrg *tb_mrg_ctr(
+	tb_stg_idx **idxs,
+	u8 idx_nbr,
+	u64 stt,
+	u64 end
+);
+
+/*
+ * Delete @mrg, unload all its blocks.
+ */
+void tb_mrg_dtr(
+	tb_mrg *mrg
+);
+
+/*
+ * If @mrg has no more elements to provide, return 0.
+ * Otherwise, initialize @dsts to the location of the
+ * next batch's arrays, store the index of the source
+ * that provides it at @src_idp, store its time at
+ * @timp, and return its number of elements.
+ * @dsts must have room for the number of arrays of
+ * the source's level.
+ * Locations are valid until the next call.
+ */
+u64 tb_mrg_nxt(
+	tb_mrg *mrg,
+	const void **dsts,
+	u8 *src_idp,
+	u64 *timp
+);
+
+#endif /* TB_COR_MRG_H */
@@ -80,6 +80,14 @@ static inline void tb_gos_fre(
  * Orderbook *
  *************/
 
+/* Number of lanes of orderbook vectors. */
+#define TB_OBK_LAN_NB 4
+
+/* Orderbook vectors, loadable from any element. */
+typedef f64 tb_obk_vf64 __attribute__((vector_size(TB_OBK_LAN_NB * 8), aligned(8)));
+typedef s64 tb_obk_vs64 __attribute__((vector_size(TB_OBK_LAN_NB * 8), aligned(8)));
+typedef u64 tb_obk_vu64 __attribute__((vector_size(TB_OBK_LAN_NB * 8), aligned(8)));
+
 /*
  * If @vol is a bid, return 0.
  * If @vol is an ask, return 1.
@@ -141,6 +149,25 @@ static inline uerr tb_obk_add(
 
 }
 
+/*
+ * Store @vol at @tck in @obk of @obk_nbr elements
+ * starting at @obk_stt. If out of range, store it at
+ * @snk instead, so that no branch is taken.
+ */
+static inline void tb_obk_put(
+	f64 *obk,
+	u64 obk_stt,
+	u64 obk_nbr,
+	f64 *snk,
+	u64 tck,
+	f64 vol
+)
+{
+	const u64 off = tck - obk_stt;
+	f64 *dst = (off < obk_nbr) ? obk + off : snk;
+	*dst = vol;
+}
+
 /*
  * Update @obk of @nbr elements starting at @stt,
  * with an orderbook snapshot located at @obs 
@@ -204,22 +231,69 @@ static inline void tb_obk_add_upds(
 )
 {
 	assert(upd_nbr);
-	const u64 obk_end = obk_stt + obk_nbr;
-	check(obk_stt < obk_end);
+	check(obk_stt < obk_stt + obk_nbr);
+
+	/* Compute extrema by vectors, store updates in order
+	 * so that the last update of a tick prevails. */
+	f64 snk;
+	tb_obk_vu64 mins = {(u64) -1, (u64) -1, (u64) -1, (u64) -1};
+	tb_obk_vu64 maxs = {0, 0, 0, 0};
+	u64 upd_idx = 0;
+	for (; upd_idx + TB_OBK_LAN_NB <= upd_nbr; upd_idx += TB_OBK_LAN_NB) {
+		const tb_obk_vu64 tck = *(const tb_obk_vu64 *) (tcks + upd_idx);
+		const tb_obk_vu64 lth = (tb_obk_vu64) (tck < mins);
+		const tb_obk_vu64 gth = (tb_obk_vu64) (tck > maxs);
+		mins = (tck & lth) | (mins & ~lth);
+		maxs = (tck & gth) | (maxs & ~gth);
+		for (u8 lan = 0; lan < TB_OBK_LAN_NB; lan++) {
+			tb_obk_put(obk, obk_stt, obk_nbr, &snk, tcks[upd_idx + lan], vols[upd_idx + lan]);
+		}
+	}
+
+	/* Reduce, and process remaining updates. */
 	u64 min = (u64) -1;
 	u64 max = 0;
-	for (u64 upd_idx = 0; upd_idx < upd_nbr; upd_idx++) {
+	for (u8 lan = 0; lan < TB_OBK_LAN_NB; lan++) {
+		min = (min < mins[lan]) ? min : mins[lan];
+		max = (max > maxs[lan]) ? max : maxs[lan];
+	}
+	for (; upd_idx < upd_nbr; upd_idx++) {
 		const u64 tck = tcks[upd_idx];
 		min = (min < tck) ? min : tck;
 		max = (max > tck) ? max : tck;
-		if ((obk_stt <= tck) && (tck < obk_end)) {
-			obk[tck - obk_stt] = vols[upd_idx];
-		}	
+		tb_obk_put(obk, obk_stt, obk_nbr, &snk, tck, vols[upd_idx]);
 	}
 	*tck_minp = min;
 	*tck_maxp = max;
 }
 
+/*
+ * Return the mask of the lanes of @cmp that are set.
+ */
+static inline u8 tb_obk_msk(
+	tb_obk_vs64 cmp
+) {return (u8) ((cmp[0] & 1) | (cmp[1] & 2) | (cmp[2] & 4) | (cmp[3] & 8));}
+
+/*
+ * Update the first and last indices at @fstp and @lstp
+ * with the lanes set in @msk, of a vector starting at
+ * @idx. Lanes must be provided in increasing index
+ * order.
+ * The first index is -1 until a lane is found.
+ */
+static inline void tb_obk_msk_add(
+	u64 idx,
+	u8 msk,
+	u64 *fstp,
+	u64 *lstp
+)
+{
+	const u64 fst = idx + (u64) __builtin_ctz(msk | (1 << TB_OBK_LAN_NB));
+	const u64 lst = idx + (u64) (31 - __builtin_clz(msk | 1));
+	*fstp = (msk && (*fstp == (u64) -1)) ? fst : *fstp;
+	*lstp = msk ? lst : *lstp;
+}
+
 /*
  * Determine the best and worst bid and ask ticks of @obk
  * in the [@stt, @end[ range.
@@ -243,57 +317,41 @@ static inline uerr tb_obk_bst_bat(
 	assert(stt < end);
 	check((!bst_bidp) == (!bst_askp));
 	check((!wst_bidp) == (!wst_askp));
-	uerr inv = 0;
-
-	/* Traverse the [@stt, @end[ range. */ 
-	u64 bst_bid = 0;
-	u64 bst_ask = (u64) -1;
-	u64 wst_bid = 0;
-	u64 wst_ask = (u64) -1;
-	u8 was_bid = 0;
-	u8 was_ask = 0;
-	for (u64 obk_idx = stt; obk_idx < end; obk_idx++) {
-		const f64 vol = obk[obk_idx];
-		if (vol == 0) continue;
-		const u64 tck_idx = obk_idx + tck_off;
-		check(obk_idx <= tck_idx);
-		const u8 is_bid = (vol < 0);
-
-		/* If bid : */
-		if (is_bid) {
-
-			/* If no bid before, report as worst bid. */ 
-			if (!was_bid) {
-				wst_bid = tck_idx;
-				was_bid = 1;
-			}
-
-			/* Report as best bid. */
-			bst_bid = tck_idx;
-
-			/* Detect inversion. */
-			if (was_ask) {
-				inv = 1;
-			}
-
-		}
-
-		/* If ask : */
-		else {
-			check(!is_bid);
-
-			/* If no ask before, report as best ask. */
-			if (!was_ask) {
-				bst_ask = tck_idx;
-				was_ask = 1;
-			}
-
-			/* Report as worst ask. */
-			wst_ask = tck_idx;
+	check(end - 1 <= end - 1 + tck_off);
+
+	/* Traverse the [@stt, @end[ range by vectors, and
+	 * track the first and last bids and asks from the
+	 * signs of volumes. */
+	const tb_obk_vf64 zro = {0, 0, 0, 0};
+	u64 bid_fst = (u64) -1;
+	u64 bid_lst = 0;
+	u64 ask_fst = (u64) -1;
+	u64 ask_lst = 0;
+	u64 obk_idx = stt;
+	for (; obk_idx + TB_OBK_LAN_NB <= end; obk_idx += TB_OBK_LAN_NB) {
+		const tb_obk_vf64 vol = *(const tb_obk_vf64 *) (obk + obk_idx);
+		tb_obk_msk_add(obk_idx, tb_obk_msk((tb_obk_vs64) (vol < zro)), &bid_fst, &bid_lst);
+		tb_obk_msk_add(obk_idx, tb_obk_msk((tb_obk_vs64) (vol > zro)), &ask_fst, &ask_lst);
+	}
 
-		}
-		
+	/* Remaining elements. */
+	u8 bid_msk = 0;
+	u8 ask_msk = 0;
+	for (u8 lan = 0; obk_idx + lan < end; lan++) {
+		const f64 vol = obk[obk_idx + lan];
+		bid_msk |= (u8) ((vol < 0) << lan);
+		ask_msk |= (u8) ((vol > 0) << lan);
 	}
+	tb_obk_msk_add(obk_idx, bid_msk, &bid_fst, &bid_lst);
+	tb_obk_msk_add(obk_idx, ask_msk, &ask_fst, &ask_lst);
+
+	/* Best bid is the last, best ask is the first. */
+	const u8 has_bid = (bid_fst != (u64) -1);
+	const u8 has_ask = (ask_fst != (u64) -1);
+	const u64 bst_bid = has_bid ? bid_lst + tck_off : 0;
+	const u64 wst_bid = has_bid ? bid_fst + tck_off : 0;
+	const u64 bst_ask = has_ask ? ask_fst + tck_off : (u64) -1;
+	const u64 wst_ask = has_ask ? ask_lst + tck_off : (u64) -1;
 
 	/* Check ordering. */
 	check(wst_bid <= bst_bid);
@@ -309,8 +367,8 @@ static inline uerr tb_obk_bst_bat(
 		*wst_askp = wst_ask;
 	}
 
-	/* Report any inversion. */
-	return inv;
+	/* Report any bid after an ask. */
+	return has_bid && has_ask && (ask_fst < bid_lst);
 
 }
 
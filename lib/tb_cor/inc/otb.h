@@ -0,0 +1,233 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_OTB_H
+#define TB_OTB_H
+
+/*
+ * The order table keeps track of the orders of a
+ * portfolio, without allocating after construction.
+ *
+ * Orders are stored in a preallocated slot array, free
+ * slots being chained in a free list. Each slot has a
+ * generation, incremented when its order is deleted.
+ * Orders are referenced by handles made of their slot
+ * index and generation, so that stale handles are
+ * detected instead of aliasing a newer order.
+ *
+ * The fields read and written when polling and
+ * processing fills (generation, status, volumes) are
+ * stored apart from the request data, so that hot
+ * records are compact.
+ *
+ * Orders are also indexed by their broker identifier in
+ * an open-addressed table with linear probing, twice as
+ * large as the slot array, so that broker updates are
+ * applied in constant time.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_otb_hot,
+	tb_otb_cld,
+	tb_otb
+);
+
+/*************
+ * Constants *
+ *************/
+
+/* Invalid handle. */
+#define TB_OTB_HDL_NON ((u64) -1)
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Hot order record.
+ */
+struct tb_otb_hot {
+
+	/* Generation, odd <=> used. */
+	u32 gen;
+
+	/* Status. */
+	u8 sts;
+
+	/* Requested volume of the primary instrument. */
+	f64 req_vol_prm;
+
+	/* Volume of the primary instrument traded. */
+	f64 vol_prm;
+
+	/* Volume of the secondary instrument traded. */
+	f64 vol_sec;
+
+};
+
+/*
+ * Cold order record.
+ */
+struct tb_otb_cld {
+
+	/* Instruments. */
+	tb_ist *prm;
+	tb_ist *sec;
+
+	/* Broker identifier. */
+	u64 id;
+
+	/* Requested prices. */
+	f64 req_prc_lim;
+	f64 req_prc_stp;
+
+	/* Type. */
+	u8 typ;
+
+	/* Next free slot, if free. */
+	u32 nxt;
+
+};
+
+/*
+ * Order table.
+ */
+struct tb_otb {
+
+	/* Maximal number of orders. */
+	u32 ord_max;
+
+	/* Number of orders. */
+	u32 ord_nbr;
+
+	/* First free slot, @ord_max if none. */
+	u32 fre;
+
+	/* Index mask. */
+	u64 idx_msk;
+
+	/* Hot records. */
+	tb_otb_hot *hots;
+
+	/* Cold records. */
+	tb_otb_cld *clds;
+
+	/* Slots indexed by broker identifier, -1 if empty. */
+	u32 *idxs;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return an empty table of at most
+ * @ord_max orders.
+ */
+tb_otb *tb_otb_ctr(
+	u32 ord_max
+);
+
+/*
+ * Delete @otb.
+ */
+void tb_otb_dtr(
+	tb_otb *otb
+);
+
+/*
+ * Add the order described by @ord to @otb and return
+ * its handle.
+ * If @otb is full, return TB_OTB_HDL_NON.
+ * Its broker identifier must not be used.
+ */
+u64 tb_otb_add(
+	tb_otb *otb,
+	const tb_ord *ord
+);
+
+/*
+ * Delete the order of handle @hdl from @otb.
+ * If @hdl is stale, return 1.
+ */
+uerr tb_otb_del(
+	tb_otb *otb,
+	u64 hdl
+);
+
+/*
+ * Return the handle of the order of broker identifier
+ * @id in @otb, TB_OTB_HDL_NON if none.
+ */
+u64 tb_otb_sch(
+	tb_otb *otb,
+	u64 id
+);
+
+/*
+ * Save the descriptor of the order of handle @hdl at
+ * @dst.
+ * If @hdl is stale, return 1.
+ */
+uerr tb_otb_get(
+	tb_otb *otb,
+	u64 hdl,
+	tb_ord *dst
+);
+
+/*
+ * Update the status and volumes of the order of @otb
+ * with @ord's broker identifier from @ord, and return
+ * its handle.
+ * If none, return TB_OTB_HDL_NON.
+ */
+u64 tb_otb_upd(
+	tb_otb *otb,
+	const tb_ord *ord
+);
+
+/*
+ * Return the hot record of the order of handle @hdl,
+ * 0 if @hdl is stale.
+ */
+static inline tb_otb_hot *tb_otb_hot_get(
+	tb_otb *otb,
+	u64 hdl
+)
+{
+	const u64 slt = hdl & 0xffffffff;
+	if (slt >= otb->ord_max) return 0;
+	tb_otb_hot *hot = otb->hots + slt;
+	return (hot->gen == (u32) (hdl >> 32)) ? hot : 0;
+}
+
+/*
+ * Return the status of the order of handle @hdl.
+ * If @hdl is stale, abort.
+ */
+static inline u8 tb_otb_sts(
+	tb_otb *otb,
+	u64 hdl
+)
+{
+	tb_otb_hot *hot = assert(tb_otb_hot_get(otb, hdl), "stale order handle %U.\n", hdl);
+	return hot->sts;
+}
+
+/*
+ * Add a fill of @vol_prm in exchange of @vol_sec to
+ * the order of handle @hdl, complete it if filled.
+ * If @hdl is stale, abort.
+ */
+void tb_otb_fil(
+	tb_otb *otb,
+	u64 hdl,
+	f64 vol_prm,
+	f64 vol_sec
+);
+
+#endif /* TB_OTB_H */
@@ -0,0 +1,89 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_PHF_H
+#define TB_PHF_H
+
+/*
+ * A perfect hash function maps each key of a fixed
+ * set of strings to a distinct slot, so that a lookup
+ * is two hashes and one comparison.
+ *
+ * Keys are first hashed into buckets, then each bucket
+ * receives a displacement seed such that the second
+ * hash of its keys lands in free slots. Buckets are
+ * placed largest first.
+ *
+ * Strings that are not keys also map to a slot, which
+ * the caller must check.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_phf
+);
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Perfect hash function.
+ */
+struct tb_phf {
+
+	/* Bucket mask. */
+	u32 bkt_msk;
+
+	/* Slot mask. */
+	u32 slt_msk;
+
+	/* Displacement seeds of buckets. */
+	u64 *dsps;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct @phf for the @key_nbr distinct keys of
+ * @keys and save the slot of each key in @slts.
+ */
+void tb_phf_ctr(
+	tb_phf *phf,
+	const char **keys,
+	u32 key_nbr,
+	u32 *slts
+);
+
+/*
+ * Delete @phf.
+ */
+void tb_phf_dtr(
+	tb_phf *phf
+);
+
+/*
+ * Return the number of slots of @phf.
+ */
+static inline u32 tb_phf_slt_nbr(
+	tb_phf *phf
+) {return phf->slt_msk + 1;}
+
+/*
+ * Return the slot of @key.
+ */
+static inline u32 tb_phf_slt(
+	tb_phf *phf,
+	const char *key
+)
+{
+	const u64 dsp = phf->dsps[tb_str_hsh(key, 0) & phf->bkt_msk];
+	return (u32) (tb_str_hsh(key, dsp) & phf->slt_msk);
+}
+
+#endif /* TB_PHF_H */
@@ -0,0 +1,305 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+/*
+ * The publisher library shares the level 1 heatmaps
+ * and bid-ask curves of a set of instruments with
+ * local consumer processes, so that the reconstruction
+ * is done once regardless of the number of consumers.
+ *
+ * A publisher maintains a level 1 reconstructor per
+ * instrument and, after each step, copies its primary
+ * heatmap and curves in the instrument's publication
+ * segment, stored next to its index.
+ * The segment has a single region made of a header,
+ * the heatmap and the curves.
+ * The publisher holds the segment's write privilege,
+ * so that an instrument has a single publisher.
+ *
+ * Frames are guarded by a sequence lock : the sequence
+ * is odd while a frame is being written, and is
+ * increased by 2 by each frame, 0 meaning that no
+ * frame was published yet.
+ * Consumers read the sequence, read the frame in place,
+ * and validate it by reading the sequence again : the
+ * frame is consistent if the sequence did not change.
+ * Consumers map the segment read-only : they never
+ * write the frame or the sequence, and never block the
+ * publisher.
+ */
+
+#ifndef TB_COR_PUB_H
+#define TB_COR_PUB_H
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_pub_imp,
+	tb_pub_hdr,
+	tb_pub_src,
+	tb_pub,
+	tb_pub_cns
+);
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Publication segment descriptor.
+ * Verified by consumers when opening the segment.
+ */
+struct tb_pub_imp {
+
+	/* Time resolution. */
+	u64 tim_res;
+
+	/* Heatmap number of columns. */
+	u64 hmp_dim_tim;
+
+	/* Heatmap number of rows. */
+	u64 hmp_dim_tck;
+
+	/* Number of bid-ask curves cells. */
+	u64 bac_nb;
+
+};
+
+/*
+ * Publication header.
+ * Followed by :
+ * f64 hmp[hmp_dim_tim][hmp_dim_tck];
+ * u64 bid[bac_nb];
+ * u64 ask[bac_nb];
+ */
+struct tb_pub_hdr {
+
+	/* Sequence, odd while a frame is written. */
+	volatile a64 seq;
+
+	/* Current time of the frame. */
+	u64 tim;
+
+	/* Heatmap tick range start. */
+	u64 tck_min;
+
+	/* Bid-ask curves start AID. */
+	u64 bac_aid;
+
+};
+
+/*
+ * Published instrument.
+ */
+struct tb_pub_src {
+
+	/* Reconstructor. */
+	tb_dr1 *dr1;
+
+	/* Publication segment. */
+	tb_sgm *sgm;
+
+	/* Header. */
+	tb_pub_hdr *hdr;
+
+	/* Published heatmap. */
+	f64 *hmp;
+
+	/* Published curves. */
+	u64 *bid;
+	u64 *ask;
+
+	/* Last published sequence. */
+	u64 seq;
+
+};
+
+/*
+ * Publisher.
+ */
+struct tb_pub {
+
+	/* Storage system. */
+	tb_stg_sys *sys;
+
+	/* Segment descriptor. */
+	tb_pub_imp imp;
+
+	/* Number of instruments. */
+	u8 src_nbr;
+
+	/* Maximal number of instruments. */
+	u8 src_max;
+
+	/* Instruments. */
+	tb_pub_src *srcs;
+
+};
+
+/*
+ * Publication consumer.
+ */
+struct tb_pub_cns {
+
+	/* Publication segment. */
+	tb_sgm *sgm;
+
+	/* Segment descriptor. */
+	tb_pub_imp imp;
+
+	/* Header. */
+	tb_pub_hdr *hdr;
+
+	/* Published heatmap. */
+	const f64 *hmp;
+
+	/* Published curves. */
+	const u64 *bid;
+	const u64 *ask;
+
+};
+
+/*****************
+ * Publisher API *
+ *****************/
+
+/*
+ * Construct and return a publisher of at most
+ * @src_max instruments of @sys, with the provided
+ * heatmap and curves dimensions.
+ */
+tb_pub *tb_pub_ctr(
+	tb_stg_sys *sys,
+	u8 src_max,
+	u64 tim_res,
+	u64 hmp_dim_tck,
+	u64 hmp_dim_tim,
+	u64 bac_nb
+);
+
+/*
+ * Delete @pub, release its segments.
+ */
+void tb_pub_dtr(
+	tb_pub *pub
+);
+
+/*
+ * Publish (@mkp, @ist) with data up to @tim_cur.
+ * Return the instrument's index in @pub.
+ * Abort if a live publisher already publishes it.
+ */
+u8 tb_pub_add(
+	tb_pub *pub,
+	const char *mkp,
+	const char *ist,
+	u64 tim_cur
+);
+
+/*
+ * Update all instruments of @pub until @tim_cur, and
+ * publish their new frames.
+ */
+void tb_pub_stp(
+	tb_pub *pub,
+	u64 tim_cur
+);
+
+/****************
+ * Consumer API *
+ ****************/
+
+/*
+ * Open the publication of (@mkp, @ist) stored in the
+ * storage directory @pth, with the provided heatmap
+ * and curves dimensions.
+ * Abort if it does not exist or if dimensions do not
+ * match.
+ */
+tb_pub_cns *tb_pub_cns_opn(
+	const char *pth,
+	const char *mkp,
+	const char *ist,
+	u64 tim_res,
+	u64 hmp_dim_tck,
+	u64 hmp_dim_tim,
+	u64 bac_nb
+);
+
+/*
+ * Close @cns.
+ */
+void tb_pub_cns_cls(
+	tb_pub_cns *cns
+);
+
+/*
+ * Wait until no frame is being written, and return
+ * the current sequence, 0 if nothing was published.
+ */
+static inline u64 tb_pub_cns_acq(
+	tb_pub_cns *cns
+)
+{
+	u64 seq;
+	while ((seq = ns_atm(a64, red, acq, &cns->hdr->seq)) & 1);
+	return seq;
+}
+
+/*
+ * Return 1 if all reads made from @cns's frame since
+ * sequence @seq was acquired read consistent data.
+ * Return 0 if the frame may have been overwritten.
+ */
+static inline u8 tb_pub_cns_vld(
+	tb_pub_cns *cns,
+	u64 seq
+)
+{
+
+	/* Order the frame reads before reading the
+	 * sequence again. */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return ns_atm(a64, red, acq, &cns->hdr->seq) == seq;
+
+}
+
+/*
+ * Return the current time of @cns's frame.
+ */
+static inline u64 tb_pub_cns_tim(
+	tb_pub_cns *cns
+) {return cns->hdr->tim;}
+
+/*
+ * Return the heatmap tick range start of @cns's frame.
+ */
+static inline u64 tb_pub_cns_tck(
+	tb_pub_cns *cns
+) {return cns->hdr->tck_min;}
+
+/*
+ * Return @cns's heatmap.
+ */
+static inline const f64 *tb_pub_cns_hmp(
+	tb_pub_cns *cns
+) {return cns->hmp;}
+
+/*
+ * If @cns supports it, return its bid curve.
+ * If not return 0.
+ */
+static inline const u64 *tb_pub_cns_bid(
+	tb_pub_cns *cns
+) {return cns->bid;}
+
+/*
+ * If @cns supports it, return its ask curve.
+ * If not return 0.
+ */
+static inline const u64 *tb_pub_cns_ask(
+	tb_pub_cns *cns
+) {return cns->ask;}
+
+#endif /* TB_COR_PUB_H */
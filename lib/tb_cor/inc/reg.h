@@ -0,0 +1,66 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_REG_H
+#define TB_REG_H
+
+/*
+ * A registry is an append only open addressing table of
+ * a power of two number of slots, kept at most half full
+ * by its owner, so that probing is bounded.
+ *
+ * Entries pack a 32 bits tag, that quickly discards
+ * mismatches, and a non-null 32 bits value, that
+ * references what is registered. They are published
+ * with a release store once what they reference is
+ * built, and never removed.
+ *
+ * Lookups take no lock and are wait-free. Insertions
+ * must be serialized by the owner, which searches again
+ * after serializing.
+ */
+
+/*
+ * Return the value of the entry of @tag in the @slt_nbr
+ * slots of @slts, probing from slot @hom, 0 if none.
+ * If @equ is set, entries of @tag must also satisfy it
+ * with @arg.
+ */
+static inline u32 tb_reg_sch(
+	volatile a64 *slts,
+	u64 slt_nbr,
+	u64 hom,
+	u32 tag,
+	u8 (*equ)(u32 val, const void *arg),
+	const void *arg
+)
+{
+	const u64 msk = slt_nbr - 1;
+	for (u64 slt = hom & msk;; slt = (slt + 1) & msk) {
+		const u64 ent = ns_atm(a64, red, acq, slts + slt);
+		if (!ent) return 0;
+		const u32 val = (u32) ent;
+		if (((u32) (ent >> 32) == tag) && ((!equ) || (*equ)(val, arg))) return val;
+	}
+}
+
+/*
+ * Publish the entry of @tag and non-null value @val in
+ * the @slt_nbr slots of @slts, probing from slot @hom.
+ * Must be serialized with other insertions.
+ */
+static inline void tb_reg_put(
+	volatile a64 *slts,
+	u64 slt_nbr,
+	u64 hom,
+	u32 tag,
+	u32 val
+)
+{
+	check(val);
+	const u64 msk = slt_nbr - 1;
+	u64 slt = hom & msk;
+	while (slts[slt]) slt = (slt + 1) & msk;
+	ns_atm(a64, wrt, rel, slts + slt, ((u64) tag << 32) | val);
+}
+
+#endif /* TB_REG_H */
@@ -27,6 +27,13 @@
  *   - maximal number of elements.
  *   but array element size can vary from one array to
  *   the other.
+ *
+ * The write privilege is leased : its holder records its
+ * pid and process start time in the sync page. If the
+ * holder dies while holding it, a new writer can detect
+ * that the lease is stale and recover the privilege.
+ * The pid alone is not enough, as it can be reused by
+ * another process after the holder's death.
  */
 
 /*********
@@ -39,6 +46,13 @@ types(
 	tb_sgm
 );
 
+/*************
+ * Constants *
+ *************/
+
+/* Number of traced write publications. */
+#define TB_SGM_PUB_NBR 32
+
 /**************
  * Structures *
  **************/
@@ -56,7 +70,7 @@ struct tb_sgm_syn {
 	/* Set <=> initialization is done. */
 	volatile a64 ini_cpl;
 
-	/* Set <=> someone is writing. */
+	/* Lease of the writer, 0 if none. See sgm.c. */
 	volatile a64 wrt;
 
 	/*
@@ -66,6 +80,20 @@ struct tb_sgm_syn {
 	 */
 	volatile a64 elm_nb;
 
+	/* Lease of the recoverer of @wrt, 0 if none. */
+	volatile a64 rcv;
+
+	/* Number of traced write publications. */
+	volatile a64 pub_nbr;
+
+	/* Number of elements after each of the last
+	 * traced publications. */
+	volatile a64 pub_ends[TB_SGM_PUB_NBR];
+
+	/* Monotonic time of each of the last traced
+	 * publications. */
+	volatile a64 pub_tims[TB_SGM_PUB_NBR];
+
 };
 
 /*
@@ -157,6 +185,7 @@ struct tb_sgm {
 
 /* Size of the synchronization block. */
 #define TB_SGM_SIZ_SYN 1024
+_Static_assert(sizeof(tb_sgm_syn) <= TB_SGM_SIZ_SYN, "sync data too large.");
 
 /* Offset of the synchronization block in the metadata block. */ 
 #define TB_SGM_OFF_DSC (TB_SGM_OFF_SYN + TB_SGM_SIZ_SYN)
@@ -182,6 +211,9 @@ struct tb_sgm {
 /* Size of an array block. */
 #define TB_SGM_SIZ_ARR(elm_nbr, elm_siz) TB_SGM_PAG_RND((elm_nbr * elm_siz))
 
+/* Open mode : map read-only. */
+#define TB_SGM_RDO 2
+
 /*****************
  * Lifecycle API *
  *****************/
@@ -192,6 +224,9 @@ struct tb_sgm {
  * initialize it with @imp_ini, @arr_nb, @elm_max and @elm_sizs.
  * Otherwise, check that @imp_ini, @arr_nb, @elm_max and @elm_sizs
  * do match with the loaded content.
+ * If @crt is TB_SGM_RDO, map it read-only : it must
+ * exist with the expected size, and its initialization
+ * is waited for.
  */
 tb_sgm *tb_sgm_vopn(
 	u8 crt,
@@ -277,6 +312,19 @@ static inline u64 tb_sgm_elm_nbr(
 	tb_sgm *sgm
 ) {return ns_atm(a64, red, acq, &sgm->syn->elm_nb);}
 
+/*
+ * Return the monotonic time of the write publication
+ * of @sgm's element @elm_idx.
+ * If it is older than the traced publications, return
+ * the time of the oldest one.
+ * If publications are not traced, or if @elm_idx is
+ * not published, return 0.
+ */
+u64 tb_sgm_pub_tim(
+	tb_sgm *sgm,
+	u64 elm_idx
+);
+
 /*
  * Return @sgm's maximal number of elements.
  */
@@ -333,6 +381,17 @@ uerr tb_sgm_wrt_get(
 	u64 *offp
 );
 
+/*
+ * Attempt to acquire @sgm's write privilege, recovering
+ * it if its holder does not exist anymore.
+ * If so, store its end offset at @offp, and return 0.
+ * If a live process has it, return 1.
+ */
+uerr tb_sgm_wrt_rcv(
+	tb_sgm *sgm,
+	u64 *offp
+);
+
 /*
  * Get the @arr_nb write locations for @elm_nb values
  * of @sgm into @dst.
@@ -356,6 +415,15 @@ u64 tb_sgm_wrt_don(
 	u64 wrt_nb
 );
 
+/*
+ * Drop all elements of @sgm.
+ * Write priv must be owned.
+ * Only valid if no one reads @sgm.
+ */
+void tb_sgm_wrt_rst(
+	tb_sgm *sgm
+);
+
 /*
  * Complete the current write.
  * Updates previous indices for the written location.
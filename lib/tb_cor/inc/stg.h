@@ -11,7 +11,9 @@ types(
 	tb_stg_blk_syn,
 	tb_stg_blk,
 	tb_stg_idx,
-	tb_stg_sys
+	tb_stg_sys,
+	tb_stg_scn_wrk,
+	tb_stg_imp_wrk
 );
 
 /**************
@@ -64,8 +66,9 @@ struct tb_stg_blk {
  */
 struct tb_stg_idx {
 
-	/* Indexes of the same system indexed by identifier. */
-	ns_mapn_str idxs;
+	/* Indexes of the same system indexed by identifier :
+	 * (mkp symbol, ist symbol, lvl). */
+	ns_mapn_u64 idxs;
 
 	/* Blocks indexed by start time. */
 	ns_map_u64 blks;
@@ -89,14 +92,11 @@ struct tb_stg_idx {
 	/* Usage counter. */
 	u32 uctr;
 
-	/* Identifier : "mkp:ist:lvl" */
-	tb_str idt;
+	/* Marketplace symbol. */
+	u32 mkp;
 
-	/* Marketplace. */
-	tb_str mkp;
-
-	/* Instrument. */
-	tb_str ist;
+	/* Instrument symbol. */
+	u32 ist;
 
 };
 
@@ -109,7 +109,7 @@ struct tb_stg_sys {
 	const char *pth;
 
 	/* Indexes. */
-	ns_map_str idxs;
+	ns_map_u64 idxs;
 
 	/* Number of active data interfaces. */
 	u32 itf_nbr;
@@ -126,6 +126,83 @@ struct tb_stg_sys {
 
 };
 
+/*
+ * Parallel scan worker descriptor.
+ */
+struct tb_stg_scn_wrk {
+
+	/* Scanned index. */
+	tb_stg_idx *idx;
+
+	/* Scanned time range [stt, end]. */
+	u64 stt;
+	u64 end;
+
+	/* Scanned block range [stt, end[. */
+	u64 blk_stt;
+	u64 blk_end;
+
+	/* Block function. */
+	void (*blk_fnc)(
+		void *ctx,
+		const void **arrs,
+		u64 elm_nbr,
+		const void *obs,
+		void *arg
+	);
+
+	/* Worker context. */
+	void *ctx;
+
+	/* Block function argument. */
+	void *arg;
+
+	/* Completion counter. */
+	volatile a64 *don;
+
+};
+
+/*
+ * Bulk import worker descriptor.
+ */
+struct tb_stg_imp_wrk {
+
+	/* Destination index. */
+	tb_stg_idx *idx;
+
+	/* Built block range [stt, end[. */
+	u64 blk_stt;
+	u64 blk_end;
+
+	/* Block number of the first imported block. */
+	u64 blk_fst;
+
+	/* Input element of the first imported block. */
+	u64 elm_fst;
+
+	/* Number of input elements. */
+	u64 elm_nbr;
+
+	/* Fill function. */
+	void (*fil_fnc)(
+		void **dsts,
+		u64 stt,
+		u64 nbr,
+		void *fil_arg
+	);
+
+	/* Fill function argument. */
+	void *fil_arg;
+
+	/* Start and end times of built blocks,
+	 * indexed by imported block number. */
+	u64 (*tims)[2];
+
+	/* Completion counter. */
+	volatile a64 *don;
+
+};
+
 /**************
  * System API *
  **************/
@@ -168,11 +245,21 @@ void *tb_stg_tst_syn(
  * Index API *
  *************/
 
+/* Open with write privileges. */
+#define TB_STG_WRT 1
+
+/* Open with write privileges, recover them if their
+ * holder died. */
+#define TB_STG_RCV 2
+
 /*
  * Open and return the index for "@mkp:@ist:@lvl". 
  * If @wrt is set, attempt to open with write privileges,
  * and if success, store the write key (non 0) at @keyp,
  * and return the index; if failure, return 0.
+ * If @wrt is TB_STG_RCV, write privileges held by a
+ * dead process are recovered; tb_stg_rcv must then be
+ * called before any write.
  * Otherwise, return the index (always succeeds).
  */
 tb_stg_idx *tb_stg_opn(
@@ -184,6 +271,19 @@ tb_stg_idx *tb_stg_opn(
 	u64 *key
 );
 
+/*
+ * tb_stg_opn for the marketplace and instrument of
+ * symbols @mkp and @ist.
+ */
+tb_stg_idx *tb_stg_opn_sym(
+	tb_stg_sys *sys,
+	u32 mkp,
+	u32 ist,
+	u8 lvl,
+	u8 wrt,
+	u64 *key
+);
+
 /*
  * Close @idx.
  * If @key is set, release its write privileges; in this
@@ -209,6 +309,17 @@ _own_ tb_stg_blk *tb_stg_lod_tim(
 	u64 tim
 );
 
+/*
+ * If @idx has no element at or after (>=) @tim,
+ * return 0.
+ * Otherwise, load the first block that has one
+ * and return it.
+ */
+_own_ tb_stg_blk *tb_stg_lod_nxt(
+	tb_stg_idx *idx,
+	u64 tim
+);
+
 /*
  * Return @blk's max number of elements.
  */
@@ -223,6 +334,15 @@ static inline u64 tb_stg_elm_nbr(
 	tb_stg_blk *blk
 ) {return tb_sgm_elm_nbr(blk->sgm);}
 
+/*
+ * Return the monotonic time of the write publication
+ * of @blk's element @elm_idx. See tb_sgm_pub_tim.
+ */
+static inline u64 tb_stg_pub_tim(
+	tb_stg_blk *blk,
+	u64 elm_idx
+) {return tb_sgm_pub_tim(blk->sgm, elm_idx);}
+
 /*
  * Initialize @dsts with @blk's arrays, set *@sizsp with
  * the array containing its element sizes, return its
@@ -389,10 +509,69 @@ static inline void *tb_stg_std(
 	tb_stg_blk *blk
 ) {return tb_sgm_rgn(blk->sgm, 1);}
 
+/*****************
+ * Parallel scan *
+ *****************/
+
+/*
+ * Scan the elements of @idx in [@stt, @end] with
+ * @thr_nbr threads, the caller being one of them.
+ * The range is split at block boundaries in @thr_nbr
+ * contiguous block ranges, the n-th one being
+ * processed by the n-th worker.
+ * For each block, a worker calls @blk_fnc with its
+ * context, the block arrays clipped to the range, their
+ * number of elements, and if the level supports it and
+ * if it exists, the orderbook snapshot of the preceding
+ * block, so that it can reconstruct state without
+ * reading earlier blocks.
+ * Worker contexts are stored contiguously at @ctxs with
+ * a stride of @ctx_siz bytes and are initialized by
+ * the caller.
+ * Once all workers are done, if @red_fnc is set,
+ * contexts are reduced in order in the first one by
+ * calling @red_fnc(ctx_0, ctx_n, @arg) for n in
+ * [1, @thr_nbr[.
+ * Each worker reads through a private storage system,
+ * @idx's system is never accessed concurrently.
+ */
+void tb_stg_scn(
+	tb_stg_idx *idx,
+	u64 stt,
+	u64 end,
+	u8 thr_nbr,
+	void (*blk_fnc)(
+		void *ctx,
+		const void **arrs,
+		u64 elm_nbr,
+		const void *obs,
+		void *arg
+	),
+	void (*red_fnc)(
+		void *dst,
+		void *src,
+		void *arg
+	),
+	void *ctxs,
+	u64 ctx_siz,
+	void *arg
+);
+
 /*************
  * Write API *
  *************/
 
+/*
+ * Bulk import functions conform to the following
+ * behavior :
+ * - input elements are provided by a fill function
+ *   that writes a given range of input elements at
+ *   the provided array locations. It may be called
+ *   concurrently for disjoint ranges.
+ * - input elements are sorted by time and start after
+ *   (>=) the end of the stored data.
+ */
+
 /*
  * Write functions conform to the following behavior :
  * - they write exactly @nb elements at the end of the
@@ -414,4 +593,43 @@ void tb_stg_wrt(
 	void *val_arg
 );
 
+/*
+ * Bulk data import.
+ * Append @nb input elements to @idx.
+ * The current last block is completed first, then the
+ * remaining elements are written in new blocks built
+ * in parallel by @thr_nbr threads, the caller being
+ * one of them.
+ * Built blocks are then published in order in the index
+ * table, and full ones are validated in order.
+ */
+void tb_stg_imp(
+	tb_stg_idx *idx,
+	u64 nb,
+	u8 thr_nbr,
+	void (*fil_fnc)(
+		void **dsts,
+		u64 stt,
+		u64 nbr,
+		void *fil_arg
+	),
+	void *fil_arg,
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg),
+	void *val_arg
+);
+
+/*
+ * Recover @idx after its previous writer died.
+ * Recover write privileges of its blocks, reconcile the
+ * index table with the blocks' data, publish blocks that
+ * were written but not reported, reset those that can't
+ * be, and redo interrupted validations.
+ * @idx must be opened with write privileges.
+ */
+void tb_stg_rcv(
+	tb_stg_idx *idx,
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg),
+	void *val_arg
+);
+
 #endif /* TB_COR_STG_H */
@@ -35,6 +35,38 @@ static inline void tb_str_cpy(
 	do {c = *(d++) = *(s++);} while (c);	
 }
 
+/*
+ * Equality test.
+ */
+static inline u8 tb_str_equ(
+	const char *str0,
+	const char *str1
+)
+{
+	char c;
+	do {
+		c = *(str0++);
+		if (c != *(str1++)) return 0;
+	} while (c);
+	return 1;
+}
+
+/*
+ * Return the hash of @str with seed @sed.
+ */
+static inline u64 tb_str_hsh(
+	const char *str,
+	u64 sed
+)
+{
+	u64 hsh = 0xcbf29ce484222325 ^ sed;
+	char c;
+	while ((c = *(str++))) {
+		hsh = (hsh ^ (u8) c) * 0x100000001b3;
+	}
+	return hsh ^ (hsh >> 29);
+}
+
 /***************************
  * Multi string generation *
  ***************************/
@@ -0,0 +1,438 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+/*
+ * The statistics library provides a low-overhead
+ * instrumentation of the level 1 and storage hot paths.
+ *
+ * It is compiled in only if TB_STT is defined. Otherwise,
+ * instrumentation macros expand to nothing.
+ *
+ * It maintains :
+ * - event counters (updates added, rows rewritten,
+ *   re-anchors, block loads, etc...).
+ * - for each instrumented function, its number of calls
+ *   and the total number of cycles spent in it.
+ * - optionally, for each instrumented function, the
+ *   totals of hardware counters (cycles, instructions,
+ *   cache misses, page faults) read through
+ *   perf_event_open. Those are opened per thread and
+ *   read by system calls, so they are much heavier than
+ *   the rest, and only meant for profiling sessions.
+ *
+ * - latency histograms of the ingestion path, from the
+ *   publication of a write in a storage segment, to
+ *   its discovery by a reader, to its addition to a
+ *   level 1 history, to the heatmap publication.
+ *   Timestamps are taken from the system monotonic
+ *   clock, so that processes can be compared. Segments
+ *   keep the times of their last write publications,
+ *   and a stage is measured from the publication of
+ *   the oldest element it handles. Stages are only
+ *   sampled when they handle new elements, and are only
+ *   meaningful for live data.
+ *   Histograms are log-linear : each power of two range
+ *   is split in 2 ^ TB_STT_LAT_SUB buckets, which
+ *   bounds the relative error of percentiles.
+ *
+ * Statistics are stored in a set of pages that can be
+ * exported as a shared segment, to be read by an
+ * external process (see the "tb stt" command).
+ * Each thread claims its own page on its first update,
+ * so that threads do not share counters cache lines.
+ * If there are more threads than pages, pages are
+ * shared. Counters are updated atomically, and can be
+ * read at any time ; readers sum pages.
+ */
+
+#ifndef TB_COR_STT_H
+#define TB_COR_STT_H
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_stt_fnc,
+	tb_stt_lat,
+	tb_stt_pag,
+	tb_stt_set,
+	tb_stt_scp
+);
+
+/*************
+ * Constants *
+ *************/
+
+/* Stats set version. */
+#define TB_STT_VER 3
+
+/* Number of pages of a set. */
+#define TB_STT_PAG_NBR 64
+
+/* Events. */
+#define TB_STT_EVT_LV1_UPD 0
+#define TB_STT_EVT_LV1_ROW 1
+#define TB_STT_EVT_LV1_IDL 2
+#define TB_STT_EVT_LV1_RNC 3
+#define TB_STT_EVT_STG_LOD 4
+#define TB_STT_EVT_STG_WRT 5
+#define TB_STT_EVT_NBR 6
+
+/* Instrumented functions. */
+#define TB_STT_FNC_LV1_ADD 0
+#define TB_STT_FNC_LV1_PRC 1
+#define TB_STT_FNC_LV1_CLN 2
+#define TB_STT_FNC_DR1_ADD 3
+#define TB_STT_FNC_STG_WRT 4
+#define TB_STT_FNC_NBR 5
+
+/* Hardware counters. */
+#define TB_STT_HWC_CYC 0
+#define TB_STT_HWC_INS 1
+#define TB_STT_HWC_CMS 2
+#define TB_STT_HWC_PGF 3
+#define TB_STT_HWC_NBR 4
+
+/* Latencies. */
+#define TB_STT_LAT_DSC 0
+#define TB_STT_LAT_ADD 1
+#define TB_STT_LAT_HMP 2
+#define TB_STT_LAT_NBR 3
+
+/* Log2 of the number of latency buckets per power
+ * of two. */
+#define TB_STT_LAT_SUB 5
+
+/* Number of latency buckets. */
+#define TB_STT_LAT_BKT_NBR ((64 - TB_STT_LAT_SUB + 1) << TB_STT_LAT_SUB)
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Function statistics.
+ */
+struct tb_stt_fnc {
+
+	/* Number of calls. */
+	volatile a64 cal;
+
+	/* Total number of cycles. */
+	volatile a64 cyc;
+
+	/* Hardware counters totals, for calls made
+	 * by threads that opened them. */
+	volatile a64 hwcs[TB_STT_HWC_NBR];
+
+};
+
+/*
+ * Latency histogram, in nanoseconds.
+ */
+struct tb_stt_lat {
+
+	/* Number of samples. */
+	volatile a64 cnt;
+
+	/* Sum of samples. */
+	volatile a64 sum;
+
+	/* Buckets. */
+	volatile a64 bkts[TB_STT_LAT_BKT_NBR];
+
+};
+
+/*
+ * Statistics page, updated by one thread.
+ * Aligned on cache lines so that pages of different
+ * threads do not share any.
+ */
+struct tb_stt_pag {
+
+	/* Event counters. */
+	volatile a64 evts[TB_STT_EVT_NBR];
+
+	/* Function statistics. */
+	tb_stt_fnc fncs[TB_STT_FNC_NBR];
+
+	/* Latency histograms. */
+	tb_stt_lat lats[TB_STT_LAT_NBR];
+
+} __attribute__((aligned(64)));
+
+/*
+ * Statistics set.
+ */
+struct tb_stt_set {
+
+	/* Version, set once initialized. */
+	volatile a64 ver;
+
+	/* Number of page claims. */
+	volatile a64 clm_nbr;
+
+	/* Pages. */
+	tb_stt_pag pags[TB_STT_PAG_NBR];
+
+};
+
+/*
+ * Function call scope.
+ */
+struct tb_stt_scp {
+
+	/* Function. */
+	u8 fnc;
+
+	/* Set <=> hardware counters were read. */
+	u8 hwc;
+
+	/* Cycle counter at entry. */
+	u64 cyc;
+
+	/* Hardware counters at entry. */
+	u64 hwcs[TB_STT_HWC_NBR];
+
+};
+
+/*********
+ * State *
+ *********/
+
+/*
+ * Current stats set.
+ * A private set until exported.
+ */
+extern tb_stt_set *tb_stt_set_cur;
+
+/*
+ * Generation of the current set, incremented each
+ * time it changes.
+ */
+extern volatile a64 tb_stt_gen;
+
+/*
+ * Page of the calling thread and its generation.
+ */
+extern __thread tb_stt_pag *tb_stt_thr_pag;
+extern __thread u64 tb_stt_thr_gen;
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Export stats in a shared segment at @pth, creating
+ * it if needed.
+ * Counters are reset.
+ * Must not be called while instrumented functions run.
+ */
+void tb_stt_exp(
+	const char *pth
+);
+
+/*
+ * Stop exporting stats, use a private set again.
+ * Must not be called while instrumented functions run.
+ */
+void tb_stt_ump(
+	void
+);
+
+/*
+ * Open the stats set exported at @pth for reading,
+ * store its segment at @sgmp, and return it.
+ * If it does not exist, return 0.
+ */
+const tb_stt_set *tb_stt_opn(
+	const char *pth,
+	tb_sgm **sgmp
+);
+
+/*
+ * Store at @dst the sum of the pages of @set.
+ */
+void tb_stt_sum(
+	tb_stt_pag *dst,
+	const tb_stt_set *set
+);
+
+/*
+ * Claim a page of the current set for the calling
+ * thread and return it.
+ */
+tb_stt_pag *tb_stt_pag_clm(
+	void
+);
+
+/*
+ * Return the page of the calling thread, claim it
+ * if needed.
+ */
+static inline tb_stt_pag *tb_stt_pag_get(
+	void
+)
+{
+	if (tb_stt_thr_gen != ns_atm(a64, red, acq, &tb_stt_gen)) return tb_stt_pag_clm();
+	return tb_stt_thr_pag;
+}
+
+/*
+ * Open hardware counters for the calling thread.
+ * If not supported or not permitted, return 1.
+ * Otherwise, return 0.
+ */
+uerr tb_stt_hwc_opn(
+	void
+);
+
+/*
+ * Close the hardware counters of the calling thread.
+ */
+void tb_stt_hwc_cls(
+	void
+);
+
+/*
+ * Return the name of event @evt.
+ */
+const char *tb_stt_evt_nam(
+	u8 evt
+);
+
+/*
+ * Return the name of function @fnc.
+ */
+const char *tb_stt_fnc_nam(
+	u8 fnc
+);
+
+/*
+ * Return the name of hardware counter @hwc.
+ */
+const char *tb_stt_hwc_nam(
+	u8 hwc
+);
+
+/*
+ * Return the name of latency @lat.
+ */
+const char *tb_stt_lat_nam(
+	u8 lat
+);
+
+/*
+ * Return the current time of the system monotonic
+ * clock in nanoseconds.
+ */
+u64 tb_stt_tim(
+	void
+);
+
+/*
+ * Record in latency @lat the time elapsed since @stt.
+ */
+void tb_stt_lat_add(
+	u8 lat,
+	u64 stt
+);
+
+/*
+ * Return the smallest latency bound under which lie
+ * at least @num / @den of @lat's samples, 0 if no
+ * samples.
+ */
+u64 tb_stt_lat_pct(
+	const tb_stt_lat *lat,
+	u64 num,
+	u64 den
+);
+
+/*
+ * Return the bucket of latency @val.
+ */
+static inline u64 tb_stt_lat_bkt(
+	u64 val
+)
+{
+	if (val < (1 << TB_STT_LAT_SUB)) return val;
+	const u8 exp = 63 - __builtin_clzll(val);
+	const u8 grp = exp - TB_STT_LAT_SUB + 1;
+	return ((u64) grp << TB_STT_LAT_SUB) + ((val >> (exp - TB_STT_LAT_SUB)) - (1 << TB_STT_LAT_SUB));
+}
+
+/*
+ * Return the lowest latency of bucket @bkt.
+ */
+static inline u64 tb_stt_lat_low(
+	u64 bkt
+)
+{
+	if (bkt < (1 << TB_STT_LAT_SUB)) return bkt;
+	const u64 grp = bkt >> TB_STT_LAT_SUB;
+	const u64 sub = bkt & ((1 << TB_STT_LAT_SUB) - 1);
+	return ((1 << TB_STT_LAT_SUB) + sub) << (grp - 1);
+}
+
+/*
+ * Start a call of function @fnc and return its scope.
+ */
+tb_stt_scp tb_stt_scp_stt(
+	u8 fnc
+);
+
+/*
+ * Complete the call of @scp.
+ */
+void tb_stt_scp_end(
+	tb_stt_scp *scp
+);
+
+/*
+ * Return the current value of the cycle counter.
+ */
+static inline u64 tb_stt_cyc(
+	void
+)
+{
+	#if defined(__aarch64__)
+	u64 cyc;
+	__asm__ volatile ("mrs %0, cntvct_el0" : "=r" (cyc));
+	return cyc;
+	#elif defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+	#else
+	return nh_run_tim();
+	#endif
+}
+
+/***********
+ * Tracing *
+ ***********/
+
+#ifdef TB_STT
+
+/* Count @nbr occurrences of event @evt. */
+#define tb_stt_evt(evt, nbr) ((void) ns_atm(a64, add_red, rel, &tb_stt_pag_get()->evts[evt], (nbr)))
+
+/* Account the rest of the current scope to function @fnc. */
+#define tb_stt_fnc(fnc) tb_stt_scp __stt_scp __attribute__((cleanup(tb_stt_scp_end))) = tb_stt_scp_stt(fnc)
+
+/* Store the current time at @dst. */
+#define tb_stt_stp(dst) ((void) ns_atm(a64, wrt, rel, (dst), tb_stt_tim()))
+
+/* If @stt is set, record in latency @lat the time
+ * elapsed since @stt. */
+#define tb_stt_lat(lat, stt) ({u64 __stt = (stt); if (__stt) tb_stt_lat_add(lat, __stt);})
+
+#else
+
+#define tb_stt_evt(evt, nbr) ((void) 0)
+#define tb_stt_fnc(fnc)
+#define tb_stt_stp(dst) ((void) 0)
+#define tb_stt_lat(lat, stt) ((void) sizeof(stt))
+
+#endif
+
+#endif /* TB_COR_STT_H */
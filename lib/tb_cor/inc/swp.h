@@ -0,0 +1,260 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_SWP_H
+#define TB_SWP_H
+
+/*
+ * The sweep runner backtests many instances of a
+ * strategy, each with its own parameters, against a
+ * single level 1 replay, so that the reconstruction
+ * cost is paid once for all of them.
+ *
+ * Each instance has its own wallet and its own
+ * simulation broker, matching against the shared
+ * history of the replay.
+ *
+ * Parameters and states of instances are stored as
+ * structures of arrays : one row per parameter or state
+ * variable, one column per instance, so that strategies
+ * can process instances in vectorized batches.
+ *
+ * Instances are split in contiguous ranges, one per
+ * worker thread. Ranges are multiples of TB_SWP_BAT_NB
+ * instances so that workers never write to the same
+ * cache lines.
+ *
+ * At each step, the replay is advanced on the calling
+ * thread, then all workers set the time of their
+ * instances' brokers, settle their complete or cancelled
+ * orders in their wallets, and call the strategy step
+ * function on their range. The step completes when all
+ * workers are done, so that the history is never
+ * modified while being read.
+ *
+ * Each instance tracks the orders passed through
+ * tb_swp_ord_pas that are not settled yet, in passing
+ * order. Each of them is settled as soon as it is
+ * complete or cancelled, regardless of the others.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_swp_opn,
+	tb_swp_wrk,
+	tb_swp
+);
+
+/*************
+ * Constants *
+ *************/
+
+/* Granularity of instance ranges. */
+#define TB_SWP_BAT_NB 8
+
+/* Stop generation. */
+#define TB_SWP_GEN_STP ((u64) -1)
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Unsettled orders of an instance.
+ */
+struct tb_swp_opn {
+
+	/* Indices, in passing order. [ord_max] */
+	u64 *idxs;
+
+	/* Number of indices. */
+	u64 nbr;
+
+};
+
+/*
+ * Worker.
+ */
+struct tb_swp_wrk {
+
+	/* Runner. */
+	tb_swp *swp;
+
+	/* Instance range [stt, end[. */
+	u32 ins_stt;
+	u32 ins_end;
+
+};
+
+/*
+ * Sweep runner.
+ */
+struct tb_swp {
+
+	/* Replay. */
+	tb_dr1 *dr1;
+
+	/* Number of instances. */
+	u32 ins_nbr;
+
+	/* Row size, @ins_nbr rounded up. */
+	u32 row_siz;
+
+	/* Number of parameters per instance. */
+	u32 prm_nbr;
+
+	/* Number of state variables per instance. */
+	u32 stt_nbr;
+
+	/* Parameters, one row per parameter. */
+	f64 *prms;
+
+	/* States, one row per state variable. */
+	f64 *stts;
+
+	/* Wallets. */
+	tb_wlt **wlts;
+
+	/* Brokers. */
+	spb_bkr **bkrs;
+
+	/* Unsettled orders of each instance. */
+	tb_swp_opn *opns;
+
+	/* Maximal number of orders per instance. */
+	u64 ord_max;
+
+	/* Strategy step function. */
+	void (*stp_fnc)(
+		tb_swp *swp,
+		u32 ins_stt,
+		u32 ins_end,
+		u64 tim,
+		void *arg
+	);
+
+	/* Strategy step argument. */
+	void *arg;
+
+	/* Current time. */
+	u64 tim;
+
+	/* Number of workers, including the caller. */
+	u8 thr_nbr;
+
+	/* Workers. */
+	tb_swp_wrk *wrks;
+
+	/* Worker threads blocks. */
+	void *thr_blk;
+
+	/* Step generation, TB_SWP_GEN_STP to stop. */
+	volatile a64 gen;
+
+	/* Number of workers done with the current
+	 * generation. */
+	volatile a64 don;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a sweep runner of @ins_nbr
+ * instances replaying @dr1 from its current time.
+ * Each instance has @prm_nbr null parameters, @stt_nbr
+ * null state variables, an empty wallet and a simulation
+ * broker of tick size @tck_siz, latency @lat and at most
+ * @ord_max orders.
+ * Instances are advanced by @thr_nbr threads, including
+ * the caller, calling @stp_fnc at each step.
+ */
+tb_swp *tb_swp_ctr(
+	tb_dr1 *dr1,
+	u32 ins_nbr,
+	u32 prm_nbr,
+	u32 stt_nbr,
+	f64 tck_siz,
+	u64 lat,
+	u64 ord_max,
+	u8 thr_nbr,
+	void (*stp_fnc)(
+		tb_swp *swp,
+		u32 ins_stt,
+		u32 ins_end,
+		u64 tim,
+		void *arg
+	),
+	void *arg
+);
+
+/*
+ * Stop the workers of @swp and delete it.
+ * The replay is not deleted.
+ */
+void tb_swp_dtr(
+	tb_swp *swp
+);
+
+/*
+ * Advance @swp by steps of @stp until @end.
+ * If @fin is set, tolerate reaching the end of the
+ * replay.
+ */
+void tb_swp_run(
+	tb_swp *swp,
+	u64 end,
+	u64 stp,
+	u8 fin
+);
+
+/*
+ * If the wallet of instance @ins can cover the order
+ * described by @ord, take its resources, pass it and
+ * return 0.
+ * Otherwise, or if its broker is full, return 1.
+ * Must only be called from the step function.
+ */
+uerr tb_swp_ord_pas(
+	tb_swp *swp,
+	u32 ins,
+	tb_ord *ord
+);
+
+/*
+ * Return the row of parameter @prm_id.
+ */
+static inline f64 *tb_swp_prm(
+	tb_swp *swp,
+	u32 prm_id
+) {check(prm_id < swp->prm_nbr); return swp->prms + (u64) prm_id * swp->row_siz;}
+
+/*
+ * Return the row of state variable @stt_id.
+ */
+static inline f64 *tb_swp_stt(
+	tb_swp *swp,
+	u32 stt_id
+) {check(stt_id < swp->stt_nbr); return swp->stts + (u64) stt_id * swp->row_siz;}
+
+/*
+ * Return the wallet of instance @ins.
+ */
+static inline tb_wlt *tb_swp_wlt(
+	tb_swp *swp,
+	u32 ins
+) {check(ins < swp->ins_nbr); return swp->wlts[ins];}
+
+/*
+ * Return the broker of instance @ins.
+ */
+static inline spb_bkr *tb_swp_bkr(
+	tb_swp *swp,
+	u32 ins
+) {check(ins < swp->ins_nbr); return swp->bkrs[ins];}
+
+#endif /* TB_SWP_H */
@@ -0,0 +1,99 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_SYM_H
+#define TB_SYM_H
+
+/*
+ * The symbol library interns strings : each distinct
+ * string receives a unique 32 bits symbol, so that
+ * structures store symbols instead of string copies and
+ * compare them by integer equality.
+ *
+ * Symbols are never freed, so they are indexed by
+ * string hash in a registry, whose entries are published
+ * once the string is stored. Lookups take no lock, only
+ * creations do.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_sym_sys
+);
+
+/*************
+ * Constants *
+ *************/
+
+/* Maximal number of symbols. */
+#define TB_SYM_MAX 16384
+
+/* Number of slots of the registry. */
+#define TB_SYM_SLT_NB (2 * TB_SYM_MAX)
+
+/* Null symbol. */
+#define TB_SYM_NON 0
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Symbols system.
+ */
+struct tb_sym_sys {
+
+	/* Lock, taken to create symbols. */
+	nh_spn lck;
+
+	/* Number of symbols, including the null one. */
+	volatile a64 sym_nbr;
+
+	/* Registry. Entries are tagged by the high half
+	 * of the string hash, their values are symbols. */
+	volatile a64 slts[TB_SYM_SLT_NB];
+
+	/* Strings indexed by symbol. */
+	const char *strs[TB_SYM_MAX];
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Deinitialize the symbols system.
+ * Deletes all symbols.
+ * Only here for valgrind to get off our backs.
+ */
+void tb_sym_cln(
+	void
+);
+
+/*
+ * Return the symbol of @str, create it if required.
+ * Wait-free if it exists.
+ */
+u32 tb_sym_get(
+	const char *str
+);
+
+/*
+ * Return the symbol of @str, TB_SYM_NON if none.
+ * Wait-free.
+ */
+u32 tb_sym_sch(
+	const char *str
+);
+
+/*
+ * Return the string of @sym.
+ */
+const char *tb_sym_str(
+	u32 sym
+);
+
+#endif /* TB_SYM_H */
@@ -9,17 +9,31 @@
 /* Headers. */
 #include <tb_cor/log.h>
 #include <tb_cor/str.h>
+#include <tb_cor/reg.h>
+#include <tb_cor/phf.h>
+#include <tb_cor/sym.h>
 #include <tb_cor/ccy.h>
 #include <tb_cor/mkp.h>
 #include <tb_cor/ist.h>
 #include <tb_cor/ord.h>
+#include <tb_cor/otb.h>
 #include <tb_cor/wlt.h>
 #include <tb_cor/sgm.h>
+#include <tb_cor/jrn.h>
+#include <tb_cor/stt.h>
 #include <tb_cor/stg.h>
 #include <tb_cor/lvl.h>
+#include <tb_cor/ibf.h>
 #include <tb_cor/lv1.h>
 #include <tb_cor/obk.h>
 #include <tb_cor/bkr.h>
+#include <tb_cor/bks.h>
+#include <tb_cor/bkp.h>
+#include <tb_cor/val.h>
 #include <tb_cor/iox.h>
+#include <tb_cor/swp.h>
+#include <tb_cor/mrg.h>
+#include <tb_cor/arw.h>
+#include <tb_cor/pub.h>
 
 #endif /* TB_COR_ALL_H */
@@ -0,0 +1,253 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_VAL_H
+#define TB_VAL_H
+
+/*
+ * The valuation engine values a set of wallets against
+ * live prices.
+ *
+ * It keeps a price per instrument, in the instrument's
+ * currency : the primary currency of its marketplace for
+ * shares, the currency itself for currency instruments,
+ * whose price is 1. Prices of shares can be set directly
+ * or from the best bid and ask of a level 1 history.
+ *
+ * Each currency has a conversion rate to a reference
+ * currency, and each instrument a margin rate.
+ *
+ * For each wallet, it maintains :
+ * - its net asset value, in the reference currency.
+ * - its exposure per currency, in that currency.
+ * - its margin usage, in the reference currency : the
+ *   sum of the absolute values of its assets weighted
+ *   by their margin rates.
+ *
+ * A wallet is valued from scratch by dot products of
+ * its amounts array with the value and margin vectors of
+ * instruments. Price updates are then applied
+ * incrementally : only the instruments whose price moved
+ * since the last update are visited, for all wallets.
+ * Wallets whose amounts change must be revalued. Rate
+ * changes revalue all wallets at the next update.
+ */
+
+/*********
+ * Types *
+ *********/
+
+types(
+	tb_val
+);
+
+/*************
+ * Constants *
+ *************/
+
+/* Number of lanes of valuation vectors. */
+#define TB_VAL_LAN_NB 4
+
+/* Valuation vectors. */
+typedef f64 tb_val_vf64 __attribute__((vector_size(TB_VAL_LAN_NB * 8), aligned(8)));
+typedef u64 tb_val_vu64 __attribute__((vector_size(TB_VAL_LAN_NB * 8), aligned(8)));
+
+/* Currency index of instruments without currency. */
+#define TB_VAL_CCY_NON TB_CCY_NB
+
+/**************
+ * Structures *
+ **************/
+
+/*
+ * Valuation engine.
+ */
+struct tb_val {
+
+	/* Number of instruments known. */
+	u32 ist_nbr;
+
+	/* Number of instruments per-instrument arrays can
+	 * hold. */
+	u32 ist_max;
+
+	/* Number of wallets. */
+	u32 wlt_nbr;
+
+	/* Maximal number of wallets. */
+	u32 wlt_max;
+
+	/* Set <=> all wallets must be revalued. */
+	u8 rvl;
+
+	/* Number of instruments whose price moved. */
+	u32 mov_nbr;
+
+	/* Instruments whose price moved. [ist_max] */
+	u32 *movs;
+
+	/* Prices of moved instruments at the last update,
+	 * then their variations. [ist_max] */
+	f64 *mov_prcs;
+
+	/* Value variations of moved instruments. [ist_max] */
+	f64 *mov_vals;
+
+	/* Margin variations of moved instruments.
+	 * [ist_max] */
+	f64 *mov_mrgs;
+
+	/* Set <=> the price of an instrument moved.
+	 * [ist_max] */
+	u8 *movd;
+
+	/* Currency index of instruments. [ist_max] */
+	u16 *ccys;
+
+	/* Prices of instruments. [ist_max] */
+	f64 *prcs;
+
+	/* Margin rates of instruments. [ist_max] */
+	f64 *mrts;
+
+	/* Values of a unit of instruments in the reference
+	 * currency. [ist_max] */
+	f64 *vals;
+
+	/* Margins of a unit of instruments in the reference
+	 * currency. [ist_max] */
+	f64 *mrgs;
+
+	/* Conversion rates of currencies. */
+	f64 rats[TB_CCY_NB + 1];
+
+	/* Wallets. */
+	tb_wlt **wlts;
+
+	/* Net asset values of wallets. */
+	f64 *wlt_navs;
+
+	/* Margin usages of wallets. */
+	f64 *wlt_mrgs;
+
+	/* Exposures of wallets, per currency. */
+	f64 *wlt_exps;
+
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a valuation engine of at most
+ * @wlt_max wallets.
+ * Conversion rates and margin rates are 1.
+ */
+tb_val *tb_val_ctr(
+	u32 wlt_max
+);
+
+/*
+ * Delete @val.
+ * Wallets are not deleted.
+ */
+void tb_val_dtr(
+	tb_val *val
+);
+
+/*
+ * Add @wlt to @val, value it, and return its index.
+ */
+u32 tb_val_wlt_add(
+	tb_val *val,
+	tb_wlt *wlt
+);
+
+/*
+ * Revalue the wallet at index @idx after its amounts
+ * changed.
+ */
+void tb_val_wlt_upd(
+	tb_val *val,
+	u32 idx
+);
+
+/*
+ * Set the price of @ist.
+ * Takes effect at the next update.
+ */
+void tb_val_prc_set(
+	tb_val *val,
+	tb_ist *ist,
+	f64 prc
+);
+
+/*
+ * Set the price of @ist to the middle of the best bid
+ * and ask of @hst, of tick size @tck_siz.
+ * If only one side exists, use it. If none, do nothing.
+ * Takes effect at the next update.
+ */
+void tb_val_prc_lv1(
+	tb_val *val,
+	tb_ist *ist,
+	tb_lv1_hst *hst,
+	f64 tck_siz
+);
+
+/*
+ * Set the conversion rate of @ccy to the reference
+ * currency.
+ * Takes effect at the next update.
+ */
+void tb_val_rat_set(
+	tb_val *val,
+	tb_ccy *ccy,
+	f64 rat
+);
+
+/*
+ * Set the margin rate of @ist.
+ * Takes effect at the next update.
+ */
+void tb_val_mrt_set(
+	tb_val *val,
+	tb_ist *ist,
+	f64 mrt
+);
+
+/*
+ * Update the valuations of all wallets.
+ */
+void tb_val_upd(
+	tb_val *val
+);
+
+/*
+ * Return the net asset value of the wallet at index
+ * @idx.
+ */
+static inline f64 tb_val_nav(
+	tb_val *val,
+	u32 idx
+) {check(idx < val->wlt_nbr); return val->wlt_navs[idx];}
+
+/*
+ * Return the margin usage of the wallet at index @idx.
+ */
+static inline f64 tb_val_mrg(
+	tb_val *val,
+	u32 idx
+) {check(idx < val->wlt_nbr); return val->wlt_mrgs[idx];}
+
+/*
+ * Return the exposure of the wallet at index @idx to
+ * @ccy, in @ccy.
+ */
+static inline f64 tb_val_exp(
+	tb_val *val,
+	u32 idx,
+	tb_ccy *ccy
+) {check(idx < val->wlt_nbr); return val->wlt_exps[(u64) idx * (TB_CCY_NB + 1) + ccy->id];}
+
+#endif /* TB_VAL_H */
@@ -10,6 +10,12 @@
  *
  * Assets instance of the same instrument are
  * non-differentiable, and hence, are measured by amount.
+ *
+ * Amounts are stored in a flat array indexed by
+ * instrument identifier, so that cloning and comparing
+ * wallets are memory copies and comparisons. The array
+ * grows when an instrument created after the wallet
+ * is first added.
  */
 
 /*********
@@ -17,7 +23,6 @@
  *********/
 
 types(
-	tb_ast,
 	tb_wlt
 );
 
@@ -25,26 +30,17 @@ types(
  * Structures *
  **************/
 
-/*
- * An asset is a quantified instance of an instrument.
- */ 
-struct tb_ast {
-
-	/* Stocks of the same wallet sorted by intrument. */
-	ns_mapn_uad asts;
-
-	/* Amount. */
-	f64 amt;
-
-};
-
 /*
  * Wallet.
  */
 struct tb_wlt {
 
-	/* Assets indexed by instrument. */
-	ns_map_uad asts;
+	/* Number of amounts. Instruments of greater
+	 * identifiers have none. */
+	u32 amt_nbr;
+
+	/* Amounts indexed by instrument identifier. */
+	f64 *amts;
 
 };
 
@@ -55,14 +51,14 @@ struct tb_wlt {
 /*
  * Construct an empty wallet.
  */
-tb_wlt *tb_wlt_ctor(
+tb_wlt *tb_wlt_ctr(
 	void
 );
 
 /*
  * Destruct @wlt.
  */
-void tb_wlt_dtor(
+void tb_wlt_dtr(
 	tb_wlt *wlt
 );
 
@@ -101,7 +97,7 @@ f64 tb_wlt_get(
  * described by @ord and return 0.
  * If an error occurs, return 1.
  */
-uerr tb_wlt_ord_tak(
+uerr tb_wlt_ord_res_tak(
 	tb_wlt *wlt,
 	const tb_ord *ord
 );
@@ -110,7 +106,7 @@ uerr tb_wlt_ord_tak(
  * Release resources from @wlt after the order
  * described by @ord was cancelled.
  */
-uerr tb_wlt_ord_rel(
+uerr tb_wlt_ord_res_rel(
 	tb_wlt *wlt,
 	const tb_ord *ord
 );
@@ -119,7 +115,7 @@ uerr tb_wlt_ord_rel(
  * Add new resources to @wlt after the order
  * described by @ord completed.
  */
-uerr tb_wlt_ord_col(
+uerr tb_wlt_ord_res_col(
 	tb_wlt *wlt,
 	const tb_ord *ord
 );
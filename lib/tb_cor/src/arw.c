@@ -0,0 +1,318 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/**********
+ * Layout *
+ **********/
+
+/*
+ * Column names per level.
+ * Level 0 matches the arrays of tb_io0_wrt.
+ */
+static const char *const _col_nams[TB_LVL_NB][TB_ANB_MAX] = {
+	{"tim", "bid", "ask", "avg", "vol"},
+	{"tim", "tck", "vol"},
+	{"tim", "ord_id", "trd_id", "ord_typ", "ord_tck", "ord_vol"},
+};
+
+/*
+ * Column formats per level.
+ * Times are nanosecond timestamps, level 0 prices
+ * are f64, level 1 and 2 prices are u64 ticks.
+ */
+static const char *const _col_fmts[TB_LVL_NB][TB_ANB_MAX] = {
+	{"tsn:", "g", "g", "g", "g"},
+	{"tsn:", "L", "g"},
+	{"tsn:", "L", "L", "C", "L", "g"},
+};
+
+/**********
+ * Schema *
+ **********/
+
+/*
+ * Release a column schema.
+ */
+static void _sch_col_rel(
+	struct ArrowSchema *sch
+) {sch->release = 0;}
+
+/*
+ * Release a level schema.
+ */
+static void _sch_rel(
+	struct ArrowSchema *sch
+)
+{
+	const u64 col_nbr = (u64) sch->n_children;
+	for (u64 col_id = 0; col_id < col_nbr; col_id++) {
+		struct ArrowSchema *col = sch->children[col_id];
+		if (col->release) col->release(col);
+	}
+	nh_fre(sch->private_data, col_nbr * (sizeof(struct ArrowSchema) + sizeof(struct ArrowSchema *)));
+	sch->release = 0;
+}
+
+/*
+ * Initialize @sch with the schema of level @lvl.
+ */
+void tb_arw_sch(
+	u8 lvl,
+	struct ArrowSchema *sch
+)
+{
+	assert(lvl < TB_LVL_NB);
+	const u8 col_nbr = tb_lvl_arr_nbr(lvl);
+
+	/* Allocate columns and their pointers in one block. */
+	const uad siz = col_nbr * (sizeof(struct ArrowSchema) + sizeof(struct ArrowSchema *));
+	struct ArrowSchema *cols = nh_all(siz);
+	struct ArrowSchema **chds = (struct ArrowSchema **) (cols + col_nbr);
+
+	/* Describe columns. */
+	for (u8 col_id = 0; col_id < col_nbr; col_id++) {
+		struct ArrowSchema *col = chds[col_id] = cols + col_id;
+		col->format = _col_fmts[lvl][col_id];
+		col->name = _col_nams[lvl][col_id];
+		col->metadata = 0;
+		col->flags = 0;
+		col->n_children = 0;
+		col->children = 0;
+		col->dictionary = 0;
+		col->release = &_sch_col_rel;
+		col->private_data = 0;
+	}
+
+	/* Describe the struct. */
+	sch->format = "+s";
+	sch->name = "";
+	sch->metadata = 0;
+	sch->flags = 0;
+	sch->n_children = col_nbr;
+	sch->children = chds;
+	sch->dictionary = 0;
+	sch->release = &_sch_rel;
+	sch->private_data = cols;
+
+}
+
+/**********
+ * Chunks *
+ **********/
+
+/*
+ * Drop a reference to @chk, delete it and unload its
+ * block if it was the last one.
+ */
+static inline void _chk_unr(
+	tb_arw_chk *chk
+)
+{
+	SAFE_DECR(chk->ref);
+	if (chk->ref) return;
+	tb_stg_unl(chk->blk);
+	nh_fre_(chk);
+}
+
+/*
+ * Release a chunk column.
+ */
+static void _chk_col_rel(
+	struct ArrowArray *arr
+)
+{
+	arr->release = 0;
+	_chk_unr(arr->private_data);
+}
+
+/*
+ * Release a chunk.
+ * Columns that were moved by the consumer are
+ * released independently.
+ */
+static void _chk_rel(
+	struct ArrowArray *arr
+)
+{
+	tb_arw_chk *chk = arr->private_data;
+	for (u8 col_id = 0; col_id < chk->col_nbr; col_id++) {
+		struct ArrowArray *col = chk->chds[col_id];
+		if (col->release) col->release(col);
+	}
+	arr->release = 0;
+	_chk_unr(chk);
+}
+
+/*
+ * Initialize @arr to expose the @elm_nbr elements of
+ * @blk's arrays @arrs.
+ * Transfer the ownership of @blk to the chunk.
+ */
+static inline void _chk_ini(
+	struct ArrowArray *arr,
+	_own_ tb_stg_blk *blk,
+	const void **arrs,
+	u64 elm_nbr
+)
+{
+	const u8 col_nbr = tb_lvl_arr_nbr(blk->idx->lvl);
+
+	/* Allocate. */
+	nh_all__(tb_arw_chk, chk);
+	chk->blk = blk;
+	chk->ref = (u32) col_nbr + 1;
+	chk->col_nbr = col_nbr;
+
+	/* Describe columns, no validity bitmap. */
+	for (u8 col_id = 0; col_id < col_nbr; col_id++) {
+		struct ArrowArray *col = chk->chds[col_id] = chk->cols + col_id;
+		chk->bufs[2 * col_id] = 0;
+		chk->bufs[2 * col_id + 1] = arrs[col_id];
+		col->length = (s64) elm_nbr;
+		col->null_count = 0;
+		col->offset = 0;
+		col->n_buffers = 2;
+		col->n_children = 0;
+		col->buffers = chk->bufs + 2 * col_id;
+		col->children = 0;
+		col->dictionary = 0;
+		col->release = &_chk_col_rel;
+		col->private_data = chk;
+	}
+
+	/* Describe the struct. */
+	chk->bufs[2 * TB_ANB_MAX] = 0;
+	arr->length = (s64) elm_nbr;
+	arr->null_count = 0;
+	arr->offset = 0;
+	arr->n_buffers = 1;
+	arr->n_children = col_nbr;
+	arr->buffers = chk->bufs + 2 * TB_ANB_MAX;
+	arr->children = chk->chds;
+	arr->dictionary = 0;
+	arr->release = &_chk_rel;
+	arr->private_data = chk;
+
+}
+
+/**********
+ * Stream *
+ **********/
+
+/*
+ * Stream schema getter.
+ */
+static int _stm_sch(
+	struct ArrowArrayStream *stm,
+	struct ArrowSchema *out
+)
+{
+	tb_arw_stm *prv = stm->private_data;
+	tb_arw_sch(prv->idx->lvl, out);
+	return 0;
+}
+
+/*
+ * Stream next chunk getter.
+ */
+static int _stm_nxt(
+	struct ArrowArrayStream *stm,
+	struct ArrowArray *out
+)
+{
+	tb_arw_stm *prv = stm->private_data;
+
+	/* If no more blocks, report the end of stream. */
+	tb_stg_blk *blk = prv->blk;
+	if (!blk) {
+		out->release = 0;
+		return 0;
+	}
+
+	/* Clip the block arrays to the range. */
+	const void *arrs[TB_ANB_MAX];
+	const u8 *sizs = 0;
+	const u8 arr_nbr = tb_lvl_arr_nbr(prv->idx->lvl);
+	const u64 elm_nbr = tb_blk_arr(blk, arrs, arr_nbr, &sizs);
+	const u64 *tims = arrs[0];
+	assert(elm_nbr);
+	u64 elm_stt = 0;
+	if (tims[0] < prv->stt) {
+		elm_stt = (prv->stt <= tims[elm_nbr - 1]) ? tb_stg_elm_sch((u64 *) tims, elm_nbr, 0, prv->stt) : elm_nbr;
+	}
+	u64 elm_end = elm_nbr;
+	while ((elm_end > elm_stt) && (tims[elm_end - 1] > prv->end)) elm_end--;
+	tb_stg_shf(arrs, arrs, sizs, arr_nbr, elm_stt);
+
+	/* Prepare the next block, keep this one loaded. */
+	prv->blk = (elm_end == elm_nbr) ? tb_stg_red_nxt(prv->idx, blk, prv->end, 0) : 0;
+
+	/* Export. */
+	_chk_ini(out, blk, arrs, elm_end - elm_stt);
+	return 0;
+
+}
+
+/*
+ * Stream error getter.
+ */
+static const char *_stm_err(
+	struct ArrowArrayStream *stm
+) {return 0;}
+
+/*
+ * Stream release.
+ */
+static void _stm_rel(
+	struct ArrowArrayStream *stm
+)
+{
+	tb_arw_stm *prv = stm->private_data;
+	if (prv->blk) tb_stg_unl(prv->blk);
+	nh_fre_(prv);
+	stm->release = 0;
+}
+
+/*
+ * Initialize @stm to export elements of @idx in
+ * [@stt, @end].
+ * @idx must not be closed before @stm and all its
+ * chunks are released.
+ */
+void tb_arw_exp(
+	tb_stg_idx *idx,
+	u64 stt,
+	u64 end,
+	struct ArrowArrayStream *stm
+)
+{
+	assert(stt <= end);
+
+	/* Allocate. */
+	nh_all__(tb_arw_stm, prv);
+	prv->idx = idx;
+	prv->stt = stt;
+	prv->end = end;
+
+	/* Load the first block, ignore it if it starts
+	 * after the range. */
+	prv->blk = tb_stg_lod_nxt(idx, stt);
+	if (prv->blk) {
+		const void *arrs[TB_ANB_MAX];
+		const u8 *sizs = 0;
+		tb_blk_arr(prv->blk, arrs, tb_lvl_arr_nbr(idx->lvl), &sizs);
+		if (((const u64 *) arrs[0])[0] > end) {
+			tb_stg_unl(prv->blk);
+			prv->blk = 0;
+		}
+	}
+
+	/* Initialize. */
+	stm->get_schema = &_stm_sch;
+	stm->get_next = &_stm_nxt;
+	stm->get_last_error = &_stm_err;
+	stm->release = &_stm_rel;
+	stm->private_data = prv;
+
+}
@@ -0,0 +1,789 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*********
+ * Rings *
+ *********/
+
+/*
+ * If @rng has space for the @nbr messages at @msgs,
+ * write them in it, publish them at once, and return 0.
+ * Otherwise, return 1.
+ * Only called by the producer.
+ */
+static inline uerr _rng_put_n(
+	tb_bkp_rng *rng,
+	const tb_bkp_msg *msgs,
+	u64 nbr
+)
+{
+	check(nbr <= TB_BKP_RNG_NB);
+	const u64 wrt = rng->wrt;
+	if (wrt + nbr - ns_atm(a64, red, acq, &rng->red) > TB_BKP_RNG_NB) return 1;
+	for (u64 msg_id = 0; msg_id < nbr; msg_id++) {
+		ns_mem_cpy(rng->msgs + ((wrt + msg_id) & (TB_BKP_RNG_NB - 1)), msgs + msg_id, sizeof(tb_bkp_msg));
+	}
+	ns_atm(a64, wrt, rel, &rng->wrt, wrt + nbr);
+	return 0;
+}
+
+/*
+ * If @rng has a message, read it at @msg and return 0.
+ * Otherwise, return 1.
+ * Only called by the consumer.
+ */
+static inline uerr _rng_get(
+	tb_bkp_rng *rng,
+	tb_bkp_msg *msg
+)
+{
+	const u64 red = rng->red;
+	if (red == ns_atm(a64, red, acq, &rng->wrt)) return 1;
+	ns_mem_cpy(msg, rng->msgs + (red & (TB_BKP_RNG_NB - 1)), sizeof(tb_bkp_msg));
+	ns_atm(a64, wrt, rel, &rng->red, red + 1);
+	return 0;
+}
+
+/*
+ * Reset @rng.
+ */
+static inline void _rng_rst(
+	tb_bkp_rng *rng
+)
+{
+	rng->wrt = 0;
+	rng->red = 0;
+}
+
+/*
+ * Called every TB_BKP_SPN_NB polls of a wait, at the
+ * @spn-th one, the first call saving the time at @sttp.
+ * Return 1 if the wait lasted more than TB_BKP_TMO, 0
+ * otherwise.
+ */
+static inline uerr _rng_tmo(
+	u64 spn,
+	u64 *sttp
+)
+{
+	const u64 tim = nh_run_tim();
+	if (spn == TB_BKP_SPN_NB) *sttp = tim;
+	return (tim - *sttp) > TB_BKP_TMO;
+}
+
+/************
+ * Encoding *
+ ************/
+
+/*
+ * Reset @ses for a new session.
+ */
+static inline void _ses_rst(
+	tb_bkp_ses *ses
+) {ns_mem_rst(ses, sizeof(tb_bkp_ses));}
+
+/*
+ * Encode @ist at @dst in session @ses.
+ * Describe it only if it was not sent before.
+ */
+static inline void _ist_enc(
+	tb_bkp_ses *ses,
+	tb_bkp_ist *dst,
+	tb_ist *ist
+)
+{
+	u64 slt = ((u64) ist >> 4) % TB_BKP_SES_SLT_NB;
+	while (ses->snd_ists[slt] && (ses->snd_ists[slt] != ist)) {
+		slt = (slt + 1) % TB_BKP_SES_SLT_NB;
+	}
+	const u8 dsc = dst->dsc = !ses->snd_ists[slt];
+	if (dsc) {
+		assert(ses->snd_nbr < TB_BKP_SES_MAX, "too many session instruments.\n");
+		ses->snd_ists[slt] = ist;
+		ses->snd_ids[slt] = ses->snd_nbr++;
+	}
+	dst->id = ses->snd_ids[slt];
+	if (!dsc) return;
+	const u8 cls = dst->cls = ist->cls;
+	if (cls == TB_IST_CLS_SHR) {
+		tb_str_cpy(dst->mkp, tb_mkp_sym(ist->shr.mkp));
+		tb_str_cpy(dst->sym, tb_sym_str(ist->shr.sym));
+	} else {
+		assert(cls == TB_IST_CLS_CCY);
+		tb_str_cpy(dst->mkp, tb_mkp_sym(ist->ccy.mkp));
+		tb_str_cpy(dst->sym, tb_ccy_sym(ist->ccy.ccy));
+	}
+}
+
+/*
+ * Decode and return the instrument at @src in session
+ * @ses.
+ * Only resolve it if it is described.
+ */
+static inline tb_ist *_ist_dec(
+	tb_bkp_ses *ses,
+	const tb_bkp_ist *src
+)
+{
+	const u32 id = src->id;
+	if (!src->dsc) {
+		assert(id < ses->rcv_nbr, "unknown session instrument %u.\n", id);
+		return ses->rcvs[id];
+	}
+	assert(id == ses->rcv_nbr, "unexpected session instrument %u, expected %u.\n", id, ses->rcv_nbr);
+	assert(id < TB_BKP_SES_MAX, "too many session instruments.\n");
+	tb_mkp *mkp = assert(tb_mkp_sch(src->mkp), "unknown marketplace '%s'.\n", src->mkp);
+	tb_ist *ist;
+	if (src->cls == TB_IST_CLS_SHR) {
+		ist = tb_ist_ctr_shr(mkp, src->sym);
+	} else {
+		assert(src->cls == TB_IST_CLS_CCY, "unknown instrument class '%u'.\n", src->cls);
+		tb_ccy *ccy = assert(tb_ccy_sch(src->sym), "unknown currency '%s'.\n", src->sym);
+		ist = tb_ist_ctr_ccy(mkp, ccy);
+	}
+	ses->rcvs[ses->rcv_nbr++] = ist;
+	return ist;
+}
+
+/*
+ * Encode @ord in @msg in session @ses.
+ */
+static inline void _ord_enc(
+	tb_bkp_ses *ses,
+	tb_bkp_msg *msg,
+	const tb_ord *ord
+)
+{
+	_ist_enc(ses, &msg->prm, ord->prm);
+	_ist_enc(ses, &msg->sec, ord->sec);
+	msg->ord_typ = ord->typ;
+	msg->ord_sts = ord->sts;
+	msg->arg = ord->id;
+	msg->req_vol_prm = ord->req_vol_prm;
+	msg->req_prc_lim = ord->req_prc_lim;
+	msg->req_prc_stp = ord->req_prc_stp;
+	msg->rsp_vol_prm = ord->rsp_vol_prm;
+	msg->rsp_vol_sec = ord->rsp_vol_sec;
+}
+
+/*
+ * Decode the order in @msg at @ord in session @ses.
+ */
+static inline void _ord_dec(
+	tb_bkp_ses *ses,
+	tb_ord *ord,
+	const tb_bkp_msg *msg
+)
+{
+	tb_ist *prm = _ist_dec(ses, &msg->prm);
+	tb_ist *sec = _ist_dec(ses, &msg->sec);
+	tb_ord_ctr(
+		ord,
+		prm,
+		sec,
+		msg->ord_typ,
+		msg->req_vol_prm,
+		msg->req_prc_lim,
+		msg->req_prc_stp,
+		msg->arg,
+		msg->ord_sts
+	);
+	ord->rsp_vol_prm = msg->rsp_vol_prm;
+	ord->rsp_vol_sec = msg->rsp_vol_sec;
+}
+
+/**********
+ * Client *
+ **********/
+
+/*
+ * Called at the @spn-th poll of @cln waiting for its
+ * bridge. The bridge is checked every TB_BKP_SPN_NB
+ * polls, the first check saving the time at @sttp.
+ * Return 1 if the bridge stopped serving or did not
+ * progress for TB_BKP_TMO, 0 otherwise.
+ */
+static inline uerr _cln_wai(
+	tb_bkp_cln *cln,
+	u64 spn,
+	u64 *sttp
+)
+{
+	if ((!spn) || (spn & (TB_BKP_SPN_NB - 1))) return 0;
+	if (ns_atm(a64, red, acq, &cln->hdr->prt) != TB_BKP_PRT_BIN) return 1;
+	return _rng_tmo(spn, sttp);
+}
+
+/*
+ * Send the @nbr messages at @msgs to the bridge of
+ * @cln at once.
+ * If it does not free space in time, return 1.
+ */
+static inline uerr _cln_put(
+	tb_bkp_cln *cln,
+	const tb_bkp_msg *msgs,
+	u64 nbr
+)
+{
+	u64 stt = 0;
+	for (u64 spn = 0; _rng_put_n(&cln->hdr->req, msgs, nbr); spn++) {
+		if (_cln_wai(cln, spn, &stt)) return 1;
+	}
+	return 0;
+}
+
+/*
+ * Receive the response of sequence @seq from the
+ * bridge of @cln at @msg, dropping the responses to
+ * a previous client.
+ * If it does not respond in time, return 1.
+ */
+static inline uerr _cln_get(
+	tb_bkp_cln *cln,
+	tb_bkp_msg *msg,
+	u64 seq
+)
+{
+	u64 stt = 0;
+	u64 spn = 0;
+	while (1) {
+		if (_rng_get(&cln->hdr->rsp, msg)) {
+			if (_cln_wai(cln, spn++, &stt)) return 1;
+		} else if (msg->seq < seq) {
+			spn = 0;
+		} else {
+			break;
+		}
+	}
+	assert(msg->seq == seq, "unexpected response sequence %U, expected %U.\n", msg->seq, seq);
+	return 0;
+}
+
+/*
+ * Send the @nbr messages at @msgs as a batch, and wait
+ * for their responses at @msgs.
+ * If the bridge failed to respond, now or before,
+ * return 1.
+ */
+static inline uerr _cln_cal_n(
+	tb_bkp_cln *cln,
+	tb_bkp_msg *msgs,
+	u64 nbr
+)
+{
+	check(nbr && (nbr <= TB_BKP_BAT_MAX));
+	if (cln->err) return 1;
+	const u64 seq = cln->seq + 1;
+	for (u64 msg_id = 0; msg_id < nbr; msg_id++) {
+		msgs[msg_id].seq = ++cln->seq;
+		msgs[msg_id].bat = (u16) (nbr - msg_id - 1);
+	}
+	if (_cln_put(cln, msgs, nbr)) return cln->err = 1;
+	for (u64 msg_id = 0; msg_id < nbr; msg_id++) {
+		tb_bkp_msg *msg = msgs + msg_id;
+		const u8 typ = msg->typ;
+		if (_cln_get(cln, msg, seq + msg_id)) return cln->err = 1;
+		assert(msg->typ == typ, "unexpected response type %u, expected %u.\n", msg->typ, typ);
+	}
+	return 0;
+}
+
+/*
+ * Send @msg, and wait for its response at @msg.
+ * If the bridge failed to respond, now or before,
+ * return 1.
+ */
+static inline uerr _cln_cal(
+	tb_bkp_cln *cln,
+	tb_bkp_msg *msg
+) {return _cln_cal_n(cln, msg, 1);}
+
+/*
+ * Report the order described by @ord as cancelled
+ * at @dst, its request having failed.
+ */
+static inline void _cln_fai(
+	tb_ord *dst,
+	const tb_ord *ord
+)
+{
+	*dst = *ord;
+	dst->sts = TB_ORD_STS_CCL;
+}
+
+/*
+ * Delete @bkr.
+ */
+static void _cln_dtor(
+	spb_bkr *bkr
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_sgm_wrt_cpl(cln->sgm);
+	tb_sgm_cls(cln->sgm);
+	nh_fre_(cln);
+}
+
+/*
+ * Reset @bkr, initialize it at time @tim.
+ */
+static void _cln_tim_rst(
+	spb_bkr *bkr,
+	u64 tim
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg = {.typ = TB_BKP_MSG_TIM_RST, .arg = tim};
+	_cln_cal(cln, &msg);
+}
+
+/*
+ * Set the current time of @bkr.
+ */
+static void _cln_tim_set(
+	spb_bkr *bkr,
+	u64 tim
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg = {.typ = TB_BKP_MSG_TIM_SET, .arg = tim};
+	_cln_cal(cln, &msg);
+}
+
+/*
+ * Report shutdown.
+ */
+static void _cln_sht(
+	spb_bkr *bkr
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg = {.typ = TB_BKP_MSG_SHT};
+	_cln_cal(cln, &msg);
+}
+
+/*
+ * Pass an order described by @ord, return
+ * its descriptor.
+ */
+static tb_ord _cln_ord_pas(
+	spb_bkr *bkr,
+	tb_ord *ord
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg;
+	_ord_enc(&cln->ses, &msg, ord);
+	msg.typ = TB_BKP_MSG_ORD_PAS;
+	tb_ord res;
+	if (_cln_cal(cln, &msg)) _cln_fai(&res, ord);
+	else _ord_dec(&cln->ses, &res, &msg);
+	return res;
+}
+
+/*
+ * Send a cancel request for the order at index @idx.
+ * If bad index, abort.
+ */
+static void _cln_ord_ccl(
+	spb_bkr *bkr,
+	u64 idx
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg = {.typ = TB_BKP_MSG_ORD_CCL, .arg = idx};
+	_cln_cal(cln, &msg);
+}
+
+/*
+ * Save the descriptor of the order at index @idx
+ * at @dst.
+ * If bad index, abort.
+ */
+static void _cln_ord_sts(
+	spb_bkr *bkr,
+	u64 idx,
+	tb_ord *dst
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg = {.typ = TB_BKP_MSG_ORD_STS, .arg = idx};
+	if (_cln_cal(cln, &msg)) {
+		dst->id = idx;
+		dst->sts = TB_ORD_STS_CCL;
+	} else {
+		_ord_dec(&cln->ses, dst, &msg);
+	}
+}
+
+/*
+ * Pass the @nbr orders described by @ords, save
+ * their descriptors at @dsts.
+ * @ords and @dsts may be the same.
+ */
+static void _cln_ord_pas_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	tb_ord *ords,
+	tb_ord *dsts
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msgs[TB_BKP_BAT_MAX];
+	for (u64 stt = 0; stt < nbr; stt += TB_BKP_BAT_MAX) {
+		const u64 bat = ((nbr - stt) < TB_BKP_BAT_MAX) ? (nbr - stt) : TB_BKP_BAT_MAX;
+		for (u64 msg_id = 0; msg_id < bat; msg_id++) {
+			_ord_enc(&cln->ses, msgs + msg_id, ords + stt + msg_id);
+			msgs[msg_id].typ = TB_BKP_MSG_ORD_PAS_N;
+		}
+		const uerr err = _cln_cal_n(cln, msgs, bat);
+		for (u64 msg_id = 0; msg_id < bat; msg_id++) {
+			if (err) _cln_fai(dsts + stt + msg_id, ords + stt + msg_id);
+			else _ord_dec(&cln->ses, dsts + stt + msg_id, msgs + msg_id);
+		}
+	}
+}
+
+/*
+ * Send a cancel request for the @nbr orders at
+ * indices @idxs.
+ * If bad index, abort.
+ */
+static void _cln_ord_ccl_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	const u64 *idxs
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msgs[TB_BKP_BAT_MAX];
+	for (u64 stt = 0; stt < nbr; stt += TB_BKP_BAT_MAX) {
+		const u64 bat = ((nbr - stt) < TB_BKP_BAT_MAX) ? (nbr - stt) : TB_BKP_BAT_MAX;
+		for (u64 msg_id = 0; msg_id < bat; msg_id++) {
+			msgs[msg_id] = (tb_bkp_msg) {.typ = TB_BKP_MSG_ORD_CCL_N, .arg = idxs[stt + msg_id]};
+		}
+		_cln_cal_n(cln, msgs, bat);
+	}
+}
+
+/*
+ * Save the descriptors of the @nbr orders at
+ * indices @idxs at @dsts.
+ * If bad index, abort.
+ */
+static void _cln_ord_sts_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	const u64 *idxs,
+	tb_ord *dsts
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msgs[TB_BKP_BAT_MAX];
+	for (u64 stt = 0; stt < nbr; stt += TB_BKP_BAT_MAX) {
+		const u64 bat = ((nbr - stt) < TB_BKP_BAT_MAX) ? (nbr - stt) : TB_BKP_BAT_MAX;
+		for (u64 msg_id = 0; msg_id < bat; msg_id++) {
+			msgs[msg_id] = (tb_bkp_msg) {.typ = TB_BKP_MSG_ORD_STS_N, .arg = idxs[stt + msg_id]};
+		}
+		const uerr err = _cln_cal_n(cln, msgs, bat);
+		for (u64 msg_id = 0; msg_id < bat; msg_id++) {
+			tb_ord *dst = dsts + stt + msg_id;
+			if (err) {
+				dst->id = idxs[stt + msg_id];
+				dst->sts = TB_ORD_STS_CCL;
+			} else {
+				_ord_dec(&cln->ses, dst, msgs + msg_id);
+			}
+		}
+	}
+}
+
+/*
+ * Cancel the order at index @idx and pass the order
+ * described by @ord in its place, return its
+ * descriptor.
+ * If bad index, abort.
+ */
+static tb_ord _cln_ord_rpl(
+	spb_bkr *bkr,
+	u64 idx,
+	tb_ord *ord
+)
+{
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	tb_bkp_msg msg;
+	_ord_enc(&cln->ses, &msg, ord);
+	msg.typ = TB_BKP_MSG_ORD_RPL;
+	msg.arg = idx;
+	tb_ord res;
+	if (_cln_cal(cln, &msg)) _cln_fai(&res, ord);
+	else _ord_dec(&cln->ses, &res, &msg);
+	return res;
+}
+
+/* Client broker type. */
+static spb_bkrt _cln_bkrt = {
+	.dtor = &_cln_dtor,
+	.tim_rst = &_cln_tim_rst,
+	.tim_set = &_cln_tim_set,
+	.sht = &_cln_sht,
+	.ord_pas = &_cln_ord_pas,
+	.ord_ccl = &_cln_ord_ccl,
+	.ord_sts = &_cln_ord_sts,
+	.ord_pas_n = &_cln_ord_pas_n,
+	.ord_ccl_n = &_cln_ord_ccl_n,
+	.ord_sts_n = &_cln_ord_sts_n,
+	.ord_rpl = &_cln_ord_rpl
+};
+
+/*
+ * Open the segment at @pth, create it if @crt is set.
+ */
+static inline tb_sgm *_sgm_opn(
+	u8 crt,
+	const char *pth
+)
+{
+	u64 imp = TB_BKP_RNG_NB;
+	return tb_sgm_fopn(
+		crt,
+		&imp,
+		sizeof(u64),
+		1,
+		(u64 []) {sizeof(tb_bkp_hdr)},
+		0,
+		0,
+		0,
+		"%s", pth
+	);
+}
+
+/*
+ * Open the binary protocol bridge at @pth, and return
+ * a broker forwarding to it, simulated if @sim is set.
+ * If it does not exist, does not serve the binary
+ * protocol or is used by another live client, return 0.
+ */
+spb_bkr *tb_bkp_cln_opn(
+	const char *pth,
+	u8 sim
+)
+{
+
+	/* Open. */
+	nh_stt stt;
+	if (nh_fs_tst(NH_FIL_TYP_STM, 0, &stt, pth)) return 0;
+	tb_sgm *sgm = _sgm_opn(0, pth);
+	tb_bkp_hdr *hdr = tb_sgm_rgn(sgm, 0);
+
+	/* Check the protocol. */
+	if (ns_atm(a64, red, acq, &hdr->prt) != TB_BKP_PRT_BIN) {
+		tb_sgm_cls(sgm);
+		return 0;
+	}
+
+	/* Take the write privilege, recovering it from a
+	 * dead client if needed. */
+	u64 off = 0;
+	if (tb_sgm_wrt_rcv(sgm, &off)) {
+		tb_sgm_cls(sgm);
+		return 0;
+	}
+
+	/* Construct. Sequence numbers follow the ones of
+	 * the requests of previous clients. */
+	nh_all__(tb_bkp_cln, cln);
+	cln->bkr.bkrt = &_cln_bkrt;
+	cln->bkr.sim = sim;
+	cln->sgm = sgm;
+	cln->hdr = hdr;
+	cln->seq = ns_atm(a64, red, acq, &hdr->req.wrt);
+	cln->err = 0;
+	_ses_rst(&cln->ses);
+
+	/* Start the session. */
+	tb_bkp_msg msg = {.typ = TB_BKP_MSG_SES};
+	if (_cln_cal(cln, &msg)) {
+		_cln_dtor(&cln->bkr);
+		return 0;
+	}
+	return &cln->bkr;
+
+}
+
+/*
+ * Return 1 if the bridge of the client @bkr failed to
+ * respond, 0 otherwise.
+ */
+u8 tb_bkp_cln_err(
+	spb_bkr *bkr
+) {return ns_cnt_of(bkr, tb_bkp_cln, bkr)->err;}
+
+/**********
+ * Bridge *
+ **********/
+
+/*
+ * Construct and return a binary protocol bridge at
+ * @pth, forwarding requests to @bkr.
+ */
+tb_bkp_srv *tb_bkp_srv_ctr(
+	const char *pth,
+	spb_bkr *bkr
+)
+{
+	nh_all__(tb_bkp_srv, srv);
+	srv->sgm = _sgm_opn(1, pth);
+	tb_bkp_hdr *hdr = srv->hdr = tb_sgm_rgn(srv->sgm, 0);
+	srv->bkr = bkr;
+	_ses_rst(&srv->ses);
+
+	/* Reset rings, then serve. */
+	_rng_rst(&hdr->req);
+	_rng_rst(&hdr->rsp);
+	ns_atm(a64, wrt, rel, &hdr->prt, TB_BKP_PRT_BIN);
+	return srv;
+}
+
+/*
+ * Stop serving, delete @srv.
+ * Its broker is not deleted.
+ */
+void tb_bkp_srv_dtr(
+	tb_bkp_srv *srv
+)
+{
+	ns_atm(a64, wrt, rel, &srv->hdr->prt, 0);
+	tb_sgm_cls(srv->sgm);
+	nh_fre_(srv);
+}
+
+/*
+ * Forward the request at @msg to the broker of @srv,
+ * store the response at @msg.
+ */
+static inline void _srv_one(
+	tb_bkp_srv *srv,
+	tb_bkp_msg *msg
+)
+{
+	spb_bkr *bkr = srv->bkr;
+	const u8 typ = msg->typ;
+	if (typ == TB_BKP_MSG_SES) {
+		_ses_rst(&srv->ses);
+	} else if (typ == TB_BKP_MSG_TIM_RST) {
+		spb_bkr_tim_rst(bkr, msg->arg);
+	} else if (typ == TB_BKP_MSG_TIM_SET) {
+		spb_bkr_tim_set(bkr, msg->arg);
+	} else if (typ == TB_BKP_MSG_SHT) {
+		spb_bkr_sht(bkr);
+	} else if ((typ == TB_BKP_MSG_ORD_PAS) || (typ == TB_BKP_MSG_ORD_RPL)) {
+		tb_ord req;
+		const u64 idx = msg->arg;
+		_ord_dec(&srv->ses, &req, msg);
+		tb_ord rsp = (typ == TB_BKP_MSG_ORD_PAS) ?
+			tb_bkr_ord_pas(bkr, &req) :
+			tb_bkr_ord_rpl(bkr, idx, &req);
+		_ord_enc(&srv->ses, msg, &rsp);
+	} else if (typ == TB_BKP_MSG_ORD_CCL) {
+		tb_bkr_ord_ccl(bkr, msg->arg);
+	} else {
+		assert(typ == TB_BKP_MSG_ORD_STS, "unknown message type %u.\n", typ);
+		tb_ord rsp;
+		tb_bkr_ord_sts(bkr, msg->arg, &rsp);
+		_ord_enc(&srv->ses, msg, &rsp);
+	}
+}
+
+/*
+ * Forward the batch of @nbr requests at @msgs to the
+ * broker of @srv, store the responses at @msgs.
+ */
+static inline void _srv_bat(
+	tb_bkp_srv *srv,
+	tb_bkp_msg *msgs,
+	u64 nbr
+)
+{
+	spb_bkr *bkr = srv->bkr;
+	const u8 typ = msgs[0].typ;
+	tb_ord ords[TB_BKP_BAT_MAX];
+	u64 idxs[TB_BKP_BAT_MAX];
+	for (u64 msg_id = 0; msg_id < nbr; msg_id++) {
+		tb_bkp_msg *msg = msgs + msg_id;
+		assert(msg->typ == typ, "mixed batch types %u and %u.\n", typ, msg->typ);
+		if (typ == TB_BKP_MSG_ORD_PAS_N) _ord_dec(&srv->ses, ords + msg_id, msg);
+		else idxs[msg_id] = msg->arg;
+	}
+	if (typ == TB_BKP_MSG_ORD_PAS_N) {
+		tb_bkr_ord_pas_n(bkr, nbr, ords, ords);
+	} else if (typ == TB_BKP_MSG_ORD_CCL_N) {
+		tb_bkr_ord_ccl_n(bkr, nbr, idxs);
+	} else {
+		assert(typ == TB_BKP_MSG_ORD_STS_N, "unknown batch type %u.\n", typ);
+		tb_bkr_ord_sts_n(bkr, nbr, idxs, ords);
+	}
+	if (typ != TB_BKP_MSG_ORD_CCL_N) {
+		for (u64 msg_id = 0; msg_id < nbr; msg_id++) {
+			_ord_enc(&srv->ses, msgs + msg_id, ords + msg_id);
+		}
+	}
+}
+
+/*
+ * Send the @nbr responses at @msgs to the client of
+ * @srv at once.
+ * If it does not free space in time, it is considered
+ * dead and they are dropped.
+ */
+static inline void _srv_rsp(
+	tb_bkp_srv *srv,
+	const tb_bkp_msg *msgs,
+	u64 nbr
+)
+{
+	u64 stt = 0;
+	for (u64 spn = 0; _rng_put_n(&srv->hdr->rsp, msgs, nbr); spn++) {
+		if ((!spn) || (spn & (TB_BKP_SPN_NB - 1))) continue;
+		if (_rng_tmo(spn, &stt)) return;
+	}
+}
+
+/*
+ * Process all pending requests of @srv, return their
+ * number.
+ */
+u64 tb_bkp_srv_stp(
+	tb_bkp_srv *srv
+)
+{
+	tb_bkp_hdr *hdr = srv->hdr;
+	tb_bkp_msg msgs[TB_BKP_BAT_MAX];
+	u64 nbr = 0;
+	while (!_rng_get(&hdr->req, msgs)) {
+
+		/* Read the rest of the batch, published along
+		 * with its first message. */
+		const u64 bat = (u64) msgs[0].bat + 1;
+		assert(bat <= TB_BKP_BAT_MAX, "batch of %U messages too large.\n", bat);
+		for (u64 msg_id = 1; msg_id < bat; msg_id++) {
+			assert(!_rng_get(&hdr->req, msgs + msg_id), "incomplete batch.\n");
+		}
+		nbr += bat;
+
+		/* Forward. Responses reuse requests. */
+		const u8 typ = msgs[0].typ;
+		if ((typ < TB_BKP_MSG_ORD_PAS_N) || (typ >= TB_BKP_MSG_ORD_RPL)) {
+			assert(bat == 1, "batch of unbatched requests.\n");
+			_srv_one(srv, msgs);
+		} else {
+			_srv_bat(srv, msgs, bat);
+		}
+
+		/* Respond. */
+		_srv_rsp(srv, msgs, bat);
+
+	}
+	return nbr;
+}
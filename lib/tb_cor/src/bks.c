@@ -0,0 +1,482 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*******
+ * Log *
+ *******/
+
+tb_lib_log_def(cor, bks);
+
+/*************
+ * Constants *
+ *************/
+
+/* Distance to a tick, in ticks, under which a price is
+ * considered to be on it. */
+#define TCK_EPS 1e-6
+
+/*************
+ * Internals *
+ *************/
+
+/*
+ * Return the tick of @prc given tick size @siz.
+ * If @prc is on a tick, up to rounding errors, return
+ * it. Otherwise, round up if @up is set, down otherwise.
+ */
+static inline u64 _prc_tck(
+	f64 prc,
+	f64 siz,
+	u8 up
+)
+{
+	const f64 val = prc / siz;
+	const u64 flr = (u64) val;
+	const f64 frc = val - (f64) flr;
+	if (frc < TCK_EPS) return flr;
+	if (frc > 1 - TCK_EPS) return flr + 1;
+	return up ? flr + 1 : flr;
+}
+
+/*
+ * Return the volume of @hst's tick @tck on the buy
+ * side if @buy is set, on the sell side otherwise,
+ * 0 if none.
+ */
+static inline f64 _lvl_vol(
+	tb_lv1_hst *hst,
+	u64 tck,
+	u8 buy
+)
+{
+	tb_lv1_tck *cur = ns_map_sch(&hst->tcks, tck, u64, tb_lv1_tck, tcks);
+	if (!cur) return 0;
+	const f64 vol = buy ? -cur->vol_cur : cur->vol_cur;
+	return (vol > 0) ? vol : 0;
+}
+
+/*
+ * Fill at most @vol of @ord at tick @tck, never beyond
+ * its limit price.
+ * Complete it if fully filled.
+ */
+static inline void _ord_fil(
+	tb_bks *bks,
+	tb_bks_ord *ord,
+	f64 vol,
+	u64 tck
+)
+{
+	tb_ord *dsc = &ord->ord;
+	const f64 rem = dsc->req_vol_prm - dsc->rsp_vol_prm;
+	check(rem > 0);
+	vol = (vol < rem) ? vol : rem;
+	f64 prc = (f64) tck * bks->tck_siz;
+	if (TB_ORD_TYP_HAS_LIM(dsc->typ)) {
+		const f64 lim = dsc->req_prc_lim;
+		if (TB_ORD_TYP_IS_BUY(dsc->typ) ? (prc > lim) : (prc < lim)) prc = lim;
+	}
+	dsc->rsp_vol_prm += vol;
+	dsc->rsp_vol_sec += vol * prc;
+	tb_bks_log("fil %U : %d at %U.\n", dsc->id, vol, tck);
+	if (dsc->rsp_vol_prm >= dsc->req_vol_prm) tb_ord_act_to_cpl(dsc);
+}
+
+/*
+ * Update @ord at @bks's current time.
+ */
+static inline void _ord_upd(
+	tb_bks *bks,
+	tb_bks_ord *ord
+)
+{
+	tb_ord *dsc = &ord->ord;
+	tb_lv1_hst *hst = bks->hst;
+
+	/* Skip orders that are complete, cancelled, or
+	 * that did not reach the market. */
+	if ((dsc->sts == TB_ORD_STS_CCL) || (dsc->sts == TB_ORD_STS_CPL)) return;
+	if (bks->tim < ord->act_tim) return;
+	if (dsc->sts == TB_ORD_STS_IDL) {
+
+		/* Deduct the volume filled on replaced orders,
+		 * cancelled by now. Drop replacements of orders
+		 * that completed or with nothing left. */
+		if (ord->rpl != (u64) -1) {
+			const tb_ord *old = &bks->ords[ord->rpl].ord;
+			const f64 vol = dsc->req_vol_prm - old->rsp_vol_prm;
+			if ((old->sts == TB_ORD_STS_CPL) || (vol <= 0)) {
+				tb_bks_log("rpl %U : %U complete.\n", dsc->id, ord->rpl);
+				tb_ord_idl_to_ccl(dsc);
+				return;
+			}
+			dsc->req_vol_prm = vol;
+		}
+		tb_ord_idl_to_act(dsc);
+
+	}
+
+	/* Cancel if the cancellation reached the market. */
+	if (ord->ccl_tim <= bks->tim) {
+		tb_bks_log("ccl %U.\n", dsc->id);
+		tb_ord_act_to_ccl(dsc);
+		return;
+	}
+
+	/* Read the best ticks. */
+	const u8 typ = dsc->typ;
+	const u8 buy = TB_ORD_TYP_IS_BUY(typ);
+	const u8 has_bid = !!hst->bst_cur_bid;
+	const u8 has_ask = !!hst->bst_cur_ask;
+	const u64 bid = has_bid ? hst->bst_cur_bid->tcks.val : 0;
+	const u64 ask = has_ask ? hst->bst_cur_ask->tcks.val : (u64) -1;
+	const f64 rem = dsc->req_vol_prm - dsc->rsp_vol_prm;
+
+	/* Trigger stops. */
+	if (!ord->trg) {
+		ord->trg = buy ?
+			(has_ask && (ask >= ord->stp_tck)) :
+			(has_bid && (bid <= ord->stp_tck));
+		if (!ord->trg) return;
+		tb_bks_log("trg %U.\n", dsc->id);
+	}
+
+	/* Market orders fill at the best opposite tick. */
+	if (!TB_ORD_TYP_HAS_LIM(typ)) {
+		check(!buy);
+		if (has_bid) _ord_fil(bks, ord, rem, bid);
+		return;
+	}
+
+	/* If the opposite side crosses the limit, fill
+	 * entirely, at the best opposite tick if the order
+	 * was marketable, at the limit if it was resting. */
+	const u64 lim = ord->lim_tck;
+	const u8 crs = buy ?
+		(has_ask && (ask <= lim)) :
+		(has_bid && (bid >= lim));
+	if (crs) {
+		_ord_fil(bks, ord, rem, ord->rst ? lim : buy ? ask : bid);
+		return;
+	}
+
+	/* Join the queue, behind the current volume. */
+	const f64 lvl = _lvl_vol(hst, lim, buy);
+	if (!ord->rst) {
+		ord->rst = 1;
+		ord->que = ord->lvl = lvl;
+		return;
+	}
+
+	/* Consume the queue from the front, fill with
+	 * what remains. */
+	const f64 dec = ord->lvl - lvl;
+	ord->lvl = lvl;
+	if (dec <= 0) return;
+	if (dec <= ord->que) {
+		ord->que -= dec;
+		return;
+	}
+	const f64 fil = dec - ord->que;
+	ord->que = 0;
+	_ord_fil(bks, ord, fil, lim);
+
+}
+
+/*
+ * Pass an order described by @ord, replacing the order
+ * at index @rpl, -1 if none, and return it.
+ * The caller checks the capacity.
+ */
+static inline tb_bks_ord *_ord_pas(
+	tb_bks *bks,
+	tb_ord *ord,
+	u64 rpl
+)
+{
+	assert(!tb_ord_val_(ord, TB_ORD_STS_IDL), "invalid order.\n");
+	check(bks->ord_nbr < bks->ord_max);
+	const u64 id = bks->ord_nbr++;
+	tb_bks_ord *dst = bks->ords + id;
+
+	/* Copy the request. */
+	const u8 typ = ord->typ;
+	const u8 buy = TB_ORD_TYP_IS_BUY(typ);
+	tb_ord_ctr(
+		&dst->ord,
+		ord->prm,
+		ord->sec,
+		typ,
+		ord->req_vol_prm,
+		ord->req_prc_lim,
+		ord->req_prc_stp,
+		id,
+		TB_ORD_STS_IDL
+	);
+
+	/* Convert prices, so that rounding never makes
+	 * the order more aggressive. */
+	const f64 siz = bks->tck_siz;
+	dst->lim_tck = TB_ORD_TYP_HAS_LIM(typ) ? _prc_tck(ord->req_prc_lim, siz, !buy) : 0;
+	dst->stp_tck = TB_ORD_TYP_HAS_STP(typ) ? _prc_tck(ord->req_prc_stp, siz, buy) : 0;
+	dst->trg = !TB_ORD_TYP_HAS_STP(typ);
+
+	/* Schedule. */
+	dst->act_tim = bks->tim + bks->lat;
+	dst->ccl_tim = (u64) -1;
+	dst->rst = 0;
+	dst->que = 0;
+	dst->lvl = 0;
+	dst->rpl = rpl;
+	tb_bks_log("pas %U : %@.\n", id, tb_ord_dsc(&dst->ord, TB_ORD_STS_IDL));
+	return dst;
+
+}
+
+/*
+ * Send a cancel request for the order at index @idx.
+ * If bad index, abort.
+ */
+static inline void _ord_ccl(
+	tb_bks *bks,
+	u64 idx
+)
+{
+	assert(idx < bks->ord_nbr, "bad order index %U.\n", idx);
+	tb_bks_ord *ord = bks->ords + idx;
+	if (ord->ccl_tim == (u64) -1) ord->ccl_tim = bks->tim + bks->lat;
+}
+
+/**************
+ * Broker ops *
+ **************/
+
+/*
+ * Delete @bkr.
+ */
+static void _bks_dtor(
+	spb_bkr *bkr
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	nh_fre(bks->ords, sizeof(tb_bks_ord) * bks->ord_max);
+	nh_fre_(bks);
+}
+
+/*
+ * Reset @bkr, initialize it at time @tim.
+ */
+static void _bks_tim_rst(
+	spb_bkr *bkr,
+	u64 tim
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	bks->tim = tim;
+	bks->ord_stt = 0;
+	bks->ord_nbr = 0;
+}
+
+/*
+ * Set the current time of @bkr, match orders against
+ * the current state of its history.
+ */
+static void _bks_tim_set(
+	spb_bkr *bkr,
+	u64 tim
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	assert(bks->tim <= tim, "non-monotonic time.\n");
+	bks->tim = tim;
+
+	/* Update all orders that may be live. */
+	for (u64 idx = bks->ord_stt; idx < bks->ord_nbr; idx++) {
+		_ord_upd(bks, bks->ords + idx);
+	}
+
+	/* Skip the leading complete or cancelled orders. */
+	while (bks->ord_stt < bks->ord_nbr) {
+		const u8 sts = bks->ords[bks->ord_stt].ord.sts;
+		if ((sts != TB_ORD_STS_CCL) && (sts != TB_ORD_STS_CPL)) break;
+		bks->ord_stt++;
+	}
+
+}
+
+/*
+ * Report shutdown.
+ */
+static void _bks_sht(
+	spb_bkr *bkr
+) {}
+
+/*
+ * Pass an order described by @ord, return
+ * its descriptor.
+ */
+static tb_ord _bks_ord_pas(
+	spb_bkr *bkr,
+	tb_ord *ord
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	assert(bks->ord_nbr < bks->ord_max, "too many orders.\n");
+	return _ord_pas(bks, ord, (u64) -1)->ord;
+}
+
+/*
+ * Send a cancel request for the order at index @idx.
+ * If bad index, abort.
+ */
+static void _bks_ord_ccl(
+	spb_bkr *bkr,
+	u64 idx
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	_ord_ccl(bks, idx);
+}
+
+/*
+ * Save the descriptor of the order at index @idx
+ * at @dst.
+ * If bad index, abort.
+ */
+static void _bks_ord_sts(
+	spb_bkr *bkr,
+	u64 idx,
+	tb_ord *dst
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	assert(idx < bks->ord_nbr, "bad order index %U.\n", idx);
+	*dst = bks->ords[idx].ord;
+}
+
+/*
+ * Pass the @nbr orders described by @ords, save
+ * their descriptors at @dsts.
+ * @ords and @dsts may be the same.
+ */
+static void _bks_ord_pas_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	tb_ord *ords,
+	tb_ord *dsts
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	assert(nbr <= bks->ord_max - bks->ord_nbr, "too many orders.\n");
+	for (u64 ord_id = 0; ord_id < nbr; ord_id++) {
+		dsts[ord_id] = _ord_pas(bks, ords + ord_id, (u64) -1)->ord;
+	}
+}
+
+/*
+ * Send a cancel request for the @nbr orders at
+ * indices @idxs.
+ * If bad index, abort.
+ */
+static void _bks_ord_ccl_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	const u64 *idxs
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	for (u64 ord_id = 0; ord_id < nbr; ord_id++) {
+		_ord_ccl(bks, idxs[ord_id]);
+	}
+}
+
+/*
+ * Save the descriptors of the @nbr orders at
+ * indices @idxs at @dsts.
+ * If bad index, abort.
+ */
+static void _bks_ord_sts_n(
+	spb_bkr *bkr,
+	u64 nbr,
+	const u64 *idxs,
+	tb_ord *dsts
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	const u64 ord_nbr = bks->ord_nbr;
+	for (u64 ord_id = 0; ord_id < nbr; ord_id++) {
+		const u64 idx = idxs[ord_id];
+		assert(idx < ord_nbr, "bad order index %U.\n", idx);
+		dsts[ord_id] = bks->ords[idx].ord;
+	}
+}
+
+/*
+ * Cancel the order at index @idx and pass the order
+ * described by @ord in its place, return its
+ * descriptor.
+ * Both requests reach the market together. The
+ * volume filled on the order at @idx is deducted from
+ * the replacement's, which is cancelled if nothing
+ * remains or if the order at @idx is complete by then.
+ * If bad index, abort.
+ */
+static tb_ord _bks_ord_rpl(
+	spb_bkr *bkr,
+	u64 idx,
+	tb_ord *ord
+)
+{
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	assert(bks->ord_nbr < bks->ord_max, "too many orders.\n");
+	_ord_ccl(bks, idx);
+	return _ord_pas(bks, ord, idx)->ord;
+}
+
+/* Simulation broker type. */
+static spb_bkrt _bks_bkrt = {
+	.dtor = &_bks_dtor,
+	.tim_rst = &_bks_tim_rst,
+	.tim_set = &_bks_tim_set,
+	.sht = &_bks_sht,
+	.ord_pas = &_bks_ord_pas,
+	.ord_ccl = &_bks_ord_ccl,
+	.ord_sts = &_bks_ord_sts,
+	.ord_pas_n = &_bks_ord_pas_n,
+	.ord_ccl_n = &_bks_ord_ccl_n,
+	.ord_sts_n = &_bks_ord_sts_n,
+	.ord_rpl = &_bks_ord_rpl
+};
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a simulation broker of at most
+ * @ord_max orders, matching against @hst with tick size
+ * @tck_siz and request latency @lat.
+ */
+spb_bkr *tb_bks_ctr(
+	tb_lv1_hst *hst,
+	f64 tck_siz,
+	u64 lat,
+	u64 ord_max
+)
+{
+	assert(tck_siz > 0);
+	assert(ord_max);
+	nh_all__(tb_bks, bks);
+	bks->bkr.bkrt = &_bks_bkrt;
+	bks->bkr.sim = 1;
+	bks->hst = hst;
+	bks->tck_siz = tck_siz;
+	bks->lat = lat;
+	bks->tim = 0;
+	bks->ord_stt = 0;
+	bks->ord_nbr = 0;
+	bks->ord_max = ord_max;
+	bks->ords = nh_all(sizeof(tb_bks_ord) * ord_max);
+	return &bks->bkr;
+}
@@ -9,7 +9,7 @@
 /*
  * Define currencies.
  */
-#define TB_CCY(nam, sym) tb_ccy tb_ccy_##sym = {{}, #sym, #nam};
+#define TB_CCY(nam, sym) tb_ccy tb_ccy_##sym = {#sym, #nam, TB_CCY_ID_##sym};
 #include <tb_cor/ccys.h>
 #undef TB_CCY
 
@@ -20,9 +20,6 @@
 /* Currencies system. */
 static tb_ccy_sys _ccy_sys = {};
 
-/* Currencies init status. */
-static u8 _ccy_ini = 0;
-
 /* Define the currencies array. */
 static tb_ccy *_ccy_arr[] = {
 #define TB_CCY(nam, sym) &tb_ccy_##sym,
@@ -38,18 +35,29 @@ static const u32 _ccys_nb = sizeof(_ccy_arr) / sizeof(_ccy_arr[0]);
  ********/
 
 /*
- * Init the currencies map.
+ * Init the currencies index.
  */
-static inline void _sys_ini(
+static void _sys_ini(
 	tb_ccy_sys *sys
 )
 {
-	check(nh_spn_lkd(&sys->lck));
-	if (_ccy_ini) return;
-	ns_map_str_ini(&sys->ccys);
-	for (u32 ccy_id = 0; ccy_id < _ccys_nb; ccy_id++) {
-		ns_map_str_put(&sys->ccys, &_ccy_arr[ccy_id]->ccys, _ccy_arr[ccy_id]->sym);
+	nh_spn_lck(&sys->lck);
+	if (!sys->rdy) {
+		const char *syms[sizeof(_ccy_arr) / sizeof(_ccy_arr[0])];
+		u32 slts[sizeof(_ccy_arr) / sizeof(_ccy_arr[0])];
+		for (u32 ccy_id = 0; ccy_id < _ccys_nb; ccy_id++) {
+			syms[ccy_id] = _ccy_arr[ccy_id]->sym;
+		}
+		tb_phf_ctr(&sys->phf, syms, _ccys_nb, slts);
+		const u32 slt_nbr = tb_phf_slt_nbr(&sys->phf);
+		sys->ccys = nh_all(sizeof(tb_ccy *) * slt_nbr);
+		ns_mem_rst(sys->ccys, sizeof(tb_ccy *) * slt_nbr);
+		for (u32 ccy_id = 0; ccy_id < _ccys_nb; ccy_id++) {
+			sys->ccys[slts[ccy_id]] = _ccy_arr[ccy_id];
+		}
+		ns_atm(a64, wrt, rel, &sys->rdy, 1);
 	}
+	nh_spn_ulk(&sys->lck);
 }
 
 /************
@@ -70,16 +78,14 @@ void tb_ccy_log(
 
 /*
  * Currency lookup by symbol.
+ * Wait-free once initialized.
  */
 tb_ccy *tb_ccy_sch(
 	const char *sym
 )
 {
 	tb_ccy_sys *sys = &_ccy_sys;
-	nh_spn_lck(&sys->lck); 
-	_sys_ini(sys);
-	tb_ccy *ccy = ns_map_sch(&sys->ccys, sym, str, tb_ccy, ccys);
-	nh_spn_ulk(&sys->lck); 
-	return ccy;
+	if (!ns_atm(a64, red, acq, &sys->rdy)) _sys_ini(sys);
+	tb_ccy *ccy = sys->ccys[tb_phf_slt(&sys->phf, sym)];
+	return (ccy && tb_str_equ(ccy->sym, sym)) ? ccy : 0;
 }
-
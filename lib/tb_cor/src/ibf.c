@@ -0,0 +1,153 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*************
+ * Internals *
+ *************/
+
+/*
+ * Publish @nb elements located at @srcs.
+ */
+static inline void _ibf_pub(
+	tb_ibf *ibf,
+	u64 nb,
+	const void **srcs
+)
+{
+	const void *locs[TB_ANB_MAX];
+	for (u8 arr_id = 0; arr_id < ibf->arr_nbr; arr_id++) {
+		locs[arr_id] = srcs[arr_id];
+	}
+	tb_stg_wrt(ibf->idx, nb, locs, ibf->arr_nbr, ibf->val_fnc, ibf->val_arg);
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return an ingest buffer for @idx,
+ * publishing writes according to @elm_max and @lat_max.
+ * @idx must be opened with write privileges and
+ * must not be written to by other means while the
+ * buffer exists.
+ */
+tb_ibf *tb_ibf_ctr(
+	tb_stg_idx *idx,
+	u64 elm_max,
+	u64 lat_max,
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg),
+	void *val_arg
+)
+{
+	assert(idx->key, "not a writeable index.\n");
+	assert(elm_max);
+
+	/* Allocate. */
+	nh_all__(tb_ibf, ibf);
+	ibf->idx = idx;
+	ibf->arr_nbr = tb_lvl_arr_nbr(idx->lvl);
+	ibf->sizs = tb_lvl_arr_elm_sizs(idx->lvl);
+	ibf->elm_max = elm_max;
+	ibf->lat_max = lat_max;
+	ibf->elm_nbr = 0;
+	ibf->tim_fst = 0;
+	ibf->val_fnc = val_fnc;
+	ibf->val_arg = val_arg;
+
+	/* Allocate arrays, not needed in write-through mode. */
+	for (u8 arr_id = 0; arr_id < ibf->arr_nbr; arr_id++) {
+		ibf->arrs[arr_id] = (lat_max) ? nh_all(elm_max * ibf->sizs[arr_id]) : 0;
+	}
+
+	/* Complete. */
+	return ibf;
+
+}
+
+/*
+ * Publish @ibf's content and delete it.
+ */
+void tb_ibf_dtr(
+	tb_ibf *ibf
+)
+{
+	tb_ibf_fls(ibf);
+	for (u8 arr_id = 0; arr_id < ibf->arr_nbr; arr_id++) {
+		if (ibf->arrs[arr_id]) nh_fre(ibf->arrs[arr_id], ibf->elm_max * ibf->sizs[arr_id]);
+	}
+	nh_fre_(ibf);
+}
+
+/*
+ * Publish @ibf's content.
+ */
+void tb_ibf_fls(
+	tb_ibf *ibf
+)
+{
+	if (!ibf->elm_nbr) return;
+	_ibf_pub(ibf, ibf->elm_nbr, (const void **) ibf->arrs);
+	ibf->elm_nbr = 0;
+}
+
+/*
+ * Buffer @nb elements located at @srcs.
+ * Publish if required by the flush policy.
+ */
+void tb_ibf_wrt(
+	tb_ibf *ibf,
+	u64 nb,
+	const void **srcs
+)
+{
+	if (!nb) return;
+
+	/* In write-through mode, publish directly. */
+	if (!ibf->lat_max) {
+		_ibf_pub(ibf, nb, srcs);
+		return;
+	}
+
+	/* If the write does not fit, publish what we have.
+	 * If it does not fit in an empty buffer either,
+	 * publish it directly. */
+	if (ibf->elm_nbr + nb > ibf->elm_max) {
+		tb_ibf_fls(ibf);
+		if (nb >= ibf->elm_max) {
+			_ibf_pub(ibf, nb, srcs);
+			return;
+		}
+	}
+
+	/* Buffer. */
+	const u64 tim = nh_run_tim();
+	if (!ibf->elm_nbr) ibf->tim_fst = tim;
+	for (u8 arr_id = 0; arr_id < ibf->arr_nbr; arr_id++) {
+		const u8 siz = ibf->sizs[arr_id];
+		ns_mem_cpy(ns_psum(ibf->arrs[arr_id], ibf->elm_nbr * siz), srcs[arr_id], nb * siz);
+	}
+	ibf->elm_nbr += nb;
+
+	/* Publish if full or late. */
+	if ((ibf->elm_nbr == ibf->elm_max) || (tim - ibf->tim_fst >= ibf->lat_max)) {
+		tb_ibf_fls(ibf);
+	}
+
+}
+
+/*
+ * If @ibf's oldest element exceeded its latency,
+ * publish its content and return 1.
+ * Otherwise, return 0.
+ */
+u8 tb_ibf_pol(
+	tb_ibf *ibf
+)
+{
+	if (!ibf->elm_nbr) return 0;
+	if (nh_run_tim() - ibf->tim_fst < ibf->lat_max) return 0;
+	tb_ibf_fls(ibf);
+	return 1;
+}
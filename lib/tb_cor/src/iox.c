@@ -8,7 +8,9 @@
 
 /*
  * If data is available, store its location at @dstp,
- * return the number of available elements.
+ * store the time of the write publication of its first
+ * element at @pub_timp, return the number of available
+ * elements.
  * Otherwise, return 0.
  */
 static inline u64 _lv1_blk_red(
@@ -17,7 +19,8 @@ static inline u64 _lv1_blk_red(
 	const void **dsts,
 	u8 dsts_nbr,
 	u8 *donp,
-	u8 *endp
+	u8 *endp,
+	u64 *pub_timp
 )
 {
 	assert(dsts_nbr == dr1->dat_nbr);
@@ -27,6 +30,13 @@ static inline u64 _lv1_blk_red(
 	/* Stream flags. */
 	u8 don = 0;
 	u8 end = 0;
+	u64 nbr = 0;
+	u64 shf = dr1->elm_idx;
+	*pub_timp = 0;
+
+	/* Number of elements of the block already
+	 * discovered. */
+	u64 elm_prv = dr1->elm_nbr;
 
 	/* First, update the block if required.
 	 * If none, fail. */
@@ -48,32 +58,43 @@ static inline u64 _lv1_blk_red(
 		dr1->elm_nbr = tb_blk_arr(blk, dr1->dats, dsts_nbr, &dr1->sizs);
 		dr1->elm_max = tb_stg_blk_max(dr1->blk);
 		dr1->elm_idx = 0;
-		dr1->blk_end = ((u64 *) dr1->dats[0])[dr1->elm_nbr - 1];
+		shf = 0;
+		elm_prv = 0;
 
 	}
 
 	/* If no time limit, or if time limit is after the
 	 * current block's end, provide as much data as possible.
 	 * If time limit within the current block, find the max index. */
-	assert(dr1->elm_idx < dr1->elm_nbr);
 	const u64 elm_nbr = dr1->elm_nbr = tb_stg_elm_nbr(dr1->blk);
-	const u64 shf = dr1->elm_idx;
-	u64 nbr = dr1->elm_nbr - shf; 
+	assert(shf <= elm_nbr);
+	dr1->blk_end = ((u64 *) dr1->dats[0])[elm_nbr - 1];
+	nbr = elm_nbr - shf; 
 	if (tim_cur <= dr1->blk_end) {
 		don = 1;
-		const u64 max = dr1->elm_idx = tb_stg_elm_sch((u64 *) dr1->dats[0], elm_nbr, 0, tim_cur); 
+		const u64 max = dr1->elm_idx = tb_stg_elm_sch((u64 *) dr1->dats[0], elm_nbr, shf, tim_cur); 
 		assert(max < elm_nbr);
-		assert(shf < max);
 		nbr = max - shf;
 	}
 	
 	/* If current block is not full, the end of
 	 * the stream is reached. */
-	else if (elm_nbr != dr1->elm_max) {
-		don = 1;
-		end = 1;
+	else {
+		dr1->elm_idx = elm_nbr;
+		if (elm_nbr != dr1->elm_max) {
+			don = 1;
+			end = 1;
+		}
 	}
 
+	/* Trace the discovery of new elements from the
+	 * oldest one, and the publication of the first
+	 * provided one. */
+	tb_stt_lat(TB_STT_LAT_DSC, (elm_nbr > elm_prv) ? tb_stg_pub_tim(dr1->blk, elm_prv) : 0);
+	#ifdef TB_STT
+	if (nbr) *pub_timp = tb_stg_pub_tim(dr1->blk, shf);
+	#endif
+
 	/* Provide data. */
 	end:;
 	*donp = don;
@@ -170,13 +191,13 @@ static inline void _add_upds(
 	/* Initialize the read environment to read starting
 	 * at @blk's first element. */
 	dr1->blk = blk;
-	const u64 elm_nbr = tb_blk_arr(dr1->blk, (const void **) dr1->dats, dat_nbr, &dr1->sizs);
+	const u64 elm_nbr = dr1->elm_nbr = tb_blk_arr(dr1->blk, (const void **) dr1->dats, dat_nbr, &dr1->sizs);
 	assert(elm_nbr);
 	assert(dr1->sizs);
 	const u64 elm_max = dr1->elm_max = tb_stg_blk_max(dr1->blk);
 	const u64 elm_idx = dr1->elm_idx = 0;
 	assert(elm_idx < elm_nbr);
-	assert(elm_nbr < elm_max);
+	assert(elm_nbr <= elm_max);
 	const u64 blk_stt = ((u64 *) dr1->dats[0])[0];
 	const u64 blk_end = ((u64 *) dr1->dats[0])[elm_nbr - 1];
 	assert(blk_stt <= tim_stt);
@@ -195,6 +216,8 @@ static inline void _add_upds(
  * read through @sys, initialized with data up to @tim_cur.
  * The reconstructor has the entire heatmap data
  * populated until @tim_cur. 
+ * Heatmaps and curves are published through @buf_nbr
+ * buffers.
  */
 tb_dr1 *tb_dr1_ctr(
 	tb_stg_sys *sys,
@@ -204,6 +227,7 @@ tb_dr1 *tb_dr1_ctr(
 	u64 hmp_dim_tck,
 	u64 hmp_dim_tim,
 	u64 bac_nb,
+	u8 buf_nbr,
 	u64 tim_cur
 )
 {
@@ -211,8 +235,8 @@ tb_dr1 *tb_dr1_ctr(
 	/* Construct, open the index, get the block
 	 * covering @tim. */
 	nh_all__(tb_dr1, dr1);
-	tb_str_cpy(dr1->mkp, mkp);
-	tb_str_cpy(dr1->ist, ist);
+	dr1->mkp = tb_sym_get(mkp);
+	dr1->ist = tb_sym_get(ist);
 	dr1->stg = sys;
 	dr1->idx = assert(tb_stg_opn(dr1->stg, mkp, ist, 1, 0, 0));
 
@@ -221,8 +245,11 @@ tb_dr1 *tb_dr1_ctr(
 		tim_res,
 		hmp_dim_tck,
 		hmp_dim_tim,
-		bac_nb
+		bac_nb,
+		TB_LV1_FMT_F64,
+		1
 	);
+	tb_lv1_buf_set(dr1->hst, buf_nbr);
 
 	/* Determine the total heatmap length and the
 	 * heatmap start. */
@@ -270,6 +297,7 @@ void tb_dr1_add(
 	u8 end_ok
 )
 {
+	tb_stt_fnc(TB_STT_FNC_DR1_ADD);
 
 	/* Ensure monotonicity. */
 	assert(dr1->tim_lst <= tim_cur);
@@ -281,6 +309,8 @@ void tb_dr1_add(
 	/* Read iteratively. */
 	u8 don = 0;
 	u8 end = 0;
+	u64 pub_tim = 0;
+	u64 pub_fst = 0;
 	const void *dsts[3];
 	while (!don) {
 
@@ -291,7 +321,8 @@ void tb_dr1_add(
 			dsts,
 			3,
 			&don,
-			&end
+			&end,
+			&pub_tim
 		);
 
 		/* Verify that end makes sense and is only
@@ -299,7 +330,8 @@ void tb_dr1_add(
 		assert((!end) || don);
 		assert((!end) || (end_ok), "unexpected end of data.\n");
 
-		/* Add. */
+		/* Add, trace from the first added element. */
+		if (!upd_nbr) continue;
 		tb_lv1_add(
 			dr1->hst,
 			upd_nbr,
@@ -307,11 +339,15 @@ void tb_dr1_add(
 			dsts[1],
 			dsts[2]
 		);
+		tb_stt_lat(TB_STT_LAT_ADD, pub_tim);
+		if (!pub_fst) pub_fst = pub_tim;
 
 	}
 
-	/* Process all updates. */
+	/* Process all updates, trace the heatmap
+	 * publication from the oldest added element. */
 	tb_lv1_prc(dr1->hst);
+	tb_stt_lat(TB_STT_LAT_HMP, pub_fst);
 
 }
 
@@ -416,7 +452,105 @@ void tb_io1_wrt(
 		&_val_lv1, (void *) gos
 	);
 }
+
+/*
+ * Construct and return a level 1 ingest buffer
+ * for @idx. See ibf.h for @elm_max and @lat_max.
+ * Receives a giga orderbook snapshot to compute the
+ * new blocks' orderbook snapshots.
+ */
+tb_ibf *tb_io1_ibf(
+	tb_stg_idx *idx,
+	u64 elm_max,
+	u64 lat_max,
+	f64 *gos
+)
+{
+	assert(idx->lvl == 1);
+	return tb_ibf_ctr(idx, elm_max, lat_max, &_val_lv1, (void *) gos);
+}
+
+/*
+ * Level 1 import fill function.
+ * Transpose records into block arrays.
+ */
+static void _fil_lv1(
+	void **dsts,
+	u64 stt,
+	u64 nbr,
+	void *arg
+)
+{
+	const tb_io1_rec *recs = (const tb_io1_rec *) arg + stt;
+	u64 *tims = dsts[0];
+	u64 *tcks = dsts[1];
+	f64 *vols = dsts[2];
+	for (u64 rec_id = 0; rec_id < nbr; rec_id++) {
+		tims[rec_id] = recs[rec_id].tim;
+		tcks[rec_id] = recs[rec_id].tck;
+		vols[rec_id] = recs[rec_id].vol;
+	}
+}
+
+/*
+ * Level 1 bulk import.
+ * Append all records of the memory-mapped import
+ * file at @pth to @idx, building blocks with
+ * @thr_nbr threads.
+ * Receives a giga orderbook snapshot to compute the
+ * new blocks' orderbook snapshots.
+ */
+void tb_io1_imp(
+	tb_stg_idx *idx,
+	const char *pth,
+	u8 thr_nbr,
+	f64 *gos
+)
+{
+	assert(idx->lvl == 1);
+
+	/* Map the import file. */
+	nh_res res;
+	ns_stg *stg = assert(nh_stg_opn(NH_FIL_ATT_R, &res, pth), "import file %s open failed.\n", pth);
+	const u64 siz = ns_stg_siz(stg);
+	assert(!(siz % sizeof(tb_io1_rec)), "import file %s : size not a multiple of the record size.\n", pth);
+	const u64 rec_nbr = siz / sizeof(tb_io1_rec);
+	if (!rec_nbr) goto end;
+	const tb_io1_rec *recs = assert(ns_stg_map(stg, 0, 0, siz, NS_STG_ATT_RED | NS_STG_ATT_SHR));
+
+	/* Import. */
+	tb_stg_imp(
+		idx,
+		rec_nbr,
+		thr_nbr,
+		&_fil_lv1, (void *) recs,
+		&_val_lv1, (void *) gos
+	);
+
+	/* Unmap. */
+	ns_stg_ump(stg, (void *) recs, siz);
+
+	/* Close. */
+	end:;
+	nh_stg_cls(&res);
+
+}
 	
+/*
+ * Level 1 recovery.
+ * See tb_stg_rcv.
+ * Receives a giga orderbook snapshot to compute the
+ * orderbook snapshots of the revalidated blocks.
+ */
+void tb_io1_rcv(
+	tb_stg_idx *idx,
+	f64 *gos
+)
+{
+	assert(idx->lvl == 1);
+	tb_stg_rcv(idx, &_val_lv1, (void *) gos);
+}
+
 /*
  * Level 2 data write.
  */
@@ -449,4 +583,3 @@ void tb_io2_wrt(
 		0, 0
 	);
 }
-
@@ -9,6 +9,149 @@
 /* System. */
 static tb_ist_sys _sys = {};
 
+/*************
+ * Internals *
+ *************/
+
+/*
+ * Return the home slot of name symbol @nam.
+ */
+static inline u64 _ist_hom(
+	u32 nam
+) {return ((u64) nam * 0x9e3779b97f4a7c15) >> 32;}
+
+/*
+ * Return the index of the chunk of the instrument table
+ * holding identifier @id, and save at @off the offset
+ * of @id in it.
+ */
+static inline u8 _chk_loc(
+	u32 id,
+	u64 *off
+)
+{
+	const u64 pos = ((u64) id >> TB_IST_CHK_ORD) + 1;
+	const u8 chk = (u8) (63 - __builtin_clzll(pos));
+	*off = (u64) id - ((((u64) 1 << chk) - 1) << TB_IST_CHK_ORD);
+	return chk;
+}
+
+/*
+ * Return the number of instruments of chunk @chk.
+ */
+static inline u64 _chk_siz(
+	u8 chk
+) {return (u64) 1 << (TB_IST_CHK_ORD + chk);}
+
+/*
+ * Return the registry referenced by @ref, 0 if none.
+ */
+static inline tb_ist_reg *_reg_get(
+	volatile a64 *ref
+) {return (tb_ist_reg *) (uad) ns_atm(a64, red, acq, ref);}
+
+/*
+ * Return the size of a registry of @slt_nbr slots.
+ */
+static inline u64 _reg_siz(
+	u64 slt_nbr
+) {return sizeof(tb_ist_reg) + sizeof(a64) * slt_nbr;}
+
+/*
+ * Return the instrument of name symbol @nam in the
+ * registry referenced by @ref in @sys, 0 if none.
+ * Name symbols are unique, tags suffice.
+ */
+static inline tb_ist *_ist_sch(
+	tb_ist_sys *sys,
+	volatile a64 *ref,
+	u32 nam
+)
+{
+	tb_ist_reg *reg = _reg_get(ref);
+	if (!reg) return 0;
+	const u32 val = tb_reg_sch(reg->slts, reg->slt_nbr, _ist_hom(nam), nam, 0, 0);
+	if (!val) return 0;
+	u64 off;
+	const u8 chk = _chk_loc(val - 1, &off);
+	return sys->chks[chk][off];
+}
+
+/*
+ * Return the registry referenced by @ref, replaced by
+ * one twice larger if it cannot take another entry
+ * while staying at most half full.
+ * Must be called with the lock held.
+ */
+static inline tb_ist_reg *_reg_rsv(
+	volatile a64 *ref
+)
+{
+	tb_ist_reg *reg = _reg_get(ref);
+	if (reg && (2 * (reg->ent_nbr + 1) <= reg->slt_nbr)) return reg;
+
+	/* Allocate, reinsert, publish. */
+	const u64 slt_nbr = reg ? 2 * reg->slt_nbr : TB_IST_REG_MIN;
+	tb_ist_reg *grw = nh_all(_reg_siz(slt_nbr));
+	ns_mem_rst(grw, _reg_siz(slt_nbr));
+	grw->prv = reg;
+	grw->slt_nbr = slt_nbr;
+	if (reg) {
+		for (u64 slt = 0; slt < reg->slt_nbr; slt++) {
+			const u64 ent = reg->slts[slt];
+			if (!ent) continue;
+			const u32 nam = (u32) (ent >> 32);
+			tb_reg_put(grw->slts, slt_nbr, _ist_hom(nam), nam, (u32) ent);
+		}
+		grw->ent_nbr = reg->ent_nbr;
+	}
+	ns_atm(a64, wrt, rel, ref, (u64) (uad) grw);
+	return grw;
+
+}
+
+/*
+ * Free the registry referenced by @ref and those it
+ * replaced.
+ * Must be called with the lock held.
+ */
+static inline void _reg_fre(
+	volatile a64 *ref
+)
+{
+	tb_ist_reg *reg = _reg_get(ref);
+	while (reg) {
+		tb_ist_reg *prv = reg->prv;
+		nh_fre(reg, _reg_siz(reg->slt_nbr));
+		reg = prv;
+	}
+	ns_atm(a64, wrt, rel, ref, 0);
+}
+
+/*
+ * Assign the next identifier to @ist and publish it in
+ * the registry referenced by @ref in @sys.
+ * Must be called with the lock held.
+ */
+static inline void _ist_reg(
+	tb_ist_sys *sys,
+	volatile a64 *ref,
+	tb_ist *ist
+)
+{
+	const u32 id = (u32) sys->ist_nbr;
+	u64 off;
+	const u8 chk = _chk_loc(id, &off);
+	assert(chk < TB_IST_CHK_NB, "too many instruments.\n");
+	if (!sys->chks[chk]) sys->chks[chk] = nh_all(sizeof(tb_ist *) * _chk_siz(chk));
+	tb_ist_reg *reg = _reg_rsv(ref);
+	ist->id = id;
+	sys->chks[chk][off] = ist;
+	ns_atm(a64, wrt, rel, &sys->ist_nbr, id + 1);
+	tb_reg_put(reg->slts, reg->slt_nbr, _ist_hom(ist->nam), ist->nam, id + 1);
+	reg->ent_nbr++;
+}
+
 /*******
  * API *
  *******/
@@ -24,20 +167,26 @@ void tb_ist_cln(
 {
 	tb_ist_sys *sys = &_sys;
 	nh_spn_lck(&sys->lck);
-	tb_ist *ist;
-	ns_map_fe(ist, &sys->shrs, shr.shrs, str, in) {
-		nh_fre_(ist);
+	const u32 ist_nbr = (u32) sys->ist_nbr;
+	for (u32 id = 0; id < ist_nbr; id++) {
+		u64 off;
+		const u8 chk = _chk_loc(id, &off);
+		nh_fre_(sys->chks[chk][off]);
 	}
-	ns_map_fe(ist, &sys->ccys, ccy.ccys, str, in) {
-		nh_fre_(ist);
+	for (u8 chk = 0; chk < TB_IST_CHK_NB; chk++) {
+		if (!sys->chks[chk]) continue;
+		nh_fre(sys->chks[chk], sizeof(tb_ist *) * _chk_siz(chk));
+		sys->chks[chk] = 0;
 	}
-	ns_map_str_ini(&sys->shrs);
-	ns_map_str_ini(&sys->ccys);
+	_reg_fre(&sys->shrs);
+	_reg_fre(&sys->ccys);
+	ns_atm(a64, wrt, rel, &sys->ist_nbr, 0);
 	nh_spn_ulk(&sys->lck);
 }
 
 /*
  * Return a share instrument identifier.
+ * Wait-free if it exists.
  */
 tb_ist *tb_ist_ctr_shr(
 	tb_mkp *mkp,
@@ -48,18 +197,23 @@ tb_ist *tb_ist_ctr_shr(
 	/* Generate the name. */
 	const char *mkp_val = tb_mkp_nam(mkp);
 	TB_STR_GEN2(idt, mkp_val, sym);
+	const u32 nam = tb_sym_get(idt);
 
-	/* Lock. */
+	/* Search without locking. */
 	tb_ist_sys *sys = &_sys;
+	tb_ist *ist = _ist_sch(sys, &sys->shrs, nam);
+	if (ist) return ist;
+
+	/* Lock to create. */
 	nh_spn_lck(&sys->lck);
-	tb_ist *ist = ns_map_sch(&sys->shrs, idt, str, tb_ist, shr.shrs);
+	ist = _ist_sch(sys, &sys->shrs, nam);
 	if (!ist) {
 		nh_all_(ist);
-		tb_str_cpy(ist->nam, idt);
+		ist->nam = nam;
 		ist->cls = TB_IST_CLS_SHR;
-		assert(!ns_map_str_put(&sys->shrs, &ist->shr.shrs, ist->nam));
 		ist->shr.mkp = mkp;
-		tb_str_cpy(ist->shr.sym, sym); 
+		ist->shr.sym = tb_sym_get(sym);
+		_ist_reg(sys, &sys->shrs, ist);
 	}
 	nh_spn_ulk(&sys->lck);
 	return ist;
@@ -68,6 +222,7 @@ tb_ist *tb_ist_ctr_shr(
 
 /*
  * Return a currency instrument identifier.
+ * Wait-free if it exists.
  */
 tb_ist *tb_ist_ctr_ccy(
 	tb_mkp *mkp,
@@ -79,24 +234,50 @@ tb_ist *tb_ist_ctr_ccy(
 	const char *mkp_val = tb_mkp_nam(mkp);
 	const char *ccy_val = tb_ccy_nam(ccy);
 	TB_STR_GEN2(idt, mkp_val, ccy_val);
+	const u32 nam = tb_sym_get(idt);
 
-	/* Lock. */
+	/* Search without locking. */
 	tb_ist_sys *sys = &_sys;
+	tb_ist *ist = _ist_sch(sys, &sys->ccys, nam);
+	if (ist) return ist;
+
+	/* Lock to create. */
 	nh_spn_lck(&sys->lck);
-	tb_ist *ist = ns_map_sch(&sys->ccys, idt, str, tb_ist, ccy.ccys);
+	ist = _ist_sch(sys, &sys->ccys, nam);
 	if (!ist) {
 		nh_all_(ist);
-		tb_str_cpy(ist->nam, idt);
+		ist->nam = nam;
 		ist->cls = TB_IST_CLS_CCY;
-		assert(!ns_map_str_put(&sys->ccys, &ist->ccy.ccys, ist->nam));
 		ist->ccy.mkp = mkp;
 		ist->ccy.ccy = ccy;
+		_ist_reg(sys, &sys->ccys, ist);
 	}
 	nh_spn_ulk(&sys->lck);
 	return ist;
 
 }
 
+/*
+ * Return the number of instruments, every identifier
+ * being lower.
+ */
+u32 tb_ist_nbr(
+	void
+) {return (u32) ns_atm(a64, red, acq, &_sys.ist_nbr);}
+
+/*
+ * Return the instrument of identifier @id.
+ */
+tb_ist *tb_ist_get(
+	u32 id
+)
+{
+	assert(id < tb_ist_nbr(), "bad instrument identifier %u.\n", id);
+	u64 off;
+	const u8 chk = _chk_loc(id, &off);
+	return _sys.chks[chk][off];
+}
+
 /*
  * Print log data for an instrument.
  */
@@ -109,7 +290,7 @@ void tb_ist_log(
 	const u8 cls = ist->cls;
 	assert(cls < TB_IST_CLS_NB);
 	if (cls == TB_IST_CLS_SHR) {
-		ns_stm_writef(stm, "(SHR %s:%s)", tb_mkp_nam(ist->shr.mkp), ist->shr.sym);
+		ns_stm_writef(stm, "(SHR %s:%s)", tb_mkp_nam(ist->shr.mkp), tb_sym_str(ist->shr.sym));
 	} else {
 		ns_stm_writef(stm, "(CCY %s:%s)", tb_mkp_nam(ist->shr.mkp), tb_ccy_nam(ist->ccy.ccy));
 	}	
@@ -0,0 +1,462 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*************
+ * Internals *
+ *************/
+
+/* Implementation descriptor. */
+static char _jrn_imp[] = "tb_jrn 1";
+
+/* Minimal capacity of instrument arrays. */
+#define ARR_MIN 16
+
+/*
+ * Grow @arr of @*max elements of @siz bytes so that it
+ * holds at least @nbr elements, zero the new ones,
+ * update @*max and return it.
+ */
+static inline void *_arr_grw(
+	void *arr,
+	u64 siz,
+	u32 *max,
+	u32 nbr
+)
+{
+	const u32 prv = *max;
+	if (nbr <= prv) return arr;
+	u32 cap = prv ? prv : ARR_MIN;
+	while (cap < nbr) cap <<= 1;
+	u8 *res = nh_all(siz * cap);
+	if (prv) {
+		ns_mem_cpy(res, arr, siz * prv);
+		nh_fre(arr, siz * prv);
+	}
+	ns_mem_rst(res + siz * prv, siz * (cap - prv));
+	*max = cap;
+	return res;
+}
+
+/*
+ * Map @ist to the journal index @jid in @jrn.
+ */
+static inline void _ist_map(
+	tb_jrn *jrn,
+	tb_ist *ist,
+	u32 jid
+)
+{
+	jrn->jids = _arr_grw(jrn->jids, sizeof(u32), &jrn->jid_max, ist->id + 1);
+	jrn->ists = _arr_grw(jrn->ists, sizeof(tb_ist *), &jrn->ist_max, jid + 1);
+	jrn->jids[ist->id] = jid + 1;
+	jrn->ists[jid] = ist;
+	jrn->ist_nbr = jid + 1;
+}
+
+/*
+ * Copy @src in the instrument record string @dst.
+ */
+static inline void _str_cpy(
+	char *dst,
+	const char *src
+)
+{
+	const uad len = ns_str_len(src);
+	assert(len < TB_JRN_STR_SIZ, "symbol '%s' too long.\n", src);
+	ns_mem_cpy(dst, src, len + 1);
+}
+
+/*
+ * Return the location of the next record of @jrn of
+ * type @typ, initialized.
+ * It must be published with _rec_don.
+ * @jrn must have room for it, see _rec_rsv.
+ */
+static inline tb_jrn_rec *_rec_loc(
+	tb_jrn *jrn,
+	u8 typ
+)
+{
+	tb_sgm *sgm = jrn->sgm;
+	check(tb_sgm_elm_nbr(sgm) < tb_sgm_elm_max(sgm));
+	void *dst;
+	tb_sgm_wrt_loc(sgm, 1, &dst, 1);
+	tb_jrn_rec *rec = dst;
+	ns_mem_rst(rec, sizeof(tb_jrn_rec));
+	rec->tim = nh_run_tim();
+	rec->typ = typ;
+	return rec;
+}
+
+/*
+ * Publish the record of @jrn returned by _rec_loc and
+ * return its index.
+ */
+static inline u64 _rec_don(
+	tb_jrn *jrn
+) {return tb_sgm_wrt_don(jrn->sgm, 1) - 1;}
+
+/*
+ * Return the journal index of @ist in @jrn plus one,
+ * 0 if it is not defined.
+ */
+static inline u32 _ist_fnd(
+	tb_jrn *jrn,
+	tb_ist *ist
+) {return (ist->id < jrn->jid_max) ? jrn->jids[ist->id] : 0;}
+
+/*
+ * Check that @jrn has room for the definitions of @prm
+ * and of @sec if they are not defined, then for one
+ * record. If not, return 1.
+ * @sec may be null.
+ */
+static inline uerr _rec_rsv(
+	tb_jrn *jrn,
+	tb_ist *prm,
+	tb_ist *sec
+)
+{
+	tb_sgm *sgm = jrn->sgm;
+	u64 nbr = 1;
+	if (!_ist_fnd(jrn, prm)) nbr++;
+	if (sec && (sec != prm) && (!_ist_fnd(jrn, sec))) nbr++;
+	return tb_sgm_elm_max(sgm) - tb_sgm_elm_nbr(sgm) < nbr;
+}
+
+/*
+ * Return the journal index of @ist in @jrn, define it
+ * if required.
+ * @jrn must have room for the definition, see _rec_rsv.
+ */
+static inline u32 _ist_jid(
+	tb_jrn *jrn,
+	tb_ist *ist
+)
+{
+	const u32 jid = _ist_fnd(jrn, ist);
+	if (jid) return jid - 1;
+
+	/* Define. */
+	const u32 nxt = jrn->ist_nbr;
+	tb_jrn_rec *rec = _rec_loc(jrn, TB_JRN_TYP_IST);
+	rec->cls = ist->cls;
+	rec->ist = nxt;
+	if (ist->cls == TB_IST_CLS_SHR) {
+		_str_cpy(rec->def.mkp, tb_mkp_sym(ist->shr.mkp));
+		_str_cpy(rec->def.sym, tb_sym_str(ist->shr.sym));
+	} else {
+		_str_cpy(rec->def.mkp, tb_mkp_sym(ist->ccy.mkp));
+		_str_cpy(rec->def.sym, tb_ccy_sym(ist->ccy.ccy));
+	}
+	_rec_don(jrn);
+	_ist_map(jrn, ist, nxt);
+	return nxt;
+
+}
+
+/*
+ * Resolve the instrument defined by @rec in @jrn.
+ * If @rec is invalid or if its marketplace or its
+ * currency is unknown, return 1.
+ */
+static inline uerr _ist_lod(
+	tb_jrn *jrn,
+	const tb_jrn_rec *rec
+)
+{
+	if (rec->ist != jrn->ist_nbr) return 1;
+	if (rec->def.mkp[TB_JRN_STR_SIZ - 1] || rec->def.sym[TB_JRN_STR_SIZ - 1]) return 1;
+	tb_mkp *mkp = tb_mkp_sch(rec->def.mkp);
+	if (!mkp) return 1;
+	tb_ist *ist;
+	if (rec->cls == TB_IST_CLS_SHR) {
+		ist = tb_ist_ctr_shr(mkp, rec->def.sym);
+	} else if (rec->cls == TB_IST_CLS_CCY) {
+		tb_ccy *ccy = tb_ccy_sch(rec->def.sym);
+		if (!ccy) return 1;
+		ist = tb_ist_ctr_ccy(mkp, ccy);
+	} else {
+		return 1;
+	}
+	_ist_map(jrn, ist, rec->ist);
+	return 0;
+}
+
+/*
+ * Save at @dst the descriptor of the order of request
+ * index @req of @jrn, in the state recorded at index
+ * @upd.
+ */
+static inline void _ord_lod(
+	tb_jrn *jrn,
+	u64 req,
+	u64 upd,
+	tb_ord *dst
+)
+{
+	const tb_jrn_rec *rec = jrn->recs + req;
+	check(rec->typ == TB_JRN_TYP_REQ);
+	tb_ord_ctr(
+		dst,
+		jrn->ists[rec->ist],
+		jrn->ists[rec->req.sec],
+		rec->ord_typ,
+		rec->req.vol,
+		rec->req.lim,
+		rec->req.stp,
+		rec->req.id,
+		rec->sts
+	);
+	if (upd == req) return;
+	rec = jrn->recs + upd;
+	check(rec->upd.req == req);
+	dst->id = rec->upd.id;
+	dst->sts = rec->sts;
+	dst->rsp_vol_prm = rec->upd.vol_prm;
+	dst->rsp_vol_sec = rec->upd.vol_sec;
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Open the journal at @pth, create it with a capacity of
+ * @rec_max records if it does not exist, take its write
+ * privileges and return it.
+ * If a live process has them or if a recorded instrument
+ * is invalid or cannot be resolved, return 0.
+ */
+tb_jrn *tb_jrn_ctr(
+	const char *pth,
+	u64 rec_max
+)
+{
+
+	/* Open. */
+	tb_sgm *sgm = tb_sgm_fopn(
+		1,
+		_jrn_imp,
+		sizeof(_jrn_imp),
+		0,
+		0,
+		1,
+		rec_max,
+		(u8 []) {sizeof(tb_jrn_rec)},
+		"%s", pth
+	);
+	assert(sgm, "journal %s open failed.\n", pth);
+	u64 off = 0;
+	if (tb_sgm_wrt_rcv(sgm, &off)) {
+		tb_sgm_cls(sgm);
+		return 0;
+	}
+
+	/* Construct. */
+	nh_all__(tb_jrn, jrn);
+	jrn->sgm = sgm;
+	jrn->recs = tb_sgm_arr_stt(sgm, 0);
+	jrn->ist_nbr = 0;
+	jrn->jid_max = 0;
+	jrn->jids = 0;
+	jrn->ist_max = 0;
+	jrn->ists = 0;
+
+	/* Resolve recorded instruments. */
+	const u64 rec_nbr = tb_jrn_rec_nbr(jrn);
+	for (u64 idx = 0; idx < rec_nbr; idx++) {
+		const tb_jrn_rec *rec = jrn->recs + idx;
+		if ((rec->typ == TB_JRN_TYP_IST) && _ist_lod(jrn, rec)) {
+			tb_jrn_dtr(jrn);
+			return 0;
+		}
+	}
+	return jrn;
+
+}
+
+/*
+ * Release @jrn's write privileges and close it.
+ */
+void tb_jrn_dtr(
+	tb_jrn *jrn
+)
+{
+	tb_sgm_wrt_cpl(jrn->sgm);
+	tb_sgm_cls(jrn->sgm);
+	if (jrn->jid_max) nh_fre(jrn->jids, sizeof(u32) * jrn->jid_max);
+	if (jrn->ist_max) nh_fre(jrn->ists, sizeof(tb_ist *) * jrn->ist_max);
+	nh_fre_(jrn);
+}
+
+/*
+ * Record the request of @ord and save at @req the index
+ * of its record, identifying the order in the journal.
+ * If @jrn is full, record nothing and return 1.
+ */
+uerr tb_jrn_req(
+	tb_jrn *jrn,
+	const tb_ord *ord,
+	u64 *req
+)
+{
+	if (_rec_rsv(jrn, ord->prm, ord->sec)) return 1;
+	const u32 prm = _ist_jid(jrn, ord->prm);
+	const u32 sec = _ist_jid(jrn, ord->sec);
+	tb_jrn_rec *rec = _rec_loc(jrn, TB_JRN_TYP_REQ);
+	rec->ord_typ = ord->typ;
+	rec->sts = ord->sts;
+	rec->ist = prm;
+	rec->req.sec = sec;
+	rec->req.id = ord->id;
+	rec->req.vol = ord->req_vol_prm;
+	rec->req.lim = ord->req_prc_lim;
+	rec->req.stp = ord->req_prc_stp;
+	*req = _rec_don(jrn);
+	return 0;
+}
+
+/*
+ * Record the event of type @typ of the order of request
+ * index @req, whose state is now @ord.
+ * If @jrn is full, record nothing and return 1.
+ */
+uerr tb_jrn_upd(
+	tb_jrn *jrn,
+	u8 typ,
+	u64 req,
+	const tb_ord *ord
+)
+{
+	check((TB_JRN_TYP_ACK <= typ) && (typ <= TB_JRN_TYP_CPL));
+	check(jrn->recs[req].typ == TB_JRN_TYP_REQ);
+	if (_rec_rsv(jrn, jrn->ists[jrn->recs[req].ist], 0)) return 1;
+	tb_jrn_rec *rec = _rec_loc(jrn, typ);
+	rec->ord_typ = ord->typ;
+	rec->sts = ord->sts;
+	rec->ist = jrn->recs[req].ist;
+	rec->upd.req = req;
+	rec->upd.id = ord->id;
+	rec->upd.vol_prm = ord->rsp_vol_prm;
+	rec->upd.vol_sec = ord->rsp_vol_sec;
+	_rec_don(jrn);
+	return 0;
+}
+
+/*
+ * Record the addition of @amt of @ist to the wallet.
+ * If @jrn is full, record nothing and return 1.
+ */
+uerr tb_jrn_mov(
+	tb_jrn *jrn,
+	tb_ist *ist,
+	f64 amt
+)
+{
+	if (_rec_rsv(jrn, ist, 0)) return 1;
+	const u32 jid = _ist_jid(jrn, ist);
+	tb_jrn_rec *rec = _rec_loc(jrn, TB_JRN_TYP_MOV);
+	rec->cls = ist->cls;
+	rec->ist = jid;
+	rec->mov.amt = amt;
+	_rec_don(jrn);
+	return 0;
+}
+
+/*
+ * Replay @jrn into @wlt : apply movements, take the
+ * resources of requested orders, and collect those of
+ * cancelled and complete orders.
+ * Then call @opn_fnc with each order that is still
+ * open, in its last recorded state, and its request
+ * index.
+ * If a record is invalid, references an unknown
+ * instrument or updates a settled order, or if a
+ * reservation or a collection fails, return 1.
+ */
+uerr tb_jrn_rpl(
+	tb_jrn *jrn,
+	tb_wlt *wlt,
+	void (*opn_fnc)(
+		u64 req,
+		const tb_ord *ord,
+		void *arg
+	),
+	void *arg
+)
+{
+	const u64 rec_nbr = tb_jrn_rec_nbr(jrn);
+	uerr err = 0;
+
+	/* Index of the last record of each request. */
+	u64 *lsts = nh_all(sizeof(u64) * (rec_nbr + 1));
+
+	/* Number of instruments defined so far. */
+	u32 ist_nbr = 0;
+
+	/* Apply. */
+	tb_ord ord;
+	for (u64 idx = 0; idx < rec_nbr; idx++) {
+		const tb_jrn_rec *rec = jrn->recs + idx;
+		const u8 typ = rec->typ;
+		if (typ >= TB_JRN_TYP_NB) {
+			err = 1;
+			goto end;
+		}
+		if (typ == TB_JRN_TYP_IST) {
+			ist_nbr++;
+		} else if (typ == TB_JRN_TYP_MOV) {
+			if (rec->ist >= ist_nbr) {
+				err = 1;
+				goto end;
+			}
+			tb_wlt_sim_add(wlt, jrn->ists[rec->ist], rec->mov.amt);
+		} else if (typ == TB_JRN_TYP_REQ) {
+			if ((rec->ist >= ist_nbr) || (rec->req.sec >= ist_nbr)) {
+				err = 1;
+				goto end;
+			}
+			lsts[idx] = idx;
+			_ord_lod(jrn, idx, idx, &ord);
+			if (tb_wlt_ord_res_tak(wlt, &ord)) {
+				err = 1;
+				goto end;
+			}
+		} else {
+			const u64 req = rec->upd.req;
+			if ((req >= idx) || (jrn->recs[req].typ != TB_JRN_TYP_REQ) || (rec->ist != jrn->recs[req].ist)) {
+				err = 1;
+				goto end;
+			}
+			const u8 lst = jrn->recs[lsts[req]].typ;
+			if ((lst == TB_JRN_TYP_CCL) || (lst == TB_JRN_TYP_CPL)) {
+				err = 1;
+				goto end;
+			}
+			lsts[req] = idx;
+			if ((typ == TB_JRN_TYP_CCL) || (typ == TB_JRN_TYP_CPL)) {
+				_ord_lod(jrn, req, idx, &ord);
+				if (tb_wlt_ord_res_col(wlt, &ord)) {
+					err = 1;
+					goto end;
+				}
+			}
+		}
+	}
+
+	/* Report open orders. */
+	for (u64 idx = 0; idx < rec_nbr; idx++) {
+		if (jrn->recs[idx].typ != TB_JRN_TYP_REQ) continue;
+		const u8 lst = jrn->recs[lsts[idx]].typ;
+		if ((lst == TB_JRN_TYP_CCL) || (lst == TB_JRN_TYP_CPL)) continue;
+		_ord_lod(jrn, idx, lsts[idx], &ord);
+		if (opn_fnc) (*opn_fnc)(idx, &ord, arg);
+	}
+
+	end:;
+	nh_fre(lsts, sizeof(u64) * (rec_nbr + 1));
+	return err;
+
+}
@@ -32,15 +32,14 @@ static inline u64 _bst_ask_val(
 
 /*
  * Get the heatmap end time corresponding to
- * @tim_cur.
+ * @tim_cur at resolution @res.
  */
 static inline u64 _to_hmp_end_tim(
-	tb_lv1_hst *hst,
+	u64 res,
 	u64 tim_cur
 )
 {
 	/* Round up to the resolution. */
-	const u64 res = hst->tim_res;
 	tim_cur += (res - 1);
 	return tim_cur - (tim_cur % res);
 }
@@ -432,16 +431,16 @@ static inline void _hst_bac_mov(
  ***********/
 
 /*
- * Print the heatmap.
+ * Print @viw's heatmap.
  */
 static inline void _hmp_log(
-	tb_lv1_hst *hst
+	tb_lv1_viw *viw
 )
 {
-	for (u64 tck_idx = hst->hmp_dim_tck; tck_idx--;) {
-		debug("%U (%U) : ", tck_idx, hst->hmp_tck_min + tck_idx);
-		for (u64 tim_idx = 0; tim_idx < hst->hmp_dim_tim; tim_idx++) {
-			debug("%.3d ", hst->hmp[tim_idx * hst->hmp_dim_tck + tck_idx]);
+	for (u64 tck_idx = viw->hmp_dim_tck; tck_idx--;) {
+		debug("%U (%U) : ", tck_idx, viw->hmp_tck_min + tck_idx * viw->tck_agg);
+		for (u64 tim_idx = 0; tim_idx < viw->hmp_dim_tim; tim_idx++) {
+			debug("%.3d ", tb_lv1_fmt_get(viw->hmp_fmt, viw->hmp, tim_idx * viw->hmp_dim_tck + tck_idx));
 		}
 		debug("\n");
 	}
@@ -449,12 +448,63 @@ static inline void _hmp_log(
 }
 
 /*
- * Move the heatmap.
+ * Store the scaled value @val in the @idx-th cell of
+ * @viw's heatmap.
+ */
+static inline void _hmp_cel_put(
+	tb_lv1_viw *viw,
+	u64 idx,
+	f64 val
+)
+{
+	switch (viw->hmp_fmt & ~TB_LV1_FMT_LOG) {
+		case TB_LV1_FMT_F64: ((f64 *) viw->hmp)[idx] = val; break;
+		case TB_LV1_FMT_F32: ((f32 *) viw->hmp)[idx] = (f32) val; break;
+		case TB_LV1_FMT_U16: ((u16 *) viw->hmp)[idx] = (u16) ((val + 1) * (65535. / 2) + 0.5); break;
+		case TB_LV1_FMT_U8: ((u8 *) viw->hmp)[idx] = (u8) ((val + 1) * (255. / 2) + 0.5); break;
+	}
+}
+
+/*
+ * Convert @vol in @viw's format and store it in the
+ * @idx-th cell of its heatmap.
+ */
+static inline void _hmp_cel_set(
+	tb_lv1_viw *viw,
+	u64 idx,
+	f64 vol
+) {_hmp_cel_put(viw, idx, tb_lv1_fmt_val(viw->hmp_fmt, viw->hmp_scl, vol));}
+
+/*
+ * Set the @wrt_nb last cells of the heatmap row at
+ * index @row_id of @viw to @vol.
+ * The conversion is made once for the whole row.
+ */
+static inline void _hmp_row_set(
+	tb_lv1_viw *viw,
+	u64 row_id,
+	u64 wrt_nb,
+	f64 vol
+)
+{
+	const u64 dim_tim = viw->hmp_dim_tim;
+	const u64 dim_tck = viw->hmp_dim_tck;
+	const f64 val = tb_lv1_fmt_val(viw->hmp_fmt, viw->hmp_scl, vol);
+	for (u64 col_id = dim_tim; (col_id--) && wrt_nb--;) {
+		_hmp_cel_put(viw, col_id * dim_tck + row_id, val);
+	}
+}
+
+/*
+ * Move the heatmap @src in @viw's heatmap.
  * Caused by a re-anchor during generation.
+ * @src may be @viw's heatmap.
+ * @shf_tck is expressed in rows.
  * @shf_tck > 0 -> move data down.
  */
 static inline void _hst_hmp_mov(
-	tb_lv1_hst *hst,
+	tb_lv1_viw *viw,
+	const void *src_hmp,
 	u64 shf_tim,
 	s64 shf_tck
 )
@@ -464,8 +514,9 @@ static inline void _hst_hmp_mov(
 	/* If shift of more than the dimensions,
 	 * no data should be reused. */ 
 	const u8 mov_dwn = (shf_tck >= 0);
-	const u64 dim_tim = hst->hmp_dim_tim;
-	const u64 dim_tck = hst->hmp_dim_tck;
+	const u64 dim_tim = viw->hmp_dim_tim;
+	const u64 dim_tck = viw->hmp_dim_tck;
+	const u64 siz = tb_lv1_fmt_siz(viw->hmp_fmt);
 	const u64 shf_abs = mov_dwn ? (u64) shf_tck : (u64) -shf_tck;
 	if (
 		(shf_tim >= dim_tim) ||
@@ -475,13 +526,13 @@ static inline void _hst_hmp_mov(
 		/* In debug mode, fill with NANs.
 		 * Otherwise, just keep as is. */
 		#ifdef DEBUG
-		ns_mem_set(hst->hmp, 0xff, dim_tim * dim_tck * sizeof(f64));
+		ns_mem_set(viw->hmp, 0xff, dim_tim * dim_tck * siz);
 		#endif
 		return;
 	}
 
 	//debug("pre :\n");
-	//_hmp_log(hst);
+	//_hmp_log(viw);
 
 	debug("shf %U %I.\n", shf_tim, shf_tck);
 	#if 0
@@ -489,39 +540,49 @@ static inline void _hst_hmp_mov(
 	check((s64) shf_tim * (s64) dim_tck >= (s64) -shf_tck);
 	const u64 cpy_off = shf_tim * dim_tck + (u64) shf_tck;
 	debug("off %U %U.\n", cpy_off, dim_tim * dim_tck - cpy_off);
-	ns_mem_cpy(hst->hmp, hst->hmp + cpy_off, (dim_tim * dim_tck - cpy_off) * sizeof(f64));
+	ns_mem_cpy(viw->hmp, (const u8 *) src_hmp + cpy_off * siz, (dim_tim * dim_tck - cpy_off) * siz);
 
 	#else
 	/* More fine-grained copy : iterate over
 	 * each column and copy just what is needed in this column. */
-	f64 *dst = hst->hmp + (mov_dwn ? 0 : -shf_tck);
-	f64 *src = hst->hmp + shf_tim * dim_tck + (mov_dwn ? shf_tck : 0);
-	const u64 len = sizeof(f64) * (dim_tck - shf_abs);
+	u8 *dst = (u8 *) viw->hmp + (mov_dwn ? 0 : shf_abs) * siz;
+	const u8 *src = (const u8 *) src_hmp + (shf_tim * dim_tck + (mov_dwn ? shf_abs : 0)) * siz;
+	const u64 len = siz * (dim_tck - shf_abs);
+	const u64 stp = siz * dim_tck;
 	for (u64 col_id = 0; col_id < dim_tim - shf_tim; col_id++) {
 		ns_mem_cpy(dst, src, len);
-		dst += dim_tck;
-		src += dim_tck;
+		dst += stp;
+		src += stp;
 	}
 	#endif
 
 	//debug("post :\n");
-	//_hmp_log(hst);
+	//_hmp_log(viw);
 
 }
 
 /*
  * Write the @wrt_nb first cells of the heatmap row
- * at index @row_id of @hst.
+ * at index @row_id of @hst's view @viw.
  * If @tck is non-null, it contains the volume updates
  * that should be used to compute cell values.
  * Otherwise, we have no volume data, and cells must
  * be filled with 0s.
+ * If @acc is set, cell values are added to the
+ * ones of @viw's aggregation row, to aggregate several
+ * ticks in the same row.
+ * If @lst is set, @tck is the last tick of the row,
+ * and cells are converted and stored in the heatmap.
+ * Otherwise, they are stored in the aggregation row.
  */
 static inline void _hmp_wrt_row(
 	tb_lv1_hst *hst,
+	tb_lv1_viw *viw,
 	u64 row_id,
 	u64 wrt_nb,
-	tb_lv1_tck *tck
+	tb_lv1_tck *tck,
+	u8 acc,
+	u8 lst
 )
 {
 
@@ -530,8 +591,13 @@ static inline void _hmp_wrt_row(
 	 * Utils.
 	 */
 
-	/* Get heatmap location. */
-	#define HMP_LOC(col, row) hmp[(col) * dim_tck + (row)]
+	/* Write or aggregate a heatmap cell. */
+	#define HMP_WRT(col, row, val) ({ \
+		f64 __val = (val); \
+		if (acc) __val += agg[col]; \
+		if (lst) _hmp_cel_set(viw, (col) * dim_tck + (row), __val); \
+		else agg[col] = __val; \
+	})
 
 	/* Get the next update. */
 	#define _upd_nxt(upd) ({ \
@@ -545,9 +611,10 @@ static inline void _hmp_wrt_row(
 		(__prv == &tck->upds_tck) ? 0 : ns_cnt_of(__prv, tb_lv1_upd, upds_tck); \
 	})
 
-	/* Cache heatmap. */
-	f64 *hmp = hst->hmp;
-	const u64 dim_tck = hst->hmp_dim_tck;
+	/* Cache the aggregation row and dimensions. */
+	f64 *agg = viw->row;
+	check((agg) || (lst && !acc));
+	const u64 dim_tck = viw->hmp_dim_tck;
 
 	/* Cache current time. */
 	const u64 tim_cur = hst->tim_cur;
@@ -574,29 +641,29 @@ static inline void _hmp_wrt_row(
 	/* If no data, just write the current volume. */
 	if (!upd) {
 		//u64 wrt_cnt = 0;
-		for (u64 col_id = hst->hmp_dim_tim; (col_id--) && wrt_nb--;) {
+		for (u64 col_id = viw->hmp_dim_tim; (col_id--) && wrt_nb--;) {
 			//wrt_cnt++;
 			//debug("  rs %U %U %d.\n", row_id, col_id, vol_cur); 
-			HMP_LOC(col_id, row_id) = vol_cur;	
+			HMP_WRT(col_id, row_id, vol_cur);	
 		}
 		//debug("wrt_cnt %U.\n", wrt_cnt);
 		return;
 	}
 
 	/* Write all cells. */
-	const u64 tim_res = hst->tim_res;
-	check(!(hst->tim_hmp % tim_res)); 
-	check(!(hst->hmp_tim_spn % tim_res)); 
-	const u64 aid_hmp = (hst->tim_hmp - hst->hmp_tim_spn) / tim_res;  
+	const u64 tim_res = viw->tim_res;
+	check(!(viw->tim_hmp % tim_res)); 
+	check(!(viw->hmp_tim_spn % tim_res)); 
+	const u64 aid_hmp = (viw->tim_hmp - viw->hmp_tim_spn) / tim_res;  
 	//u64 wrt_cnt = 0;
-	for (u64 col_id = hst->hmp_dim_tim; (col_id--) && wrt_nb--;) {
+	for (u64 col_id = viw->hmp_dim_tim; (col_id--) && wrt_nb--;) {
 		check((upd) || (vol_stt == vol_cur));
 		//debug("col %U, [%U, %U[, cur %U.\n", col_id, tim_res * (aid_hmp + col_id), tim_res * (aid_hmp + col_id + 1), tim_cur);
 
 		/* If no update anymore, just write the start volume. */
 		if (!upd) {
 			//debug("  end %U %U %d.\n", row_id, col_id, vol_stt); 
-			HMP_LOC(col_id, row_id) = vol_stt;	
+			HMP_WRT(col_id, row_id, vol_stt);	
 			//wrt_cnt++;
 			continue;
 		}
@@ -619,7 +686,7 @@ static inline void _hmp_wrt_row(
 		 * just write the current volume. */
 		if (aid_upd < aid_col) {
 			//debug("  bef %U %U %d.\n", row_id, col_id, vol_stt); 
-			HMP_LOC(col_id, row_id) = vol_cur;	
+			HMP_WRT(col_id, row_id, vol_cur);	
 			//wrt_cnt++;
 			continue;
 		}
@@ -679,7 +746,7 @@ static inline void _hmp_wrt_row(
 		/* Compute the average. */
 		const f64 vol_avg = wgt_sum / (f64) tim_ttl;
 		//debug("  avg %U %U %d (%d / %U).\n", row_id, col_id, vol_avg, wgt_sum, tim_ttl); 
-		HMP_LOC(col_id, row_id) = vol_avg;	
+		HMP_WRT(col_id, row_id, vol_avg);	
 
 		//wrt_cnt++;
 
@@ -743,14 +810,41 @@ static inline tb_lv1_tck *_tck_get(
 }
 
 /*
- * Return the tick reference at the current time.
+ * Return the tick preceding @tck, 0 if none.
+ */
+static inline tb_lv1_tck *_tck_prv(
+	tb_lv1_tck *tck
+)
+{
+	ns_mapn_u64 *prv = ns_map_u64_fn_inr(&tck->tcks);
+	return (prv) ? ns_cnt_of(prv, tb_lv1_tck, tcks) : 0;
+}
+
+/*
+ * Return 1 if @tck's volume did not change after
+ * @tim (>), i.e. if its last processed update is at
+ * or before @tim.
+ */
+static inline u8 _tck_idl(
+	tb_lv1_tck *tck,
+	u64 tim
+)
+{
+	tb_lv1_upd *upd;
+	if (ns_dls_emptype(&tck->upds_tck, upd, tb_lv1_upd, upds_tck)) return 1;
+	return upd->tim <= tim;
+}
+
+/*
+ * Return @viw's tick reference at the current time.
  * If both best bid and ask exist, use the average.
  * If only a best bid or ask exists, use it.
  * If the orderbook is currently empty, use the
  * previous reference.
  */
 static inline u64 _tck_ref_cpt(
-	tb_lv1_hst *hst
+	tb_lv1_hst *hst,
+	tb_lv1_viw *viw
 )
 {
 
@@ -762,16 +856,18 @@ static inline u64 _tck_ref_cpt(
 	const u64 bst_bid = _bst_bid_val(bid);
 	const u64 bst_ask = _bst_ask_val(ask);
 
-	/* Get the anchor. */
-	const u64 tck_ref = tb_obk_anc(
+	/* Get the anchor, aligned on a row boundary. */
+	const u64 tck_agg = viw->tck_agg;
+	u64 tck_ref = tb_obk_anc(
 		bst_bid,
 		bst_ask,
-		hst->tck_ref, 
-		hst->hmp_dim_tck
+		viw->tck_ref, 
+		viw->hmp_dim_tck * tck_agg
 	);
+	tck_ref -= tck_ref % tck_agg;
 
 	/* Check integrity and complete. */
-	assert(tck_ref >= (hst->hmp_dim_tck >> 1));
+	assert(tck_ref >= (viw->hmp_dim_tck >> 1) * tck_agg);
 	return tck_ref;
 }
 
@@ -839,6 +935,275 @@ static inline void _upd_dtr(
 
 }
 
+/******************
+ * View internals *
+ ******************/
+
+/*
+ * Allocate @viw's heatmap buffers in [@buf_stt, @buf_end[.
+ */
+static inline void _viw_buf_all(
+	tb_lv1_viw *viw,
+	u8 buf_stt,
+	u8 buf_end
+)
+{
+	const u64 siz = tb_lv1_fmt_siz(viw->hmp_fmt) * viw->hmp_dim_tim * viw->hmp_dim_tck;
+	for (u8 buf_id = buf_stt; buf_id < buf_end; buf_id++) {
+		viw->hmps[buf_id] = nh_all(siz);
+	}
+}
+
+/*
+ * Initialize @viw with @buf_nbr heatmap buffers.
+ */
+static inline void _viw_ini(
+	tb_lv1_viw *viw,
+	u8 buf_nbr,
+	u64 tim_res,
+	u64 hmp_dim_tim,
+	u64 hmp_dim_tck,
+	u64 tck_agg,
+	u8 hmp_fmt,
+	f64 hmp_scl
+)
+{
+	assert(tim_res);
+	assert(hmp_dim_tim);
+	assert(hmp_dim_tck);
+	assert(!(hmp_dim_tck & 1));
+	assert(tck_agg);
+
+	/* Save dimensions. */
+	viw->tim_res = tim_res;
+	viw->hmp_dim_tim = hmp_dim_tim;
+	viw->hmp_dim_tck = hmp_dim_tck;
+	viw->tck_agg = tck_agg;
+	viw->hmp_tim_spn = hmp_dim_tim * tim_res;
+
+	/* Save the format. */
+	viw->hmp_fmt = hmp_fmt;
+	viw->hmp_scl = hmp_scl;
+
+	/* Reset times. */
+	viw->tim_hmp = 0;
+	viw->tim_rnc = 0;
+
+	/* Start with a heatmap lower-anchored at 0. */
+	viw->tck_ref = (hmp_dim_tck >> 1) * tck_agg;
+
+	/* Trigger a full heatmap generation next time. */
+	viw->hmp_tck_min = 0;
+	viw->hmp_tck_max = 0;
+
+	/* No re-anchoring. Will be set at first prp call. */
+	viw->hmp_shf_tim = 0;
+
+	/* Allocate heatmaps, and the aggregation row if needed. */
+	_viw_buf_all(viw, 0, buf_nbr);
+	viw->hmp = viw->hmps[0];
+	viw->row = (tck_agg == 1) ? 0 : nh_all(sizeof(f64) * hmp_dim_tim);
+
+}
+
+/*
+ * Free @viw's @buf_nbr heatmap buffers and arrays.
+ */
+static inline void _viw_fin(
+	tb_lv1_viw *viw,
+	u8 buf_nbr
+)
+{
+	const u64 siz = tb_lv1_fmt_siz(viw->hmp_fmt) * viw->hmp_dim_tim * viw->hmp_dim_tck;
+	for (u8 buf_id = 0; buf_id < buf_nbr; buf_id++) {
+		nh_fre(viw->hmps[buf_id], siz);
+	}
+	if (viw->row) nh_fre(viw->row, sizeof(f64) * viw->hmp_dim_tim);
+}
+
+/*
+ * Return the start time of the earliest of @hst's
+ * heatmaps.
+ */
+static inline u64 _hst_hmp_stt(
+	tb_lv1_hst *hst
+)
+{
+	u64 hmp_stt = (u64) -1;
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		tb_lv1_viw *viw = hst->viws + viw_id;
+		assert(viw->tim_hmp > viw->hmp_tim_spn);
+		const u64 viw_stt = viw->tim_hmp - viw->hmp_tim_spn;
+		if (viw_stt < hmp_stt) hmp_stt = viw_stt;
+	}
+	return hmp_stt;
+}
+
+/*
+ * Compute the new tick reference of all views of @hst
+ * whose re-anchor time is before (<=) @tim, store it
+ * in @tck_refs, and reset their re-anchor time in
+ * @rnc_tims.
+ * Return the first remaining re-anchor time.
+ */
+static inline u64 _viw_rnc_cpt(
+	tb_lv1_hst *hst,
+	u64 *rnc_tims,
+	u64 *tck_refs,
+	u64 tim
+)
+{
+	u64 rnc_min = (u64) -1;
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		if ((rnc_tims[viw_id] != (u64) -1) && (rnc_tims[viw_id] <= tim)) {
+			tck_refs[viw_id] = _tck_ref_cpt(hst, hst->viws + viw_id);
+			rnc_tims[viw_id] = (u64) -1;
+		}
+		if (rnc_tims[viw_id] < rnc_min) rnc_min = rnc_tims[viw_id];
+	}
+	return rnc_min;
+}
+
+/*
+ * Re-anchor @viw at @tck_ref_new if required, and
+ * update its heatmap in its buffer @buf_id from the
+ * previously generated one.
+ */
+static inline void _viw_prc(
+	tb_lv1_hst *hst,
+	tb_lv1_viw *viw,
+	u64 tck_ref_new,
+	u8 buf_id
+)
+{
+
+	/* Switch to the back buffer. */
+	const void *src_hmp = viw->hmp;
+	viw->hmp = viw->hmps[buf_id];
+
+	/* Cache the previous heatmap price range. */
+	const u64 hmp_tck_prv_min = viw->hmp_tck_min; 
+	const u64 hmp_tck_prv_max = viw->hmp_tck_max; 
+	const u64 tck_agg = viw->tck_agg;
+	const u64 hmp_tck_hln = (viw->hmp_dim_tck >> 1) * tck_agg;
+	u64 hmp_tck_cur_min = hmp_tck_prv_min; 
+	u64 hmp_tck_cur_max = hmp_tck_prv_max; 
+
+	/* Minimal number of columns to write. */
+	const u64 hmp_shf_tim = viw->hmp_shf_tim;
+	const u64 wrt_min = hmp_shf_tim + 1;
+
+	/* Re-anchor if needed. */
+	if (hmp_shf_tim) {
+
+		/* New tick ref should have been computed. */
+		assert(tck_ref_new != (u64) -1);
+
+		/* Determine the new reference price. */
+		const u64 tck_ref_cur = viw->tck_ref;
+		check(tck_ref_cur >= hmp_tck_hln);
+		check(tck_ref_new >= hmp_tck_hln);
+		check(!(tck_ref_new % tck_agg));
+
+		/* Update references and current heatmap range. */
+		viw->tck_ref = tck_ref_new; 
+		viw->hmp_shf_tim = 0;
+		viw->tim_rnc = viw->tim_hmp - viw->tim_res;
+		viw->hmp_tck_min = hmp_tck_cur_min = tck_ref_new - hmp_tck_hln;
+		viw->hmp_tck_max = hmp_tck_cur_max = tck_ref_new + hmp_tck_hln;
+
+		tb_lv1_log("rnc : %U -> %U,%U,%U.\n", tck_ref_cur, tck_ref_new, viw->hmp_tck_min, viw->hmp_tck_max);
+		tb_stt_evt(TB_STT_EVT_LV1_RNC, 1);
+
+		/* Move heatmap data, by a number of rows. */
+		const s64 hmp_shf_tck = ((s64) tck_ref_new - (s64) tck_ref_cur) / (s64) tck_agg;
+		_hst_hmp_mov(viw, src_hmp, hmp_shf_tim, hmp_shf_tck);
+
+	} else if (src_hmp != viw->hmp) {
+
+		/* Start from the previous heatmap. */
+		ns_mem_cpy(viw->hmp, src_hmp, tb_lv1_fmt_siz(viw->hmp_fmt) * viw->hmp_dim_tim * viw->hmp_dim_tck);
+
+	}
+	check(viw->hmp_tck_max == viw->hmp_tck_min + viw->hmp_dim_tck * tck_agg);
+
+	/* Iterate over all ticks (decreasing order). */
+	tb_lv1_tck *tck = ns_map_sch_gs(&hst->tcks, hmp_tck_cur_max, u64, tb_lv1_tck, tcks); 
+	check(hmp_tck_cur_max - hmp_tck_cur_min == viw->hmp_dim_tck * tck_agg);
+	const u64 hmp_dim_tim = viw->hmp_dim_tim;
+	const u64 tim_res = viw->tim_res;
+	const u64 tim_hmp = viw->tim_hmp;
+	for (u64 row_id = viw->hmp_dim_tck; row_id--;) {
+		const u64 tck_val = hmp_tck_cur_min + row_id * tck_agg;
+		check(tck_val < hmp_tck_cur_max);
+		check((!tck) || tck->tcks.val < tck_val + tck_agg); 
+
+		/* Determine the number of heatmap cells to fill in this row.
+		 * Ranges are aligned on rows, so the row is either
+		 * entirely in the previous range or not at all. */
+		const u8 wrt_ful = !((hmp_tck_prv_min <= tck_val) && (tck_val < hmp_tck_prv_max));  
+		const u64 wrt_nbr = wrt_ful ? hmp_dim_tim : wrt_min;
+
+		/* Determine if the volume of all ticks of this row
+		 * is constant over the cells to write, and their
+		 * total volume. Rows without ticks are idle. */
+		const u64 idl_tim = tim_hmp - ((wrt_nbr < hmp_dim_tim) ? wrt_nbr : hmp_dim_tim) * tim_res;
+		u8 idl = 1;
+		f64 idl_vol = 0;
+		for (tb_lv1_tck *cur = tck; idl && cur && (cur->tcks.val >= tck_val); cur = _tck_prv(cur)) {
+			idl = _tck_idl(cur, idl_tim);
+			idl_vol += cur->vol_cur;
+		}
+
+		/* If idle, cells have the total volume.
+		 * If the row was already generated and no time
+		 * shift happened, its last cell already has it. */
+		if (idl) {
+			if (wrt_ful || hmp_shf_tim) _hmp_row_set(viw, row_id, wrt_nbr, idl_vol);
+			tb_stt_evt(TB_STT_EVT_LV1_IDL, 1);
+			while (tck && (tck->tcks.val >= tck_val)) tck = _tck_prv(tck);
+			continue;
+		}
+
+		/* Otherwise, aggregate the cells of all ticks of
+		 * this row. */
+		u8 acc = 0;
+		while (tck && (tck->tcks.val >= tck_val)) {
+			tb_lv1_tck *nxt = _tck_prv(tck);
+			const u8 lst = (!nxt) || (nxt->tcks.val < tck_val);
+			_hmp_wrt_row(hst, viw, row_id, wrt_nbr, tck, acc, lst); 
+			acc = 1;
+			tck = nxt;
+		}
+		check(acc);
+		tb_stt_evt(TB_STT_EVT_LV1_ROW, 1);
+
+	}
+
+	//debug("Res : \n");
+	//_hmp_log(viw);
+
+}
+
+/***************
+ * Publication *
+ ***************/
+
+/*
+ * Start the generation of the next epoch of @hst if
+ * not done yet.
+ * Must precede any write to a buffer that may be
+ * published, including curves, which are published in
+ * place when there is a single buffer.
+ */
+static inline void _pub_stt(
+	tb_lv1_hst *hst
+)
+{
+	const u64 epc = hst->pub_epc + 1;
+	if (hst->pub_wrt != epc) ns_atm(a64, xch, aar, &hst->pub_wrt, epc);
+}
+
 /*******
  * API *
  *******/
@@ -847,18 +1212,18 @@ static inline void _upd_dtr(
  * Construct and return an empty history with a
  * current time of 0.
  * If @bac is set, generate the bid-ask curve.
+ * The primary heatmap uses the cell format @hmp_fmt
+ * and the volume scale @hmp_scl.
  */
 tb_lv1_hst *tb_lv1_ctr(
 	u64 tim_res,
 	u64 hmp_dim_tim,
 	u64 hmp_dim_tck,
-	u64 bac_nb
+	u64 bac_nb,
+	u8 hmp_fmt,
+	f64 hmp_scl
 )
 {
-	assert(tim_res);
-	assert(hmp_dim_tim);
-	assert(hmp_dim_tck);
-	assert(!(hmp_dim_tck & 1));
 
 	/* Allocate. */
 	nh_all__(tb_lv1_hst, hst);
@@ -870,15 +1235,11 @@ tb_lv1_hst *tb_lv1_ctr(
 
 	/* Save dimenstions. */
 	hst->tim_res = tim_res;
-	hst->hmp_dim_tim = hmp_dim_tim;
-	hst->hmp_dim_tck = hmp_dim_tck;
 	hst->bac_nb = bac_nb;
-	hst->hmp_tim_spn = (hmp_dim_tim) * tim_res;
 	hst->bac_tim_spn = bac_nb * tim_res;
 
 	/* Reset times. */
 	hst->tim_cur = 0;
-	hst->tim_rnc = 0;
 	hst->tim_hmp = 0;
 	hst->tim_max = 0;
 	hst->tim_end = 0;
@@ -888,13 +1249,6 @@ tb_lv1_hst *tb_lv1_ctr(
 	hst->bst_cur_bid = 0;
 	hst->bst_cur_ask = 0;
 
-	/* Start with a heatmap lower-anchored at 0. */
-	hst->tck_ref = hmp_dim_tck >> 1;
-
-	/* Trigger a full heatmap generation next time. */
-	hst->hmp_tck_min = 0;
-	hst->hmp_tck_max = 0;
-
 	/* Reset bad metadata. */
 	hst->bst_max_bid = 0;
 	hst->bst_max_ask = 0;
@@ -902,11 +1256,20 @@ tb_lv1_hst *tb_lv1_ctr(
 	hst->bid_aid = 0;
 	hst->ask_aid = 0;
 
-	/* No re-anchoring. Will be set at first prp call. */
-	hst->hmp_shf_tim = 0;
+	/* Nothing published, single buffer. */
+	hst->buf_nbr = 1;
+	hst->pub_epc = 0;
+	hst->pub_wrt = 0;
+	for (u8 buf_id = 0; buf_id < TB_LV1_BUF_MAX; buf_id++) {
+		hst->pub_bids[buf_id] = 0;
+		hst->pub_asks[buf_id] = 0;
+	}
+
+	/* Create the primary view. */
+	hst->viw_nbr = 1;
+	_viw_ini(hst->viws, 1, tim_res, hmp_dim_tim, hmp_dim_tck, 1, hmp_fmt, hmp_scl);
 	
 	/* Allocate arrays. */
-	hst->hmp = nh_all(sizeof(f64) * hmp_dim_tim * hmp_dim_tck);
 	hst->bid_crv = bac_nb ? nh_all(sizeof(u64) * bac_nb) : 0;
 	hst->ask_crv = bac_nb ? nh_all(sizeof(u64) * bac_nb) : 0;
 
@@ -915,6 +1278,61 @@ tb_lv1_hst *tb_lv1_ctr(
 
 }
 
+/*
+ * Add a view to @hst and return its index.
+ * Each row of its heatmap aggregates @tck_agg ticks.
+ * Its heatmap uses the cell format @hmp_fmt and the
+ * volume scale @hmp_scl.
+ * Must be called before the first preparation.
+ */
+u8 tb_lv1_viw_add(
+	tb_lv1_hst *hst,
+	u64 tim_res,
+	u64 hmp_dim_tim,
+	u64 hmp_dim_tck,
+	u64 tck_agg,
+	u8 hmp_fmt,
+	f64 hmp_scl
+)
+{
+	assert(!hst->tim_cur, "views must be added before the first preparation.\n");
+	assert(hst->viw_nbr < TB_LV1_VIW_MAX, "too many views.\n");
+	const u8 viw_id = hst->viw_nbr++;
+	_viw_ini(hst->viws + viw_id, hst->buf_nbr, tim_res, hmp_dim_tim, hmp_dim_tck, tck_agg, hmp_fmt, hmp_scl);
+	return viw_id;
+}
+
+/*
+ * Use @buf_nbr buffers to publish @hst's heatmaps
+ * and curves.
+ * Must be called before the first preparation.
+ */
+void tb_lv1_buf_set(
+	tb_lv1_hst *hst,
+	u8 buf_nbr
+)
+{
+	assert(!hst->tim_cur, "buffers must be set before the first preparation.\n");
+	assert(hst->buf_nbr == 1, "buffers already set.\n");
+	assert(buf_nbr && (buf_nbr <= TB_LV1_BUF_MAX), "invalid number of buffers %u.\n", buf_nbr);
+	if (buf_nbr == 1) return;
+
+	/* Allocate heatmap buffers of existing views. */
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		_viw_buf_all(hst->viws + viw_id, 1, buf_nbr);
+	}
+
+	/* Allocate published curves. */
+	if (hst->bac_nb) {
+		for (u8 buf_id = 0; buf_id < buf_nbr; buf_id++) {
+			hst->pub_bids[buf_id] = nh_all(sizeof(u64) * hst->bac_nb);
+			hst->pub_asks[buf_id] = nh_all(sizeof(u64) * hst->bac_nb);
+		}
+	}
+	hst->buf_nbr = buf_nbr;
+
+}
+
 /*
  * Delete @hst.
  */
@@ -923,8 +1341,13 @@ void tb_lv1_dtr(
 )
 {
 
-	/* Prepare at time where all orders are out of heatmap. */
-	tb_lv1_prp(hst, hst->tim_end + hst->hmp_tim_spn);
+	/* Prepare at time where all orders are out of all heatmaps. */
+	u64 spn_max = 0;
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		const u64 spn = hst->viws[viw_id].hmp_tim_spn;
+		if (spn > spn_max) spn_max = spn;
+	}
+	tb_lv1_prp(hst, hst->tim_end + spn_max);
 	
 	/* Process. Will move all orders in tick lists. */
 	tb_lv1_prc(hst);
@@ -935,7 +1358,7 @@ void tb_lv1_dtr(
 
 	/* Delete all resting ticks. */
 	tb_lv1_tck *tck;
-	const u64 hmp_stt = hst->tim_hmp - hst->hmp_tim_spn;
+	const u64 hmp_stt = _hst_hmp_stt(hst);
 	ns_map_fe(tck, &hst->tcks, tcks, u64, in) {
 		assert(tck->tim_max <= hmp_stt);
 		assert(tck->vol_max != 0);
@@ -947,9 +1370,17 @@ void tb_lv1_dtr(
 	assert(ns_map_u64_emp(&hst->tcks));
 
 	/* Free. */
-	nh_fre(hst->hmp, sizeof(f64) * hst->hmp_dim_tim * hst->hmp_dim_tck);
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		_viw_fin(hst->viws + viw_id, hst->buf_nbr);
+	}
 	if (hst->bid_crv) nh_fre(hst->bid_crv, sizeof(u64) * hst->bac_nb);
 	if (hst->ask_crv) nh_fre(hst->ask_crv, sizeof(u64) * hst->bac_nb);
+	if ((hst->buf_nbr != 1) && hst->bac_nb) {
+		for (u8 buf_id = 0; buf_id < hst->buf_nbr; buf_id++) {
+			nh_fre(hst->pub_bids[buf_id], sizeof(u64) * hst->bac_nb);
+			nh_fre(hst->pub_asks[buf_id], sizeof(u64) * hst->bac_nb);
+		}
+	}
 	nh_fre_(hst);
 }
 
@@ -975,12 +1406,15 @@ void tb_lv1_prp(
 	/* If no time adjustment, nothing to do. */
 	if (tim_cur == hst->tim_cur) return;
 
+	/* Curves may move, start the next epoch. */
+	_pub_stt(hst);
+
 	/* Update the current time. */
 	hst->tim_cur = tim_cur;
 
-	/* Determine the new heatmap end time. */ 
+	/* Determine the new primary heatmap end time. */ 
 	const u64 tim_res = hst->tim_res;
-	const u64 tim_hmp_new = _to_hmp_end_tim(hst, tim_cur);
+	const u64 tim_hmp_new = _to_hmp_end_tim(tim_res, tim_cur);
 	const u64 tim_hmp_prv = hst->tim_hmp;
 	assert(!(tim_hmp_new % tim_res));
 	assert(!(tim_hmp_prv % tim_res));
@@ -996,24 +1430,40 @@ void tb_lv1_prp(
 	 */
 	check(!(tim_hmp_prv % tim_res));
 	check(!(tim_hmp_new % tim_res));
-	const u64 hmp_shf_tim = (tim_hmp_new - tim_hmp_prv) / tim_res;
-	if (hmp_shf_tim) {
-	
-		tb_lv1_log("prp : rnc : %U : %U -> %U.\n", hmp_shf_tim, hst->hmp_shf_tim, hst->hmp_shf_tim + hmp_shf_tim);
+	const u64 bac_shf_tim = (tim_hmp_new - tim_hmp_prv) / tim_res;
+	if (bac_shf_tim) {
 
 		/* Move the bid-ask curves. */
 		if (hst->bac_nb) { 
-			_hst_bac_mov(hst, hmp_shf_tim);
+			_hst_bac_mov(hst, bac_shf_tim);
 		}
 
-		/* Count re-anchoring. */
-		SAFE_ADD(hst->hmp_shf_tim, hmp_shf_tim);
-		
 		/* Update the heatmap end time. */
 		hst->tim_hmp = tim_hmp_new;
 
 	}
 
+	/* Report re-anchoring of each view. */
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		tb_lv1_viw *viw = hst->viws + viw_id;
+		const u64 viw_res = viw->tim_res;
+		const u64 viw_hmp_new = _to_hmp_end_tim(viw_res, tim_cur);
+		check(viw_hmp_new >= viw->tim_hmp);
+		const u64 hmp_shf_tim = (viw_hmp_new - viw->tim_hmp) / viw_res;
+		if (hmp_shf_tim) {
+	
+			tb_lv1_log("prp : rnc %u : %U : %U -> %U.\n", viw_id, hmp_shf_tim, viw->hmp_shf_tim, viw->hmp_shf_tim + hmp_shf_tim);
+
+			/* Count re-anchoring. */
+			SAFE_ADD(viw->hmp_shf_tim, hmp_shf_tim);
+		
+			/* Update the heatmap end time. */
+			viw->tim_hmp = viw_hmp_new;
+
+		}
+	}
+	check(hst->viws[0].tim_hmp == hst->tim_hmp);
+
 	/* Update the bid/ask end time. */
 	hst->tim_end = hst->tim_cur + hst->bac_tim_spn;
 
@@ -1040,6 +1490,8 @@ void tb_lv1_add(
 	const f64 *vols
 )
 {
+	tb_stt_fnc(TB_STT_FNC_LV1_ADD);
+	tb_stt_evt(TB_STT_EVT_LV1_UPD, upd_nb);
 	assert(upd_nb);
 
 	tb_lv1_log("add : %U%s.\n", upd_nb, (tims) ? "" : " : ini");
@@ -1047,6 +1499,9 @@ void tb_lv1_add(
 	/* Require a prepared history. */
 	assert((!hst->tim_cur) == (!tims));
 
+	/* Curves may change, start the next epoch. */
+	_pub_stt(hst);
+
 	/* Add all updates. */
 	const u8 ini = (!tims);
 	const u8 has_bac = !!hst->bac_nb;
@@ -1129,13 +1584,18 @@ void tb_lv1_prc(
 	tb_lv1_hst *hst
 )
 {
+	tb_stt_fnc(TB_STT_FNC_LV1_PRC);
 
-	tb_lv1_log("prc %U.\n", hst->hmp_shf_tim);
+	tb_lv1_log("prc %U.\n", hst->viws[0].hmp_shf_tim);
 
 	/* Require a prepared history. */
 	assert(hst->tim_cur);
 	assert(hst->tim_end);
 
+	/* Start the next epoch if preparation and
+	 * additions did not. */
+	_pub_stt(hst);
+
 	/* Propagate best bid / ask until last cells of
 	 * bid / ask curves. */ 
 	if (hst->bac_nb) {
@@ -1151,12 +1611,23 @@ void tb_lv1_prc(
 		hst->ask_aid = prp_aid;
 	}
 
-	/* Determine the re-anchor time. */
-	u64 tim_rnc = (u64) -1;
-	if (hst->hmp_shf_tim) {
-		tim_rnc = hst->tim_hmp - hst->tim_res;
-		assert(hst->tim_rnc < tim_rnc);
-		assert(tim_rnc < hst->tim_cur);
+	/* Determine the re-anchor time of each view,
+	 * and the first one. */
+	const u8 viw_nbr = hst->viw_nbr;
+	u64 rnc_tims[TB_LV1_VIW_MAX];
+	u64 tck_refs[TB_LV1_VIW_MAX];
+	u64 rnc_min = (u64) -1;
+	for (u8 viw_id = 0; viw_id < viw_nbr; viw_id++) {
+		tb_lv1_viw *viw = hst->viws + viw_id;
+		u64 tim_rnc = (u64) -1;
+		if (viw->hmp_shf_tim) {
+			tim_rnc = viw->tim_hmp - viw->tim_res;
+			assert(viw->tim_rnc < tim_rnc);
+			assert(tim_rnc < hst->tim_cur);
+		}
+		rnc_tims[viw_id] = tim_rnc;
+		tck_refs[viw_id] = 0;
+		if (tim_rnc < rnc_min) rnc_min = tim_rnc;
 	}
 
 	/* Determine the first node to update. */
@@ -1169,17 +1640,16 @@ void tb_lv1_prc(
 	/* Process all updates until the first >= tim_cur. 
 	 * If no updates, stop here. */
 	const u64 tim_cur = hst->tim_cur;
-	u64 tck_ref_new = 0;
 	while (upd && (upd->tim < tim_cur)) {
 		const u64 upd_tim = upd->tim;
 		check(upd_tim >= hst->tim_prc);
 		hst->tim_prc = upd_tim;
 
-		/* If we found an update after the reanchor time,
-		 * we should reanchor now, compute the new tick ref. */
-		if (upd_tim >= tim_rnc) { 
-			tck_ref_new = _tck_ref_cpt(hst);
-			tim_rnc = (u64) -1;
+		/* If we found an update after the reanchor time
+		 * of views, we should reanchor them now, compute
+		 * their new tick ref. */
+		if (upd_tim >= rnc_min) { 
+			rnc_min = _viw_rnc_cpt(hst, rnc_tims, tck_refs, upd_tim);
 		}
 
 		/* Insert the update at the end of its price list. */
@@ -1198,77 +1668,27 @@ void tb_lv1_prc(
 	
 	/* If reanchor was needed but no update was after it,
 	 * reanchor now. */
-	if (tim_rnc != (u64) -1) {
-		tck_ref_new = _tck_ref_cpt(hst);
+	if (rnc_min != (u64) -1) {
+		_viw_rnc_cpt(hst, rnc_tims, tck_refs, (u64) -1);
 	}
 
-	/* Cache the previous heatmap price range. */
-	const u64 hmp_tck_prv_min = hst->hmp_tck_min; 
-	const u64 hmp_tck_prv_max = hst->hmp_tck_max; 
-	const u64 hmp_tck_hln = hst->hmp_dim_tck >> 1;
-	u64 hmp_tck_cur_min = hmp_tck_prv_min; 
-	u64 hmp_tck_cur_max = hmp_tck_prv_max; 
-
-	/* Minimal number of columns to write. */
-	const u64 hmp_shf_tim = hst->hmp_shf_tim;
-	const u64 wrt_min = hmp_shf_tim + 1;
-
-	/* Re-anchor if needed. */
-	if (hmp_shf_tim) {
-
-		/* New tick ref should have been computed. */
-		assert(tck_ref_new != (u64) -1);
-
-		/* Determine the new reference price. */
-		const u64 tck_ref_cur = hst->tck_ref;
-		check(tck_ref_cur >= (hst->hmp_dim_tck >> 1));
-		check(tck_ref_new >= (hst->hmp_dim_tck >> 1));
-
-		/* Update references and current heatmap range. */
-		hst->tck_ref = tck_ref_new; 
-		hst->hmp_shf_tim = 0;
-		hst->hmp_tck_min = hmp_tck_cur_min = tck_ref_new - hmp_tck_hln;
-		hst->hmp_tck_max = hmp_tck_cur_max = tck_ref_new + hmp_tck_hln;
-
-		tb_lv1_log("rnc : %U -> %U,%U,%U.\n", tck_ref_cur, tck_ref_new, hst->hmp_tck_min, hst->hmp_tck_max);
-
-		/* Move heatmap data. */
-		const s64 hmp_shf_tck = (s64) tck_ref_new - (s64) tck_ref_cur;
-		_hst_hmp_mov(hst, hmp_shf_tim, hmp_shf_tck);
+	/* Generate the next epoch. */
+	const u64 epc = hst->pub_epc + 1;
+	const u8 buf_id = (u8) (epc % hst->buf_nbr);
 
+	/* Update all views from the same tick state. */
+	for (u8 viw_id = 0; viw_id < viw_nbr; viw_id++) {
+		_viw_prc(hst, hst->viws + viw_id, tck_refs[viw_id], buf_id);
 	}
-	check(hst->hmp_tck_max == hst->hmp_tck_min + hst->hmp_dim_tck);
-
-	/* Iterate over all ticks (decreasing order). */
-	tb_lv1_tck *tck = ns_map_sch_gs(&hst->tcks, hmp_tck_cur_max, u64, tb_lv1_tck, tcks); 
-	check(hmp_tck_cur_max - hmp_tck_cur_min == hst->hmp_dim_tck);
-	const u64 hmp_dim_tim = hst->hmp_dim_tim;
-	for (u64 row_id = hst->hmp_dim_tck; row_id--;) {
-		const u64 tck_val = hmp_tck_cur_min + row_id;
-		check(tck_val < hmp_tck_cur_max);
-		check((!tck) || tck->tcks.val <= tck_val); 
-
-		/* Determine the number of heatmap cells to fill in this row. */
-		const u8 wrt_ful = !((hmp_tck_prv_min <= tck_val) && (tck_val < hmp_tck_prv_max));  
-		const u64 wrt_nbr = wrt_ful ? hmp_dim_tim : wrt_min;
-
-		/* Determine if we have tick data for this level. */
-		const u8 has_dat = tck && (tck->tcks.val == tck_val);
-
-		/* Fill heatmap cells. */
-		_hmp_wrt_row(hst, row_id, wrt_nbr, has_dat ? tck : 0); 
-
-		/* If current price used, fetch the previous one. */
-		if (has_dat) {
-			check(tck);
-			ns_mapn_u64 *prv = ns_map_u64_fn_inr(&tck->tcks);
-			tck = (prv) ? ns_cnt_of(prv, tb_lv1_tck, tcks) : 0;
-		}
 
+	/* Copy curves if they are not published in place. */
+	if ((hst->buf_nbr != 1) && hst->bac_nb) {
+		ns_mem_cpy(hst->pub_bids[buf_id], hst->bid_crv, sizeof(u64) * hst->bac_nb);
+		ns_mem_cpy(hst->pub_asks[buf_id], hst->ask_crv, sizeof(u64) * hst->bac_nb);
 	}
 
-	//debug("Res : \n");
-	//_hmp_log(hst);
+	/* Publish. */
+	ns_atm(a64, wrt, rel, &hst->pub_epc, epc);
 
 }
 
@@ -1280,13 +1700,14 @@ void tb_lv1_cln(
 	tb_lv1_hst *hst
 )
 {
+	tb_stt_fnc(TB_STT_FNC_LV1_CLN);
 
 	/* Require a prepared history. */
 	assert(hst->tim_cur);
 
-	/* Purge all updates before @hmp_stt. */
-	assert(hst->tim_hmp > hst->hmp_tim_spn);
-	const u64 hmp_stt = hst->tim_hmp - hst->hmp_tim_spn;
+	/* Purge all updates before the start of the
+	 * earliest heatmap. */
+	const u64 hmp_stt = _hst_hmp_stt(hst);
 	tb_lv1_upd *upd;
 	ns_slsh_fes(upd, &hst->upds_hst, upds_hst) {
 
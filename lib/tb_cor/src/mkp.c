@@ -9,7 +9,7 @@
 /*
  * Define marketplaces.
  */
-#define TB_MKP(nam, sym, ccy) tb_mkp tb_mkp_##sym = {{}, #sym, #nam, NS_PRP_CDS_EMP(ccy) (0) (#ccy), 0};
+#define TB_MKP(nam, sym, ccy) tb_mkp tb_mkp_##sym = {#sym, #nam, NS_PRP_CDS_EMP(ccy) (0) (#ccy), 0};
 #include <tb_cor/mkps.h>
 #undef TB_MKP
 
@@ -20,9 +20,6 @@
 /* Marketplaces system. */
 static tb_mkp_sys _mkp_sys = {};
 
-/* Marketplaces init status. */
-static u8 _mkp_ini = 0;
-
 /* Define the marketplaces array. */
 static tb_mkp *_mkp_arr[] = {
 #define TB_MKP(nam, sym, ccy) &tb_mkp_##sym,
@@ -38,18 +35,29 @@ static const u32 _mkps_nb = sizeof(_mkp_arr) / sizeof(_mkp_arr[0]);
  ********/
 
 /*
- * Init the marketplaces map.
+ * Init the marketplaces index.
  */
-static inline void _sys_ini(
+static void _sys_ini(
 	tb_mkp_sys *sys
 )
 {
-	check(nh_spn_lkd(&sys->lck));
-	if (_mkp_ini) return;
-	ns_map_str_ini(&sys->mkps);
-	for (u32 mkp_id = 0; mkp_id < _mkps_nb; mkp_id++) {
-		ns_map_str_put(&sys->mkps, &_mkp_arr[mkp_id]->mkps, _mkp_arr[mkp_id]->sym);
+	nh_spn_lck(&sys->lck);
+	if (!sys->rdy) {
+		const char *syms[sizeof(_mkp_arr) / sizeof(_mkp_arr[0])];
+		u32 slts[sizeof(_mkp_arr) / sizeof(_mkp_arr[0])];
+		for (u32 mkp_id = 0; mkp_id < _mkps_nb; mkp_id++) {
+			syms[mkp_id] = _mkp_arr[mkp_id]->sym;
+		}
+		tb_phf_ctr(&sys->phf, syms, _mkps_nb, slts);
+		const u32 slt_nbr = tb_phf_slt_nbr(&sys->phf);
+		sys->mkps = nh_all(sizeof(tb_mkp *) * slt_nbr);
+		ns_mem_rst(sys->mkps, sizeof(tb_mkp *) * slt_nbr);
+		for (u32 mkp_id = 0; mkp_id < _mkps_nb; mkp_id++) {
+			sys->mkps[slts[mkp_id]] = _mkp_arr[mkp_id];
+		}
+		ns_atm(a64, wrt, rel, &sys->rdy, 1);
 	}
+	nh_spn_ulk(&sys->lck);
 }
 
 /************
@@ -70,16 +78,14 @@ void tb_mkp_log(
 
 /*
  * Currency lookup by symbol.
+ * Wait-free once initialized.
  */
 tb_mkp *tb_mkp_sch(
 	const char *sym
 )
 {
 	tb_mkp_sys *sys = &_mkp_sys;
-	nh_spn_lck(&sys->lck); 
-	_sys_ini(sys);
-	tb_mkp *mkp = ns_map_sch(&sys->mkps, sym, str, tb_mkp, mkps);
-	nh_spn_ulk(&sys->lck); 
-	return mkp;
+	if (!ns_atm(a64, red, acq, &sys->rdy)) _sys_ini(sys);
+	tb_mkp *mkp = sys->mkps[tb_phf_slt(&sys->phf, sym)];
+	return (mkp && tb_str_equ(mkp->sym, sym)) ? mkp : 0;
 }
-
@@ -0,0 +1,265 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/********************
+ * Source internals *
+ ********************/
+
+/*
+ * Unload @src's block and mark it exhausted.
+ * Return 1.
+ */
+static inline u8 _src_exh(
+	tb_mrg_src *src
+)
+{
+	assert(src->blk);
+	tb_stg_unl(src->blk);
+	src->blk = 0;
+	return 1;
+}
+
+/*
+ * Move @src to its next element in [stt, @end],
+ * loading the next block if required, and update its
+ * time.
+ * If no such element exists, unload @src's block and
+ * return 1.
+ * Otherwise, return 0.
+ */
+static inline u8 _src_lod(
+	tb_mrg_src *src,
+	u64 end
+)
+{
+	assert(src->blk);
+	while (src->elm_idx == src->elm_nbr) {
+
+		/* The block may still be written to,
+		 * refresh its number of elements. */
+		src->elm_nbr = tb_stg_elm_nbr(src->blk);
+		if (src->elm_idx != src->elm_nbr) break;
+
+		/* If the block is not full, no more data. */
+		if (src->elm_nbr != tb_stg_blk_max(src->blk)) return _src_exh(src);
+
+		/* Move to the next block if any. */
+		src->blk = tb_stg_red_nxt(src->idx, src->blk, end, 1);
+		if (!src->blk) return 1;
+		src->elm_nbr = tb_blk_arr(src->blk, src->dats, src->dat_nbr, &src->sizs);
+		src->elm_idx = 0;
+
+	}
+
+	/* Read the time, stop if after the end. */
+	assert(src->elm_idx < src->elm_nbr);
+	src->tim = ((const u64 *) src->dats[0])[src->elm_idx];
+	if (src->tim > end) return _src_exh(src);
+	return 0;
+
+}
+
+/*
+ * Initialize @src to read @idx starting at @stt.
+ * If @idx has no element in [@stt, @end], return 1.
+ * Otherwise, return 0.
+ */
+static inline u8 _src_ini(
+	tb_mrg_src *src,
+	tb_stg_idx *idx,
+	u64 stt,
+	u64 end
+)
+{
+	src->idx = idx;
+	src->dat_nbr = tb_lvl_arr_nbr(idx->lvl);
+	src->blk = 0;
+
+	/* Load the first block with elements at or after @stt. */
+	tb_stg_blk *blk = tb_stg_lod_nxt(idx, stt);
+	if (!blk) return 1;
+	src->blk = blk;
+
+	/* Locate the first element. */
+	src->elm_nbr = tb_blk_arr(blk, src->dats, src->dat_nbr, &src->sizs);
+	assert(src->elm_nbr);
+	const u64 *tims = src->dats[0];
+	src->elm_idx = (stt <= tims[0]) ? 0 : tb_stg_elm_sch((u64 *) tims, src->elm_nbr, 0, stt);
+
+	/* Read the first time. */
+	return _src_lod(src, end);
+
+}
+
+/******************
+ * Heap internals *
+ ******************/
+
+/*
+ * Return 1 if source @id0 must be read before @id1.
+ */
+static inline u8 _hep_lss(
+	tb_mrg *mrg,
+	u8 id0,
+	u8 id1
+)
+{
+	const u64 tim0 = mrg->srcs[id0].tim;
+	const u64 tim1 = mrg->srcs[id1].tim;
+	return (tim0 < tim1) || ((tim0 == tim1) && (id0 < id1));
+}
+
+/*
+ * Move the heap element at @pos up to its location.
+ */
+static inline void _hep_up(
+	tb_mrg *mrg,
+	u8 pos
+)
+{
+	u8 *hep = mrg->hep;
+	const u8 id = hep[pos];
+	while (pos) {
+		const u8 par = (u8) ((pos - 1) >> 1);
+		if (!_hep_lss(mrg, id, hep[par])) break;
+		hep[pos] = hep[par];
+		pos = par;
+	}
+	hep[pos] = id;
+}
+
+/*
+ * Move the heap element at @pos down to its location.
+ */
+static inline void _hep_dwn(
+	tb_mrg *mrg,
+	u8 pos
+)
+{
+	u8 *hep = mrg->hep;
+	const u8 nbr = mrg->hep_nbr;
+	const u8 id = hep[pos];
+	while (1) {
+		const u64 chd = ((u64) pos << 1) + 1;
+		if (chd >= nbr) break;
+		u8 min = (u8) chd;
+		if ((chd + 1 < nbr) && _hep_lss(mrg, hep[chd + 1], hep[chd])) min = (u8) (chd + 1);
+		if (!_hep_lss(mrg, hep[min], id)) break;
+		hep[pos] = hep[min];
+		pos = min;
+	}
+	hep[pos] = id;
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a merger reading the elements
+ * of @idxs in [@stt, @end].
+ * Indexes must not be closed before the merger is
+ * deleted.
+ */
+tb_mrg *tb_mrg_ctr(
+	tb_stg_idx **idxs,
+	u8 idx_nbr,
+	u64 stt,
+	u64 end
+)
+{
+	assert(idx_nbr);
+	assert(idx_nbr <= TB_MRG_SRC_MAX);
+	assert(stt <= end);
+
+	/* Allocate. */
+	nh_all__(tb_mrg, mrg);
+	mrg->end = end;
+	mrg->src_nbr = idx_nbr;
+	mrg->hep_nbr = 0;
+	mrg->srcs = nh_all(sizeof(tb_mrg_src) * idx_nbr);
+	mrg->hep = nh_all(sizeof(u8) * idx_nbr);
+	mrg->lst_nbr = 0;
+
+	/* Initialize sources, insert non-empty ones
+	 * in the heap. */
+	for (u8 src_id = 0; src_id < idx_nbr; src_id++) {
+		if (_src_ini(mrg->srcs + src_id, idxs[src_id], stt, end)) continue;
+		mrg->hep[mrg->hep_nbr] = src_id;
+		_hep_up(mrg, mrg->hep_nbr);
+		mrg->hep_nbr++;
+	}
+
+	/* Complete. */
+	return mrg;
+
+}
+
+/*
+ * Delete @mrg, unload all its blocks.
+ */
+void tb_mrg_dtr(
+	tb_mrg *mrg
+)
+{
+	for (u8 src_id = 0; src_id < mrg->src_nbr; src_id++) {
+		tb_mrg_src *src = mrg->srcs + src_id;
+		if (src->blk) tb_stg_unl(src->blk);
+	}
+	nh_fre(mrg->srcs, sizeof(tb_mrg_src) * mrg->src_nbr);
+	nh_fre(mrg->hep, sizeof(u8) * mrg->src_nbr);
+	nh_fre_(mrg);
+}
+
+/*
+ * If @mrg has no more elements to provide, return 0.
+ * Otherwise, initialize @dsts to the location of the
+ * next batch's arrays, store the index of the source
+ * that provides it at @src_idp, store its time at
+ * @timp, and return its number of elements.
+ * @dsts must have room for the number of arrays of
+ * the source's level.
+ * Locations are valid until the next call.
+ */
+u64 tb_mrg_nxt(
+	tb_mrg *mrg,
+	const void **dsts,
+	u8 *src_idp,
+	u64 *timp
+)
+{
+
+	/* Consume the previous batch, now that its
+	 * locations are not used anymore. */
+	if (mrg->lst_nbr) {
+		assert(mrg->hep_nbr);
+		tb_mrg_src *src = mrg->srcs + mrg->hep[0];
+		src->elm_idx += mrg->lst_nbr;
+		mrg->lst_nbr = 0;
+		if (_src_lod(src, mrg->end)) {
+			mrg->hep[0] = mrg->hep[--mrg->hep_nbr];
+		}
+		if (mrg->hep_nbr) _hep_dwn(mrg, 0);
+	}
+
+	/* If no more sources, complete. */
+	if (!mrg->hep_nbr) return 0;
+
+	/* Count the elements of the top source
+	 * that share its time. */
+	const u8 src_id = mrg->hep[0];
+	tb_mrg_src *src = mrg->srcs + src_id;
+	const u64 *tims = src->dats[0];
+	const u64 tim = src->tim;
+	u64 end = src->elm_idx + 1;
+	while ((end < src->elm_nbr) && (tims[end] == tim)) end++;
+	const u64 nbr = mrg->lst_nbr = end - src->elm_idx;
+
+	/* Provide. */
+	tb_stg_shf(dsts, src->dats, src->sizs, src->dat_nbr, src->elm_idx);
+	*src_idp = src_id;
+	*timp = tim;
+	return nbr;
+
+}
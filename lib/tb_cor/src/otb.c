@@ -0,0 +1,282 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*************
+ * Internals *
+ *************/
+
+/* Empty index entry. */
+#define IDX_NON ((u32) -1)
+
+/*
+ * Return the home position of broker identifier @id
+ * in @otb's index.
+ */
+static inline u64 _idx_hom(
+	tb_otb *otb,
+	u64 id
+) {return ((id * 0x9e3779b97f4a7c15) >> 32) & otb->idx_msk;}
+
+/*
+ * Return the index position of the order of broker
+ * identifier @id in @otb, -1 if none.
+ */
+static inline u64 _idx_sch(
+	tb_otb *otb,
+	u64 id
+)
+{
+	const u64 msk = otb->idx_msk;
+	for (u64 pos = _idx_hom(otb, id);; pos = (pos + 1) & msk) {
+		const u32 slt = otb->idxs[pos];
+		if (slt == IDX_NON) return (u64) -1;
+		if (otb->clds[slt].id == id) return pos;
+	}
+}
+
+/*
+ * Index slot @slt of broker identifier @id in @otb.
+ */
+static inline void _idx_add(
+	tb_otb *otb,
+	u64 id,
+	u32 slt
+)
+{
+	const u64 msk = otb->idx_msk;
+	u64 pos = _idx_hom(otb, id);
+	while (otb->idxs[pos] != IDX_NON) {
+		assert(otb->clds[otb->idxs[pos]].id != id, "order %U already in the table.\n", id);
+		pos = (pos + 1) & msk;
+	}
+	otb->idxs[pos] = slt;
+}
+
+/*
+ * Remove the index entry at position @pos of @otb.
+ * Shift the following entries back, so that no probe
+ * sequence is broken.
+ */
+static inline void _idx_rem(
+	tb_otb *otb,
+	u64 pos
+)
+{
+	const u64 msk = otb->idx_msk;
+	u32 *idxs = otb->idxs;
+	for (u64 nxt = (pos + 1) & msk; idxs[nxt] != IDX_NON; nxt = (nxt + 1) & msk) {
+		const u64 hom = _idx_hom(otb, otb->clds[idxs[nxt]].id);
+
+		/* Move entries whose home is not in ]@pos, @nxt]. */
+		if (((nxt - hom) & msk) >= ((nxt - pos) & msk)) {
+			idxs[pos] = idxs[nxt];
+			pos = nxt;
+		}
+
+	}
+	idxs[pos] = IDX_NON;
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return an empty table of at most
+ * @ord_max orders.
+ */
+tb_otb *tb_otb_ctr(
+	u32 ord_max
+)
+{
+	assert(ord_max && (ord_max < IDX_NON));
+	nh_all__(tb_otb, otb);
+	otb->ord_max = ord_max;
+	otb->ord_nbr = 0;
+
+	/* Chain all slots. */
+	otb->hots = nh_all(sizeof(tb_otb_hot) * ord_max);
+	otb->clds = nh_all(sizeof(tb_otb_cld) * ord_max);
+	for (u32 slt = 0; slt < ord_max; slt++) {
+		otb->hots[slt].gen = 0;
+		otb->clds[slt].nxt = slt + 1;
+	}
+	otb->fre = 0;
+
+	/* Keep the index at most half full. */
+	u64 idx_nbr = 1;
+	while (idx_nbr < 2 * (u64) ord_max) idx_nbr <<= 1;
+	otb->idx_msk = idx_nbr - 1;
+	otb->idxs = nh_all(sizeof(u32) * idx_nbr);
+	for (u64 pos = 0; pos < idx_nbr; pos++) {
+		otb->idxs[pos] = IDX_NON;
+	}
+	return otb;
+}
+
+/*
+ * Delete @otb.
+ */
+void tb_otb_dtr(
+	tb_otb *otb
+)
+{
+	nh_fre(otb->hots, sizeof(tb_otb_hot) * otb->ord_max);
+	nh_fre(otb->clds, sizeof(tb_otb_cld) * otb->ord_max);
+	nh_fre(otb->idxs, sizeof(u32) * (otb->idx_msk + 1));
+	nh_fre_(otb);
+}
+
+/*
+ * Add the order described by @ord to @otb and return
+ * its handle.
+ * If @otb is full, return TB_OTB_HDL_NON.
+ * Its broker identifier must not be used.
+ */
+u64 tb_otb_add(
+	tb_otb *otb,
+	const tb_ord *ord
+)
+{
+
+	/* Take a free slot. */
+	const u32 slt = otb->fre;
+	if (slt == otb->ord_max) return TB_OTB_HDL_NON;
+	tb_otb_hot *hot = otb->hots + slt;
+	tb_otb_cld *cld = otb->clds + slt;
+	otb->fre = cld->nxt;
+	otb->ord_nbr++;
+
+	/* Store. */
+	check(!(hot->gen & 1));
+	const u32 gen = ++hot->gen;
+	hot->sts = ord->sts;
+	hot->req_vol_prm = ord->req_vol_prm;
+	hot->vol_prm = ord->rsp_vol_prm;
+	hot->vol_sec = ord->rsp_vol_sec;
+	cld->prm = ord->prm;
+	cld->sec = ord->sec;
+	cld->id = ord->id;
+	cld->req_prc_lim = ord->req_prc_lim;
+	cld->req_prc_stp = ord->req_prc_stp;
+	cld->typ = ord->typ;
+
+	/* Index. */
+	_idx_add(otb, ord->id, slt);
+	return ((u64) gen << 32) | slt;
+
+}
+
+/*
+ * Delete the order of handle @hdl from @otb.
+ * If @hdl is stale, return 1.
+ */
+uerr tb_otb_del(
+	tb_otb *otb,
+	u64 hdl
+)
+{
+	tb_otb_hot *hot = tb_otb_hot_get(otb, hdl);
+	if (!hot) return 1;
+	const u32 slt = (u32) (hdl & 0xffffffff);
+	tb_otb_cld *cld = otb->clds + slt;
+
+	/* Unindex. */
+	const u64 pos = _idx_sch(otb, cld->id);
+	check(pos != (u64) -1);
+	check(otb->idxs[pos] == slt);
+	_idx_rem(otb, pos);
+
+	/* Invalidate handles, free the slot. */
+	hot->gen++;
+	cld->nxt = otb->fre;
+	otb->fre = slt;
+	otb->ord_nbr--;
+	return 0;
+
+}
+
+/*
+ * Return the handle of the order of broker identifier
+ * @id in @otb, TB_OTB_HDL_NON if none.
+ */
+u64 tb_otb_sch(
+	tb_otb *otb,
+	u64 id
+)
+{
+	const u64 pos = _idx_sch(otb, id);
+	if (pos == (u64) -1) return TB_OTB_HDL_NON;
+	const u32 slt = otb->idxs[pos];
+	return ((u64) otb->hots[slt].gen << 32) | slt;
+}
+
+/*
+ * Save the descriptor of the order of handle @hdl at
+ * @dst.
+ * If @hdl is stale, return 1.
+ */
+uerr tb_otb_get(
+	tb_otb *otb,
+	u64 hdl,
+	tb_ord *dst
+)
+{
+	tb_otb_hot *hot = tb_otb_hot_get(otb, hdl);
+	if (!hot) return 1;
+	tb_otb_cld *cld = otb->clds + (hdl & 0xffffffff);
+	tb_ord_ctr(
+		dst,
+		cld->prm,
+		cld->sec,
+		cld->typ,
+		hot->req_vol_prm,
+		cld->req_prc_lim,
+		cld->req_prc_stp,
+		cld->id,
+		hot->sts
+	);
+	dst->rsp_vol_prm = hot->vol_prm;
+	dst->rsp_vol_sec = hot->vol_sec;
+	return 0;
+}
+
+/*
+ * Update the status and volumes of the order of @otb
+ * with @ord's broker identifier from @ord, and return
+ * its handle.
+ * If none, return TB_OTB_HDL_NON.
+ */
+u64 tb_otb_upd(
+	tb_otb *otb,
+	const tb_ord *ord
+)
+{
+	const u64 hdl = tb_otb_sch(otb, ord->id);
+	if (hdl == TB_OTB_HDL_NON) return hdl;
+	tb_otb_hot *hot = otb->hots + (hdl & 0xffffffff);
+	hot->sts = ord->sts;
+	hot->vol_prm = ord->rsp_vol_prm;
+	hot->vol_sec = ord->rsp_vol_sec;
+	return hdl;
+}
+
+/*
+ * Add a fill of @vol_prm in exchange of @vol_sec to
+ * the order of handle @hdl, complete it if filled.
+ * If @hdl is stale, abort.
+ */
+void tb_otb_fil(
+	tb_otb *otb,
+	u64 hdl,
+	f64 vol_prm,
+	f64 vol_sec
+)
+{
+	tb_otb_hot *hot = assert(tb_otb_hot_get(otb, hdl), "stale order handle %U.\n", hdl);
+	assert((hot->sts == TB_ORD_STS_IDL) || (hot->sts == TB_ORD_STS_ACT), "fill of a terminated order.\n");
+	hot->vol_prm += vol_prm;
+	hot->vol_sec += vol_sec;
+	hot->sts = (hot->vol_prm >= hot->req_vol_prm) ? TB_ORD_STS_CPL : TB_ORD_STS_ACT;
+}
@@ -0,0 +1,122 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*************
+ * Internals *
+ *************/
+
+/* Maximal number of keys per bucket. */
+#define BKT_MAX 16
+
+/* Maximal number of displacement attempts. */
+#define DSP_MAX 1000000
+
+/*
+ * Find a displacement seed placing the @nbr keys of
+ * @keys whose indices are @idxs in free slots of @useds,
+ * mark them used, save their slots in @slts and return
+ * the seed.
+ */
+static inline u64 _bkt_dsp(
+	tb_phf *phf,
+	const char **keys,
+	const u32 *idxs,
+	u32 nbr,
+	u8 *useds,
+	u32 *slts
+)
+{
+	u32 tsts[BKT_MAX];
+	for (u64 dsp = 1; dsp < DSP_MAX; dsp++) {
+		u32 key_id = 0;
+		for (; key_id < nbr; key_id++) {
+			const u32 slt = (u32) (tb_str_hsh(keys[idxs[key_id]], dsp) & phf->slt_msk);
+			if (useds[slt]) break;
+			u32 prv_id = 0;
+			while ((prv_id < key_id) && (tsts[prv_id] != slt)) prv_id++;
+			if (prv_id < key_id) break;
+			tsts[key_id] = slt;
+		}
+		if (key_id < nbr) continue;
+		for (key_id = 0; key_id < nbr; key_id++) {
+			useds[tsts[key_id]] = 1;
+			slts[idxs[key_id]] = tsts[key_id];
+		}
+		return dsp;
+	}
+	assert(0, "no displacement found.\n");
+	return 0;
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct @phf for the @key_nbr distinct keys of
+ * @keys and save the slot of each key in @slts.
+ */
+void tb_phf_ctr(
+	tb_phf *phf,
+	const char **keys,
+	u32 key_nbr,
+	u32 *slts
+)
+{
+	assert(key_nbr);
+
+	/* Two keys per bucket, slots half full. */
+	u32 bkt_nbr = 1;
+	while (2 * bkt_nbr < key_nbr) bkt_nbr <<= 1;
+	u32 slt_nbr = 1;
+	while (slt_nbr < 2 * key_nbr) slt_nbr <<= 1;
+	phf->bkt_msk = bkt_nbr - 1;
+	phf->slt_msk = slt_nbr - 1;
+	phf->dsps = nh_all(sizeof(u64) * bkt_nbr);
+
+	/* Distribute keys in buckets. */
+	u32 *bkts = nh_all(sizeof(u32) * key_nbr);
+	u32 *sizs = nh_all(sizeof(u32) * bkt_nbr);
+	ns_mem_rst(sizs, sizeof(u32) * bkt_nbr);
+	u32 siz_max = 0;
+	for (u32 key_id = 0; key_id < key_nbr; key_id++) {
+		const u32 bkt = (u32) (tb_str_hsh(keys[key_id], 0) & phf->bkt_msk);
+		bkts[key_id] = bkt;
+		if (++sizs[bkt] > siz_max) siz_max = sizs[bkt];
+	}
+	assert(siz_max <= BKT_MAX, "bucket too large.\n");
+
+	/* Place buckets, largest first. */
+	u8 *useds = nh_all(slt_nbr);
+	ns_mem_rst(useds, slt_nbr);
+	u32 idxs[BKT_MAX];
+	for (u32 bkt = 0; bkt < bkt_nbr; bkt++) {
+		phf->dsps[bkt] = 0;
+	}
+	for (u32 siz = siz_max; siz; siz--) {
+		for (u32 bkt = 0; bkt < bkt_nbr; bkt++) {
+			if (sizs[bkt] != siz) continue;
+			u32 nbr = 0;
+			for (u32 key_id = 0; key_id < key_nbr; key_id++) {
+				if (bkts[key_id] == bkt) idxs[nbr++] = key_id;
+			}
+			check(nbr == siz);
+			phf->dsps[bkt] = _bkt_dsp(phf, keys, idxs, nbr, useds, slts);
+		}
+	}
+
+	nh_fre(useds, slt_nbr);
+	nh_fre(sizs, sizeof(u32) * bkt_nbr);
+	nh_fre(bkts, sizeof(u32) * key_nbr);
+}
+
+/*
+ * Delete @phf.
+ */
+void tb_phf_dtr(
+	tb_phf *phf
+)
+{
+	nh_fre(phf->dsps, sizeof(u64) * (phf->bkt_msk + 1));
+}
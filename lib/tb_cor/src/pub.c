@@ -0,0 +1,268 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*********************
+ * Segment internals *
+ *********************/
+
+/*
+ * Return the size of the heatmap described by @imp.
+ */
+static inline u64 _hmp_siz(
+	tb_pub_imp *imp
+) {return sizeof(f64) * imp->hmp_dim_tim * imp->hmp_dim_tck;}
+
+/*
+ * Return the size of a curve described by @imp.
+ */
+static inline u64 _crv_siz(
+	tb_pub_imp *imp
+) {return sizeof(u64) * imp->bac_nb;}
+
+/*
+ * Initialize @imp.
+ */
+static inline void _imp_ini(
+	tb_pub_imp *imp,
+	u64 tim_res,
+	u64 hmp_dim_tck,
+	u64 hmp_dim_tim,
+	u64 bac_nb
+)
+{
+	assert(hmp_dim_tck);
+	assert(hmp_dim_tim);
+	imp->tim_res = tim_res;
+	imp->hmp_dim_tim = hmp_dim_tim;
+	imp->hmp_dim_tck = hmp_dim_tck;
+	imp->bac_nb = bac_nb;
+}
+
+/*
+ * Open the publication segment of (@mkp, @ist) in
+ * the storage directory @pth, create it if @crt is 1,
+ * map it read-only if it is TB_SGM_RDO.
+ * Store the location of its header, heatmap and curves.
+ */
+static inline tb_sgm *_sgm_opn(
+	u8 crt,
+	tb_pub_imp *imp,
+	const char *pth,
+	const char *mkp,
+	const char *ist,
+	tb_pub_hdr **hdrp,
+	f64 **hmpp,
+	u64 **bidp,
+	u64 **askp
+)
+{
+
+	/* Open. */
+	const u64 rgn_siz = sizeof(tb_pub_hdr) + _hmp_siz(imp) + 2 * _crv_siz(imp);
+	tb_sgm *sgm = tb_sgm_fopn(
+		crt,
+		imp,
+		sizeof(tb_pub_imp),
+		1,
+		(u64 []) {rgn_siz},
+		0,
+		0,
+		0,
+		"%s/%s/%s/pub", pth, mkp, ist
+	);
+	assert(sgm, "segment %s/%s/%s/pub open failed.\n", pth, mkp, ist);
+
+	/* Locate. */
+	tb_pub_hdr *hdr = *hdrp = tb_sgm_rgn(sgm, 0);
+	f64 *hmp = *hmpp = ns_psum(hdr, sizeof(tb_pub_hdr));
+	u64 *bid = ns_psum(hmp, _hmp_siz(imp));
+	*bidp = imp->bac_nb ? bid : 0;
+	*askp = imp->bac_nb ? ns_psum(bid, _crv_siz(imp)) : 0;
+	return sgm;
+
+}
+
+/*
+ * Publish the current frame of @src.
+ */
+static inline void _src_pub(
+	tb_pub *pub,
+	tb_pub_src *src
+)
+{
+	tb_pub_hdr *hdr = src->hdr;
+	tb_lv1_hst *hst = tb_dr1_hst(src->dr1);
+
+	/* Mark the frame as being written. */
+	ns_atm(a64, xch, aar, &hdr->seq, src->seq + 1);
+
+	/* Write. */
+	hdr->tim = hst->tim_cur;
+	hdr->tck_min = hst->viws[0].hmp_tck_min;
+	hdr->bac_aid = hst->bac_aid;
+	ns_mem_cpy(src->hmp, tb_dr1_hmp(src->dr1), _hmp_siz(&pub->imp));
+	if (pub->imp.bac_nb) {
+		ns_mem_cpy(src->bid, hst->bid_crv, _crv_siz(&pub->imp));
+		ns_mem_cpy(src->ask, hst->ask_crv, _crv_siz(&pub->imp));
+	}
+
+	/* Publish. */
+	src->seq += 2;
+	ns_atm(a64, wrt, rel, &hdr->seq, src->seq);
+
+}
+
+/*****************
+ * Publisher API *
+ *****************/
+
+/*
+ * Construct and return a publisher of at most
+ * @src_max instruments of @sys, with the provided
+ * heatmap and curves dimensions.
+ */
+tb_pub *tb_pub_ctr(
+	tb_stg_sys *sys,
+	u8 src_max,
+	u64 tim_res,
+	u64 hmp_dim_tck,
+	u64 hmp_dim_tim,
+	u64 bac_nb
+)
+{
+	assert(src_max);
+	nh_all__(tb_pub, pub);
+	pub->sys = sys;
+	_imp_ini(&pub->imp, tim_res, hmp_dim_tck, hmp_dim_tim, bac_nb);
+	pub->src_nbr = 0;
+	pub->src_max = src_max;
+	pub->srcs = nh_all(sizeof(tb_pub_src) * src_max);
+	return pub;
+}
+
+/*
+ * Delete @pub, release its segments.
+ */
+void tb_pub_dtr(
+	tb_pub *pub
+)
+{
+	for (u8 src_id = 0; src_id < pub->src_nbr; src_id++) {
+		tb_pub_src *src = pub->srcs + src_id;
+		tb_sgm_wrt_cpl(src->sgm);
+		tb_sgm_cls(src->sgm);
+		tb_dr1_dtr(src->dr1);
+	}
+	nh_fre(pub->srcs, sizeof(tb_pub_src) * pub->src_max);
+	nh_fre_(pub);
+}
+
+/*
+ * Publish (@mkp, @ist) with data up to @tim_cur.
+ * Return the instrument's index in @pub.
+ * Abort if a live publisher already publishes it.
+ */
+u8 tb_pub_add(
+	tb_pub *pub,
+	const char *mkp,
+	const char *ist,
+	u64 tim_cur
+)
+{
+	assert(pub->src_nbr < pub->src_max, "too many published instruments.\n");
+	const u8 src_id = pub->src_nbr;
+	tb_pub_src *src = pub->srcs + src_id;
+
+	/* Reconstruct. Frames are copied, a single
+	 * buffer is enough. */
+	tb_pub_imp *imp = &pub->imp;
+	src->dr1 = tb_dr1_ctr(
+		pub->sys,
+		mkp,
+		ist,
+		imp->tim_res,
+		imp->hmp_dim_tck,
+		imp->hmp_dim_tim,
+		imp->bac_nb,
+		1,
+		tim_cur
+	);
+
+	/* Open the segment and take its write privilege,
+	 * recovering it from a dead publisher if needed. */
+	src->sgm = _sgm_opn(1, imp, pub->sys->pth, mkp, ist, &src->hdr, &src->hmp, &src->bid, &src->ask);
+	u64 off = 0;
+	assert(!tb_sgm_wrt_rcv(src->sgm, &off), "%s/%s already published.\n", mkp, ist);
+
+	/* Resume the sequence, a dead publisher may
+	 * have left it odd. */
+	src->seq = (ns_atm(a64, red, acq, &src->hdr->seq) + 1) & ~(u64) 1;
+
+	/* Publish the first frame. */
+	_src_pub(pub, src);
+	pub->src_nbr++;
+	return src_id;
+
+}
+
+/*
+ * Update all instruments of @pub until @tim_cur, and
+ * publish their new frames.
+ */
+void tb_pub_stp(
+	tb_pub *pub,
+	u64 tim_cur
+)
+{
+	for (u8 src_id = 0; src_id < pub->src_nbr; src_id++) {
+		tb_pub_src *src = pub->srcs + src_id;
+		tb_dr1_add(src->dr1, tim_cur, 1);
+		tb_dr1_cln(src->dr1);
+		_src_pub(pub, src);
+	}
+}
+
+/****************
+ * Consumer API *
+ ****************/
+
+/*
+ * Open the publication of (@mkp, @ist) stored in the
+ * storage directory @pth, with the provided heatmap
+ * and curves dimensions.
+ * Abort if it does not exist or if dimensions do not
+ * match.
+ */
+tb_pub_cns *tb_pub_cns_opn(
+	const char *pth,
+	const char *mkp,
+	const char *ist,
+	u64 tim_res,
+	u64 hmp_dim_tck,
+	u64 hmp_dim_tim,
+	u64 bac_nb
+)
+{
+	nh_all__(tb_pub_cns, cns);
+	_imp_ini(&cns->imp, tim_res, hmp_dim_tck, hmp_dim_tim, bac_nb);
+	f64 *hmp;
+	u64 *bid;
+	u64 *ask;
+	cns->sgm = _sgm_opn(TB_SGM_RDO, &cns->imp, pth, mkp, ist, &cns->hdr, &hmp, &bid, &ask);
+	cns->hmp = hmp;
+	cns->bid = bid;
+	cns->ask = ask;
+	return cns;
+}
+
+/*
+ * Close @cns.
+ */
+void tb_pub_cns_cls(
+	tb_pub_cns *cns
+)
+{
+	tb_sgm_cls(cns->sgm);
+	nh_fre_(cns);
+}
@@ -163,6 +163,9 @@ static inline void _imp_chk(
  * initialize it with @imp_ini, @arr_nb, @elm_max and @elm_sizs.
  * Otherwise, check that @imp_ini, @arr_nb, @elm_max and @elm_sizs
  * do match with the loaded content.
+ * If @crt is TB_SGM_RDO, map it read-only : it must
+ * exist with the expected size, and its initialization
+ * is waited for.
  */
 tb_sgm *tb_sgm_vopn(
 	u8 crt,
@@ -179,7 +182,8 @@ tb_sgm *tb_sgm_vopn(
 {
 
 	/* Construct. */
-	const u8 att = crt ? NH_FIL_ATT_RWC : NH_FIL_ATT_RW; 
+	const u8 rdo = (crt == TB_SGM_RDO);
+	const u8 att = rdo ? NH_FIL_ATT_R : crt ? NH_FIL_ATT_RWC : NH_FIL_ATT_RW; 
 	tb_sgm *sgm = nh_all(sizeof(tb_sgm) + arr_nb * sizeof(void *));
 	ns_stg *stg = sgm->stg = nh_stg_vopn(att, &sgm->res, pth, args);
 	assert(stg, "storage %s open failed.\n", pth);
@@ -194,16 +198,21 @@ tb_sgm *tb_sgm_vopn(
 	}
 	const u64 siz_tgt = TB_SGM_OFF_DAT + dat_siz;
 
-	/* Resize. */
+	/* Resize if writable. */
 	u64 siz_cur = ns_stg_siz(stg);
 	assert(stg, "storage %s open failed.\n", pth);
-	assert((siz_cur == 0) || (siz_cur == siz_tgt), "storage %s unexpected size, expected 0 or %U, got %U.\n", pth, siz_tgt, siz_cur);
-	ns_stg_rsz(stg, siz_tgt);
-	siz_cur = ns_stg_siz(stg);
-	assert(siz_cur == siz_tgt, "storage %s resize failed, expected %U, got %U.\n", pth, siz_tgt, siz_cur);
+	if (rdo) {
+		assert(siz_cur == siz_tgt, "storage %s unexpected size, expected %U, got %U.\n", pth, siz_tgt, siz_cur);
+	} else {
+		assert((siz_cur == 0) || (siz_cur == siz_tgt), "storage %s unexpected size, expected 0 or %U, got %U.\n", pth, siz_tgt, siz_cur);
+		ns_stg_rsz(stg, siz_tgt);
+		siz_cur = ns_stg_siz(stg);
+		assert(siz_cur == siz_tgt, "storage %s resize failed, expected %U, got %U.\n", pth, siz_tgt, siz_cur);
+	}
 
-	/* Map the metadata block as shareable RW. */
-	const u64 att_rws = NS_STG_ATT_RED | NS_STG_ATT_WRT | NS_STG_ATT_SHR; 
+	/* Map the metadata block as shareable, RW unless
+	 * read-only. */
+	const u64 att_rws = NS_STG_ATT_RED | (rdo ? 0 : NS_STG_ATT_WRT) | NS_STG_ATT_SHR; 
 	void *mtd = sgm->mtd = ns_stg_map(stg, 0, TB_SGM_OFF_MTD, TB_SGM_SIZ_MTD, att_rws); 
 	assert(mtd);
 
@@ -212,8 +221,14 @@ tb_sgm *tb_sgm_vopn(
 	tb_sgm_dsc *dsc = sgm->dsc = ns_psum(mtd, TB_SGM_OFF_DSC);
 	sgm->imp = ns_psum(mtd, TB_SGM_OFF_IMP);
 
-	/* Determine if initialized. */
-	const u8 do_ini = _syn_ini(syn);
+	/* Determine if initialized. Read-only, wait for
+	 * the initialization. */
+	u8 do_ini = 0;
+	if (rdo) {
+		while (!ns_atm(a64, red, acq, &syn->ini_cpl));
+	} else {
+		do_ini = _syn_ini(syn);
+	}
 	
 	/* Initialize if required. */
 	if (do_ini) {
@@ -339,6 +354,172 @@ void tb_sgm_red_rng(
 	}
 }
 
+/*
+ * Return the monotonic time of the write publication
+ * of @sgm's element @elm_idx.
+ * If it is older than the traced publications, return
+ * the time of the oldest one.
+ * If publications are not traced, or if @elm_idx is
+ * not published, return 0.
+ */
+u64 tb_sgm_pub_tim(
+	tb_sgm *sgm,
+	u64 elm_idx
+)
+{
+	tb_sgm_syn *syn = sgm->syn;
+
+	/* The slot after the last publication may be being
+	 * overwritten, do not search it. */
+	const u64 pub_nbr = ns_atm(a64, red, acq, &syn->pub_nbr);
+	const u64 pub_min = (pub_nbr < TB_SGM_PUB_NBR) ? 0 : pub_nbr - TB_SGM_PUB_NBR + 1;
+
+	/* Find the first publication that includes
+	 * @elm_idx, ends increase with publications. */
+	u64 low = pub_min;
+	u64 hgh = pub_nbr;
+	while (low < hgh) {
+		const u64 mid = (low + hgh) >> 1;
+		if (ns_atm(a64, red, acq, &syn->pub_ends[mid % TB_SGM_PUB_NBR]) <= elm_idx) {
+			low = mid + 1;
+		} else {
+			hgh = mid;
+		}
+	}
+	if (low == pub_nbr) return 0;
+	const u64 tim = ns_atm(a64, red, acq, &syn->pub_tims[low % TB_SGM_PUB_NBR]);
+
+	/* If slots were overwritten during the search,
+	 * drop the result. */
+	const u64 pub_cur = ns_atm(a64, red, acq, &syn->pub_nbr);
+	if ((pub_cur >= TB_SGM_PUB_NBR) && (pub_cur - TB_SGM_PUB_NBR + 1 > pub_min)) return 0;
+	return tim;
+
+}
+
+/*******************
+ * Lease internals *
+ *******************/
+
+/*
+ * A lease identifies a process by its pid and its
+ * start time, so that a reused pid does not pass for
+ * its previous holder.
+ * Both are packed with a lease count in a single word
+ * so that a lease is taken atomically with the
+ * privilege it protects.
+ * Leases are taken and released by adding them to the
+ * word, so that concurrent attempts commute. A word
+ * whose count is not 1 is being raced for.
+ */
+#define LSE_CNT_BIT 8
+#define LSE_PID_BIT 22
+#define LSE_PID_SFT LSE_CNT_BIT
+#define LSE_STT_SFT (LSE_CNT_BIT + LSE_PID_BIT)
+#define LSE_MSK(bit) (((u64) 1 << (bit)) - 1)
+
+/* Cached identity of the current process. */
+static u64 _slf_pid = 0;
+static u64 _slf_lse = 0;
+
+/*
+ * Return the lease of process @pid started at @stt.
+ */
+static inline u64 _lse_gen(
+	u64 pid,
+	u64 stt
+) {return (stt << LSE_STT_SFT) | (pid << LSE_PID_SFT) | 1;}
+
+/*
+ * Return the lease of the current process.
+ */
+static inline u64 _lse_slf(
+	void
+)
+{
+
+	/* Refresh the identity cache, the pid changes
+	 * across forks. */
+	const u64 pid = nh_prc_pid();
+	if (_slf_pid != pid) {
+		assert(pid <= LSE_MSK(LSE_PID_BIT), "pid %U does not fit in a lease.\n", pid);
+		_slf_lse = _lse_gen(pid, nh_prc_stt(pid));
+		_slf_pid = pid;
+	}
+	return _slf_lse;
+
+}
+
+/*
+ * Return 0 if @lse is a single lease whose holder
+ * does not exist anymore, 1 otherwise.
+ */
+static inline u8 _lse_liv(
+	u64 lse
+)
+{
+	if ((lse & LSE_MSK(LSE_CNT_BIT)) != 1) return 1;
+	const u64 pid = (lse >> LSE_PID_SFT) & LSE_MSK(LSE_PID_BIT);
+	const u64 stt = nh_prc_stt(pid);
+	return (stt && (_lse_gen(pid, stt) == lse));
+}
+
+/*
+ * Attempt to replace the lease @exp held in @lck by
+ * the current process' one.
+ * Only the first of concurrent attempts observes @exp
+ * and succeeds, the others revert their addition.
+ * Return 0 on success, 1 on failure.
+ */
+static inline uerr _lse_tak(
+	volatile a64 *lck,
+	u64 exp
+)
+{
+	const u64 dlt = _lse_slf() - exp;
+	const u64 prv = ns_atm(a64, add_red, aar, lck, dlt) - dlt;
+	if (prv == exp) return 0;
+	ns_atm(a64, add_red, rel, lck, -dlt);
+	return 1;
+}
+
+/*
+ * Release the current process' lease held in @lck.
+ */
+static inline void _lse_rel(
+	volatile a64 *lck
+) {ns_atm(a64, add_red, rel, lck, -_lse_slf());}
+
+/*
+ * Attempt to take the lease held in @lck if it is
+ * free or if its holder does not exist anymore.
+ * Return 0 on success, 1 if it is held or raced for.
+ */
+static inline uerr _lse_rcv(
+	volatile a64 *lck
+)
+{
+	const u64 lse = ns_atm(a64, red, acq, lck);
+	if (lse && _lse_liv(lse)) return 1;
+	return _lse_tak(lck, lse);
+}
+
+/*
+ * Trace the publication of @wrt_nb elements in @syn,
+ * before it is reported.
+ */
+static inline void _pub_trc(
+	tb_sgm_syn *syn,
+	u64 wrt_nb
+)
+{
+	const u64 pub_id = NS_RED_ONC(syn->pub_nbr);
+	const u64 slt = pub_id % TB_SGM_PUB_NBR;
+	ns_atm(a64, wrt, rel, &syn->pub_tims[slt], tb_stt_tim());
+	ns_atm(a64, wrt, rel, &syn->pub_ends[slt], NS_RED_ONC(syn->elm_nb) + wrt_nb);
+	ns_atm(a64, wrt, rel, &syn->pub_nbr, pub_id + 1);
+}
+
 /*************
  * Write API *
  *************/
@@ -354,12 +535,12 @@ uerr tb_sgm_wrt_get(
 )
 {
 
-	/* Require lock priv. */
+	/* If someone already has it, fail without racing. */
 	tb_sgm_syn *syn = sgm->syn;
-	const u64 prv = ns_atm(a64, xch, aar, &syn->wrt, 1);
+	if (ns_atm(a64, red, acq, &syn->wrt)) return 1;
 
-	/* If someone already has it, fail. */
-	if (prv) return 1;
+	/* Require lock priv with our lease. */
+	if (_lse_tak(&syn->wrt, 0)) return 1;
 
 	/* If we got it, initialize the write procedure. */
 	*offp = ns_atm(a64, red, acq, &syn->elm_nb);
@@ -369,6 +550,38 @@ uerr tb_sgm_wrt_get(
 
 }
 
+/*
+ * Attempt to acquire @sgm's write privilege, recovering
+ * it if its holder does not exist anymore.
+ * If so, store its end offset at @offp, and return 0.
+ * If a live process has it, return 1.
+ */
+uerr tb_sgm_wrt_rcv(
+	tb_sgm *sgm,
+	u64 *offp
+)
+{
+
+	/* If the privilege is free, take it. */
+	if (!tb_sgm_wrt_get(sgm, offp)) return 0;
+
+	/* Reserve the recovery, fail if someone else
+	 * is doing it. Recover it if its holder died. */
+	tb_sgm_syn *syn = sgm->syn;
+	if (_lse_rcv(&syn->rcv)) return 1;
+
+	/* If the holder is dead, take its lease.
+	 * Elements it was writing were not reported and
+	 * will be overwritten. */
+	uerr err = _lse_rcv(&syn->wrt);
+	if (!err) *offp = ns_atm(a64, red, acq, &syn->elm_nb);
+
+	/* Release the recovery. */
+	_lse_rel(&syn->rcv);
+	return err;
+
+}
+
 /*
  * Get the @arr_nb write locations for @wrt_nb values
  * of @sgm into @dst.
@@ -406,12 +619,29 @@ u64 tb_sgm_wrt_don(
 	u64 wrt_nb
 )
 {
+	#ifdef TB_STT
+	_pub_trc(sgm->syn, wrt_nb);
+	#endif
 	const u64 elm_nb = ns_atm(a64, add_red, rel, &sgm->syn->elm_nb, wrt_nb);
 	assert(wrt_nb <= elm_nb);
 	assert(elm_nb <= sgm->dsc->elm_max);
 	return elm_nb;
 }
 
+/*
+ * Drop all elements of @sgm.
+ * Write priv must be owned.
+ * Only valid if no one reads @sgm.
+ */
+void tb_sgm_wrt_rst(
+	tb_sgm *sgm
+)
+{
+	check(NS_RED_ONC(sgm->syn->wrt));
+	ns_atm(a64, wrt, rel, &sgm->syn->elm_nb, 0);
+	ns_atm(a64, wrt, rel, &sgm->syn->pub_nbr, 0);
+}
+
 /*
  * Complete the current write.
  * Updates previous indices for the written location.
@@ -429,9 +659,8 @@ u8 tb_sgm_wrt_cpl(
 	assert(elm_nb <= elm_max);
 	const u8 ful = (elm_nb == elm_max);
 
-	/* Update nb and clear write. */
-	const u64 prv = ns_atm(a64, xch, aar, &syn->wrt, 0);
-	assert(prv == 1);
+	/* Release write. */
+	_lse_rel(&syn->wrt);
 
 	/* Return the fullness. */
 	return ful;
@@ -70,7 +70,7 @@ static inline uad _ini_blk(
 )
 {
 	char *ini = idx->sys->ini;
-	uad nb = _ini_idx(idx->sys, idx->mkp, idx->ist, idx->lvl); 
+	uad nb = _ini_idx(idx->sys, tb_sym_str(idx->mkp), tb_sym_str(idx->ist), idx->lvl); 
 	char *end = ns_u64_to_str_hex(blk_nbr, ini + nb, 16); 
 	return ns_psub(end, ini);
 }
@@ -284,9 +284,9 @@ static inline tb_stg_blk *_blk_ctr_lod(
 		arr_nbr,
 		elm_max,
 		elm_sizs,
-		"%s/%s/%s/%u/%U", idx->sys->pth, idx->mkp, idx->ist, idx->lvl, blk_nbr
+		"%s/%s/%s/%u/%U", idx->sys->pth, tb_sym_str(idx->mkp), tb_sym_str(idx->ist), idx->lvl, blk_nbr
 	);
-	assert(sgm, "segment %s/%s/%s/%u/%U open failed.\n", idx->sys->pth, idx->mkp, idx->ist, idx->lvl, blk_nbr);
+	assert(sgm, "segment %s/%s/%s/%u/%U open failed.\n", idx->sys->pth, tb_sym_str(idx->mkp), tb_sym_str(idx->ist), idx->lvl, blk_nbr);
 
 	/* Get the sync page. */
 	tb_stg_blk_syn *syn = tb_sgm_rgn(sgm, 0);
@@ -311,7 +311,11 @@ static inline tb_stg_blk *_blk_ctr_lod(
 static inline tb_stg_blk *_blk_lod(
 	tb_stg_idx *idx,
 	u64 blk_nbr
-) {return _blk_ctr_lod(0, idx, blk_nbr);}
+)
+{
+	tb_stt_evt(TB_STT_EVT_STG_LOD, 1);
+	return _blk_ctr_lod(0, idx, blk_nbr);
+}
 
 /*
  * Construct a block and insert it at the end of
@@ -525,7 +529,7 @@ static inline void _idx_dtr(
 	assert(ns_map_u64_emp(&idx->blks));
 
 	/* Delete. */
-	ns_map_str_rem(&sys->idxs, &idx->idxs);
+	ns_map_u64_rem(&sys->idxs, &idx->idxs);
 	tb_sgm_cls(idx->sgm);
 	nh_fre_(idx);
 }
@@ -598,7 +602,7 @@ static inline void _sys_cln(
 )
 {
 	tb_stg_idx *idx;
-	ns_map_fe(idx, &sys->idxs, idxs, str, in) {
+	ns_map_fe(idx, &sys->idxs, idxs, u64, in) {
 		_idx_cln(sys, idx);
 	}
 }
@@ -655,7 +659,7 @@ tb_stg_sys *tb_stg_ctr(
 	/* Allocate. */	
 	nh_all__(tb_stg_sys, sys);
 	sys->pth = nh_sall(pth);
-	ns_map_str_ini(&sys->idxs);
+	ns_map_u64_ini(&sys->idxs);
 	sys->itf_nbr = 0;
 	sys->ini = nh_all(1024);
 	sys->tst = !!tst;
@@ -699,7 +703,7 @@ void tb_stg_dtr(
 	_sys_cln(sys);
 
 	/* No index should remain. */
-	assert(ns_map_str_emp(&sys->idxs));
+	assert(ns_map_u64_emp(&sys->idxs));
 
 	/* Delete the segment. */
 	tb_sgm_cls(sys->sgm);
@@ -724,24 +728,23 @@ void *tb_stg_tst_syn(
  * Index API *
  *************/
 
-static inline void _gen_idt(
-	char *dst,
-	const char *mkp,
-	const char *ist,
+/* Instrument symbols must fit between the level and
+ * the marketplace symbol. */
+_Static_assert(TB_SYM_MAX <= (1 << 24), "symbols overlap in index identifiers.");
+
+/*
+ * Return the identifier of the index of symbols
+ * @mkp and @ist at level @lvl.
+ */
+static inline u64 _gen_idt(
+	u32 mkp,
+	u32 ist,
 	u8 lvl
 )
 {
-	const uad mkp_len = ns_str_len(mkp);
-	const uad ist_len = ns_str_len(ist);
-	assert(mkp_len < 21);
-	assert(ist_len < 21);
 	assert(lvl < 3);
-	ns_mem_cpy(dst, mkp, mkp_len);
-	dst[mkp_len] = '/';
-	ns_mem_cpy(dst + mkp_len + 1, ist, ist_len);
-	dst[mkp_len + ist_len + 1] = '/';
-	dst[mkp_len + ist_len + 2] = '0' + lvl; 
-	dst[mkp_len + ist_len + 3] = 0;
+	check(ist < TB_SYM_MAX);
+	return ((u64) mkp << 32) | ((u64) ist << 8) | lvl;
 }
 
 /*
@@ -759,14 +762,31 @@ tb_stg_idx *tb_stg_opn(
 	u8 wrt,
 	u64 *key
 )
+{
+	assert(ns_str_len(mkp) < 21);
+	assert(ns_str_len(ist) < 21);
+	return tb_stg_opn_sym(sys, tb_sym_get(mkp), tb_sym_get(ist), lvl, wrt, key);
+}
+
+/*
+ * tb_stg_opn for the marketplace and instrument of
+ * symbols @mkp and @ist.
+ */
+tb_stg_idx *tb_stg_opn_sym(
+	tb_stg_sys *sys,
+	u32 mkp,
+	u32 ist,
+	u8 lvl,
+	u8 wrt,
+	u64 *key
+)
 {
 
 	/* Generate the identifier. */ 
-	tb_str idt;
-	_gen_idt(idt, mkp, ist, lvl);
+	const u64 idt = _gen_idt(mkp, ist, lvl);
 
 	/* Search. */
-	tb_stg_idx *idx = ns_map_sch(&sys->idxs, idt, str, tb_stg_idx, idxs);
+	tb_stg_idx *idx = ns_map_sch(&sys->idxs, idt, u64, tb_stg_idx, idxs);
 	if (idx) {
 		SAFE_INCR(idx->uctr);
 		goto end;
@@ -774,18 +794,20 @@ tb_stg_idx *tb_stg_opn(
 
 	/* Allocate. */
 	nh_all_(idx);
+	const char *mkp_str = tb_sym_str(mkp);
+	const char *ist_str = tb_sym_str(ist);
 
 	/*
 	 * Create the mkp dir, the instrument dir,
 	 * and the level dir.
 	 * Ignore errors.
 	 */
-	nh_fs_fcrt_dir("%s/%s", sys->pth, mkp);
-	nh_fs_fcrt_dir("%s/%s/%s", sys->pth, mkp, ist);
-	nh_fs_fcrt_dir("%s/%s/%s/%u", sys->pth, mkp, ist, lvl);
+	nh_fs_fcrt_dir("%s/%s", sys->pth, mkp_str);
+	nh_fs_fcrt_dir("%s/%s/%s", sys->pth, mkp_str, ist_str);
+	nh_fs_fcrt_dir("%s/%s/%s/%u", sys->pth, mkp_str, ist_str, lvl);
 
 	/* Generate the segment initializer. */
-	uad imp_siz = _ini_idx(sys, mkp, ist, lvl);
+	uad imp_siz = _ini_idx(sys, mkp_str, ist_str, lvl);
 	uad elm_max = tb_lvl_idx_siz(sys->tst, lvl);
 
 	/* Open the index segment. */
@@ -798,21 +820,20 @@ tb_stg_idx *tb_stg_opn(
 		1,
 		elm_max,
 		(u8 []) {2 * sizeof(u64)},  
-		"%s/%s/%s/%u/idx", sys->pth, mkp, ist, lvl
+		"%s/%s/%s/%u/idx", sys->pth, mkp_str, ist_str, lvl
 	);
-	assert(sgm, "segment %s/%s/%s/%u/idx failed.\n", sys->pth, mkp, ist, lvl);
+	assert(sgm, "segment %s/%s/%s/%u/idx failed.\n", sys->pth, mkp_str, ist_str, lvl);
 
 	/* Initialize. */
-	tb_str_cpy(idx->idt, idt);
-	assert(!ns_map_str_put(&sys->idxs, &idx->idxs, idx->idt));
+	assert(!ns_map_u64_put(&sys->idxs, &idx->idxs, idt));
 	ns_map_u64_ini(&idx->blks);
 	idx->sys = sys; 
 	idx->lvl = lvl;
 	idx->sgm = sgm;
 	idx->uctr = 1;
 	idx->key = 0;
-	tb_str_cpy(idx->mkp, mkp);
-	tb_str_cpy(idx->ist, ist);
+	idx->mkp = mkp;
+	idx->ist = ist;
 	tb_sgm_red_rng(
 		idx->sgm,
 		0,
@@ -832,7 +853,9 @@ tb_stg_idx *tb_stg_opn(
 	 * Bail out if failure. */
 	if (wrt) {
 		uad off = 0;
-		const uerr err = tb_sgm_wrt_get(sgm, &off);
+		const uerr err = (wrt == TB_STG_RCV) ?
+			tb_sgm_wrt_rcv(idx->sgm, &off) :
+			tb_sgm_wrt_get(idx->sgm, &off);
 		if (err) {
 			tb_stg_cls(idx, 0);
 			return 0;
@@ -893,6 +916,29 @@ _own_ tb_stg_blk *tb_stg_lod_tim(
 	return blk ? _blk_tak(blk) : 0;
 }
 
+/*
+ * If @idx has no element at or after (>=) @tim,
+ * return 0.
+ * Otherwise, load the first block that has one
+ * and return it.
+ */
+_own_ tb_stg_blk *tb_stg_lod_nxt(
+	tb_stg_idx *idx,
+	u64 tim
+)
+{
+
+	/* If a block covers @tim, use it. */
+	tb_stg_blk *blk = tb_stg_lod_tim(idx, tim);
+	if (blk) return blk;
+
+	/* If @tim precedes the first block, use the first block. */
+	const u64 itb_nbr = _itb_nbr(idx);
+	if ((!itb_nbr) || (_itb_blk_stt(idx->tbl, itb_nbr, 0) < tim)) return 0;
+	return _blk_tak(_idx_lod_nbr(idx, 0));
+
+}
+
 /*
  * Unload @blk.
  */
@@ -953,11 +999,11 @@ tb_stg_blk *tb_stg_red_nxt(
 	}
 
 	/* Read the index table.
-	 * If next block is after end time, nothing to do. */
+	 * If next block starts after end time, nothing to do. */
 	const u64 itb_nbr = _itb_nbr(idx);
 	check(blk_nbr < itb_nbr);
 	const u64 nxt_nbr = blk_nbr + 1;
-	if (((nxt_nbr) == itb_nbr) || (end < _itb_blk_end(idx->tbl, itb_nbr, nxt_nbr))) {
+	if (((nxt_nbr) == itb_nbr) || (end < _itb_blk_stt(idx->tbl, itb_nbr, nxt_nbr))) {
 		return 0;
 	}
 
@@ -992,6 +1038,195 @@ u64 tb_blk_arr(
 	return nb;
 }
 
+/*****************
+ * Parallel scan *
+ *****************/
+
+/*
+ * Scan @wrk's block range.
+ */
+static u32 _scn_wrk(
+	tb_stg_scn_wrk *wrk
+)
+{
+
+	/* Open a private view of the index,
+	 * systems are not thread-safe. */
+	tb_stg_idx *src = wrk->idx;
+	tb_stg_sys *sys = assert(tb_stg_ctr(src->sys->pth, src->sys->tst));
+	tb_stg_idx *idx = assert(tb_stg_opn_sym(sys, src->mkp, src->ist, src->lvl, 0, 0));
+	const u8 arr_nbr = tb_lvl_arr_nbr(idx->lvl);
+	const u8 std = tb_lvl_rgn_nbr(idx->lvl) > 1;
+	const void *arrs[TB_ANB_MAX];
+
+	/* Load the predecessor of the first block if needed. */
+	tb_stg_blk *prv = 0;
+	if (std && wrk->blk_stt) {
+		prv = _blk_tak(_idx_lod_nbr(idx, wrk->blk_stt - 1));
+	}
+
+	/* Process all blocks. */
+	for (u64 blk_nbr = wrk->blk_stt; blk_nbr < wrk->blk_end; blk_nbr++) {
+		tb_stg_blk *blk = _blk_tak(_idx_lod_nbr(idx, blk_nbr));
+
+		/* Clip to the time range. */
+		const u8 *sizs = 0;
+		const u64 elm_nbr = tb_blk_arr(blk, arrs, arr_nbr, &sizs);
+		const u64 *tims = arrs[0];
+		assert(elm_nbr);
+		u64 elm_stt = 0;
+		if (tims[0] < wrk->stt) {
+			elm_stt = (wrk->stt <= tims[elm_nbr - 1]) ? tb_stg_elm_sch((u64 *) tims, elm_nbr, 0, wrk->stt) : elm_nbr;
+		}
+		u64 elm_end = elm_nbr;
+		while ((elm_end > elm_stt) && (tims[elm_end - 1] > wrk->end)) elm_end--;
+
+		/* Process. */
+		if (elm_stt != elm_end) {
+			tb_stg_shf(arrs, arrs, sizs, arr_nbr, elm_stt);
+			(*(wrk->blk_fnc))(wrk->ctx, arrs, elm_end - elm_stt, prv ? tb_stg_std(prv) : 0, wrk->arg);
+		}
+
+		/* Unmap the predecessor, keep @blk as the next one's. */
+		if (prv) {
+			_blk_rel(prv);
+			_blk_dtr(idx, prv);
+		}
+		if (std) {
+			prv = blk;
+		} else {
+			_blk_rel(blk);
+			_blk_dtr(idx, blk);
+		}
+
+	}
+
+	/* Cleanup. */
+	if (prv) {
+		_blk_rel(prv);
+		_blk_dtr(idx, prv);
+	}
+	tb_stg_cls(idx, 0);
+	tb_stg_dtr(sys);
+
+	/* Report completion. */
+	ns_atm(a64, inc_red, rel, wrk->don);
+	return 0;
+
+}
+
+/*
+ * Scan the elements of @idx in [@stt, @end] with
+ * @thr_nbr threads, the caller being one of them.
+ * The range is split at block boundaries in @thr_nbr
+ * contiguous block ranges, the n-th one being
+ * processed by the n-th worker.
+ * For each block, a worker calls @blk_fnc with its
+ * context, the block arrays clipped to the range, their
+ * number of elements, and if the level supports it and
+ * if it exists, the orderbook snapshot of the preceding
+ * block, so that it can reconstruct state without
+ * reading earlier blocks.
+ * Worker contexts are stored contiguously at @ctxs with
+ * a stride of @ctx_siz bytes and are initialized by
+ * the caller.
+ * Once all workers are done, if @red_fnc is set,
+ * contexts are reduced in order in the first one by
+ * calling @red_fnc(ctx_0, ctx_n, @arg) for n in
+ * [1, @thr_nbr[.
+ * Each worker reads through a private storage system,
+ * @idx's system is never accessed concurrently.
+ */
+void tb_stg_scn(
+	tb_stg_idx *idx,
+	u64 stt,
+	u64 end,
+	u8 thr_nbr,
+	void (*blk_fnc)(
+		void *ctx,
+		const void **arrs,
+		u64 elm_nbr,
+		const void *obs,
+		void *arg
+	),
+	void (*red_fnc)(
+		void *dst,
+		void *src,
+		void *arg
+	),
+	void *ctxs,
+	u64 ctx_siz,
+	void *arg
+)
+{
+	assert(thr_nbr);
+	assert(stt <= end);
+
+	/* Determine the block range [blk_stt, blk_end[. */
+	const u64 itb_nbr = _itb_nbr(idx);
+	u64 blk_stt = 0;
+	u64 blk_end = 0;
+	if (itb_nbr && (_itb_blk_stt(idx->tbl, itb_nbr, 0) <= end)) {
+		if (_itb_sch(idx, stt, &blk_stt)) {
+			blk_stt = (stt < _itb_blk_stt(idx->tbl, itb_nbr, 0)) ? 0 : itb_nbr;
+		}
+		if (_itb_sch(idx, end, &blk_end)) {
+			blk_end = itb_nbr;
+		} else {
+			blk_end += (_itb_blk_stt(idx->tbl, itb_nbr, blk_end) <= end);
+		}
+	}
+	if (blk_end < blk_stt) blk_end = blk_stt;
+	const u64 blk_nbr = blk_end - blk_stt;
+
+	/* Prepare worker descriptors, split blocks evenly. */
+	volatile a64 don = 0;
+	tb_stg_scn_wrk *wrks = nh_all(sizeof(tb_stg_scn_wrk) * thr_nbr);
+	u64 nxt = blk_stt;
+	for (u8 thr_id = 0; thr_id < thr_nbr; thr_id++) {
+		tb_stg_scn_wrk *wrk = wrks + thr_id;
+		const u64 nbr = (blk_nbr / thr_nbr) + (thr_id < (blk_nbr % thr_nbr));
+		wrk->idx = idx;
+		wrk->stt = stt;
+		wrk->end = end;
+		wrk->blk_stt = nxt;
+		wrk->blk_end = nxt = nxt + nbr;
+		wrk->blk_fnc = blk_fnc;
+		wrk->ctx = ns_psum(ctxs, ctx_siz * thr_id);
+		wrk->arg = arg;
+		wrk->don = &don;
+	}
+	assert(nxt == blk_end);
+
+	/* Run workers, execute the first one ourselves. */
+	u8 *thr_blk = nh_all(1024 * (uad) thr_nbr);
+	for (u8 thr_id = 1; thr_id < thr_nbr; thr_id++) {
+		assert(!nh_thr_run(
+			ns_psum(thr_blk, 1024 * (uad) thr_id),
+			1024,
+			0,
+			(u32 (*)(void *)) &_scn_wrk,
+			wrks + thr_id
+		));
+	}
+	_scn_wrk(wrks);
+
+	/* Wait for all workers. */
+	while (ns_atm(a64, red, acq, &don) != thr_nbr);
+
+	/* Reduce in order. */
+	if (red_fnc) {
+		for (u8 thr_id = 1; thr_id < thr_nbr; thr_id++) {
+			(*red_fnc)(ctxs, ns_psum(ctxs, ctx_siz * thr_id), arg);
+		}
+	}
+
+	/* Cleanup. */
+	nh_fre(thr_blk, 1024 * (uad) thr_nbr);
+	nh_fre(wrks, sizeof(tb_stg_scn_wrk) * thr_nbr);
+
+}
+
 /*************
  * Write API *
  *************/
@@ -1018,6 +1253,8 @@ void tb_stg_wrt(
 	void *val_arg
 )
 {
+	tb_stt_fnc(TB_STT_FNC_STG_WRT);
+	tb_stt_evt(TB_STT_EVT_STG_WRT, nb);
 	assert(idx->key, "not a writeable index.\n");
 
 	/* Fetch the index table. */
@@ -1105,3 +1342,337 @@ void tb_stg_wrt(
 	assert(itb_nbr == _itb_nbr(idx));
 
 }
+
+/***************
+ * Bulk import *
+ ***************/
+
+/*
+ * Fill @nbr elements of @sgm with input elements
+ * starting at @stt.
+ * Store the times of the first and last written
+ * elements at @timp.
+ */
+static inline void _sgm_fil(
+	tb_sgm *sgm,
+	u8 arr_nbr,
+	u64 stt,
+	u64 nbr,
+	void (*fil_fnc)(void **dsts, u64 stt, u64 nbr, void *fil_arg),
+	void *fil_arg,
+	u64 *timp
+)
+{
+	assert(nbr);
+	void *dsts[TB_ANB_MAX];
+	uad off = 0;
+	assert(!tb_sgm_wrt_get(sgm, &off));
+	tb_sgm_wrt_loc(sgm, nbr, dsts, arr_nbr);
+	(*fil_fnc)(dsts, stt, nbr, fil_arg);
+	const u64 *tims = dsts[0];
+	timp[0] = tims[0];
+	timp[1] = tims[nbr - 1];
+	tb_sgm_wrt_don(sgm, nbr);
+	tb_sgm_wrt_cpl(sgm);
+}
+
+/*
+ * Build @wrk's block range.
+ */
+static u32 _imp_wrk(
+	tb_stg_imp_wrk *wrk
+)
+{
+
+	/* Build through a private view of the index,
+	 * systems are not thread-safe. */
+	tb_stg_idx *src = wrk->idx;
+	tb_stg_sys *sys = assert(tb_stg_ctr(src->sys->pth, src->sys->tst));
+	tb_stg_idx *idx = assert(tb_stg_opn_sym(sys, src->mkp, src->ist, src->lvl, 0, 0));
+	const u8 arr_nbr = tb_lvl_arr_nbr(idx->lvl);
+	const u64 blk_len = tb_lvl_blk_len(sys->tst, idx->lvl);
+
+	/* Build blocks. */
+	for (u64 blk_id = wrk->blk_stt; blk_id < wrk->blk_end; blk_id++) {
+
+		/* Determine the input range. */
+		const u64 elm_stt = wrk->elm_fst + blk_id * blk_len;
+		assert(elm_stt < wrk->elm_nbr);
+		const u64 elm_nbr = ((wrk->elm_nbr - elm_stt) < blk_len) ? (wrk->elm_nbr - elm_stt) : blk_len;
+
+		/* Create, fill and unmap the block. */
+		tb_stg_blk *blk = _blk_ctr_lod(1, idx, wrk->blk_fst + blk_id);
+		assert(!tb_sgm_elm_nbr(blk->sgm), "block %U already populated.\n", wrk->blk_fst + blk_id);
+		_sgm_fil(blk->sgm, arr_nbr, elm_stt, elm_nbr, wrk->fil_fnc, wrk->fil_arg, wrk->tims[blk_id]);
+		assert(wrk->tims[blk_id][0] <= wrk->tims[blk_id][1]);
+		_blk_dtr(idx, blk);
+
+	}
+
+	/* Cleanup. */
+	tb_stg_cls(idx, 0);
+	tb_stg_dtr(sys);
+
+	/* Report completion. */
+	ns_atm(a64, inc_red, rel, wrk->don);
+	return 0;
+
+}
+
+/*
+ * Bulk data import.
+ * Append @nb input elements to @idx.
+ * The current last block is completed first, then the
+ * remaining elements are written in new blocks built
+ * in parallel by @thr_nbr threads, the caller being
+ * one of them.
+ * Built blocks are then published in order in the index
+ * table, and full ones are validated in order.
+ */
+void tb_stg_imp(
+	tb_stg_idx *idx,
+	u64 nb,
+	u8 thr_nbr,
+	void (*fil_fnc)(
+		void **dsts,
+		u64 stt,
+		u64 nbr,
+		void *fil_arg
+	),
+	void *fil_arg,
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg),
+	void *val_arg
+)
+{
+	assert(idx->key, "not a writeable index.\n");
+	assert(thr_nbr);
+	if (!nb) return;
+
+	/* Fetch the index table. */
+	const u64 itb_max = tb_lvl_idx_siz(idx->sys->tst, idx->lvl);
+	u64 itb_nbr = _itb_nbr(idx);
+	volatile u64 (*tbl)[2] = idx->tbl;
+	const u8 arr_nbr = tb_lvl_arr_nbr(idx->lvl);
+	const u64 blk_len = tb_lvl_blk_len(idx->sys->tst, idx->lvl);
+	u64 prv_end = (itb_nbr) ? _itb_blk_end(tbl, itb_nbr, itb_nbr - 1) : 0;
+
+	/* Complete the last block if it is not full. */
+	u64 elm_fst = 0;
+	tb_stg_blk *lst = _idx_lst(idx);
+	if (lst) {
+		const u64 avl = tb_sgm_elm_max(lst->sgm) - tb_sgm_elm_nbr(lst->sgm);
+		if (avl) {
+			u64 tims[2];
+			elm_fst = (nb < avl) ? nb : avl;
+			_sgm_fil(lst->sgm, arr_nbr, 0, elm_fst, fil_fnc, fil_arg, tims);
+			assert(prv_end <= tims[0], "unsorted import.\n");
+			_itb_blk_end_set(tbl, itb_nbr, itb_nbr - 1, prv_end = tims[1]);
+			if (elm_fst == avl) _blk_val(idx, lst, val_fnc, val_arg);
+		}
+	}
+
+	/* Determine the number of blocks to build. */
+	const u64 rem = nb - elm_fst;
+	const u64 blk_nbr = (rem + blk_len - 1) / blk_len;
+	assert(itb_nbr + blk_nbr <= itb_max, "index table full.\n");
+	if (!blk_nbr) return;
+
+	/* Prepare worker descriptors, split blocks evenly. */
+	volatile a64 don = 0;
+	u64 (*tims)[2] = nh_all(blk_nbr * sizeof(u64 [2]));
+	tb_stg_imp_wrk *wrks = nh_all(sizeof(tb_stg_imp_wrk) * thr_nbr);
+	u64 nxt = 0;
+	for (u8 thr_id = 0; thr_id < thr_nbr; thr_id++) {
+		tb_stg_imp_wrk *wrk = wrks + thr_id;
+		const u64 nbr = (blk_nbr / thr_nbr) + (thr_id < (blk_nbr % thr_nbr));
+		wrk->idx = idx;
+		wrk->blk_stt = nxt;
+		wrk->blk_end = nxt = nxt + nbr;
+		wrk->blk_fst = itb_nbr;
+		wrk->elm_fst = elm_fst;
+		wrk->elm_nbr = nb;
+		wrk->fil_fnc = fil_fnc;
+		wrk->fil_arg = fil_arg;
+		wrk->tims = tims;
+		wrk->don = &don;
+	}
+	assert(nxt == blk_nbr);
+
+	/* Build blocks, execute the first worker ourselves. */
+	u8 *thr_blk = nh_all(1024 * (uad) thr_nbr);
+	for (u8 thr_id = 1; thr_id < thr_nbr; thr_id++) {
+		assert(!nh_thr_run(
+			ns_psum(thr_blk, 1024 * (uad) thr_id),
+			1024,
+			0,
+			(u32 (*)(void *)) &_imp_wrk,
+			wrks + thr_id
+		));
+	}
+	_imp_wrk(wrks);
+	while (ns_atm(a64, red, acq, &don) != thr_nbr);
+	nh_fre(thr_blk, 1024 * (uad) thr_nbr);
+	nh_fre(wrks, sizeof(tb_stg_imp_wrk) * thr_nbr);
+
+	/* Publish blocks in order, validate full ones.
+	 * Unmap validated blocks once their successor
+	 * does not need them anymore. */
+	tb_stg_blk *prv = 0;
+	for (u64 blk_id = 0; blk_id < blk_nbr; blk_id++) {
+		assert(prv_end <= tims[blk_id][0], "unsorted import.\n");
+		_itb_blk_stt_set(tbl, itb_nbr + 1, itb_nbr, tims[blk_id][0]);
+		_itb_blk_end_set(tbl, itb_nbr + 1, itb_nbr, prv_end = tims[blk_id][1]);
+		const uad itb_nxt = tb_sgm_wrt_don(idx->sgm, 1);
+		assert(itb_nxt == itb_nbr + 1);
+		itb_nbr = itb_nxt;
+		tb_stg_blk *blk = _blk_tak(_idx_lod_nbr(idx, itb_nbr - 1));
+		if (tb_sgm_elm_nbr(blk->sgm) == tb_sgm_elm_max(blk->sgm)) {
+			_blk_val(idx, blk, val_fnc, val_arg);
+		}
+		if (prv) {
+			_blk_rel(prv);
+			if (!prv->uctr) _blk_dtr(idx, prv);
+		}
+		prv = blk;
+	}
+	_blk_rel(prv);
+
+	/* Cleanup. */
+	nh_fre(tims, blk_nbr * sizeof(u64 [2]));
+	assert(itb_nbr == _itb_nbr(idx));
+
+}
+
+/************
+ * Recovery *
+ ************/
+
+/*
+ * Recover @blk's write privilege and release it.
+ */
+static inline void _blk_rcv(
+	tb_stg_blk *blk
+)
+{
+	uad off = 0;
+	const uerr err = tb_sgm_wrt_rcv(blk->sgm, &off);
+	assert(!err, "block write privilege held by a live process.\n");
+	tb_sgm_wrt_cpl(blk->sgm);
+}
+
+/*
+ * Drop all elements of the unpublished block @blk,
+ * and reset its validation state.
+ */
+static inline void _blk_rst(
+	tb_stg_blk *blk
+)
+{
+	uad off = 0;
+	assert(!tb_sgm_wrt_get(blk->sgm, &off));
+	tb_sgm_wrt_rst(blk->sgm);
+	ns_atm(a64, wrt, rel, &blk->syn->scd_ini, 0);
+	ns_atm(a64, wrt, rel, &blk->syn->scd_wip, 0);
+	tb_sgm_wrt_cpl(blk->sgm);
+}
+
+/*
+ * Store the times of @blk's first and last elements
+ * at @sttp and @endp, return its number of elements.
+ */
+static inline u64 _blk_rng(
+	tb_stg_blk *blk,
+	u64 *sttp,
+	u64 *endp
+)
+{
+	const void *arrs[TB_ANB_MAX];
+	const u8 *sizs = 0;
+	const u64 elm_nbr = tb_blk_arr(blk, arrs, tb_lvl_arr_nbr(blk->idx->lvl), &sizs);
+	if (!elm_nbr) return 0;
+	*sttp = _dat_tim(blk->idx->lvl, arrs, 0);
+	*endp = _dat_tim(blk->idx->lvl, arrs, elm_nbr - 1);
+	return elm_nbr;
+}
+
+/*
+ * Recover @idx after its previous writer died.
+ * Recover write privileges of its blocks, reconcile the
+ * index table with the blocks' data, publish blocks that
+ * were written but not reported, reset those that can't
+ * be, and redo interrupted validations.
+ * @idx must be opened with write privileges.
+ */
+void tb_stg_rcv(
+	tb_stg_idx *idx,
+	void (*val_fnc)(tb_stg_blk *blk, tb_stg_blk *prv, void *val_arg),
+	void *val_arg
+)
+{
+	assert(idx->key, "not a writeable index.\n");
+	tb_stg_sys *sys = idx->sys;
+	const u64 itb_max = tb_lvl_idx_siz(sys->tst, idx->lvl);
+	assert(itb_max == tb_sgm_elm_max(idx->sgm));
+	volatile u64 (*tbl)[2] = idx->tbl;
+	u64 itb_nbr = _itb_nbr(idx);
+	u64 stt = 0;
+	u64 end = 0;
+
+	/* The writer may have died after writing in the last
+	 * block and before reporting its end : reconcile it.
+	 * Blocks are only published with data. */
+	u8 pub = 1;
+	u64 prv_end = 0;
+	if (itb_nbr) {
+		tb_stg_blk *blk = _idx_lst(idx);
+		_blk_rcv(blk);
+		assert(_blk_rng(blk, &stt, &end));
+		_itb_blk_end_set(tbl, itb_nbr, itb_nbr - 1, end);
+		pub = (tb_sgm_elm_nbr(blk->sgm) == tb_sgm_elm_max(blk->sgm));
+		prv_end = end;
+	}
+
+	/* The writer may have died after writing blocks
+	 * and before publishing them. Publish them in order
+	 * while their predecessor is full. Reset the others,
+	 * as they would be reused by the next writes. */
+	nh_stt fst;
+	for (u64 blk_nbr = itb_nbr; blk_nbr < itb_max; blk_nbr++) {
+		if (nh_fs_ftst(NH_FIL_TYP_STM, 0, &fst, "%s/%s/%s/%u/%U", sys->pth, tb_sym_str(idx->mkp), tb_sym_str(idx->ist), idx->lvl, blk_nbr)) break;
+		tb_stg_blk *blk = _idx_lod_nbr(idx, blk_nbr);
+		_blk_rcv(blk);
+		const u64 elm_nbr = _blk_rng(blk, &stt, &end);
+		if (pub && elm_nbr && (prv_end <= stt)) {
+			_itb_blk_stt_set(tbl, itb_nbr + 1, itb_nbr, stt);
+			_itb_blk_end_set(tbl, itb_nbr + 1, itb_nbr, end);
+			itb_nbr = tb_sgm_wrt_don(idx->sgm, 1);
+			assert(itb_nbr == blk_nbr + 1);
+			pub = (elm_nbr == tb_sgm_elm_max(blk->sgm));
+			prv_end = end;
+		} else {
+			_blk_rst(blk);
+			pub = 0;
+			if (!blk->uctr) _blk_dtr(idx, blk);
+		}
+	}
+
+	/* Full blocks are validated in order : find the
+	 * first one whose validation did not complete. */
+	u64 val_stt = itb_nbr;
+	while (val_stt) {
+		tb_stg_blk *blk = _idx_lod_nbr(idx, val_stt - 1);
+		const u8 ful = (tb_sgm_elm_nbr(blk->sgm) == tb_sgm_elm_max(blk->sgm));
+		if (ful && ns_atm(a64, red, acq, &blk->syn->scd_ini)) break;
+		val_stt--;
+	}
+
+	/* Redo validations. A validation may have been
+	 * interrupted, release its ownership first. */
+	for (u64 blk_nbr = val_stt; blk_nbr < itb_nbr; blk_nbr++) {
+		tb_stg_blk *blk = _idx_lod_nbr(idx, blk_nbr);
+		if (tb_sgm_elm_nbr(blk->sgm) != tb_sgm_elm_max(blk->sgm)) continue;
+		ns_atm(a64, wrt, rel, &blk->syn->scd_wip, 0);
+		_blk_val(idx, blk, val_fnc, val_arg);
+	}
+
+}
@@ -0,0 +1,447 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/* Hardware counters require the libc. */
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* The monotonic clock requires the libc. */
+#include <time.h>
+
+/*********
+ * State *
+ *********/
+
+/* Private set. */
+static tb_stt_set _stt_set_loc = {.ver = TB_STT_VER};
+
+/* Current set. */
+tb_stt_set *tb_stt_set_cur = &_stt_set_loc;
+
+/* Generation of the current set. */
+volatile a64 tb_stt_gen = 1;
+
+/* Page of the calling thread and its generation. */
+__thread tb_stt_pag *tb_stt_thr_pag = 0;
+__thread u64 tb_stt_thr_gen = 0;
+
+/* Exported set segment. */
+static tb_sgm *_stt_sgm = 0;
+
+/* Hardware counters file descriptors of the calling
+ * thread, -1 if not opened. */
+static __thread int _stt_hwc_fds[TB_STT_HWC_NBR] = {
+	[0 ... TB_STT_HWC_NBR - 1] = -1
+};
+
+/* Names. */
+static const char *_stt_evt_nams[TB_STT_EVT_NBR] = {
+	[TB_STT_EVT_LV1_UPD] = "lv1_upd",
+	[TB_STT_EVT_LV1_ROW] = "lv1_row",
+	[TB_STT_EVT_LV1_IDL] = "lv1_idl",
+	[TB_STT_EVT_LV1_RNC] = "lv1_rnc",
+	[TB_STT_EVT_STG_LOD] = "stg_lod",
+	[TB_STT_EVT_STG_WRT] = "stg_wrt",
+};
+static const char *_stt_fnc_nams[TB_STT_FNC_NBR] = {
+	[TB_STT_FNC_LV1_ADD] = "tb_lv1_add",
+	[TB_STT_FNC_LV1_PRC] = "tb_lv1_prc",
+	[TB_STT_FNC_LV1_CLN] = "tb_lv1_cln",
+	[TB_STT_FNC_DR1_ADD] = "tb_dr1_add",
+	[TB_STT_FNC_STG_WRT] = "tb_stg_wrt",
+};
+static const char *_stt_hwc_nams[TB_STT_HWC_NBR] = {
+	[TB_STT_HWC_CYC] = "cycles",
+	[TB_STT_HWC_INS] = "instructions",
+	[TB_STT_HWC_CMS] = "cache_misses",
+	[TB_STT_HWC_PGF] = "page_faults",
+};
+static const char *_stt_lat_nams[TB_STT_LAT_NBR] = {
+	[TB_STT_LAT_DSC] = "wrt_to_dsc",
+	[TB_STT_LAT_ADD] = "wrt_to_add",
+	[TB_STT_LAT_HMP] = "wrt_to_hmp",
+};
+
+/*************
+ * Internals *
+ *************/
+
+/*
+ * Open the stats segment at @pth, create it if @crt
+ * is set.
+ */
+static inline tb_sgm *_sgm_opn(
+	u8 crt,
+	const char *pth
+)
+{
+	u64 ver = TB_STT_VER;
+	return tb_sgm_fopn(
+		crt,
+		&ver,
+		sizeof(u64),
+		1,
+		(u64 []) {sizeof(tb_stt_set)},
+		0,
+		0,
+		0,
+		"%s", pth
+	);
+}
+
+/*
+ * Make @set the current set.
+ * Threads claim a page of it on their next update.
+ */
+static inline void _set_use(
+	tb_stt_set *set
+)
+{
+	tb_stt_set_cur = set;
+	ns_atm(a64, add_red, rel, &tb_stt_gen, 1);
+}
+
+/*
+ * Add the counters of @src to @dst.
+ */
+static inline void _pag_add(
+	tb_stt_pag *dst,
+	const tb_stt_pag *src
+)
+{
+	for (u8 evt_id = 0; evt_id < TB_STT_EVT_NBR; evt_id++) {
+		dst->evts[evt_id] += ns_atm(a64, red, acq, &src->evts[evt_id]);
+	}
+	for (u8 fnc_id = 0; fnc_id < TB_STT_FNC_NBR; fnc_id++) {
+		tb_stt_fnc *fnc_dst = dst->fncs + fnc_id;
+		const tb_stt_fnc *fnc_src = src->fncs + fnc_id;
+		fnc_dst->cal += ns_atm(a64, red, acq, &fnc_src->cal);
+		fnc_dst->cyc += ns_atm(a64, red, acq, &fnc_src->cyc);
+		for (u8 hwc_id = 0; hwc_id < TB_STT_HWC_NBR; hwc_id++) {
+			fnc_dst->hwcs[hwc_id] += ns_atm(a64, red, acq, &fnc_src->hwcs[hwc_id]);
+		}
+	}
+	for (u8 lat_id = 0; lat_id < TB_STT_LAT_NBR; lat_id++) {
+		tb_stt_lat *lat_dst = dst->lats + lat_id;
+		const tb_stt_lat *lat_src = src->lats + lat_id;
+		lat_dst->cnt += ns_atm(a64, red, acq, &lat_src->cnt);
+		lat_dst->sum += ns_atm(a64, red, acq, &lat_src->sum);
+		for (u64 bkt = 0; bkt < TB_STT_LAT_BKT_NBR; bkt++) {
+			lat_dst->bkts[bkt] += ns_atm(a64, red, acq, &lat_src->bkts[bkt]);
+		}
+	}
+}
+
+/*
+ * Read the hardware counters of the calling thread
+ * in @hwcs.
+ */
+static inline void _hwc_red(
+	u64 *hwcs
+)
+{
+	for (u8 hwc_id = 0; hwc_id < TB_STT_HWC_NBR; hwc_id++) {
+		if (read(_stt_hwc_fds[hwc_id], hwcs + hwc_id, sizeof(u64)) != sizeof(u64))
+			hwcs[hwc_id] = 0;
+	}
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Export stats in a shared segment at @pth, creating
+ * it if needed.
+ * Counters are reset.
+ * Must not be called while instrumented functions run.
+ */
+void tb_stt_exp(
+	const char *pth
+)
+{
+	assert(!_stt_sgm, "stats already exported.\n");
+	_stt_sgm = _sgm_opn(1, pth);
+	assert(_stt_sgm, "stats segment %s open failed.\n", pth);
+	tb_stt_set *set = tb_sgm_rgn(_stt_sgm, 0);
+	ns_mem_rst(set, sizeof(tb_stt_set));
+	ns_atm(a64, wrt, rel, &set->ver, TB_STT_VER);
+	_set_use(set);
+}
+
+/*
+ * Stop exporting stats, use a private set again.
+ * Must not be called while instrumented functions run.
+ */
+void tb_stt_ump(
+	void
+)
+{
+	assert(_stt_sgm, "stats not exported.\n");
+	_set_use(&_stt_set_loc);
+	tb_sgm_cls(_stt_sgm);
+	_stt_sgm = 0;
+}
+
+/*
+ * Open the stats set exported at @pth for reading,
+ * store its segment at @sgmp, and return it.
+ * If it does not exist, return 0.
+ */
+const tb_stt_set *tb_stt_opn(
+	const char *pth,
+	tb_sgm **sgmp
+)
+{
+	nh_stt stt;
+	if (nh_fs_tst(NH_FIL_TYP_STM, 0, &stt, pth)) return 0;
+	tb_sgm *sgm = *sgmp = _sgm_opn(0, pth);
+	return tb_sgm_rgn(sgm, 0);
+}
+
+/*
+ * Store at @dst the sum of the pages of @set.
+ */
+void tb_stt_sum(
+	tb_stt_pag *dst,
+	const tb_stt_set *set
+)
+{
+	ns_mem_rst(dst, sizeof(tb_stt_pag));
+	u64 pag_nbr = ns_atm(a64, red, acq, &set->clm_nbr);
+	if (pag_nbr > TB_STT_PAG_NBR) pag_nbr = TB_STT_PAG_NBR;
+	for (u64 pag_id = 0; pag_id < pag_nbr; pag_id++) {
+		_pag_add(dst, set->pags + pag_id);
+	}
+}
+
+/*
+ * Claim a page of the current set for the calling
+ * thread and return it.
+ */
+tb_stt_pag *tb_stt_pag_clm(
+	void
+)
+{
+	const u64 gen = ns_atm(a64, red, acq, &tb_stt_gen);
+	tb_stt_set *set = tb_stt_set_cur;
+	const u64 pag_id = ns_atm(a64, add_red, aar, &set->clm_nbr, 1) - 1;
+	tb_stt_thr_pag = set->pags + (pag_id % TB_STT_PAG_NBR);
+	tb_stt_thr_gen = gen;
+	return tb_stt_thr_pag;
+}
+
+/*
+ * Open hardware counters for the calling thread.
+ * If not supported or not permitted, return 1.
+ * Otherwise, return 0.
+ */
+uerr tb_stt_hwc_opn(
+	void
+)
+{
+	assert(_stt_hwc_fds[0] < 0, "hardware counters already opened.\n");
+	const u32 typs[TB_STT_HWC_NBR] = {
+		[TB_STT_HWC_CYC] = PERF_TYPE_HARDWARE,
+		[TB_STT_HWC_INS] = PERF_TYPE_HARDWARE,
+		[TB_STT_HWC_CMS] = PERF_TYPE_HARDWARE,
+		[TB_STT_HWC_PGF] = PERF_TYPE_SOFTWARE,
+	};
+	const u64 cfgs[TB_STT_HWC_NBR] = {
+		[TB_STT_HWC_CYC] = PERF_COUNT_HW_CPU_CYCLES,
+		[TB_STT_HWC_INS] = PERF_COUNT_HW_INSTRUCTIONS,
+		[TB_STT_HWC_CMS] = PERF_COUNT_HW_CACHE_MISSES,
+		[TB_STT_HWC_PGF] = PERF_COUNT_SW_PAGE_FAULTS,
+	};
+	for (u8 hwc_id = 0; hwc_id < TB_STT_HWC_NBR; hwc_id++) {
+
+		/* Count user space events of the calling thread
+		 * on any cpu. */
+		struct perf_event_attr att;
+		ns_mem_rst(&att, sizeof(att));
+		att.size = sizeof(att);
+		att.type = typs[hwc_id];
+		att.config = cfgs[hwc_id];
+		att.exclude_kernel = 1;
+		att.exclude_hv = 1;
+		const long fd = syscall(SYS_perf_event_open, &att, 0, -1, -1, 0);
+
+		/* On error, close what was opened. */
+		if (fd < 0) {
+			debug("perf_event_open failed for %s.\n", _stt_hwc_nams[hwc_id]);
+			tb_stt_hwc_cls();
+			return 1;
+		}
+		_stt_hwc_fds[hwc_id] = (int) fd;
+
+	}
+	return 0;
+}
+
+/*
+ * Close the hardware counters of the calling thread.
+ */
+void tb_stt_hwc_cls(
+	void
+)
+{
+	for (u8 hwc_id = 0; hwc_id < TB_STT_HWC_NBR; hwc_id++) {
+		if (_stt_hwc_fds[hwc_id] >= 0) close(_stt_hwc_fds[hwc_id]);
+		_stt_hwc_fds[hwc_id] = -1;
+	}
+}
+
+/*
+ * Return the name of event @evt.
+ */
+const char *tb_stt_evt_nam(
+	u8 evt
+)
+{
+	assert(evt < TB_STT_EVT_NBR);
+	return _stt_evt_nams[evt];
+}
+
+/*
+ * Return the name of function @fnc.
+ */
+const char *tb_stt_fnc_nam(
+	u8 fnc
+)
+{
+	assert(fnc < TB_STT_FNC_NBR);
+	return _stt_fnc_nams[fnc];
+}
+
+/*
+ * Return the name of hardware counter @hwc.
+ */
+const char *tb_stt_hwc_nam(
+	u8 hwc
+)
+{
+	assert(hwc < TB_STT_HWC_NBR);
+	return _stt_hwc_nams[hwc];
+}
+
+/*
+ * Return the name of latency @lat.
+ */
+const char *tb_stt_lat_nam(
+	u8 lat
+)
+{
+	assert(lat < TB_STT_LAT_NBR);
+	return _stt_lat_nams[lat];
+}
+
+/*
+ * Return the current time of the system monotonic
+ * clock in nanoseconds.
+ */
+u64 tb_stt_tim(
+	void
+)
+{
+	struct timespec ts;
+	assert(!clock_gettime(CLOCK_MONOTONIC, &ts));
+	return (u64) ts.tv_sec * 1000000000 + (u64) ts.tv_nsec;
+}
+
+/*
+ * Record in latency @lat the time elapsed since @stt.
+ */
+void tb_stt_lat_add(
+	u8 lat,
+	u64 stt
+)
+{
+	check(lat < TB_STT_LAT_NBR);
+
+	/* Drop timestamps from the future, or from another
+	 * boot. */
+	const u64 tim = tb_stt_tim();
+	if (tim < stt) return;
+	const u64 val = tim - stt;
+
+	/* Record. */
+	tb_stt_lat *dst = tb_stt_pag_get()->lats + lat;
+	ns_atm(a64, add_red, rel, &dst->bkts[tb_stt_lat_bkt(val)], 1);
+	ns_atm(a64, add_red, rel, &dst->sum, val);
+	ns_atm(a64, add_red, rel, &dst->cnt, 1);
+
+}
+
+/*
+ * Return the smallest latency bound under which lie
+ * at least @num / @den of @lat's samples, 0 if no
+ * samples.
+ */
+u64 tb_stt_lat_pct(
+	const tb_stt_lat *lat,
+	u64 num,
+	u64 den
+)
+{
+	assert(num <= den);
+	assert(den);
+
+	/* Count samples, buckets may be updated concurrently. */
+	u64 cnt = 0;
+	for (u64 bkt = 0; bkt < TB_STT_LAT_BKT_NBR; bkt++) {
+		cnt += ns_atm(a64, red, acq, &lat->bkts[bkt]);
+	}
+	if (!cnt) return 0;
+
+	/* Find the bucket that contains the rank, report
+	 * its upper bound. */
+	const u64 rnk = (cnt * num + den - 1) / den;
+	u64 cum = 0;
+	for (u64 bkt = 0; bkt < TB_STT_LAT_BKT_NBR - 1; bkt++) {
+		cum += ns_atm(a64, red, acq, &lat->bkts[bkt]);
+		if (cum >= rnk) return tb_stt_lat_low(bkt + 1);
+	}
+	return (u64) -1;
+
+}
+
+/*
+ * Start a call of function @fnc and return its scope.
+ */
+tb_stt_scp tb_stt_scp_stt(
+	u8 fnc
+)
+{
+	check(fnc < TB_STT_FNC_NBR);
+	tb_stt_scp scp;
+	scp.fnc = fnc;
+	scp.hwc = (_stt_hwc_fds[TB_STT_HWC_NBR - 1] >= 0);
+	if (scp.hwc) _hwc_red(scp.hwcs);
+
+	/* Read cycles last, so that the hardware counters
+	 * read is not accounted. */
+	scp.cyc = tb_stt_cyc();
+	return scp;
+}
+
+/*
+ * Complete the call of @scp.
+ */
+void tb_stt_scp_end(
+	tb_stt_scp *scp
+)
+{
+	const u64 cyc = tb_stt_cyc();
+	tb_stt_fnc *fnc = tb_stt_pag_get()->fncs + scp->fnc;
+	ns_atm(a64, add_red, rel, &fnc->cal, 1);
+	ns_atm(a64, add_red, rel, &fnc->cyc, cyc - scp->cyc);
+	if (scp->hwc) {
+		u64 hwcs[TB_STT_HWC_NBR];
+		_hwc_red(hwcs);
+		for (u8 hwc_id = 0; hwc_id < TB_STT_HWC_NBR; hwc_id++) {
+			ns_atm(a64, add_red, rel, &fnc->hwcs[hwc_id], hwcs[hwc_id] - scp->hwcs[hwc_id]);
+		}
+	}
+}
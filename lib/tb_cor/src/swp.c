@@ -0,0 +1,267 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*************
+ * Internals *
+ *************/
+
+/*
+ * Settle the complete or cancelled orders of instance
+ * @ins of @swp in its wallet, in passing order.
+ * Keep the others, compacted.
+ */
+static inline void _ins_stl(
+	tb_swp *swp,
+	u32 ins
+)
+{
+	tb_bks *bks = ns_cnt_of(swp->bkrs[ins], tb_bks, bkr);
+	tb_swp_opn *opn = swp->opns + ins;
+	u64 *idxs = opn->idxs;
+	const u64 nbr = opn->nbr;
+	u64 kep = 0;
+	for (u64 opn_id = 0; opn_id < nbr; opn_id++) {
+		const u64 idx = idxs[opn_id];
+		const tb_ord *ord = &bks->ords[idx].ord;
+		if ((ord->sts != TB_ORD_STS_CPL) && (ord->sts != TB_ORD_STS_CCL)) {
+			idxs[kep++] = idx;
+			continue;
+		}
+
+		/* Collection returns what a cancelled order
+		 * did not use. */
+		assert(!tb_wlt_ord_res_col(swp->wlts[ins], ord));
+
+	}
+	opn->nbr = kep;
+}
+
+
+/*
+ * Advance the instances of @wrk to the current time.
+ */
+static inline void _wrk_stp(
+	tb_swp_wrk *wrk
+)
+{
+	tb_swp *swp = wrk->swp;
+	const u64 tim = swp->tim;
+	for (u32 ins = wrk->ins_stt; ins < wrk->ins_end; ins++) {
+		spb_bkr_tim_set(swp->bkrs[ins], tim);
+		_ins_stl(swp, ins);
+	}
+	if (wrk->ins_stt < wrk->ins_end) {
+		(*(swp->stp_fnc))(swp, wrk->ins_stt, wrk->ins_end, tim, swp->arg);
+	}
+}
+
+/*
+ * Worker thread, run a step at each generation until
+ * stopped.
+ */
+static u32 _wrk_thr(
+	tb_swp_wrk *wrk
+)
+{
+	tb_swp *swp = wrk->swp;
+	u64 gen = 0;
+	while (1) {
+		u64 cur;
+		while ((cur = ns_atm(a64, red, acq, &swp->gen)) == gen);
+		if (cur == TB_SWP_GEN_STP) break;
+		gen = cur;
+		_wrk_stp(wrk);
+		ns_atm(a64, add_red, rel, &swp->don, 1);
+	}
+	ns_atm(a64, add_red, rel, &swp->don, 1);
+	return 0;
+}
+
+/*
+ * Publish generation @gen to the workers of @swp,
+ * run the first worker, and wait for the others.
+ */
+static inline void _swp_gen(
+	tb_swp *swp,
+	u64 gen
+)
+{
+	ns_atm(a64, wrt, rel, &swp->don, 0);
+	ns_atm(a64, wrt, rel, &swp->gen, gen);
+	if (gen != TB_SWP_GEN_STP) _wrk_stp(swp->wrks);
+	while (ns_atm(a64, red, acq, &swp->don) != (u64) (swp->thr_nbr - 1));
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a sweep runner of @ins_nbr
+ * instances replaying @dr1 from its current time.
+ * Each instance has @prm_nbr null parameters, @stt_nbr
+ * null state variables, an empty wallet and a simulation
+ * broker of tick size @tck_siz, latency @lat and at most
+ * @ord_max orders.
+ * Instances are advanced by @thr_nbr threads, including
+ * the caller, calling @stp_fnc at each step.
+ */
+tb_swp *tb_swp_ctr(
+	tb_dr1 *dr1,
+	u32 ins_nbr,
+	u32 prm_nbr,
+	u32 stt_nbr,
+	f64 tck_siz,
+	u64 lat,
+	u64 ord_max,
+	u8 thr_nbr,
+	void (*stp_fnc)(
+		tb_swp *swp,
+		u32 ins_stt,
+		u32 ins_end,
+		u64 tim,
+		void *arg
+	),
+	void *arg
+)
+{
+	assert(ins_nbr);
+	assert(thr_nbr);
+	nh_all__(tb_swp, swp);
+	swp->dr1 = dr1;
+	swp->ins_nbr = ins_nbr;
+	const u32 row_siz = swp->row_siz = (ins_nbr + TB_SWP_BAT_NB - 1) & ~(u32) (TB_SWP_BAT_NB - 1);
+	swp->prm_nbr = prm_nbr;
+	swp->stt_nbr = stt_nbr;
+	swp->ord_max = ord_max;
+	swp->stp_fnc = stp_fnc;
+	swp->arg = arg;
+	swp->tim = dr1->hst->tim_cur;
+
+	/* Parameters and states. */
+	swp->prms = nh_all(sizeof(f64) * row_siz * (prm_nbr + 1));
+	swp->stts = nh_all(sizeof(f64) * row_siz * (stt_nbr + 1));
+	ns_mem_rst(swp->prms, sizeof(f64) * row_siz * prm_nbr);
+	ns_mem_rst(swp->stts, sizeof(f64) * row_siz * stt_nbr);
+
+	/* Instances. */
+	swp->wlts = nh_all(sizeof(tb_wlt *) * ins_nbr);
+	swp->bkrs = nh_all(sizeof(spb_bkr *) * ins_nbr);
+	swp->opns = nh_all(sizeof(tb_swp_opn) * ins_nbr);
+	for (u32 ins = 0; ins < ins_nbr; ins++) {
+		swp->wlts[ins] = tb_wlt_ctr();
+		swp->bkrs[ins] = tb_bks_ctr(dr1->hst, tck_siz, lat, ord_max);
+		spb_bkr_tim_rst(swp->bkrs[ins], swp->tim);
+		tb_swp_opn *opn = swp->opns + ins;
+		opn->idxs = nh_all(sizeof(u64) * ord_max);
+		opn->nbr = 0;
+	}
+
+	/* Split instances in ranges of whole batches. */
+	swp->thr_nbr = thr_nbr;
+	swp->wrks = nh_all(sizeof(tb_swp_wrk) * thr_nbr);
+	const u32 bat_nbr = row_siz / TB_SWP_BAT_NB;
+	u32 nxt = 0;
+	for (u8 thr_id = 0; thr_id < thr_nbr; thr_id++) {
+		tb_swp_wrk *wrk = swp->wrks + thr_id;
+		const u32 nbr = ((bat_nbr / thr_nbr) + (thr_id < (bat_nbr % thr_nbr))) * TB_SWP_BAT_NB;
+		wrk->swp = swp;
+		wrk->ins_stt = (nxt < ins_nbr) ? nxt : ins_nbr;
+		nxt += nbr;
+		wrk->ins_end = (nxt < ins_nbr) ? nxt : ins_nbr;
+	}
+	check(nxt == row_siz);
+
+	/* Start workers, the first one being the caller. */
+	swp->gen = 0;
+	swp->don = 0;
+	swp->thr_blk = nh_all(1024 * (uad) thr_nbr);
+	for (u8 thr_id = 1; thr_id < thr_nbr; thr_id++) {
+		assert(!nh_thr_run(
+			ns_psum(swp->thr_blk, 1024 * (uad) thr_id),
+			1024,
+			0,
+			(u32 (*)(void *)) &_wrk_thr,
+			swp->wrks + thr_id
+		));
+	}
+	return swp;
+
+}
+
+/*
+ * Stop the workers of @swp and delete it.
+ * The replay is not deleted.
+ */
+void tb_swp_dtr(
+	tb_swp *swp
+)
+{
+	_swp_gen(swp, TB_SWP_GEN_STP);
+	const u32 ins_nbr = swp->ins_nbr;
+	const u32 row_siz = swp->row_siz;
+	for (u32 ins = 0; ins < ins_nbr; ins++) {
+		tb_wlt_dtr(swp->wlts[ins]);
+		spb_bkr_dtor(swp->bkrs[ins]);
+		nh_fre(swp->opns[ins].idxs, sizeof(u64) * swp->ord_max);
+	}
+	nh_fre(swp->thr_blk, 1024 * (uad) swp->thr_nbr);
+	nh_fre(swp->wrks, sizeof(tb_swp_wrk) * swp->thr_nbr);
+	nh_fre(swp->wlts, sizeof(tb_wlt *) * ins_nbr);
+	nh_fre(swp->bkrs, sizeof(spb_bkr *) * ins_nbr);
+	nh_fre(swp->opns, sizeof(tb_swp_opn) * ins_nbr);
+	nh_fre(swp->prms, sizeof(f64) * row_siz * (swp->prm_nbr + 1));
+	nh_fre(swp->stts, sizeof(f64) * row_siz * (swp->stt_nbr + 1));
+	nh_fre_(swp);
+}
+
+/*
+ * Advance @swp by steps of @stp until @end.
+ * If @fin is set, tolerate reaching the end of the
+ * replay.
+ */
+void tb_swp_run(
+	tb_swp *swp,
+	u64 end,
+	u64 stp,
+	u8 fin
+)
+{
+	assert(stp);
+	u64 gen = ns_atm(a64, red, acq, &swp->gen);
+	while (swp->tim + stp <= end) {
+
+		/* Reconstruct once. */
+		const u64 tim = swp->tim + stp;
+		tb_dr1_add(swp->dr1, tim, fin);
+		swp->tim = tim;
+
+		/* Advance all instances. */
+		_swp_gen(swp, ++gen);
+
+	}
+}
+
+/*
+ * If the wallet of instance @ins can cover the order
+ * described by @ord, take its resources, pass it and
+ * return 0.
+ * Otherwise, or if its broker is full, return 1.
+ * Must only be called from the step function.
+ */
+uerr tb_swp_ord_pas(
+	tb_swp *swp,
+	u32 ins,
+	tb_ord *ord
+)
+{
+	check(ins < swp->ins_nbr);
+	spb_bkr *bkr = swp->bkrs[ins];
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	if (bks->ord_nbr == bks->ord_max) return 1;
+	if (tb_wlt_ord_res_tak(swp->wlts[ins], ord)) return 1;
+	tb_swp_opn *opn = swp->opns + ins;
+	opn->idxs[opn->nbr++] = tb_bkr_ord_pas(bkr, ord).id;
+	return 0;
+}
@@ -0,0 +1,107 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/***********
+ * Globals *
+ ***********/
+
+/* System. */
+static tb_sym_sys _sys = {.sym_nbr = 1};
+
+/*************
+ * Internals *
+ *************/
+
+/*
+ * Return 1 if the string of @sym is @str.
+ */
+static u8 _sym_equ(
+	u32 sym,
+	const char *str
+) {return tb_str_equ(_sys.strs[sym], str);}
+
+/*
+ * Return the symbol of @str of hash @hsh in @sys,
+ * TB_SYM_NON if none.
+ */
+static inline u32 _sym_sch(
+	tb_sym_sys *sys,
+	const char *str,
+	u64 hsh
+) {return tb_reg_sch(sys->slts, TB_SYM_SLT_NB, hsh, (u32) (hsh >> 32), (u8 (*)(u32, const void *)) &_sym_equ, str);}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Deinitialize the symbols system.
+ * Deletes all symbols.
+ * Only here for valgrind to get off our backs.
+ */
+void tb_sym_cln(
+	void
+)
+{
+	tb_sym_sys *sys = &_sys;
+	nh_spn_lck(&sys->lck);
+	const u32 sym_nbr = (u32) sys->sym_nbr;
+	for (u32 sym = 1; sym < sym_nbr; sym++) {
+		nh_sfre(sys->strs[sym]);
+	}
+	for (u32 slt = 0; slt < TB_SYM_SLT_NB; slt++) {
+		sys->slts[slt] = 0;
+	}
+	ns_atm(a64, wrt, rel, &sys->sym_nbr, 1);
+	nh_spn_ulk(&sys->lck);
+}
+
+/*
+ * Return the symbol of @str, create it if required.
+ * Wait-free if it exists.
+ */
+u32 tb_sym_get(
+	const char *str
+)
+{
+
+	/* Search without locking. */
+	tb_sym_sys *sys = &_sys;
+	const u64 hsh = tb_str_hsh(str, 0);
+	u32 sym = _sym_sch(sys, str, hsh);
+	if (sym) return sym;
+
+	/* Lock to create. */
+	nh_spn_lck(&sys->lck);
+	sym = _sym_sch(sys, str, hsh);
+	if (!sym) {
+		sym = (u32) sys->sym_nbr;
+		assert(sym < TB_SYM_MAX, "too many symbols.\n");
+		sys->strs[sym] = nh_sall(str);
+		ns_atm(a64, wrt, rel, &sys->sym_nbr, sym + 1);
+		tb_reg_put(sys->slts, TB_SYM_SLT_NB, hsh, (u32) (hsh >> 32), sym);
+	}
+	nh_spn_ulk(&sys->lck);
+	return sym;
+
+}
+
+/*
+ * Return the symbol of @str, TB_SYM_NON if none.
+ * Wait-free.
+ */
+u32 tb_sym_sch(
+	const char *str
+) {return _sym_sch(&_sys, str, tb_str_hsh(str, 0));}
+
+/*
+ * Return the string of @sym.
+ */
+const char *tb_sym_str(
+	u32 sym
+)
+{
+	check(sym && (sym < (u32) ns_atm(a64, red, acq, &_sys.sym_nbr)));
+	return _sys.strs[sym];
+}
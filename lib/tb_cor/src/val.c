@@ -0,0 +1,416 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_cor/tb_cor.all.h>
+
+/*************
+ * Internals *
+ *************/
+
+/* Number of exposures of a wallet. */
+#define EXP_NB (TB_CCY_NB + 1)
+
+/* Minimal number of instruments of per-instrument
+ * arrays. */
+#define IST_MIN 16
+
+/*
+ * Resize @arr of @prv_nbr elements of @siz bytes to
+ * @nbr elements, keep its first ones, and return it.
+ */
+static inline void *_arr_rsz(
+	void *arr,
+	u64 siz,
+	u32 prv_nbr,
+	u32 nbr
+)
+{
+	void *res = nbr ? nh_all(siz * nbr) : 0;
+	const u32 cpy = (prv_nbr < nbr) ? prv_nbr : nbr;
+	if (cpy) ns_mem_cpy(res, arr, siz * cpy);
+	if (prv_nbr) nh_fre(arr, siz * prv_nbr);
+	return res;
+}
+
+/*
+ * Resize the per-instrument arrays of @val to hold
+ * @nbr instruments.
+ */
+static inline void _ist_rsz(
+	tb_val *val,
+	u32 nbr
+)
+{
+	const u32 prv = val->ist_max;
+	#define IST_ARR_RSZ(arr) val->arr = _arr_rsz(val->arr, sizeof(*val->arr), prv, nbr);
+	IST_ARR_RSZ(movs);
+	IST_ARR_RSZ(mov_prcs);
+	IST_ARR_RSZ(mov_vals);
+	IST_ARR_RSZ(mov_mrgs);
+	IST_ARR_RSZ(movd);
+	IST_ARR_RSZ(ccys);
+	IST_ARR_RSZ(prcs);
+	IST_ARR_RSZ(mrts);
+	IST_ARR_RSZ(vals);
+	IST_ARR_RSZ(mrgs);
+	#undef IST_ARR_RSZ
+	val->ist_max = nbr;
+}
+
+/*
+ * Return the currency of @ist, 0 if none.
+ */
+static inline tb_ccy *_ist_ccy(
+	tb_ist *ist
+)
+{
+	if (ist->cls == TB_IST_CLS_CCY) return ist->ccy.ccy;
+	tb_mkp *mkp = ist->shr.mkp;
+	tb_ccy *ccy = tb_mkp_ccy(mkp);
+	if ((!ccy) && mkp->ccy_sym) ccy = tb_ccy_sch(mkp->ccy_sym);
+	return ccy;
+}
+
+/*
+ * Update the unit value and margin of instrument @id
+ * of @val.
+ */
+static inline void _ist_val(
+	tb_val *val,
+	u32 id
+)
+{
+	const f64 unt = val->prcs[id] * val->rats[val->ccys[id]];
+	val->vals[id] = unt;
+	val->mrgs[id] = ((unt < 0) ? -unt : unt) * val->mrts[id];
+}
+
+/*
+ * Add the instruments created since the last call
+ * to @val.
+ */
+static inline void _ist_syn(
+	tb_val *val
+)
+{
+	const u32 nbr = tb_ist_nbr();
+	if (nbr > val->ist_max) {
+		u32 max = val->ist_max ? val->ist_max : IST_MIN;
+		while (max < nbr) max <<= 1;
+		_ist_rsz(val, max);
+	}
+	for (u32 id = val->ist_nbr; id < nbr; id++) {
+		tb_ist *ist = tb_ist_get(id);
+		tb_ccy *ccy = _ist_ccy(ist);
+		val->ccys[id] = ccy ? (u16) ccy->id : TB_VAL_CCY_NON;
+		val->prcs[id] = (ist->cls == TB_IST_CLS_CCY) ? 1 : 0;
+		val->mrts[id] = 1;
+		val->movd[id] = 0;
+		_ist_val(val, id);
+	}
+	val->ist_nbr = nbr;
+}
+
+/*
+ * Return the sum of the lanes of @vec.
+ */
+static inline f64 _vec_sum(
+	tb_val_vf64 vec
+)
+{
+	f64 sum = 0;
+	for (u8 lan = 0; lan < TB_VAL_LAN_NB; lan++) sum += vec[lan];
+	return sum;
+}
+
+/*
+ * Value the wallet at index @idx of @val from scratch.
+ */
+static inline void _wlt_val(
+	tb_val *val,
+	u32 idx
+)
+{
+	tb_wlt *wlt = val->wlts[idx];
+	const f64 *amts = wlt->amts;
+	const u32 nbr = (wlt->amt_nbr < val->ist_nbr) ? wlt->amt_nbr : val->ist_nbr;
+
+	/* Dot products with unit values and margins. */
+	tb_val_vf64 navs = {0, 0, 0, 0};
+	tb_val_vf64 mrgs = {0, 0, 0, 0};
+	u32 id = 0;
+	for (; id + TB_VAL_LAN_NB <= nbr; id += TB_VAL_LAN_NB) {
+		const tb_val_vf64 amt = *(const tb_val_vf64 *) (amts + id);
+		const tb_val_vf64 abs = (tb_val_vf64) ((tb_val_vu64) amt & 0x7fffffffffffffff);
+		navs += amt * *(const tb_val_vf64 *) (val->vals + id);
+		mrgs += abs * *(const tb_val_vf64 *) (val->mrgs + id);
+	}
+	f64 nav = _vec_sum(navs);
+	f64 mrg = _vec_sum(mrgs);
+	for (; id < nbr; id++) {
+		const f64 amt = amts[id];
+		nav += amt * val->vals[id];
+		mrg += ((amt < 0) ? -amt : amt) * val->mrgs[id];
+	}
+	val->wlt_navs[idx] = nav;
+	val->wlt_mrgs[idx] = mrg;
+
+	/* Scatter exposures, skipping empty amounts. */
+	f64 *exps = val->wlt_exps + (u64) idx * EXP_NB;
+	ns_mem_rst(exps, sizeof(f64) * EXP_NB);
+	for (id = 0; id < nbr; id++) {
+		const f64 amt = amts[id];
+		if (amt != 0) exps[val->ccys[id]] += amt * val->prcs[id];
+	}
+
+}
+
+/*
+ * Record that the price of instrument @id of @val
+ * moved.
+ */
+static inline void _prc_mov(
+	tb_val *val,
+	u32 id
+)
+{
+	if (val->movd[id]) return;
+	val->movd[id] = 1;
+	val->mov_prcs[val->mov_nbr] = val->prcs[id];
+	val->movs[val->mov_nbr++] = id;
+}
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Construct and return a valuation engine of at most
+ * @wlt_max wallets.
+ * Conversion rates and margin rates are 1.
+ */
+tb_val *tb_val_ctr(
+	u32 wlt_max
+)
+{
+	assert(wlt_max);
+	nh_all__(tb_val, val);
+	val->ist_nbr = 0;
+	val->ist_max = 0;
+	val->wlt_nbr = 0;
+	val->wlt_max = wlt_max;
+	val->rvl = 0;
+	val->mov_nbr = 0;
+	for (u32 ccy_id = 0; ccy_id < TB_CCY_NB; ccy_id++) {
+		val->rats[ccy_id] = 1;
+	}
+	val->rats[TB_VAL_CCY_NON] = 0;
+	val->wlts = nh_all(sizeof(tb_wlt *) * wlt_max);
+	val->wlt_navs = nh_all(sizeof(f64) * wlt_max);
+	val->wlt_mrgs = nh_all(sizeof(f64) * wlt_max);
+	val->wlt_exps = nh_all(sizeof(f64) * EXP_NB * wlt_max);
+	_ist_syn(val);
+	return val;
+}
+
+/*
+ * Delete @val.
+ * Wallets are not deleted.
+ */
+void tb_val_dtr(
+	tb_val *val
+)
+{
+	const u32 wlt_max = val->wlt_max;
+	nh_fre(val->wlts, sizeof(tb_wlt *) * wlt_max);
+	nh_fre(val->wlt_navs, sizeof(f64) * wlt_max);
+	nh_fre(val->wlt_mrgs, sizeof(f64) * wlt_max);
+	nh_fre(val->wlt_exps, sizeof(f64) * EXP_NB * wlt_max);
+	_ist_rsz(val, 0);
+	nh_fre_(val);
+}
+
+/*
+ * Add @wlt to @val, value it, and return its index.
+ */
+u32 tb_val_wlt_add(
+	tb_val *val,
+	tb_wlt *wlt
+)
+{
+	assert(val->wlt_nbr < val->wlt_max, "too many wallets.\n");
+	const u32 idx = val->wlt_nbr++;
+	val->wlts[idx] = wlt;
+	tb_val_wlt_upd(val, idx);
+	return idx;
+}
+
+/*
+ * Revalue the wallet at index @idx after its amounts
+ * changed.
+ */
+void tb_val_wlt_upd(
+	tb_val *val,
+	u32 idx
+)
+{
+	assert(idx < val->wlt_nbr, "bad wallet index %u.\n", idx);
+	_ist_syn(val);
+	if (!val->mov_nbr) {
+		_wlt_val(val, idx);
+		return;
+	}
+
+	/* Value at the last update prices, so that the
+	 * next update applies moves to it. */
+	for (u32 mov_id = 0; mov_id < val->mov_nbr; mov_id++) {
+		const u32 id = val->movs[mov_id];
+		const f64 prc = val->prcs[id];
+		val->prcs[id] = val->mov_prcs[mov_id];
+		val->mov_prcs[mov_id] = prc;
+	}
+	_wlt_val(val, idx);
+	for (u32 mov_id = 0; mov_id < val->mov_nbr; mov_id++) {
+		const u32 id = val->movs[mov_id];
+		const f64 prc = val->prcs[id];
+		val->prcs[id] = val->mov_prcs[mov_id];
+		val->mov_prcs[mov_id] = prc;
+	}
+
+}
+
+/*
+ * Set the price of @ist.
+ * Takes effect at the next update.
+ */
+void tb_val_prc_set(
+	tb_val *val,
+	tb_ist *ist,
+	f64 prc
+)
+{
+	const u32 id = ist->id;
+	if (id >= val->ist_nbr) _ist_syn(val);
+	check(id < val->ist_nbr);
+	if (val->prcs[id] == prc) return;
+	_prc_mov(val, id);
+	val->prcs[id] = prc;
+}
+
+/*
+ * Set the price of @ist to the middle of the best bid
+ * and ask of @hst, of tick size @tck_siz.
+ * If only one side exists, use it. If none, do nothing.
+ * Takes effect at the next update.
+ */
+void tb_val_prc_lv1(
+	tb_val *val,
+	tb_ist *ist,
+	tb_lv1_hst *hst,
+	f64 tck_siz
+)
+{
+	tb_lv1_tck *bid = hst->bst_cur_bid;
+	tb_lv1_tck *ask = hst->bst_cur_ask;
+	if ((!bid) && (!ask)) return;
+	const f64 tck = (bid && ask) ?
+		((f64) bid->tcks.val + (f64) ask->tcks.val) / 2 :
+		(f64) (bid ? bid : ask)->tcks.val;
+	tb_val_prc_set(val, ist, tck * tck_siz);
+}
+
+/*
+ * Set the conversion rate of @ccy to the reference
+ * currency.
+ * Takes effect at the next update.
+ */
+void tb_val_rat_set(
+	tb_val *val,
+	tb_ccy *ccy,
+	f64 rat
+)
+{
+	check(ccy->id < TB_CCY_NB);
+	val->rats[ccy->id] = rat;
+	val->rvl = 1;
+}
+
+/*
+ * Set the margin rate of @ist.
+ * Takes effect at the next update.
+ */
+void tb_val_mrt_set(
+	tb_val *val,
+	tb_ist *ist,
+	f64 mrt
+)
+{
+	const u32 id = ist->id;
+	if (id >= val->ist_nbr) _ist_syn(val);
+	check(id < val->ist_nbr);
+	val->mrts[id] = mrt;
+	val->rvl = 1;
+}
+
+/*
+ * Update the valuations of all wallets.
+ */
+void tb_val_upd(
+	tb_val *val
+)
+{
+	_ist_syn(val);
+	const u32 wlt_nbr = val->wlt_nbr;
+	const u32 mov_nbr = val->mov_nbr;
+
+	/* Revalue everything after rate changes. */
+	if (val->rvl) {
+		for (u32 mov_id = 0; mov_id < mov_nbr; mov_id++) {
+			val->movd[val->movs[mov_id]] = 0;
+		}
+		val->mov_nbr = 0;
+		for (u32 id = 0; id < val->ist_nbr; id++) {
+			_ist_val(val, id);
+		}
+		for (u32 idx = 0; idx < wlt_nbr; idx++) {
+			_wlt_val(val, idx);
+		}
+		val->rvl = 0;
+		return;
+	}
+	if (!mov_nbr) return;
+
+	/* Compute the variations of moved instruments. */
+	for (u32 mov_id = 0; mov_id < mov_nbr; mov_id++) {
+		const u32 id = val->movs[mov_id];
+		const f64 val_prv = val->vals[id];
+		const f64 mrg_prv = val->mrgs[id];
+		_ist_val(val, id);
+		val->mov_prcs[mov_id] = val->prcs[id] - val->mov_prcs[mov_id];
+		val->mov_vals[mov_id] = val->vals[id] - val_prv;
+		val->mov_mrgs[mov_id] = val->mrgs[id] - mrg_prv;
+		val->movd[id] = 0;
+	}
+	val->mov_nbr = 0;
+
+	/* Apply them to all wallets. */
+	for (u32 idx = 0; idx < wlt_nbr; idx++) {
+		tb_wlt *wlt = val->wlts[idx];
+		const f64 *amts = wlt->amts;
+		const u32 amt_nbr = wlt->amt_nbr;
+		f64 *exps = val->wlt_exps + (u64) idx * EXP_NB;
+		f64 nav = val->wlt_navs[idx];
+		f64 mrg = val->wlt_mrgs[idx];
+		for (u32 mov_id = 0; mov_id < mov_nbr; mov_id++) {
+			const u32 id = val->movs[mov_id];
+			if (id >= amt_nbr) continue;
+			const f64 amt = amts[id];
+			if (amt == 0) continue;
+			nav += amt * val->mov_vals[mov_id];
+			mrg += ((amt < 0) ? -amt : amt) * val->mov_mrgs[mov_id];
+			exps[val->ccys[id]] += amt * val->mov_prcs[mov_id];
+		}
+		val->wlt_navs[idx] = nav;
+		val->wlt_mrgs[idx] = mrg;
+	}
+
+}
@@ -9,136 +9,64 @@
 tb_lib_log_def(cor, wlt);
 #define _wlt_log(...) tb_log_lib(cor, wlt, __VA_ARGS__)
 
-/*********
- * Asset *
- *********/
-
-/*
- * Return @ast's investment.
- */
-static inline tb_ist *_ast_ist(
-	tb_ast *ast
-) {return (tb_ist *) ast->asts.val;}
-
-/*
- * Pring log data for @ast.
- */
-void _ast_log(
-	ns_stm *stm,
-	va_list *args
-)
-{
-	tb_ast *ast = va_arg(*args, tb_ast *);
-	ns_stm_writef(stm, "asset (%@, %d)", tb_ist_dsc(_ast_ist(ast)), ast->amt);
-}
-#define _ast_dsc(ast) &_ast_log, ast
-
-/*
- * Check @ast.
- */
-static void _ast_chk(
-	tb_wlt *wlt,
-	tb_ast *ast
-) {check(ast->amt > 0);}
+/*************
+ * Internals *
+ *************/
 
-/*
- * If @wlt has instances of @ist, return the asset.
- * Otherwise, return 0.
- */
-static inline tb_ast *_ast_sch(
-	tb_wlt *wlt,
-	tb_ist *ist
-)
-{
-	tb_ast *ast = ns_map_sch(&wlt->asts, (uad) ist, uad, tb_ast, asts);
-	if (ast) _ast_chk(wlt, ast);
-	return ast;
-}	
+/* Minimal number of amounts of a wallet. */
+#define AMT_MIN 16
 
 /*
- * Destruct @ast from @wlt.
+ * Return the number of amounts to allocate to cover
+ * @nbr instruments.
  */
-static inline void _ast_dtr(
-	tb_wlt *wlt,
-	tb_ast *ast
+static inline u32 _amt_nbr(
+	u32 nbr
 )
 {
-	_wlt_log("[%p] ast_del %@ : %d.\n",
-		wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt);
-	_ast_chk(wlt, ast);
-	ns_map_uad_rem(&wlt->asts, &ast->asts);
-	nh_fre_(ast);
+	u32 res = AMT_MIN;
+	while (res < nbr) res <<= 1;
+	return res;
 }
 
 /*
- * Create and return a depot for currency @ccy with amount @amt in @wlt.
+ * Allocate @nbr amounts for @wlt, copy the @cpy first
+ * ones from @src, zero the others.
  */
-static inline tb_ast *_ast_ctr(
+static inline void _amt_all(
 	tb_wlt *wlt,
-	tb_ist *ist,
-	f64 amt
+	u32 nbr,
+	const f64 *src,
+	u32 cpy
 )
 {
-
-	assert(amt > 0);
-
-	/* Create. */
-	nh_all__(tb_ast, ast);
-	uerr err = ns_map_uad_put(&wlt->asts, &ast->asts, (uad) ist);
-	assert(!err, "ast_insertion error.\n");
-	ast->amt = amt;
-	_wlt_log("[%p] ast %@ amt %@\n", wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt);
-
-	/* Complete. */
-	_ast_chk(wlt, ast);
-	return ast;
-
+	check(cpy <= nbr);
+	f64 *amts = nh_all(sizeof(f64) * nbr);
+	if (cpy) ns_mem_cpy(amts, src, sizeof(f64) * cpy);
+	ns_mem_rst(amts + cpy, sizeof(f64) * (nbr - cpy));
+	wlt->amt_nbr = nbr;
+	wlt->amts = amts;
 }
 
 /*
- * Increase @ast's amount by @amt.
+ * Grow @wlt so that it has an amount for instrument
+ * @id.
  */
-static inline void _ast_add_(
+static inline void _amt_grw(
 	tb_wlt *wlt,
-	tb_ast *ast,
-	f64 amt
+	u32 id
 )
 {
-	check(amt >= 0);
-	_ast_chk(wlt, ast);
-	const f64 sum = ast->amt + amt;
-	_wlt_log("[%p] ast_add %@ : %d -> %d.\n", wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt, sum);
-	ast->amt = sum;
-	_wlt_log("[%p] ast_add %@ : %d -> %d.\n", wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt, sum);
-	_wlt_log("[%p] ast %@ amt %@\n", wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt);
-	_ast_chk(wlt, ast);
+	const u32 prv_nbr = wlt->amt_nbr;
+	if (id < prv_nbr) return;
+	f64 *prv = wlt->amts;
+	_amt_all(wlt, _amt_nbr(id + 1), prv, prv_nbr);
+	nh_fre(prv, sizeof(f64) * prv_nbr);
+	_wlt_log("[%p] grw : %u -> %u.\n", wlt, prv_nbr, wlt->amt_nbr);
 }
 
 /*
- * Decrease @ast's amount by @amt and return 0.
- * If an error occurs, return 1.
- */
-static inline uerr _ast_rem_(
-	tb_wlt *wlt,
-	tb_ast *ast,
-	f64 amt
-)
-{
-	_ast_chk(wlt, ast);
-	const f64 dif = ast->amt - amt;
-	_wlt_log("[%p] ast_add %@ : %d -> %d : %s.\n", wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt, dif, (dif < 0) ? "error (< 0)" : "OK");
-	if (dif < 0) return 1;
-	ast->amt = dif;
-	_wlt_log("[%p] ast %@ amt %@\n", wlt, tb_ist_dsc(_ast_ist(ast)), ast->amt);
-	if (amt == 0) _ast_dtr(wlt, ast);
-	else {_ast_chk(wlt, ast);}
-	return 0;
-}
-
-/*
- * If @wlt has instances of @ist, increase their amount
- * by @amt.
- * Otherwise, create an asset for @ist. 
+ * Increase the amount of @ist in @wlt by @amt.
  */
 static inline void _ast_add(
 	tb_wlt *wlt,
@@ -148,16 +76,18 @@ static inline void _ast_add(
 {
 	check(amt >= 0);
 	if (amt > 0) {
-		tb_ast *ast = _ast_sch(wlt, ist);
-		if (ast) _ast_add_(wlt, ast, amt);
-		else _ast_ctr(wlt, ist, amt);
+		const u32 id = ist->id;
+		_amt_grw(wlt, id);
+		const f64 sum = wlt->amts[id] + amt;
+		_wlt_log("[%p] ast_add %@ : %d -> %d.\n", wlt, tb_ist_dsc(ist), wlt->amts[id], sum);
+		wlt->amts[id] = sum;
 	}
 }
 
 /*
- * If @wlt has instances of @ist, try to decrease their
- * amount by @amt and return 0 if possible.
- * If no instances or not enough, return 1.
+ * Try to decrease the amount of @ist in @wlt by @amt
+ * and return 0 if possible.
+ * If not enough, return 1.
  */
 static inline uerr _ast_rem(
 	tb_wlt *wlt,
@@ -166,9 +96,13 @@ static inline uerr _ast_rem(
 )
 {
 	check(amt >= 0);
-	tb_ast *ast = _ast_sch(wlt, ist);
-	if (!ast) return (amt == 0);
-	else return _ast_rem_(wlt, ast, amt);
+	const u32 id = ist->id;
+	const f64 cur = (id < wlt->amt_nbr) ? wlt->amts[id] : 0;
+	const f64 dif = cur - amt;
+	_wlt_log("[%p] ast_rem %@ : %d -> %d : %s.\n", wlt, tb_ist_dsc(ist), cur, dif, (dif < 0) ? "error (< 0)" : "OK");
+	if (dif < 0) return 1;
+	if (id < wlt->amt_nbr) wlt->amts[id] = dif;
+	return 0;
 }
 
 /*************
@@ -183,7 +117,7 @@ tb_wlt *tb_wlt_ctr(
 )
 {
 	nh_all__(tb_wlt, wlt);
-	ns_map_uad_ini(&wlt->asts);
+	_amt_all(wlt, _amt_nbr(tb_ist_nbr()), 0, 0);
 	_wlt_log("[%p] ctr.\n", wlt);
 	return wlt;
 }
@@ -195,12 +129,8 @@ void tb_wlt_dtr(
 	tb_wlt *wlt
 )
 {
-	tb_ast *ast;
-	ns_map_fe(ast, &wlt->asts, asts, uad, in) {
-		_ast_chk(wlt, ast);
-		_ast_dtr(wlt, ast);
-	}
 	_wlt_log("[%p] : dtr.\n", wlt);
+	nh_fre(wlt->amts, sizeof(f64) * wlt->amt_nbr);
 	nh_fre_(wlt);
 }
 
@@ -214,41 +144,8 @@ tb_wlt *tb_wlt_cln(
 {
 	nh_all__(tb_wlt, dst);
 	_wlt_log("[%p] : cln : %p.\n", src, dst);
-	tb_ast *ast;
-	ns_map_fe(ast, &src->asts, asts, uad, post) {
-		_ast_ctr(dst, _ast_ist(ast), ast->amt);
-	}
+	_amt_all(dst, src->amt_nbr, src->amts, src->amt_nbr);
 	return dst;
-
-}
-
-/*
- * If @ast0 and ast1 are the same, return 0.
- * If they differ, return 1.
- */
-static uerr _ast_cmp(
-	tb_ast *ast0,
-	tb_ast *ast1
-)
-{
-
-	/* Compare currencies. */
-	tb_ist *ist0 = _ast_ist(ast0);
-	tb_ist *ist1 = _ast_ist(ast1);
-	if (ist0 != ist1) {
-		error("assets have different currencies : '%@' and '%@'.\n", tb_ist_dsc(ist0), tb_ist_dsc(ist1));
-		return 1;
-	}
-
-	/* Compare amounts. */
-	if (ast0->amt != ast1->amt) {
-		error("assets have different amounts : '%d' and '%d'.\n", ast0->amt, ast1->amt);
-		return 1;
-	}
-
-	/* Complete. */
-	return 0;
-
 }
 
 /*
@@ -260,24 +157,24 @@ uerr tb_wlt_cmp(
 	tb_wlt *wlt1
 )
 {
-	/* Compare assets. */
-	tb_ast *ast0;
-	tb_ast *ast1 = _map_entry(ns_map_uad_fi_post(&wlt1->asts), tb_ast, asts);
-	ns_map_fe(ast0, &wlt0->asts, asts, uad, post) {
-		_ast_chk(wlt0, ast0);
-		_ast_chk(wlt1, ast1);
-		check(ast0);
-		if (!ast1) {
-			error("wlts have different number of assets.\n");
+
+	/* Compare common amounts at once. */
+	const u32 nbr0 = wlt0->amt_nbr;
+	const u32 nbr1 = wlt1->amt_nbr;
+	const u32 nbr = (nbr0 < nbr1) ? nbr0 : nbr1;
+	const u8 dif = !!ns_mem_cmp(wlt0->amts, wlt1->amts, sizeof(f64) * nbr);
+
+	/* Report the first difference, amounts only
+	 * covered by one wallet must be null. */
+	const u32 max = (nbr0 < nbr1) ? nbr1 : nbr0;
+	for (u32 id = dif ? 0 : nbr; id < max; id++) {
+		const f64 amt0 = (id < nbr0) ? wlt0->amts[id] : 0;
+		const f64 amt1 = (id < nbr1) ? wlt1->amts[id] : 0;
+		if (amt0 != amt1) {
+			error("wlts differ : %@ amounts '%d' and '%d'.\n", tb_ist_dsc(tb_ist_get(id)), amt0, amt1);
 			return 1;
 		}
-		if (_ast_cmp(ast0, ast1)) {
-			error("wlts differ.\n");
-			return 1;	
-		}
-		ast1 = _map_entry(ns_map_uad_fn_post(&ast1->asts), tb_ast, asts);
 	}
-
 	return 0;
 
 }
@@ -287,16 +184,16 @@ uerr tb_wlt_cmp(
  **************/
 
 /*
- * Return the amount of money in depot of currency @ccy of @wlt.
- * If no such depot exists, return 0.
+ * Return the amount of instruments @ist in @wlt if any
+ * and 0 otherwise.
  */
 f64 tb_wlt_get(
 	tb_wlt *wlt,
 	tb_ist *ist
 )
 {
-	tb_ast *ast = _ast_sch(wlt, ist);
-	f64 amt = (ast) ? ast->amt : 0;
+	const u32 id = ist->id;
+	f64 amt = (id < wlt->amt_nbr) ? wlt->amts[id] : 0;
 	_wlt_log("[%p] ast_get %@ : %d.\n", wlt, tb_ist_dsc(ist), amt);
 	return amt;
 }
@@ -389,7 +286,7 @@ uerr tb_wlt_ord_res_rel(
 
 	/* If sell, add primary back. */
 	else {
-		_ast_add(wlt, ord->sec, req_vol_prm);
+		_ast_add(wlt, ord->prm, req_vol_prm);
 	}
 
 	/* No failure. */
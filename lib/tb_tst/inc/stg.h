@@ -9,7 +9,8 @@
 
 types(
 	tb_tst_stg_syn,
-	tb_tst_stg_dsc
+	tb_tst_stg_dsc,
+	tb_tst_stg_scn
 );
 
 /**************
@@ -73,6 +74,23 @@ struct tb_tst_stg_dsc {
 
 };
 
+/*
+ * Parallel scan context.
+ */
+struct tb_tst_stg_scn {
+
+	/* Number of scanned elements. */
+	u64 nbr;
+
+	/* First and last scanned times. */
+	u64 stt;
+	u64 end;
+
+	/* Number of ordering errors. */
+	u64 err;
+
+};
+
 /*******
  * API *
  *******/
@@ -0,0 +1,20 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#ifndef TB_TST_SWP_H
+#define TB_TST_SWP_H
+
+/*******
+ * API *
+ *******/
+
+/*
+ * Sweep runner testing.
+ */
+void tb_tst_swp(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+);
+
+#endif /* TB_TST_SWP_H */
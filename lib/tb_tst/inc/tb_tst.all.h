@@ -14,5 +14,18 @@
 #include <tb_tst/lv1.h>
 #include <tb_tst/lv1_gens.h>
 #include <tb_tst/lv1_vrf.h>
+#include <tb_tst/mrg.h>
+#include <tb_tst/iox.h>
+#include <tb_tst/pub.h>
+#include <tb_tst/stt.h>
+#include <tb_tst/bks.h>
+#include <tb_tst/bkp.h>
+#include <tb_tst/otb.h>
+#include <tb_tst/wlt.h>
+#include <tb_tst/val.h>
+#include <tb_tst/swp.h>
+#include <tb_tst/reg.h>
+#include <tb_tst/sym.h>
+#include <tb_tst/jrn.h>
 
 #endif /* TB_TST_ALL_H */
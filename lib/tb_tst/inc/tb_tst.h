@@ -2,3 +2,9 @@
 
 #define SGM_PTH "/home/bt/tb_tst_sgm"
 #define STG_PTH "/tmp/tb_tst_stg"
+#define IOX_PTH "/tmp/tb_tst_iox"
+#define IMP_PTH "/tmp/tb_tst_imp"
+#define PUB_PTH "/tmp/tb_tst_pub"
+#define BKP_PTH "/tmp/tb_tst_bkp"
+#define SWP_PTH "/tmp/tb_tst_swp"
+#define JRN_PTH "/tmp/tb_tst_jrn"
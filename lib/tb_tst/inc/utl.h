@@ -44,6 +44,44 @@ static inline u64 *_tim_all(
 	return tims;
 }
 
+/*
+ * Generate and store @rec_nb level 1 records for
+ * (@mkp, @ist) in @sys, one every 10 time units from
+ * time 1000, over the @tck_nb ticks from @tck_stt, bids
+ * in the lower half and asks in the upper one.
+ */
+static inline void _lv1_dat_gen(
+	tb_stg_sys *sys,
+	const char *mkp,
+	const char *ist,
+	u64 rec_nb,
+	u64 tck_stt,
+	u64 tck_nb,
+	u64 sed
+)
+{
+	u64 key = 0;
+	tb_stg_idx *idx = assert(tb_stg_opn(sys, mkp, ist, 1, TB_STG_WRT, &key));
+	u64 *tims = nh_all(rec_nb * sizeof(u64));
+	u64 *tcks = nh_all(rec_nb * sizeof(u64));
+	f64 *vols = nh_all(rec_nb * sizeof(f64));
+	for (u64 rec_id = 0; rec_id < rec_nb; rec_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u64 tck = tck_stt + (sed % tck_nb);
+		const f64 vol = (f64) (1 + ((sed >> 16) % 8));
+		tims[rec_id] = 1000 + 10 * rec_id;
+		tcks[rec_id] = tck;
+		vols[rec_id] = (tck < tck_stt + (tck_nb >> 1)) ? -vol : vol;
+	}
+	f64 *gos = tb_gos_all();
+	tb_io1_wrt(idx, rec_nb, tims, (const f64 *) tcks, vols, gos);
+	tb_gos_fre(gos);
+	nh_fre(vols, rec_nb * sizeof(f64));
+	nh_fre(tcks, rec_nb * sizeof(u64));
+	nh_fre(tims, rec_nb * sizeof(u64));
+	tb_stg_cls(idx, key);
+}
+
 
 #define GAT_PAS(dsc) \
 	assert(gat_ctr == itr_ctr, "gate entry error\n"); \
@@ -60,6 +98,7 @@ static inline u64 *_tim_all(
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 
 #define TST_PRL(_prc, _fnc, _ini) ({ \
 	/* If thread-based test : */ \
@@ -0,0 +1,425 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Tick size. */
+#define TCK_SIZ 0.01
+
+/* Request latency. */
+#define LAT 5
+
+/* Maximal number of orders. */
+#define ORD_MAX 128
+
+/* Number of orders passed one by one. */
+#define ORD_NB 24
+
+/* Number of orders passed in batches. */
+#define BAT_NB 40
+
+/* Number of market steps. */
+#define STP_NB 5
+
+/*
+ * Bridge context.
+ */
+typedef struct {
+
+	/* History. */
+	tb_lv1_hst *hst;
+
+	/* Served broker. */
+	spb_bkr *sim;
+
+	/* Reference broker, driven directly. */
+	spb_bkr *ref;
+
+	/* Bridge. */
+	tb_bkp_srv *srv;
+
+	/* State : 0 if running, 1 if it must stop, 2 if
+	 * stopped. */
+	volatile a64 stp;
+
+	/* Bridge thread block. */
+	u8 *thr_blk;
+
+} _bkp_ctx;
+
+/*
+ * Bridge thread.
+ * Serve until stopped.
+ */
+static u32 _bkp_thr(
+	_bkp_ctx *ctx
+)
+{
+	while (!ns_atm(a64, red, acq, &ctx->stp)) tb_bkp_srv_stp(ctx->srv);
+	ns_atm(a64, wrt, rel, &ctx->stp, 2);
+	return 0;
+}
+
+/*
+ * Initialize @ctx with a book, bids at 998 and 999,
+ * asks at 1001 and 1002, and serve its simulation
+ * broker.
+ */
+static inline void _bkp_ini(
+	_bkp_ctx *ctx
+)
+{
+	system("rm -rf "BKP_PTH);
+	tb_lv1_hst *hst = ctx->hst = tb_lv1_ctr(10, 8, 8, 0, TB_LV1_FMT_F64, 1);
+	tb_lv1_add(hst, 4, 0, (u64 []) {998, 999, 1001, 1002}, (f64 []) {-10, -5, 4, 10});
+	ctx->sim = tb_bks_ctr(hst, TCK_SIZ, LAT, ORD_MAX);
+	ctx->ref = tb_bks_ctr(hst, TCK_SIZ, LAT, ORD_MAX);
+	ctx->srv = tb_bkp_srv_ctr(BKP_PTH, ctx->sim);
+	ctx->stp = 0;
+	ctx->thr_blk = nh_all(1024);
+	assert(!nh_thr_run(ctx->thr_blk, 1024, 0, (u32 (*)(void *)) &_bkp_thr, ctx));
+}
+
+/*
+ * Stop serving, delete the bridge of @ctx.
+ */
+static inline void _bkp_hlt(
+	_bkp_ctx *ctx
+)
+{
+	ns_atm(a64, wrt, rel, &ctx->stp, 1);
+	while (ns_atm(a64, red, acq, &ctx->stp) != 2);
+	tb_bkp_srv_dtr(ctx->srv);
+}
+
+/*
+ * Deinitialize @ctx, whose bridge is deleted.
+ */
+static inline void _bkp_dei(
+	_bkp_ctx *ctx
+)
+{
+	nh_fre(ctx->thr_blk, 1024);
+	spb_bkr_dtor(ctx->ref);
+	spb_bkr_dtor(ctx->sim);
+	tb_lv1_dtr(ctx->hst);
+	system("rm -rf "BKP_PTH);
+}
+
+/*
+ * Return 1 if @ord0 and @ord1 are identical, 0
+ * otherwise.
+ */
+static inline u8 _ord_equ(
+	const tb_ord *ord0,
+	const tb_ord *ord1
+)
+{
+	return
+		(ord0->prm == ord1->prm) &&
+		(ord0->sec == ord1->sec) &&
+		(ord0->typ == ord1->typ) &&
+		(ord0->req_vol_prm == ord1->req_vol_prm) &&
+		(ord0->req_prc_lim == ord1->req_prc_lim) &&
+		(ord0->req_prc_stp == ord1->req_prc_stp) &&
+		(ord0->id == ord1->id) &&
+		(ord0->sts == ord1->sts) &&
+		(ord0->rsp_vol_prm == ord1->rsp_vol_prm) &&
+		(ord0->rsp_vol_sec == ord1->rsp_vol_sec);
+}
+
+/*
+ * Generate at @ord a random order of @prm in @sec
+ * from @sed, return the next seed.
+ */
+static inline u64 _ord_gen(
+	tb_ord *ord,
+	tb_ist *prm,
+	tb_ist *sec,
+	u64 sed
+)
+{
+	sed = ns_hsh_mas_gen(sed);
+	const u8 typs[3] = {TB_ORD_TYP_LIM_BUY, TB_ORD_TYP_LIM_SEL, TB_ORD_TYP_STP_SEL};
+	const u8 typ = typs[sed % 3];
+	const f64 vol = (f64) (1 + ((sed >> 8) % 4));
+	const f64 prc = (f64) (995 + ((sed >> 16) % 11)) * TCK_SIZ;
+	if (typ == TB_ORD_TYP_STP_SEL) tb_ord_ctr(ord, prm, sec, typ, vol, 0, prc, 0, TB_ORD_STS_IDL);
+	else tb_ord_ctr(ord, prm, sec, typ, vol, prc, 0, 0, TB_ORD_STS_IDL);
+	return sed;
+}
+
+/*
+ * Compare the descriptors of the @nbr first orders of
+ * @bkr and @ref, return the number of differences.
+ */
+static inline u64 _ord_cmp(
+	spb_bkr *bkr,
+	spb_bkr *ref,
+	u64 nbr
+)
+{
+	u64 dif_nbr = 0;
+	for (u64 idx = 0; idx < nbr; idx++) {
+		tb_ord ord;
+		tb_ord exp;
+		tb_bkr_ord_sts(bkr, idx, &ord);
+		tb_bkr_ord_sts(ref, idx, &exp);
+		dif_nbr += !_ord_equ(&ord, &exp);
+	}
+	return dif_nbr;
+}
+
+/*
+ * Prepare @hst until @tim, apply @nbr updates of the
+ * volumes of ticks @tcks to @vols, then set the time
+ * of @bkr and @ref to @tim.
+ */
+static inline void _bkp_stp(
+	tb_lv1_hst *hst,
+	spb_bkr *bkr,
+	spb_bkr *ref,
+	u64 tim,
+	u64 nbr,
+	const u64 *tcks,
+	const f64 *vols
+)
+{
+	tb_lv1_prp(hst, tim);
+	u64 tims[8];
+	assert(nbr && (nbr <= 8));
+	for (u64 upd_id = 0; upd_id < nbr; upd_id++) tims[upd_id] = tim - 1;
+	tb_lv1_add(hst, nbr, tims, tcks, vols);
+	tb_lv1_prc(hst);
+	spb_bkr_tim_set(bkr, tim);
+	spb_bkr_tim_set(ref, tim);
+}
+
+/*
+ * Unit test for round trips.
+ * Drive a simulation broker through a bridge and
+ * another one directly, their orders must match.
+ */
+static inline void _bkp_unt_rnd(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prms[2] = {tb_ist_ctr_shr(mkp, "BKPA"), tb_ist_ctr_shr(mkp, "BKPB")};
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	_bkp_ctx ctx;
+	_bkp_ini(&ctx);
+	tb_lv1_hst *hst = ctx.hst;
+	spb_bkr *ref = ctx.ref;
+
+	/* A single client at a time. */
+	spb_bkr *bkr = tb_bkp_cln_opn(BKP_PTH, 1);
+	nt_chk(bkr);
+	if (!bkr) {
+		_bkp_hlt(&ctx);
+		_bkp_dei(&ctx);
+		return;
+	}
+	nt_chk(!tb_bkp_cln_opn(BKP_PTH, 1));
+	tb_bkp_cln *cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	spb_bkr_tim_rst(bkr, 10);
+	spb_bkr_tim_rst(ref, 10);
+
+	/* Pass orders, responses must match. */
+	for (u64 ord_id = 0; ord_id < ORD_NB; ord_id++) {
+		tb_ord req;
+		sed = _ord_gen(&req, prms[ord_id & 1], sec, sed);
+		tb_ord ord = tb_bkr_ord_pas(bkr, &req);
+		tb_ord exp = tb_bkr_ord_pas(ref, &req);
+		nt_chk(_ord_equ(&ord, &exp));
+		nt_chk(ord.id == ord_id);
+	}
+
+	/* Instruments were sent once. */
+	nt_chk(cln->ses.snd_nbr == 3);
+	nt_chk(cln->ses.rcv_nbr == 3);
+
+	/* Move the market, cancel some orders, statuses
+	 * must match. */
+	const u64 stp_tcks[STP_NB][3] = {
+		{999}, {999}, {997, 998, 999}, {1001, 1002, 1003}, {999}
+	};
+	const f64 stp_vols[STP_NB][3] = {
+		{-3}, {-1}, {-7, 0, 0}, {0, 0, 5}, {2}
+	};
+	const u64 stp_nbrs[STP_NB] = {1, 1, 3, 3, 1};
+	for (u64 stp_id = 0; stp_id < STP_NB; stp_id++) {
+		_bkp_stp(hst, bkr, ref, 20 + 10 * stp_id, stp_nbrs[stp_id], stp_tcks[stp_id], stp_vols[stp_id]);
+		nt_chk(!_ord_cmp(bkr, ref, ORD_NB));
+		const u64 idx = (3 * stp_id) % ORD_NB;
+		tb_bkr_ord_ccl(bkr, idx);
+		tb_bkr_ord_ccl(ref, idx);
+	}
+	_bkp_stp(hst, bkr, ref, 100, 1, (u64 []) {1004}, (f64 []) {1});
+	nt_chk(!_ord_cmp(bkr, ref, ORD_NB));
+	nt_chk(!tb_bkp_cln_err(bkr));
+	spb_bkr_dtor(bkr);
+
+	/* A client dies holding the bridge, leaving a
+	 * request unanswered. */
+	pid_t pid = fork();
+	if (!pid) {
+		spb_bkr *chd = tb_bkp_cln_opn(BKP_PTH, 1);
+		if (!chd) _exit(1);
+		tb_bkp_cln *chd_cln = ns_cnt_of(chd, tb_bkp_cln, bkr);
+		tb_bkp_rng *req = &chd_cln->hdr->req;
+		const u64 wrt = req->wrt;
+		tb_bkp_msg msg = {.typ = TB_BKP_MSG_ORD_STS, .seq = chd_cln->seq + 1, .arg = 0};
+		ns_mem_cpy(req->msgs + (wrt & (TB_BKP_RNG_NB - 1)), &msg, sizeof(tb_bkp_msg));
+		ns_atm(a64, wrt, rel, &req->wrt, wrt + 1);
+		_exit(0);
+	}
+	assert(pid > 0);
+	int sts = 0;
+	assert(waitpid(pid, &sts, 0) == pid);
+	nt_chk(WIFEXITED(sts) && !WEXITSTATUS(sts));
+
+	/* A new client recovers the bridge, drops the
+	 * stale response, and starts a new session. */
+	bkr = tb_bkp_cln_opn(BKP_PTH, 1);
+	nt_chk(bkr);
+	if (!bkr) {
+		_bkp_hlt(&ctx);
+		_bkp_dei(&ctx);
+		return;
+	}
+	cln = ns_cnt_of(bkr, tb_bkp_cln, bkr);
+	nt_chk(!_ord_cmp(bkr, ref, ORD_NB));
+	nt_chk(cln->ses.snd_nbr == 0);
+	nt_chk(cln->ses.rcv_nbr == 3);
+
+	/* Once the bridge stops, requests fail and orders
+	 * are reported cancelled. */
+	_bkp_hlt(&ctx);
+	tb_ord ord;
+	tb_bkr_ord_sts(bkr, 1, &ord);
+	nt_chk(ord.id == 1);
+	nt_chk(ord.sts == TB_ORD_STS_CCL);
+	nt_chk(tb_bkp_cln_err(bkr));
+	tb_ord req;
+	_ord_gen(&req, prms[0], sec, sed);
+	ord = tb_bkr_ord_pas(bkr, &req);
+	nt_chk(ord.sts == TB_ORD_STS_CCL);
+
+	/* Cleanup. */
+	spb_bkr_dtor(bkr);
+	_bkp_dei(&ctx);
+
+}
+
+/*
+ * Unit test for batches and cancel-replace.
+ * Batches larger than TB_BKP_BAT_MAX are split, each
+ * batch being served at once.
+ */
+static inline void _bkp_unt_bat(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prms[2] = {tb_ist_ctr_shr(mkp, "BKPA"), tb_ist_ctr_shr(mkp, "BKPB")};
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	_bkp_ctx ctx;
+	_bkp_ini(&ctx);
+	tb_lv1_hst *hst = ctx.hst;
+	spb_bkr *ref = ctx.ref;
+	spb_bkr *bkr = tb_bkp_cln_opn(BKP_PTH, 1);
+	nt_chk(bkr);
+	if (!bkr) {
+		_bkp_hlt(&ctx);
+		_bkp_dei(&ctx);
+		return;
+	}
+	spb_bkr_tim_rst(bkr, 10);
+	spb_bkr_tim_rst(ref, 10);
+
+	/* Pass orders in batches, responses must match. */
+	tb_ord *reqs = nh_all(BAT_NB * sizeof(tb_ord));
+	tb_ord *ords = nh_all(BAT_NB * sizeof(tb_ord));
+	tb_ord *exps = nh_all(BAT_NB * sizeof(tb_ord));
+	u64 *idxs = nh_all(BAT_NB * sizeof(u64));
+	for (u64 ord_id = 0; ord_id < BAT_NB; ord_id++) {
+		sed = _ord_gen(reqs + ord_id, prms[ord_id & 1], sec, sed);
+	}
+	tb_bkr_ord_pas_n(bkr, BAT_NB, reqs, ords);
+	tb_bkr_ord_pas_n(ref, BAT_NB, reqs, exps);
+	for (u64 ord_id = 0; ord_id < BAT_NB; ord_id++) {
+		nt_chk(_ord_equ(ords + ord_id, exps + ord_id));
+		nt_chk(ords[ord_id].id == ord_id);
+	}
+
+	/* Move the market, read statuses in reverse order
+	 * in batches. */
+	for (u64 ord_id = 0; ord_id < BAT_NB; ord_id++) idxs[ord_id] = BAT_NB - 1 - ord_id;
+	_bkp_stp(hst, bkr, ref, 20, 1, (u64 []) {999}, (f64 []) {-3});
+	tb_bkr_ord_sts_n(bkr, BAT_NB, idxs, ords);
+	tb_bkr_ord_sts_n(ref, BAT_NB, idxs, exps);
+	for (u64 ord_id = 0; ord_id < BAT_NB; ord_id++) {
+		nt_chk(_ord_equ(ords + ord_id, exps + ord_id));
+		nt_chk(ords[ord_id].id == idxs[ord_id]);
+	}
+
+	/* Cancel one order out of three in batches, replace
+	 * others. */
+	const u64 ccl_nbr = (BAT_NB + 2) / 3;
+	for (u64 ccl_id = 0; ccl_id < ccl_nbr; ccl_id++) idxs[ccl_id] = 3 * ccl_id;
+	tb_bkr_ord_ccl_n(bkr, ccl_nbr, idxs);
+	tb_bkr_ord_ccl_n(ref, ccl_nbr, idxs);
+	for (u64 idx = 1; idx < BAT_NB; idx += 3) {
+		tb_ord req;
+		sed = _ord_gen(&req, prms[idx & 1], sec, sed);
+		tb_ord ord = tb_bkr_ord_rpl(bkr, idx, &req);
+		tb_ord exp = tb_bkr_ord_rpl(ref, idx, &req);
+		nt_chk(_ord_equ(&ord, &exp));
+	}
+
+	/* Move the market, statuses must match. */
+	const u64 ord_nbr = BAT_NB + (BAT_NB + 1) / 3;
+	_bkp_stp(hst, bkr, ref, 30, 3, (u64 []) {997, 998, 999}, (f64 []) {-7, 0, 0});
+	nt_chk(!_ord_cmp(bkr, ref, ord_nbr));
+	_bkp_stp(hst, bkr, ref, 40, 3, (u64 []) {1001, 1002, 1003}, (f64 []) {0, 0, 5});
+	nt_chk(!_ord_cmp(bkr, ref, ord_nbr));
+	nt_chk(!tb_bkp_cln_err(bkr));
+
+	/* Cleanup. */
+	nh_fre(idxs, BAT_NB * sizeof(u64));
+	nh_fre(exps, BAT_NB * sizeof(tb_ord));
+	nh_fre(ords, BAT_NB * sizeof(tb_ord));
+	nh_fre(reqs, BAT_NB * sizeof(tb_ord));
+	spb_bkr_dtor(bkr);
+	_bkp_hlt(&ctx);
+	_bkp_dei(&ctx);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _bkp_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _bkp_unt_rnd);
+	NH_TST_UNT(exc, _bkp_unt_bat);
+}
+
+/*
+ * Broker protocol testing.
+ */
+void tb_tst_bkp(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _bkp_tsq, arg);
+}
@@ -0,0 +1,299 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Tick size. */
+#define TCK_SIZ 0.01
+
+/* Request latency. */
+#define LAT 5
+
+/* Maximal number of orders. */
+#define ORD_MAX 16
+
+/*
+ * Prepare @hst until @tim, apply @nbr updates of the
+ * volumes of ticks @tcks to @vols, then set @bkr's
+ * time to @tim.
+ */
+static inline void _bks_stp(
+	tb_lv1_hst *hst,
+	spb_bkr *bkr,
+	u64 tim,
+	u64 nbr,
+	const u64 *tcks,
+	const f64 *vols
+)
+{
+	tb_lv1_prp(hst, tim);
+	if (nbr) {
+		u64 tims[8];
+		assert(nbr <= 8);
+		for (u64 upd_id = 0; upd_id < nbr; upd_id++) tims[upd_id] = tim - 1;
+		tb_lv1_add(hst, nbr, tims, tcks, vols);
+	}
+	tb_lv1_prc(hst);
+	spb_bkr_tim_set(bkr, tim);
+}
+
+/*
+ * Pass an order of type @typ for @vol at limit @lim
+ * and stop @stp through @bkr, return its identifier.
+ */
+static inline u64 _bks_pas(
+	spb_bkr *bkr,
+	tb_ist *prm,
+	tb_ist *sec,
+	u8 typ,
+	f64 vol,
+	f64 lim,
+	f64 stp
+)
+{
+	tb_ord ord;
+	tb_ord_ctr(&ord, prm, sec, typ, vol, lim, stp, 0, TB_ORD_STS_IDL);
+	return tb_bkr_ord_pas(bkr, &ord).id;
+}
+
+/*
+ * Return the descriptor of @bkr's order @id.
+ */
+static inline tb_ord _bks_sts(
+	spb_bkr *bkr,
+	u64 id
+)
+{
+	tb_ord ord;
+	tb_bkr_ord_sts(bkr, id, &ord);
+	return ord;
+}
+
+/*
+ * Unit test for the matching engine.
+ * Drive a book through latency, queue consumption,
+ * stop triggers, crossing fills and cancellations.
+ */
+static inline void _bks_unt_mtc(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prm = tb_ist_ctr_shr(mkp, "BKSA");
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+
+	/* Bids at 998 and 999, asks at 1001 and 1002. */
+	tb_lv1_hst *hst = tb_lv1_ctr(10, 8, 8, 0, TB_LV1_FMT_F64, 1);
+	tb_lv1_add(hst, 4, 0, (u64 []) {998, 999, 1001, 1002}, (f64 []) {-10, -5, 4, 10});
+	spb_bkr *bkr = tb_bks_ctr(hst, TCK_SIZ, LAT, ORD_MAX);
+	tb_bks *bks = ns_cnt_of(bkr, tb_bks, bkr);
+	spb_bkr_tim_rst(bkr, 10);
+
+	/* A marketable buy, a resting buy, a sell stop and
+	 * a buy stop limit. Prices on ticks up to rounding
+	 * errors map to them. */
+	const u64 mkt = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_BUY, 3, 10.01, 0);
+	const u64 rst = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_BUY, 4, 9.99, 0);
+	const u64 stp = _bks_pas(bkr, prm, sec, TB_ORD_TYP_STP_SEL, 2, 0, 9.97);
+	const u64 stl = _bks_pas(bkr, prm, sec, TB_ORD_TYP_STP_LIM_BUY, 1, 10.04, 10.03);
+	nt_chk(bks->ords[mkt].lim_tck == 1001);
+	nt_chk(bks->ords[rst].lim_tck == 999);
+	nt_chk(bks->ords[stp].stp_tck == 997);
+	nt_chk(bks->ords[stl].stp_tck == 1003);
+	nt_chk(bks->ords[stl].lim_tck == 1004);
+
+	/* Nothing reaches the market before the latency. */
+	_bks_stp(hst, bkr, 14, 0, 0, 0);
+	for (u64 id = mkt; id <= stl; id++) {
+		nt_chk(_bks_sts(bkr, id).sts == TB_ORD_STS_IDL);
+	}
+
+	/* The marketable buy fills at the ask, the others
+	 * are active. The resting buy is behind 5. */
+	_bks_stp(hst, bkr, 20, 0, 0, 0);
+	tb_ord ord = _bks_sts(bkr, mkt);
+	nt_chk(ord.sts == TB_ORD_STS_CPL);
+	nt_chk(ord.rsp_vol_prm == 3);
+	nt_chk(ord.rsp_vol_sec <= 3 * 10.01);
+	nt_chk(ord.rsp_vol_sec > 3 * 10.01 - 1e-9);
+	for (u64 id = rst; id <= stl; id++) {
+		ord = _bks_sts(bkr, id);
+		nt_chk(ord.sts == TB_ORD_STS_ACT);
+		nt_chk(ord.rsp_vol_prm == 0);
+	}
+	nt_chk(bks->ords[rst].que == 5);
+
+	/* Decrements consume the queue, then fill.
+	 * Increments queue behind the order. */
+	_bks_stp(hst, bkr, 30, 1, (u64 []) {999}, (f64 []) {-3});
+	nt_chk(bks->ords[rst].que == 3);
+	_bks_stp(hst, bkr, 40, 1, (u64 []) {999}, (f64 []) {-1});
+	nt_chk(bks->ords[rst].que == 1);
+	_bks_stp(hst, bkr, 50, 1, (u64 []) {999}, (f64 []) {-4});
+	nt_chk(bks->ords[rst].que == 1);
+	nt_chk(_bks_sts(bkr, rst).rsp_vol_prm == 0);
+	_bks_stp(hst, bkr, 60, 1, (u64 []) {999}, (f64 []) {-1});
+	ord = _bks_sts(bkr, rst);
+	nt_chk(bks->ords[rst].que == 0);
+	nt_chk(ord.sts == TB_ORD_STS_ACT);
+	nt_chk(ord.rsp_vol_prm == 2);
+
+	/* The bid falls to 997 : the sell stop triggers
+	 * and fills at the bid. */
+	_bks_stp(hst, bkr, 70, 3, (u64 []) {997, 998, 999}, (f64 []) {-7, 0, 0});
+	ord = _bks_sts(bkr, stp);
+	nt_chk(ord.sts == TB_ORD_STS_CPL);
+	nt_chk(ord.rsp_vol_prm == 2);
+	nt_chk(ord.rsp_vol_sec == 2 * (997 * TCK_SIZ));
+	nt_chk(_bks_sts(bkr, rst).rsp_vol_prm == 3);
+	nt_chk(_bks_sts(bkr, stl).sts == TB_ORD_STS_ACT);
+
+	/* The ask rises to 1003 : the buy stop limit
+	 * triggers and fills at the ask, below its limit. */
+	_bks_stp(hst, bkr, 80, 3, (u64 []) {1001, 1002, 1003}, (f64 []) {0, 0, 5});
+	ord = _bks_sts(bkr, stl);
+	nt_chk(ord.sts == TB_ORD_STS_CPL);
+	nt_chk(ord.rsp_vol_prm == 1);
+	nt_chk(ord.rsp_vol_sec == 1003 * TCK_SIZ);
+	nt_chk(_bks_sts(bkr, rst).sts == TB_ORD_STS_ACT);
+
+	/* The ask crosses the resting buy : it fills
+	 * entirely, at its limit at most. */
+	_bks_stp(hst, bkr, 90, 1, (u64 []) {999}, (f64 []) {2});
+	ord = _bks_sts(bkr, rst);
+	nt_chk(ord.sts == TB_ORD_STS_CPL);
+	nt_chk(ord.rsp_vol_prm == 4);
+	nt_chk(ord.rsp_vol_sec <= 4 * 9.99 + 1e-9);
+
+	/* Prices between ticks round away from the
+	 * market. A cancellation takes effect after
+	 * the latency. */
+	const u64 sel = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_SEL, 1, 10.505, 0);
+	const u64 buy = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_BUY, 1, 9.505, 0);
+	nt_chk(bks->ords[sel].lim_tck == 1051);
+	nt_chk(bks->ords[buy].lim_tck == 950);
+	_bks_stp(hst, bkr, 92, 0, 0, 0);
+	tb_bkr_ord_ccl(bkr, sel);
+	_bks_stp(hst, bkr, 96, 0, 0, 0);
+	nt_chk(_bks_sts(bkr, sel).sts == TB_ORD_STS_ACT);
+	_bks_stp(hst, bkr, 97, 0, 0, 0);
+	nt_chk(_bks_sts(bkr, sel).sts == TB_ORD_STS_CCL);
+	nt_chk(_bks_sts(bkr, buy).sts == TB_ORD_STS_ACT);
+
+	/* Cleanup. */
+	spb_bkr_dtor(bkr);
+	tb_lv1_dtr(hst);
+
+}
+
+/*
+ * Unit test for cancel-replace.
+ * Replacements take the volume not filled on the
+ * orders they replace, and are dropped if the latter
+ * completed.
+ */
+static inline void _bks_unt_rpl(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prm = tb_ist_ctr_shr(mkp, "BKSA");
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+
+	/* Bids at 998 and 999, asks at 1001 and 1002. */
+	tb_lv1_hst *hst = tb_lv1_ctr(10, 8, 8, 0, TB_LV1_FMT_F64, 1);
+	tb_lv1_add(hst, 4, 0, (u64 []) {998, 999, 1001, 1002}, (f64 []) {-10, -5, 4, 10});
+	spb_bkr *bkr = tb_bks_ctr(hst, TCK_SIZ, LAT, ORD_MAX);
+	spb_bkr_tim_rst(bkr, 10);
+
+	/* Two resting buys behind 5 get 2 filled. */
+	const u64 rs0 = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_BUY, 4, 9.99, 0);
+	const u64 rs1 = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_BUY, 4, 9.99, 0);
+	_bks_stp(hst, bkr, 20, 0, 0, 0);
+	_bks_stp(hst, bkr, 30, 1, (u64 []) {999}, (f64 []) {-2});
+	_bks_stp(hst, bkr, 40, 1, (u64 []) {999}, (f64 []) {-4});
+	_bks_stp(hst, bkr, 50, 1, (u64 []) {999}, (f64 []) {0});
+	for (u64 id = rs0; id <= rs1; id++) {
+		tb_ord ord = _bks_sts(bkr, id);
+		nt_chk(ord.sts == TB_ORD_STS_ACT);
+		nt_chk(ord.rsp_vol_prm == 2);
+	}
+
+	/* Replace them by 5 and 2. Replacements take
+	 * effect after the latency. */
+	tb_ord req;
+	tb_ord_ctr(&req, prm, sec, TB_ORD_TYP_LIM_BUY, 5, 9.99, 0, 0, TB_ORD_STS_IDL);
+	tb_ord ord = tb_bkr_ord_rpl(bkr, rs0, &req);
+	const u64 rp0 = ord.id;
+	nt_chk(ord.sts == TB_ORD_STS_IDL);
+	nt_chk(ord.req_vol_prm == 5);
+	tb_ord_ctr(&req, prm, sec, TB_ORD_TYP_LIM_BUY, 2, 9.99, 0, 0, TB_ORD_STS_IDL);
+	const u64 rp1 = tb_bkr_ord_rpl(bkr, rs1, &req).id;
+	_bks_stp(hst, bkr, 54, 0, 0, 0);
+	nt_chk(_bks_sts(bkr, rs0).sts == TB_ORD_STS_ACT);
+	nt_chk(_bks_sts(bkr, rp0).sts == TB_ORD_STS_IDL);
+	nt_chk(_bks_sts(bkr, rp1).sts == TB_ORD_STS_IDL);
+
+	/* The replaced orders are cancelled with 2 filled.
+	 * The first replacement is left with 3, the second
+	 * with nothing. */
+	_bks_stp(hst, bkr, 55, 0, 0, 0);
+	for (u64 id = rs0; id <= rs1; id++) {
+		ord = _bks_sts(bkr, id);
+		nt_chk(ord.sts == TB_ORD_STS_CCL);
+		nt_chk(ord.rsp_vol_prm == 2);
+	}
+	ord = _bks_sts(bkr, rp0);
+	nt_chk(ord.sts == TB_ORD_STS_ACT);
+	nt_chk(ord.req_vol_prm == 3);
+	nt_chk(ord.rsp_vol_prm == 0);
+	nt_chk(_bks_sts(bkr, rp1).sts == TB_ORD_STS_CCL);
+
+	/* The replacement of an order that completes
+	 * first is cancelled. */
+	const u64 mkt = _bks_pas(bkr, prm, sec, TB_ORD_TYP_LIM_BUY, 1, 10.01, 0);
+	_bks_stp(hst, bkr, 56, 0, 0, 0);
+	tb_ord_ctr(&req, prm, sec, TB_ORD_TYP_LIM_BUY, 2, 10.01, 0, 0, TB_ORD_STS_IDL);
+	const u64 rp2 = tb_bkr_ord_rpl(bkr, mkt, &req).id;
+	_bks_stp(hst, bkr, 60, 0, 0, 0);
+	nt_chk(_bks_sts(bkr, mkt).sts == TB_ORD_STS_CPL);
+	nt_chk(_bks_sts(bkr, rp2).sts == TB_ORD_STS_IDL);
+	_bks_stp(hst, bkr, 61, 0, 0, 0);
+	nt_chk(_bks_sts(bkr, mkt).sts == TB_ORD_STS_CPL);
+	ord = _bks_sts(bkr, rp2);
+	nt_chk(ord.sts == TB_ORD_STS_CCL);
+	nt_chk(ord.rsp_vol_prm == 0);
+	nt_chk(_bks_sts(bkr, rp0).sts == TB_ORD_STS_ACT);
+
+	/* Cleanup. */
+	spb_bkr_dtor(bkr);
+	tb_lv1_dtr(hst);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _bks_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _bks_unt_mtc);
+	NH_TST_UNT(exc, _bks_unt_rpl);
+}
+
+/*
+ * Simulation broker testing.
+ */
+void tb_tst_bks(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _bks_tsq, arg);
+}
@@ -0,0 +1,467 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of records, not a multiple of the test
+ * block length. */
+#define REC_NB 152
+
+/* Number of records of the first import. */
+#define REC_NB0 71
+
+/* Number of records per reference write. */
+#define WRT_NB 13
+
+/* First tick and tick range. */
+#define TCK_STT 100000
+#define TCK_NB 64
+
+/* Number of import threads. */
+#define THR_NB 4
+
+/* Ingest buffer capacity. */
+#define IBF_MAX 16
+
+/* Ingest buffer latency, 20ms. */
+#define IBF_LAT 20000000
+
+/* Number of records written before the reader starts,
+ * the last one alone in its block. */
+#define LAT_NB0 61
+
+/* Delay between the two writes, 50ms. */
+#define LAT_SLP 50000000
+
+/* Set <=> latencies are traced. */
+#ifdef TB_STT
+#define LAT_TRC 1
+#else
+#define LAT_TRC 0
+#endif
+
+/*
+ * Generate @nbr level 1 records.
+ */
+static inline void _rec_gen(
+	tb_io1_rec *recs,
+	u64 nbr,
+	u64 sed
+)
+{
+	for (u64 rec_id = 0; rec_id < nbr; rec_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u64 tck = TCK_STT + (sed % TCK_NB);
+		const f64 vol = (f64) (1 + ((sed >> 16) % 8));
+		recs[rec_id].tim = 1000 + 10 * rec_id;
+		recs[rec_id].tck = tck;
+		recs[rec_id].vol = (tck < TCK_STT + (TCK_NB >> 1)) ? -vol : vol;
+	}
+}
+
+/*
+ * Write @nbr records of @recs in the import file.
+ */
+static inline void _imp_wrt(
+	const tb_io1_rec *recs,
+	u64 nbr
+)
+{
+	const u64 siz = nbr * sizeof(tb_io1_rec);
+	nh_res res;
+	ns_stg *stg = assert(nh_stg_opn(NH_FIL_ATT_RWC, &res, IMP_PTH));
+	ns_stg_rsz(stg, siz);
+	void *dst = ns_stg_map(stg, 0, 0, siz, NS_STG_ATT_RWS);
+	ns_mem_cpy(dst, recs, siz);
+	ns_stg_syn(stg, dst, siz);
+	ns_stg_ump(stg, dst, siz);
+	nh_stg_cls(&res);
+}
+
+/*
+ * Unit test for the parallel level 1 import.
+ * Import records in two steps and compare blocks and
+ * their orderbook snapshots with those of an index
+ * written sequentially.
+ */
+static inline void _iox_unt_imp(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	system("rm -rf "IOX_PTH);
+	tb_stg_ini(IOX_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(IOX_PTH, 1);
+	nt_chk(sys);
+	if (!sys) return;
+	u64 imp_key = 0;
+	u64 wrt_key = 0;
+	tb_stg_idx *imp = tb_stg_opn(sys, "IOX", "IMP", 1, TB_STG_WRT, &imp_key);
+	tb_stg_idx *wrt = tb_stg_opn(sys, "IOX", "WRT", 1, TB_STG_WRT, &wrt_key);
+	nt_chk(imp);
+	nt_chk(wrt);
+	if ((!imp) || (!wrt)) return;
+	f64 *gos = tb_gos_all();
+
+	/* Generate records. */
+	tb_io1_rec *recs = nh_all(REC_NB * sizeof(tb_io1_rec));
+	_rec_gen(recs, REC_NB, sed);
+
+	/* Import in two steps so that the second one
+	 * completes a partial block and chains snapshots
+	 * with the first one's. */
+	_imp_wrt(recs, REC_NB0);
+	tb_io1_imp(imp, IMP_PTH, THR_NB, gos);
+	_imp_wrt(recs + REC_NB0, REC_NB - REC_NB0);
+	tb_io1_imp(imp, IMP_PTH, THR_NB, gos);
+
+	/* Write the reference sequentially. */
+	u64 *tims = nh_all(REC_NB * sizeof(u64));
+	u64 *tcks = nh_all(REC_NB * sizeof(u64));
+	f64 *vols = nh_all(REC_NB * sizeof(f64));
+	for (u64 rec_id = 0; rec_id < REC_NB; rec_id++) {
+		tims[rec_id] = recs[rec_id].tim;
+		tcks[rec_id] = recs[rec_id].tck;
+		vols[rec_id] = recs[rec_id].vol;
+	}
+	for (u64 rec_id = 0; rec_id < REC_NB; rec_id += WRT_NB) {
+		const u64 nbr = (REC_NB - rec_id < WRT_NB) ? REC_NB - rec_id : WRT_NB;
+		tb_io1_wrt(wrt, nbr, tims + rec_id, (const f64 *) (tcks + rec_id), vols + rec_id, gos);
+	}
+
+	/* Both indexes have the same blocks. */
+	const u64 blk_nbr = tb_sgm_elm_nbr(imp->sgm);
+	nt_chk(blk_nbr == (REC_NB + 2) / 3);
+	nt_chk(blk_nbr == tb_sgm_elm_nbr(wrt->sgm));
+	u64 rec_id = 0;
+	for (u64 blk_id = 0; blk_id < blk_nbr; blk_id++) {
+		nt_chk(imp->tbl[blk_id][0] == wrt->tbl[blk_id][0]);
+		nt_chk(imp->tbl[blk_id][1] == wrt->tbl[blk_id][1]);
+		tb_stg_blk *imp_blk = tb_stg_lod_tim(imp, imp->tbl[blk_id][0]);
+		tb_stg_blk *wrt_blk = tb_stg_lod_tim(wrt, wrt->tbl[blk_id][0]);
+		nt_chk(imp_blk);
+		nt_chk(wrt_blk);
+		if ((!imp_blk) || (!wrt_blk)) break;
+
+		/* Same records. */
+		const void *arrs[3];
+		const u8 *sizs;
+		const u64 elm_nbr = tb_blk_arr(imp_blk, arrs, 3, &sizs);
+		for (u64 elm_id = 0; elm_id < elm_nbr; elm_id++, rec_id++) {
+			nt_chk(((const u64 *) arrs[0])[elm_id] == recs[rec_id].tim);
+			nt_chk(((const u64 *) arrs[1])[elm_id] == recs[rec_id].tck);
+			nt_chk(((const f64 *) arrs[2])[elm_id] == recs[rec_id].vol);
+		}
+
+		/* Full blocks have the same snapshot. */
+		if (elm_nbr == 3) {
+			nt_chk(!ns_mem_cmp(tb_stg_std(imp_blk), tb_stg_std(wrt_blk), TB_LVL_RGN_SIZ_OBS));
+		}
+		tb_stg_unl(imp_blk);
+		tb_stg_unl(wrt_blk);
+
+	}
+	nt_chk(rec_id == REC_NB);
+
+	/* Cleanup. */
+	nh_fre(vols, REC_NB * sizeof(f64));
+	nh_fre(tcks, REC_NB * sizeof(u64));
+	nh_fre(tims, REC_NB * sizeof(u64));
+	nh_fre(recs, REC_NB * sizeof(tb_io1_rec));
+	tb_gos_fre(gos);
+	tb_stg_cls(wrt, wrt_key);
+	tb_stg_cls(imp, imp_key);
+	tb_stg_dtr(sys);
+	nh_fs_del_stg(IMP_PTH);
+	system("rm -rf "IOX_PTH);
+
+}
+
+/*
+ * Return the number of elements published in @idx.
+ * Blocks of the test storage contain 3 elements.
+ */
+static inline u64 _idx_elm_nbr(
+	tb_stg_idx *idx
+)
+{
+	const u64 blk_nbr = tb_sgm_elm_nbr(idx->sgm);
+	if (!blk_nbr) return 0;
+	tb_stg_blk *blk = assert(tb_stg_lod_tim(idx, idx->tbl[blk_nbr - 1][0]));
+	const u64 elm_nbr = 3 * (blk_nbr - 1) + tb_stg_elm_nbr(blk);
+	tb_stg_unl(blk);
+	return elm_nbr;
+}
+
+/*
+ * Wait until @lat nanoseconds elapsed since @tim.
+ */
+static inline void _lat_wai(
+	u64 tim,
+	u64 lat
+) {while (nh_run_tim() - tim < lat);}
+
+/*
+ * Unit test for the ingest buffer flush policy.
+ */
+static inline void _iox_unt_ibf(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	system("rm -rf "IOX_PTH);
+	tb_stg_ini(IOX_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(IOX_PTH, 1);
+	nt_chk(sys);
+	if (!sys) return;
+	u64 lat_key = 0;
+	u64 wth_key = 0;
+	tb_stg_idx *lat_idx = tb_stg_opn(sys, "IOX", "LAT", 0, TB_STG_WRT, &lat_key);
+	tb_stg_idx *wth_idx = tb_stg_opn(sys, "IOX", "WTH", 0, TB_STG_WRT, &wth_key);
+	nt_chk(lat_idx);
+	nt_chk(wth_idx);
+	if ((!lat_idx) || (!wth_idx)) return;
+
+	/* Strictly increasing times, arbitrary data. */
+	const u64 elm_nbr = 4 * IBF_MAX;
+	u64 *tims = nh_all(elm_nbr * sizeof(u64));
+	u64 *dat = nh_all(elm_nbr * sizeof(u64));
+	for (u64 elm_id = 0; elm_id < elm_nbr; elm_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		tims[elm_id] = 1000 + 10 * elm_id;
+		dat[elm_id] = sed;
+	}
+	#define SRCS(id) (const void *[]) {tims + (id), dat + (id), dat + (id), dat + (id), dat + (id)}
+
+	/* Buffered writes are not published until polled
+	 * after their latency. */
+	tb_ibf *ibf = tb_ibf_ctr(lat_idx, IBF_MAX, IBF_LAT, 0, 0);
+	tb_ibf_wrt(ibf, 5, SRCS(0));
+	nt_chk(_idx_elm_nbr(lat_idx) == 0);
+	nt_chk(ibf->elm_nbr == 5);
+	if (nh_run_tim() - ibf->tim_fst < IBF_LAT) {
+		nt_chk(!tb_ibf_pol(ibf));
+	}
+	_lat_wai(ibf->tim_fst, IBF_LAT);
+	nt_chk(tb_ibf_pol(ibf));
+	nt_chk(_idx_elm_nbr(lat_idx) == 5);
+	nt_chk(!ibf->elm_nbr);
+	nt_chk(!tb_ibf_pol(ibf));
+
+	/* A write after the latency of the oldest buffered
+	 * element publishes without polling. */
+	tb_ibf_wrt(ibf, 3, SRCS(5));
+	nt_chk(_idx_elm_nbr(lat_idx) == 5);
+	_lat_wai(ibf->tim_fst, IBF_LAT);
+	tb_ibf_wrt(ibf, 1, SRCS(8));
+	nt_chk(_idx_elm_nbr(lat_idx) == 9);
+	nt_chk(!ibf->elm_nbr);
+
+	/* A full buffer publishes, an oversized write is
+	 * published directly after the buffer content. */
+	tb_ibf_wrt(ibf, IBF_MAX - 1, SRCS(9));
+	nt_chk(_idx_elm_nbr(lat_idx) == 9);
+	tb_ibf_wrt(ibf, 1, SRCS(9 + IBF_MAX - 1));
+	nt_chk(_idx_elm_nbr(lat_idx) == 9 + IBF_MAX);
+	tb_ibf_wrt(ibf, 2, SRCS(9 + IBF_MAX));
+	tb_ibf_wrt(ibf, IBF_MAX, SRCS(11 + IBF_MAX));
+	nt_chk(_idx_elm_nbr(lat_idx) == 11 + 2 * IBF_MAX);
+	nt_chk(!ibf->elm_nbr);
+
+	/* Destruction publishes the rest. */
+	tb_ibf_wrt(ibf, 1, SRCS(11 + 2 * IBF_MAX));
+	tb_ibf_dtr(ibf);
+	nt_chk(_idx_elm_nbr(lat_idx) == 12 + 2 * IBF_MAX);
+
+	/* Write-through mode publishes every write. */
+	ibf = tb_ibf_ctr(wth_idx, IBF_MAX, 0, 0, 0);
+	tb_ibf_wrt(ibf, 2, SRCS(0));
+	nt_chk(_idx_elm_nbr(wth_idx) == 2);
+	tb_ibf_wrt(ibf, IBF_MAX + 1, SRCS(2));
+	nt_chk(_idx_elm_nbr(wth_idx) == IBF_MAX + 3);
+	nt_chk(!tb_ibf_pol(ibf));
+	tb_ibf_dtr(ibf);
+	#undef SRCS
+
+	/* Published data is the written one. */
+	const void *dsts[5];
+	u64 red_id = 0;
+	tb_stg_red(lat_idx, tims[0], tims[elm_nbr - 1], dsts, 5) {
+		nt_chk(((const u64 *) dsts[0])[blk_id] == tims[red_id]);
+		nt_chk(((const u64 *) dsts[1])[blk_id] == dat[red_id]);
+		red_id++;
+	}
+	nt_chk(red_id == 12 + 2 * IBF_MAX);
+
+	/* Cleanup. */
+	nh_fre(dat, elm_nbr * sizeof(u64));
+	nh_fre(tims, elm_nbr * sizeof(u64));
+	tb_stg_cls(wth_idx, wth_key);
+	tb_stg_cls(lat_idx, lat_key);
+	tb_stg_dtr(sys);
+	system("rm -rf "IOX_PTH);
+
+}
+
+/*
+ * Return the number of samples of @lat and not of @ref
+ * in buckets [@bkt_stt, @bkt_end].
+ */
+static inline u64 _lat_cnt(
+	const tb_stt_lat *lat,
+	const tb_stt_lat *ref,
+	u64 bkt_stt,
+	u64 bkt_end
+)
+{
+	u64 cnt = 0;
+	for (u64 bkt = bkt_stt; bkt <= bkt_end; bkt++) {
+		cnt += lat->bkts[bkt] - ref->bkts[bkt];
+	}
+	return cnt;
+}
+
+/*
+ * Check that @lat has @lng_nbr samples more than @ref
+ * in [@lng_min, @lng_max], and @srt_nbr samples more in
+ * [@srt_min, @srt_max].
+ */
+static inline void _lat_chk(
+	const tb_stt_lat *lat,
+	const tb_stt_lat *ref,
+	u64 lng_nbr,
+	u64 lng_min,
+	u64 lng_max,
+	u64 srt_nbr,
+	u64 srt_min,
+	u64 srt_max,
+	u64 *nt_err_cnt
+)
+{
+	nt_chk(lat->cnt - ref->cnt == LAT_TRC * (lng_nbr + srt_nbr));
+	if (!LAT_TRC) return;
+	const u64 sum = lat->sum - ref->sum;
+	nt_chk(lng_nbr * lng_min + srt_nbr * srt_min <= sum);
+	nt_chk(sum <= lng_nbr * lng_max + srt_nbr * srt_max);
+	nt_chk(_lat_cnt(lat, ref, tb_stt_lat_bkt(lng_min), tb_stt_lat_bkt(lng_max)) == lng_nbr);
+	nt_chk(_lat_cnt(lat, ref, tb_stt_lat_bkt(srt_min), tb_stt_lat_bkt(srt_max)) == srt_nbr);
+}
+
+/*
+ * Unit test for the ingestion latencies.
+ * Write data, start a reader, wait, write more data,
+ * then read it all : samples of the elements of the
+ * first write must include the wait.
+ */
+static inline void _iox_unt_lat(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	system("rm -rf "IOX_PTH);
+	tb_stg_ini(IOX_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(IOX_PTH, 1);
+	nt_chk(sys);
+	if (!sys) return;
+	u64 key = 0;
+	tb_stg_idx *idx = tb_stg_opn(sys, "IOX", "LAT", 1, TB_STG_WRT, &key);
+	nt_chk(idx);
+	if (!idx) return;
+	f64 *gos = tb_gos_all();
+
+	/* Generate records. */
+	tb_io1_rec *recs = nh_all(REC_NB * sizeof(tb_io1_rec));
+	_rec_gen(recs, REC_NB, sed);
+	u64 *tims = nh_all(REC_NB * sizeof(u64));
+	u64 *tcks = nh_all(REC_NB * sizeof(u64));
+	f64 *vols = nh_all(REC_NB * sizeof(f64));
+	for (u64 rec_id = 0; rec_id < REC_NB; rec_id++) {
+		tims[rec_id] = recs[rec_id].tim;
+		tcks[rec_id] = recs[rec_id].tck;
+		vols[rec_id] = recs[rec_id].vol;
+	}
+
+	/* Write the first records, read until the second
+	 * element of block 10. */
+	const u64 wrt_stt0 = tb_stt_tim();
+	tb_io1_wrt(idx, LAT_NB0, tims, (const f64 *) tcks, vols, gos);
+	const u64 wrt_end0 = tb_stt_tim();
+	tb_dr1 *dr1 = tb_dr1_ctr(sys, "IOX", "LAT", 10, 16, 16, 0, 1, tims[31]);
+
+	/* Save the latencies of this thread. */
+	const u64 lat_siz = TB_STT_LAT_NBR * sizeof(tb_stt_lat);
+	tb_stt_lat *refs = nh_all(lat_siz);
+	ns_mem_cpy(refs, tb_stt_pag_get()->lats, lat_siz);
+
+	/* Write the other records after a delay, then
+	 * read everything. */
+	while (tb_stt_tim() - wrt_end0 < LAT_SLP);
+	const u64 wrt_stt1 = tb_stt_tim();
+	tb_io1_wrt(idx, REC_NB - LAT_NB0, tims + LAT_NB0, (const f64 *) (tcks + LAT_NB0), vols + LAT_NB0, gos);
+	const u64 wrt_end1 = tb_stt_tim();
+	const u64 red_stt = tb_stt_tim();
+	tb_dr1_add(dr1, tims[REC_NB - 1] + 10, 1);
+	const u64 red_end = tb_stt_tim();
+
+	/* Long and short latency ranges must not share
+	 * buckets. */
+	const u64 lng_min = red_stt - wrt_end0;
+	const u64 lng_max = red_end - wrt_stt0;
+	const u64 srt_min = red_stt - wrt_end1;
+	const u64 srt_max = red_end - wrt_stt1;
+	nt_chk(tb_stt_lat_bkt(srt_max) < tb_stt_lat_bkt(lng_min));
+
+	/* Blocks 11 to 20 start with the first records,
+	 * blocks 21 to 50 with the others. The rest of block
+	 * 10 is known, but not added yet. */
+	const tb_stt_lat *lats = tb_stt_pag_get()->lats;
+	_lat_chk(lats + TB_STT_LAT_DSC, refs + TB_STT_LAT_DSC, 10, lng_min, lng_max, 30, srt_min, srt_max, nt_err_cnt);
+	_lat_chk(lats + TB_STT_LAT_ADD, refs + TB_STT_LAT_ADD, 11, lng_min, lng_max, 30, srt_min, srt_max, nt_err_cnt);
+	_lat_chk(lats + TB_STT_LAT_HMP, refs + TB_STT_LAT_HMP, 1, lng_min, lng_max, 0, srt_min, srt_max, nt_err_cnt);
+
+	/* Polling without new data samples nothing. */
+	ns_mem_cpy(refs, tb_stt_pag_get()->lats, lat_siz);
+	tb_dr1_add(dr1, tims[REC_NB - 1] + 20, 1);
+	for (u8 lat_id = 0; lat_id < TB_STT_LAT_NBR; lat_id++) {
+		nt_chk(lats[lat_id].cnt == refs[lat_id].cnt);
+	}
+
+	/* Cleanup. */
+	nh_fre(refs, lat_siz);
+	tb_dr1_dtr(dr1);
+	nh_fre(vols, REC_NB * sizeof(f64));
+	nh_fre(tcks, REC_NB * sizeof(u64));
+	nh_fre(tims, REC_NB * sizeof(u64));
+	nh_fre(recs, REC_NB * sizeof(tb_io1_rec));
+	tb_gos_fre(gos);
+	tb_stg_cls(idx, key);
+	tb_stg_dtr(sys);
+	system("rm -rf "IOX_PTH);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _iox_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _iox_unt_imp);
+	NH_TST_UNT(exc, _iox_unt_ibf);
+	NH_TST_UNT(exc, _iox_unt_lat);
+}
+
+/*
+ * Level IO testing.
+ */
+void tb_tst_iox(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _iox_tsq, arg);
+}
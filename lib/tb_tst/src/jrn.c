@@ -0,0 +1,305 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of shares. */
+#define SHR_NB 4
+
+/* Maximal number of open orders. */
+#define OPN_MAX 16
+
+/* Number of operations. */
+#define OPR_NB 2000
+
+/* Journal capacity. */
+#define REC_MAX 10000
+
+/*
+ * Replay context.
+ */
+typedef struct {
+
+	/* Number of open orders. */
+	u32 opn_nbr;
+
+	/* Request indices of open orders. */
+	u64 *reqs;
+
+	/* Open orders. */
+	tb_ord *ords;
+
+	/* Error counter. */
+	u64 *nt_err_cnt;
+
+} _rpl_ctx;
+
+/*
+ * Check that the open order @ord of request index @req
+ * is expected by @ctx.
+ */
+static void _rpl_opn(
+	u64 req,
+	const tb_ord *ord,
+	_rpl_ctx *ctx
+)
+{
+	u64 *nt_err_cnt = ctx->nt_err_cnt;
+	u32 opn_id = 0;
+	while ((opn_id < ctx->opn_nbr) && (ctx->reqs[opn_id] != req)) opn_id++;
+	nt_chk(opn_id < ctx->opn_nbr);
+	if (opn_id == ctx->opn_nbr) return;
+	nt_chk(!tb_ord_cmp((tb_ord *) ord, ctx->ords + opn_id));
+	nt_chk(ord->id == ctx->ords[opn_id].id);
+	nt_chk(ord->sts == ctx->ords[opn_id].sts);
+	ctx->reqs[opn_id] = (u64) -1;
+}
+
+/*
+ * Unit test for journal replay.
+ */
+static inline void _jrn_unt_rpl(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	nh_fs_del_stg(JRN_PTH);
+	tb_jrn *jrn = tb_jrn_ctr(JRN_PTH, REC_MAX);
+	nt_chk(jrn);
+	if (!jrn) return;
+
+	/* The journal has a single writer. */
+	nt_chk(!tb_jrn_ctr(JRN_PTH, REC_MAX));
+
+	/* Fund a reference wallet with dollars. */
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *usd = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	tb_ist *shrs[SHR_NB];
+	for (u32 shr_id = 0; shr_id < SHR_NB; shr_id++) {
+		const char sym[5] = {'J', 'R', 'N', (char) ('A' + shr_id), 0};
+		shrs[shr_id] = tb_ist_ctr_shr(mkp, sym);
+	}
+	tb_wlt *ref = tb_wlt_ctr();
+	tb_wlt_sim_add(ref, usd, 1000000);
+	nt_chk(!tb_jrn_mov(jrn, usd, 1000000));
+
+	/* Randomly pass, acknowledge, fill, complete and
+	 * cancel limit buy orders. */
+	u64 reqs[OPN_MAX];
+	tb_ord ords[OPN_MAX];
+	u32 opn_nbr = 0;
+	for (u64 opr_id = 0; opr_id < OPR_NB; opr_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u8 opr = (u8) (sed % 5);
+
+		/* Pass. */
+		if (((opr == 0) || (!opn_nbr)) && (opn_nbr < OPN_MAX)) {
+			tb_ord *ord = ords + opn_nbr;
+			tb_ord_ctr(
+				ord,
+				shrs[(sed >> 8) % SHR_NB],
+				usd,
+				TB_ORD_TYP_LIM_BUY,
+				(f64) (1 + ((sed >> 16) % 10)),
+				(f64) (10 + ((sed >> 24) % 90)),
+				0,
+				0,
+				TB_ORD_STS_IDL
+			);
+			nt_chk(!tb_wlt_ord_res_tak(ref, ord));
+			nt_chk(!tb_jrn_req(jrn, ord, reqs + opn_nbr));
+			opn_nbr++;
+			continue;
+		}
+		if (!opn_nbr) continue;
+		const u32 opn_id = (u32) ((sed >> 32) % opn_nbr);
+		tb_ord *ord = ords + opn_id;
+
+		/* Acknowledge. */
+		if (ord->sts == TB_ORD_STS_IDL) {
+			ord->id = opr_id;
+			tb_ord_idl_to_act(ord);
+			nt_chk(!tb_jrn_upd(jrn, TB_JRN_TYP_ACK, reqs[opn_id], ord));
+			continue;
+		}
+
+		/* Fill at most the limit price. */
+		u8 typ = TB_JRN_TYP_FIL;
+		if (opr < 3) {
+			const f64 vol = (ord->req_vol_prm - ord->rsp_vol_prm > 1) ? 1 : ord->req_vol_prm - ord->rsp_vol_prm;
+			ord->rsp_vol_prm += vol;
+			ord->rsp_vol_sec += vol * (ord->req_prc_lim - (f64) (opr_id % 3));
+			if (ord->rsp_vol_prm == ord->req_vol_prm) {
+				tb_ord_act_to_cpl(ord);
+				typ = TB_JRN_TYP_CPL;
+			}
+		} else {
+			tb_ord_act_to_ccl(ord);
+			typ = TB_JRN_TYP_CCL;
+		}
+		nt_chk(!tb_jrn_upd(jrn, typ, reqs[opn_id], ord));
+		if (typ == TB_JRN_TYP_FIL) continue;
+
+		/* Settle, forget. */
+		nt_chk(!tb_wlt_ord_res_col(ref, ord));
+		opn_nbr--;
+		reqs[opn_id] = reqs[opn_nbr];
+		ords[opn_id] = ords[opn_nbr];
+
+	}
+
+	/* Reopen, replay, compare. */
+	const u64 rec_nbr = tb_jrn_rec_nbr(jrn);
+	tb_jrn_dtr(jrn);
+	jrn = tb_jrn_ctr(JRN_PTH, REC_MAX);
+	nt_chk(jrn);
+	if (!jrn) return;
+	nt_chk(tb_jrn_rec_nbr(jrn) == rec_nbr);
+	tb_wlt *wlt = tb_wlt_ctr();
+	_rpl_ctx ctx = {opn_nbr, reqs, ords, nt_err_cnt};
+	nt_chk(!tb_jrn_rpl(jrn, wlt, (void (*)(u64, const tb_ord *, void *)) &_rpl_opn, &ctx));
+	nt_chk(!tb_wlt_cmp(ref, wlt));
+	for (u32 opn_id = 0; opn_id < opn_nbr; opn_id++) {
+		nt_chk(reqs[opn_id] == (u64) -1);
+	}
+
+	/* Cleanup. */
+	tb_wlt_dtr(wlt);
+	tb_wlt_dtr(ref);
+	tb_jrn_dtr(jrn);
+	nh_fs_del_stg(JRN_PTH);
+
+}
+
+/*
+ * Replay @jrn in an empty wallet and return the status.
+ */
+static inline uerr _rpl_sts(
+	tb_jrn *jrn
+)
+{
+	tb_wlt *wlt = tb_wlt_ctr();
+	const uerr err = tb_jrn_rpl(jrn, wlt, 0, 0);
+	tb_wlt_dtr(wlt);
+	return err;
+}
+
+/*
+ * Unit test for the rejection of invalid journals.
+ */
+static inline void _jrn_unt_inv(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	nh_fs_del_stg(JRN_PTH);
+	tb_jrn *jrn = tb_jrn_ctr(JRN_PTH, REC_MAX);
+	nt_chk(jrn);
+	if (!jrn) return;
+
+	/* Fund, pass, acknowledge and cancel.
+	 * Records : dollar definition, movement, share
+	 * definition, request, acknowledge, cancel. */
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *usd = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	tb_ist *shr = tb_ist_ctr_shr(mkp, "JRNI");
+	nt_chk(!tb_jrn_mov(jrn, usd, 1000));
+	tb_ord ord;
+	tb_ord_ctr(&ord, shr, usd, TB_ORD_TYP_LIM_BUY, 1, 10, 0, 0, TB_ORD_STS_IDL);
+	u64 req = 0;
+	nt_chk(!tb_jrn_req(jrn, &ord, &req));
+	nt_chk(req == 3);
+	ord.id = sed;
+	tb_ord_idl_to_act(&ord);
+	nt_chk(!tb_jrn_upd(jrn, TB_JRN_TYP_ACK, req, &ord));
+	tb_ord_act_to_ccl(&ord);
+	nt_chk(!tb_jrn_upd(jrn, TB_JRN_TYP_CCL, req, &ord));
+	nt_chk(!_rpl_sts(jrn));
+
+	/* Reject references to instruments not defined yet. */
+	tb_jrn_rec *recs = jrn->recs;
+	recs[1].ist = 1;
+	nt_chk(_rpl_sts(jrn));
+	recs[1].ist = 0;
+	recs[req].req.sec = 2;
+	nt_chk(_rpl_sts(jrn));
+	recs[req].req.sec = 0;
+	nt_chk(!_rpl_sts(jrn));
+
+	/* Reject updates of settled orders. */
+	nt_chk(!tb_jrn_upd(jrn, TB_JRN_TYP_CPL, req, &ord));
+	nt_chk(_rpl_sts(jrn));
+
+	/* Fail to open with an unknown currency. */
+	ns_mem_cpy(recs[0].def.sym, "QQQ", 4);
+	tb_jrn_dtr(jrn);
+	nt_chk(!tb_jrn_ctr(JRN_PTH, REC_MAX));
+	nh_fs_del_stg(JRN_PTH);
+
+}
+
+/*
+ * Unit test for full journals.
+ */
+static inline void _jrn_unt_ful(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	nh_fs_del_stg(JRN_PTH);
+	tb_jrn *jrn = tb_jrn_ctr(JRN_PTH, 3);
+	nt_chk(jrn);
+	if (!jrn) return;
+
+	/* Define dollars, move. */
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *usd = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	tb_ist *shr = tb_ist_ctr_shr(mkp, "JRNF");
+	nt_chk(!tb_jrn_mov(jrn, usd, 1000));
+	nt_chk(tb_jrn_rec_nbr(jrn) == 2);
+
+	/* The request and the definition of its share do
+	 * not fit, and nothing is recorded. */
+	tb_ord ord;
+	tb_ord_ctr(&ord, shr, usd, TB_ORD_TYP_LIM_BUY, 1, 10, 0, 0, TB_ORD_STS_IDL);
+	u64 req = 0;
+	nt_chk(tb_jrn_req(jrn, &ord, &req));
+	nt_chk(tb_jrn_rec_nbr(jrn) == 2);
+
+	/* A movement fits, the next one does not. */
+	nt_chk(!tb_jrn_mov(jrn, usd, (f64) (sed % 1000)));
+	nt_chk(tb_jrn_mov(jrn, usd, 1000));
+	nt_chk(tb_jrn_rec_nbr(jrn) == 3);
+	nt_chk(!_rpl_sts(jrn));
+
+	/* Cleanup. */
+	tb_jrn_dtr(jrn);
+	nh_fs_del_stg(JRN_PTH);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _jrn_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _jrn_unt_rpl);
+	NH_TST_UNT(exc, _jrn_unt_inv);
+	NH_TST_UNT(exc, _jrn_unt_ful);
+}
+
+/*
+ * Journal testing.
+ */
+void tb_tst_jrn(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _jrn_tsq, arg);
+}
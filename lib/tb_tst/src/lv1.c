@@ -288,6 +288,28 @@ static inline u64 _uid_cln_upd(
 	return uid_cln;
 }
 
+/*
+ * Verify that @hst published its last processing
+ * pass as the epoch following @epcp, and update it.
+ */
+static inline void _pub_chk(
+	tb_lv1_hst *hst,
+	u64 *epcp
+)
+{
+	const u64 epc = ++(*epcp);
+	assert(tb_lv1_pub_acq(hst) == epc);
+	assert(tb_lv1_pub_vld(hst, epc));
+	assert((epc < hst->buf_nbr) || (!tb_lv1_pub_vld(hst, epc - hst->buf_nbr)));
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		assert(tb_lv1_pub_hmp(hst, epc, viw_id) == tb_lv1_viw_hmp(hst, viw_id));
+	}
+	if (hst->bac_nb) {
+		assert(!ns_mem_cmp(tb_lv1_pub_bid(hst, epc), tb_lv1_bid(hst), hst->bac_nb * sizeof(u64)));
+		assert(!ns_mem_cmp(tb_lv1_pub_ask(hst, epc), tb_lv1_ask(hst), hst->bac_nb * sizeof(u64)));
+	}
+}
+
 /*
  * Entrypoint for lv1 tests.
  */
@@ -360,9 +382,25 @@ static void _lv1_run(
 		aid_wid,
 		hmp_dim_tck,
 		hmp_dim_tim,
-		bac_siz
+		bac_siz,
+		TB_LV1_FMT_F64,
+		1
 	);
 
+	/* Add a coarser and taller view, a shorter and
+	 * thinner one, and one gathering 3 ticks per row,
+	 * each in a different format.
+	 * None must span more time than the primary view,
+	 * as the expected cleanup is based on it. */
+	assert(!(hmp_dim_tim & 1));
+	assert(tb_lv1_viw_add(hst, 2 * aid_wid, hmp_dim_tim >> 1, hmp_dim_tck + 4, 1, TB_LV1_FMT_F32, 1) == 1);
+	assert(tb_lv1_viw_add(hst, aid_wid, hmp_dim_tim >> 1, (hmp_dim_tck >> 2) << 1, 1, TB_LV1_FMT_U8, 1 / ref_vol) == 2);
+	assert(tb_lv1_viw_add(hst, aid_wid, hmp_dim_tim, (hmp_dim_tck >> 2) << 1, 3, TB_LV1_FMT_U16 | TB_LV1_FMT_LOG, 0.05) == 3);
+
+	/* Publish through a seed-dependent number of buffers. */
+	tb_lv1_buf_set(hst, (u8) (1 + sed % TB_LV1_BUF_MAX));
+	u64 pub_epc = 0;
+
 	/* Set initial volumes in groups of 19 by step of 19. */
 	debug("Adding initial volumes.\n");
 	assert(tck_nbr % 19);
@@ -461,6 +499,7 @@ static void _lv1_run(
 
 	/* Process. */
 	tb_lv1_prc(hst);
+	_pub_chk(hst, &pub_epc);
 
 	/* Verify the history's internal state. */
 	if (chk_stt) {
@@ -521,6 +560,7 @@ static void _lv1_run(
 		
 		/* Process. */
 		tb_lv1_prc(hst);
+		_pub_chk(hst, &pub_epc);
 
 		/* Incorporate all orders <= current time in the
 		 * heatmap data. */
@@ -20,6 +20,28 @@ static inline u8 _f64_eq(
 	if (dif < 0) dif = -dif;
 	return dif < 0.001;
 }
+
+/*
+ * Return 1 if scaled values @a and @b are equal up to
+ * the precision of format @fmt.
+ */
+static inline u8 _fmt_eq(
+	u8 fmt,
+	f64 a,
+	f64 b
+)
+{
+	f64 dif = a - b;
+	if (dif < 0) dif = -dif;
+	f64 abs = (a < 0) ? -a : a;
+	switch (fmt & ~TB_LV1_FMT_LOG) {
+		case TB_LV1_FMT_F64: return dif < 0.001;
+		case TB_LV1_FMT_F32: return dif < 0.001 + abs * 0.000001;
+		case TB_LV1_FMT_U16: return dif < 2. / 65535;
+		case TB_LV1_FMT_U8: return dif < 2. / 255;
+	}
+	return 0;
+}
 	
 /*****************
  * Updates check *
@@ -584,12 +606,13 @@ static inline void _vrf_hst_bac(
  ************************/
 
 /*
- * Reconstruct the heatmap of @hst and verify
- * that it matches @hst's version.
+ * Reconstruct the heatmap of @hst's view @viw and
+ * verify that it matches @viw's version.
  */
 static inline void _vrf_hst_hmp(
 	tb_tst_lv1_ctx *ctx,
 	tb_lv1_hst *hst,
+	tb_lv1_viw *viw,
 	u64 uid_cln,
 	u64 uid_cur,
 	u64 uid_add,
@@ -600,41 +623,40 @@ static inline void _vrf_hst_hmp(
 {
 
 	/* Constants. */
-	const u64 dim_tck = hst->hmp_dim_tck;
-	const u64 dim_tim = hst->hmp_dim_tim;
-	const u64 tim_res = hst->tim_res;
-	assert(hst->tim_cur <= hst->tim_hmp);
-	const u64 hmp_tim_end = hst->tim_hmp;
-	const u64 hmp_tim_stt = hst->tim_hmp - hst->hmp_tim_spn;
+	const u64 dim_tck = viw->hmp_dim_tck;
+	const u64 tck_agg = viw->tck_agg;
+	const u64 tck_nbr = dim_tck * tck_agg;
+	const u64 dim_tim = viw->hmp_dim_tim;
+	const u64 tim_res = viw->tim_res;
+	assert(hst->tim_cur <= viw->tim_hmp);
+	const u64 hmp_tim_end = viw->tim_hmp;
+	const u64 hmp_tim_stt = viw->tim_hmp - viw->hmp_tim_spn;
 	assert(hmp_tim_end > hmp_tim_stt);
-	assert((hmp_tim_end - hmp_tim_stt) == ((hst->hmp_dim_tim) * tim_res));
+	assert((hmp_tim_end - hmp_tim_stt) == ((viw->hmp_dim_tim) * tim_res));
+
+	/* Expected value of each tick at each column.
+	 * [dim_tim][tck_nbr]. */
+	f64 *exp = nh_all(sizeof(f64) * dim_tim * tck_nbr);
 
 	/*
 	 * Traverse each tick of the heatmap.
 	 */
 	u64 tck_cnt = 0;
-	for (u64 row_idx = 0; row_idx < dim_tck; row_idx++) {
+	for (u64 row_idx = 0; row_idx < tck_nbr; row_idx++) {
 		tck_cnt++;
 
 		/* Determine the effective tick ID. */
-		u64 tck_val = row_idx + hst->hmp_tck_min;
+		u64 tck_val = row_idx + viw->hmp_tck_min;
 		
 		/* Find the tick. */
 		tb_lv1_tck *tck = ns_map_sch(&hst->tcks, tck_val, u64, tb_lv1_tck, tcks);
 		
-		/* If tick not present, the entire heatmap row must be null. */
+		/* If tick not present, the entire tick row must be null. */
 		if (!tck) {
 			u64 tim_cnt = 0;
 			for (u64 col_idx = 0; col_idx < dim_tim; col_idx++) {
 				tim_cnt++;
-				assert(hst->hmp[col_idx * dim_tck + row_idx] == 0,
-					"incorrect heatmap value at row %U/%U (tck %U) col %U/%U.\n"
-					"Expected 0 (no tick data), got %d.",
-					row_idx, dim_tck,
-					tck_val, 
-					col_idx, dim_tim,
-					hst->hmp[col_idx * dim_tck + row_idx]
-				);
+				exp[col_idx * tck_nbr + row_idx] = 0;
 			}	
 			assert(tim_cnt == dim_tim);
 			continue;
@@ -696,17 +718,11 @@ static inline void _vrf_hst_hmp(
 			assert(upd_cel <= col_nxt);
 			if (upd_cel != col_nxt) {
 
-				/* Compute and compare the cell's expected value. */
+				/* Compute the cell's expected value. */
 				assert(cel_dur == cel_ttl_dur);
 				assert(cel_dur <= tim_res);
 				const f64 cel_val = (f64) cel_sum / (f64) cel_dur;
-				assert(_f64_eq(cel_val, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]),
-					"incorrect heatmap value at row %U/%U col %U/%U.\n"
-					"Expected %d, got %d.",
-					row_idx, dim_tck,
-					col_nxt, dim_tim,
-					cel_val, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]
-				);
+				exp[((u64) col_nxt) * tck_nbr + row_idx] = cel_val;
 				col_nxt--;
 
 				/* All cells between ] max(upd_cel, 0), col_nxt [ should have @upd_vol as value. */ 
@@ -715,13 +731,7 @@ static inline void _vrf_hst_hmp(
 				for (s64 prp_idx = col_nxt; prp_idx >= prp_min; prp_idx--) {
 					assert(col_nxt >= 0);
 					assert(prp_idx == col_nxt);
-					assert(_f64_eq(upd_vol, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]),
-						"incorrect heatmap value at row %U/%U col %U/%U.\n"
-						"Expected %d, got %d.",
-						row_idx, dim_tck,
-						col_nxt, dim_tim,
-						upd_vol, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]
-					);
+					exp[((u64) col_nxt) * tck_nbr + row_idx] = upd_vol;
 					col_nxt--;
 				}
 
@@ -767,40 +777,56 @@ static inline void _vrf_hst_hmp(
 			/* Update the time of last update. */
 			upd_lst_tim = hmp_tim_stt;
 
-			/* Compute and compare the cell's expected value. */
+			/* Compute the cell's expected value. */
 			assert(cel_dur == cel_ttl_dur);
 			const f64 cel_val = (f64) cel_sum / (f64) cel_dur;
-			assert(_f64_eq(cel_val, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]),
-				"incorrect heatmap value at row %U/%U col %U/%U.\n"
-				"Expected %d, got %d.",
-				row_idx, dim_tck,
-				col_nxt, dim_tim,
-				cel_val, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]
-			);
+			exp[((u64) col_nxt) * tck_nbr + row_idx] = cel_val;
 			col_nxt--;
 
 			/* All cells between [0, col_nxt [ should have @vol_stt as value. */ 
 			for (s64 prp_idx = col_nxt + 1; prp_idx--;) {
 				assert(col_nxt >= 0);
 				assert(prp_idx == col_nxt);
-				assert(_f64_eq(vol_stt, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]),
-					"incorrect heatmap value at row %U/%U col %U/%U.\n"
-					"Expected %d, got %d.",
-					row_idx, dim_tck,
-					col_nxt, dim_tim,
-					vol_stt, hst->hmp[((u64) col_nxt) * dim_tck + row_idx]
-				);
+				exp[((u64) col_nxt) * tck_nbr + row_idx] = vol_stt;
 				col_nxt--;
 			}
 
 		}
 
-		/* Check that we verified all cells. */
+		/* Check that we computed all cells. */
 		assert(col_nxt == -1);
 		assert(upd_lst_tim <= hmp_tim_stt);
 		
 	}
-	assert(tck_cnt == dim_tck);
+	assert(tck_cnt == tck_nbr);
+
+	/*
+	 * Compare each heatmap cell with the sum of the
+	 * expected values of its ticks, in the view's
+	 * format.
+	 */
+	const u8 fmt = viw->hmp_fmt;
+	for (u64 col_idx = 0; col_idx < dim_tim; col_idx++) {
+		for (u64 row_idx = 0; row_idx < dim_tck; row_idx++) {
+			f64 cel_val = 0;
+			for (u64 agg_idx = 0; agg_idx < tck_agg; agg_idx++) {
+				cel_val += exp[col_idx * tck_nbr + row_idx * tck_agg + agg_idx];
+			}
+			const f64 exp_val = tb_lv1_fmt_val(fmt, viw->hmp_scl, cel_val);
+			const f64 hmp_val = tb_lv1_fmt_get(fmt, viw->hmp, col_idx * dim_tck + row_idx);
+			assert(_fmt_eq(fmt, exp_val, hmp_val),
+				"incorrect heatmap value at row %U/%U (tck %U) col %U/%U.\n"
+				"Expected %d (volume %d), got %d.",
+				row_idx, dim_tck,
+				viw->hmp_tck_min + row_idx * tck_agg,
+				col_idx, dim_tim,
+				exp_val, cel_val, hmp_val
+			);
+		}
+	}
+
+	/* Free. */
+	nh_fre(exp, sizeof(f64) * dim_tim * tck_nbr);
 
 }
 
@@ -868,12 +894,14 @@ void tb_tst_lv1_vrf_hst_stt(
 		tim_cln, tim_cur, tim_add
 	);
 
-	/* Verify the heatmap. */
-	_vrf_hst_hmp(
-		ctx, hst,
-		uid_cln, uid_cur, uid_add,
-		tim_cln, tim_cur, tim_add
-	);
+	/* Verify the heatmap of all views. */
+	for (u8 viw_id = 0; viw_id < hst->viw_nbr; viw_id++) {
+		_vrf_hst_hmp(
+			ctx, hst, tb_lv1_viw_get(hst, viw_id),
+			uid_cln, uid_cur, uid_add,
+			tim_cln, tim_cur, tim_add
+		);
+	}
 
 }
 
@@ -898,7 +926,7 @@ void tb_tst_lv1_vrf_hst_res(
 {
 
 	/* Verify the heatmap reference. */
-	const u64 ref = hst->tck_ref;
+	const u64 ref = hst->viws[0].tck_ref;
 	const u64 aid_cur = (tim_cur <= ctx->tim_stt) ? 0 : (tim_cur - 1 - ctx->tim_stt) / ctx->aid_wid;
 	assert(ref == ctx->ref_arr[aid_cur], "reference mismatch at time %U cell %U : expected %U, got %U.\n",
 		tim_cur, aid_cur, ctx->ref_arr[aid_cur], ref); 
@@ -910,8 +938,8 @@ void tb_tst_lv1_vrf_hst_res(
 	 * and dynamically compte the corresponding
 	 * index in @ctx's datastructures.
 	 */
-	const u64 hmp_min = hst->hmp_tck_min;
-	const u64 hmp_max = hst->hmp_tck_max;
+	const u64 hmp_min = hst->viws[0].hmp_tck_min;
+	const u64 hmp_max = hst->viws[0].hmp_tck_max;
 	const u64 hmp_nbr = ctx->hmp_dim_tck;
 	assert(hmp_min + hmp_nbr == hmp_max);
 	assert(hmp_min < hmp_max);
@@ -960,10 +988,10 @@ void tb_tst_lv1_vrf_hst_res(
 				src_val, hmp_val
 			);
 		}
-		assert(chk_nbr == hst->hmp_dim_tck);
+		assert(chk_nbr == hst->viws[0].hmp_dim_tck);
 
 	}
-	assert(itr_nbr + 1 == hst->hmp_dim_tim);
+	assert(itr_nbr + 1 == hst->viws[0].hmp_dim_tim);
 
 	/* Verify the heatmap current column against the
 	 * currently updated column. */
@@ -1009,7 +1037,7 @@ void tb_tst_lv1_vrf_hst_res(
 			avg, hmp_cmp[tck_idx - hmp_min]
 		);
 	}
-	assert(chk_nbr == hst->hmp_dim_tck);
+	assert(chk_nbr == hst->viws[0].hmp_dim_tck);
 
 	/*
 	 * If init, we cannot verify the bid-ask curve,
@@ -0,0 +1,198 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of sources. */
+#define SRC_NB 3
+
+/* Number of elements per source. */
+#define ELM_NB 600
+
+/*
+ * Block validator.
+ */
+static void _blk_val(
+	tb_stg_blk *blk,
+	tb_stg_blk *prv,
+	void *arg
+) {}
+
+/*
+ * Generate @nb non-decreasing times starting at @tim,
+ * with random duplicates.
+ */
+static inline void _tim_gen(
+	u64 *tims,
+	u64 nb,
+	u64 tim,
+	u64 sed
+)
+{
+	for (u64 i = 0; i < nb; i++) {
+		sed = ns_hsh_mas_gen(sed);
+		tim += sed % 3;
+		tims[i] = tim;
+	}
+}
+
+/*
+ * Merge @idxs in [@stt, @end] and verify the output
+ * against @tims.
+ */
+static inline void _mrg_chk(
+	tb_stg_idx **idxs,
+	u64 (*tims)[ELM_NB],
+	u64 stt,
+	u64 end,
+	u64 *nt_err_cnt
+)
+{
+
+	/* Determine the expected first element and count
+	 * of each source. */
+	u64 exp_idx[SRC_NB];
+	u64 exp_end[SRC_NB];
+	for (u8 src_id = 0; src_id < SRC_NB; src_id++) {
+		u64 i = 0;
+		while ((i < ELM_NB) && (tims[src_id][i] < stt)) i++;
+		exp_idx[src_id] = i;
+		while ((i < ELM_NB) && (tims[src_id][i] <= end)) i++;
+		exp_end[src_id] = i;
+	}
+
+	/* Read all batches. */
+	tb_mrg *mrg = tb_mrg_ctr(idxs, SRC_NB, stt, end);
+	const void *dsts[TB_ANB_MAX];
+	u64 prv_tim = 0;
+	u8 prv_src = 0;
+	u8 src_id = 0;
+	u64 tim = 0;
+	u64 nbr;
+	while ((nbr = tb_mrg_nxt(mrg, dsts, &src_id, &tim))) {
+		nt_chk(src_id < SRC_NB);
+		if (src_id >= SRC_NB) break;
+
+		/* Verify the output order. */
+		nt_chk(stt <= tim);
+		nt_chk(tim <= end);
+		nt_chk((prv_tim < tim) || ((prv_tim == tim) && (prv_src <= src_id)));
+		prv_tim = tim;
+		prv_src = src_id;
+
+		/* Verify that elements are the next ones
+		 * of their source, and that they share
+		 * the batch time. */
+		for (u64 i = 0; i < nbr; i++) {
+			const u64 elm_idx = exp_idx[src_id]++;
+			nt_chk(((const u64 *) dsts[0])[i] == tim);
+			nt_chk(((const u64 *) dsts[1])[i] == (((u64) src_id << 32) | elm_idx));
+		}
+
+	}
+	tb_mrg_dtr(mrg);
+
+	/* All elements must have been read. */
+	for (u8 src_id = 0; src_id < SRC_NB; src_id++) {
+		nt_chk(exp_idx[src_id] == exp_end[src_id]);
+	}
+
+}
+
+/*
+ * Unit test for the merge reader.
+ */
+static inline void _mrg_unt_red(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+
+	/* Create a test storage. */
+	system("rm -rf "STG_PTH);
+	tb_stg_ini(STG_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(STG_PTH, 1);
+	assert(sys);
+
+	/* Generate sources with overlapping time ranges. */
+	u64 (*tims)[ELM_NB] = nh_all(SRC_NB * ELM_NB * sizeof(u64));
+	u64 *dat = nh_all(ELM_NB * sizeof(u64));
+	tb_stg_idx *idxs[SRC_NB];
+	u64 keys[SRC_NB];
+	const char *ists[SRC_NB] = {"IST0", "IST1", "IST2"};
+	for (u8 src_id = 0; src_id < SRC_NB; src_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		_tim_gen(tims[src_id], ELM_NB, 1000 + (sed % 50), sed);
+
+		/* Tag each element with its source and index. */
+		for (u64 i = 0; i < ELM_NB; i++) {
+			dat[i] = ((u64) src_id << 32) | i;
+		}
+
+		/* Write in randomly sized chunks. */
+		idxs[src_id] = tb_stg_opn(sys, "MKP", ists[src_id], 0, 1, keys + src_id);
+		assert(idxs[src_id]);
+		u64 wrt_id = 0;
+		while (wrt_id < ELM_NB) {
+			sed = ns_hsh_mas_gen(sed);
+			u64 nb = 1 + (sed % 7);
+			if (nb > ELM_NB - wrt_id) nb = ELM_NB - wrt_id;
+			const void *srcs[5] = {
+				tims[src_id] + wrt_id,
+				dat + wrt_id,
+				dat + wrt_id,
+				dat + wrt_id,
+				dat + wrt_id,
+			};
+			tb_stg_wrt(idxs[src_id], nb, srcs, 5, _blk_val, 0);
+			wrt_id += nb;
+		}
+
+	}
+
+	/* Merge everything. */
+	_mrg_chk(idxs, tims, 0, (u64) -1, nt_err_cnt);
+
+	/* Merge random windows. */
+	for (u8 itr = 0; itr < 16; itr++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u64 stt = tims[sed % SRC_NB][(sed >> 8) % ELM_NB];
+		sed = ns_hsh_mas_gen(sed);
+		const u64 end = stt + (sed % 300);
+		_mrg_chk(idxs, tims, stt, end, nt_err_cnt);
+	}
+
+	/* Cleanup. */
+	for (u8 src_id = 0; src_id < SRC_NB; src_id++) {
+		tb_stg_cls(idxs[src_id], keys[src_id]);
+	}
+	tb_stg_dtr(sys);
+	nh_fre(tims, SRC_NB * ELM_NB * sizeof(u64));
+	nh_fre(dat, ELM_NB * sizeof(u64));
+	system("rm -rf "STG_PTH);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _mrg_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _mrg_unt_red);
+}
+
+/*
+ * Merge reader testing.
+ */
+void tb_tst_mrg(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _mrg_tsq, arg);
+}
@@ -85,6 +85,129 @@ static inline void _obk_unt_add(
 
 }
 
+/***********
+ * Kernels *
+ ***********/
+
+/*
+ * Reference best bid-ask computation, one tick at
+ * a time.
+ */
+static inline uerr _bst_bat_ref(
+	const f64 *obk,
+	u64 stt,
+	u64 end,
+	u64 tck_off,
+	u64 *res
+)
+{
+	u64 bst_bid = 0;
+	u64 bst_ask = (u64) -1;
+	u64 wst_bid = 0;
+	u64 wst_ask = (u64) -1;
+	u8 was_bid = 0;
+	u8 was_ask = 0;
+	uerr inv = 0;
+	for (u64 obk_idx = stt; obk_idx < end; obk_idx++) {
+		const f64 vol = obk[obk_idx];
+		if (vol == 0) continue;
+		const u64 tck_idx = obk_idx + tck_off;
+		if (vol < 0) {
+			if (!was_bid) wst_bid = tck_idx;
+			was_bid = 1;
+			bst_bid = tck_idx;
+			inv |= was_ask;
+		} else {
+			if (!was_ask) bst_ask = tck_idx;
+			was_ask = 1;
+			wst_ask = tck_idx;
+		}
+	}
+	res[0] = bst_bid;
+	res[1] = bst_ask;
+	res[2] = wst_bid;
+	res[3] = wst_ask;
+	return inv;
+}
+
+/*
+ * Unit test for vectorized orderbook kernels.
+ * Compare them with reference implementations on
+ * random books, ranges and updates, so that all
+ * vector alignments and remainders are covered.
+ */
+static inline void _obk_unt_krn(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	const u64 obk_nbr = 64;
+	f64 *obk = nh_all(obk_nbr * sizeof(f64));
+	f64 *obk_ref = nh_all(obk_nbr * sizeof(f64));
+	u64 *tcks = nh_all(obk_nbr * sizeof(u64));
+	f64 *vols = nh_all(obk_nbr * sizeof(f64));
+	u64 rnd = sed;
+	for (u64 itr = 0; itr < 10000; itr++) {
+
+		/* Generate a sparse book of random density. */
+		rnd = ns_hsh_mas_gen(rnd);
+		const u64 dns = ns_hsh_u64_rng(rnd, 0, 5, 1);
+		for (u64 idx = 0; idx < obk_nbr; idx++) {
+			rnd = ns_hsh_mas_gen(rnd);
+			const u64 val = ns_hsh_u64_rng(rnd, 0, 16, 1);
+			obk[idx] = (val >= dns) ? 0 : (val & 1) ? -1.5 : 2.5;
+		}
+
+		/* Compare best bid-asks on a random range. */
+		rnd = ns_hsh_mas_gen(rnd);
+		const u64 stt = ns_hsh_u64_rng(rnd, 0, obk_nbr, 1);
+		rnd = ns_hsh_mas_gen(rnd);
+		const u64 end = ns_hsh_u64_rng(rnd, stt + 1, obk_nbr + 1, 1);
+		rnd = ns_hsh_mas_gen(rnd);
+		const u64 tck_off = ns_hsh_u64_rng(rnd, 0, 1000, 1);
+		u64 ref[4];
+		u64 res[4];
+		const uerr ref_inv = _bst_bat_ref(obk, stt, end, tck_off, ref);
+		const uerr res_inv = tb_obk_bst_bat(obk, obk_nbr, stt, end, tck_off, res, res + 1, res + 2, res + 3);
+		nt_chk(ref_inv == res_inv);
+		for (u8 res_idx = 0; res_idx < 4; res_idx++) {
+			nt_chk(ref[res_idx] == res[res_idx]);
+		}
+
+		/* Generate updates around a random range of the
+		 * book, possibly on the same ticks. */
+		rnd = ns_hsh_mas_gen(rnd);
+		const u64 upd_nbr = ns_hsh_u64_rng(rnd, 1, obk_nbr + 1, 1);
+		const u64 obk_stt = 1000 + stt;
+		const u64 obk_len = end - stt;
+		u64 min = (u64) -1;
+		u64 max = 0;
+		ns_mem_rst(obk, obk_nbr * sizeof(f64));
+		ns_mem_rst(obk_ref, obk_nbr * sizeof(f64));
+		for (u64 upd_idx = 0; upd_idx < upd_nbr; upd_idx++) {
+			rnd = ns_hsh_mas_gen(rnd);
+			const u64 tck = tcks[upd_idx] = ns_hsh_u64_rng(rnd, 990, 1000 + obk_nbr + 10, 1);
+			const f64 vol = vols[upd_idx] = (f64) (upd_idx + 1);
+			min = (min < tck) ? min : tck;
+			max = (max > tck) ? max : tck;
+			if ((obk_stt <= tck) && (tck < obk_stt + obk_len)) obk_ref[tck - obk_stt] = vol;
+		}
+
+		/* Compare updates addition. */
+		u64 upd_min = 0;
+		u64 upd_max = 0;
+		tb_obk_add_upds(obk, obk_stt, obk_len, upd_nbr, tcks, vols, &upd_min, &upd_max);
+		nt_chk(upd_min == min);
+		nt_chk(upd_max == max);
+		nt_chk(!ns_mem_cmp(obk, obk_ref, obk_nbr * sizeof(f64)));
+
+	}
+	nh_fre(obk, obk_nbr * sizeof(f64));
+	nh_fre(obk_ref, obk_nbr * sizeof(f64));
+	nh_fre(tcks, obk_nbr * sizeof(u64));
+	nh_fre(vols, obk_nbr * sizeof(f64));
+}
+
 /*******
  * OBS *
  *******/
@@ -444,6 +567,7 @@ static inline void _obk_tsq(
 {
 	NH_TST_UNT(exc, _obk_unt_ask);
 	NH_TST_UNT(exc, _obk_unt_add);
+	NH_TST_UNT(exc, _obk_unt_krn);
 	NH_TST_UNT(exc, _obk_unt_obs);
 }
 
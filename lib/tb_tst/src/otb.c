@@ -0,0 +1,138 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Maximal number of orders. */
+#define ORD_MAX 1000
+
+/* Number of operations. */
+#define OPR_NB 100000
+
+/*
+ * Unit test for the order table.
+ */
+static inline void _otb_unt_tbl(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_otb *otb = tb_otb_ctr(ORD_MAX);
+
+	/* Reference : handles and broker identifiers
+	 * of live orders, and a handle of each deleted
+	 * order. */
+	u64 *hdls = nh_all(ORD_MAX * sizeof(u64));
+	u64 *ids = nh_all(ORD_MAX * sizeof(u64));
+	u64 *dels = nh_all(ORD_MAX * sizeof(u64));
+	u64 ord_nbr = 0;
+	u64 del_nbr = 0;
+	u64 id_nxt = 0;
+
+	/* Randomly add, fill, update and delete orders. */
+	for (u64 opr_id = 0; opr_id < OPR_NB; opr_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u8 opr = (u8) (sed % 4);
+
+		/* Add with a sparse broker identifier.
+		 * A full table must reject the order. */
+		if ((opr == 0) || (!ord_nbr)) {
+			id_nxt += 1 + ((sed >> 8) % 37);
+			tb_ord ord;
+			tb_ord_ctr(&ord, 0, 0, TB_ORD_TYP_LIM_BUY, 10, 1, 0, id_nxt, TB_ORD_STS_IDL);
+			const u64 hdl = tb_otb_add(otb, &ord);
+			if (ord_nbr == ORD_MAX) {
+				nt_chk(hdl == TB_OTB_HDL_NON);
+				continue;
+			}
+			nt_chk(hdl != TB_OTB_HDL_NON);
+			hdls[ord_nbr] = hdl;
+			ids[ord_nbr] = id_nxt;
+			ord_nbr++;
+			continue;
+		}
+		const u64 ord_id = (sed >> 16) % ord_nbr;
+		const u64 hdl = hdls[ord_id];
+
+		/* Fill partially, then completely. */
+		if (opr == 1) {
+			if (tb_otb_sts(otb, hdl) == TB_ORD_STS_CPL) continue;
+			tb_otb_fil(otb, hdl, 5, 50);
+			tb_otb_hot *hot = tb_otb_hot_get(otb, hdl);
+			nt_chk(hot);
+			nt_chk(hot->sts == ((hot->vol_prm >= 10) ? TB_ORD_STS_CPL : TB_ORD_STS_ACT));
+			nt_chk(hot->vol_sec == 10 * hot->vol_prm);
+		}
+
+		/* Look up by broker identifier and update. */
+		else if (opr == 2) {
+			nt_chk(tb_otb_sch(otb, ids[ord_id]) == hdl);
+			tb_ord ord;
+			nt_chk(!tb_otb_get(otb, hdl, &ord));
+			nt_chk(ord.id == ids[ord_id]);
+			nt_chk(ord.req_vol_prm == 10);
+			nt_chk(ord.req_prc_lim == 1);
+			nt_chk(ord.typ == TB_ORD_TYP_LIM_BUY);
+			if (ord.sts == TB_ORD_STS_IDL) {
+				ord.sts = TB_ORD_STS_ACT;
+				nt_chk(tb_otb_upd(otb, &ord) == hdl);
+				nt_chk(tb_otb_sts(otb, hdl) == TB_ORD_STS_ACT);
+			}
+		}
+
+		/* Delete, keep the handle. */
+		else {
+			nt_chk(!tb_otb_del(otb, hdl));
+			if (del_nbr < ORD_MAX) dels[del_nbr++] = hdl;
+			hdls[ord_id] = hdls[ord_nbr - 1];
+			ids[ord_id] = ids[ord_nbr - 1];
+			ord_nbr--;
+		}
+
+	}
+
+	/* Live orders must be found, deleted ones not. */
+	nt_chk(otb->ord_nbr == ord_nbr);
+	for (u64 ord_id = 0; ord_id < ord_nbr; ord_id++) {
+		nt_chk(tb_otb_sch(otb, ids[ord_id]) == hdls[ord_id]);
+		nt_chk(tb_otb_hot_get(otb, hdls[ord_id]));
+	}
+	for (u64 del_id = 0; del_id < del_nbr; del_id++) {
+		tb_ord ord;
+		nt_chk(!tb_otb_hot_get(otb, dels[del_id]));
+		nt_chk(tb_otb_get(otb, dels[del_id], &ord));
+		nt_chk(tb_otb_del(otb, dels[del_id]));
+	}
+	nt_chk(tb_otb_sch(otb, id_nxt + 1) == TB_OTB_HDL_NON);
+
+	/* Cleanup. */
+	nh_fre(hdls, ORD_MAX * sizeof(u64));
+	nh_fre(ids, ORD_MAX * sizeof(u64));
+	nh_fre(dels, ORD_MAX * sizeof(u64));
+	tb_otb_dtr(otb);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _otb_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _otb_unt_tbl);
+}
+
+/*
+ * Order table testing.
+ */
+void tb_tst_otb(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _otb_tsq, arg);
+}
@@ -0,0 +1,190 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of level 1 records. */
+#define REC_NB 3000
+
+/* First tick and tick range. */
+#define TCK_STT 100000
+#define TCK_NB 64
+
+/* Heatmap resolution and dimensions. */
+#define TIM_RES 100
+#define HMP_DIM 32
+
+/* Time of the first frame. */
+#define TIM_STT 5000
+
+/* Number of frames published by the child and by
+ * the writer thread. */
+#define CHD_NB 8
+#define FRM_NB 200
+
+/*
+ * Writer and consumer context.
+ */
+typedef struct {
+
+	/* Publisher. */
+	tb_pub *pub;
+
+	/* Heatmap checksums per frame. [FRM_NB + 1] */
+	f64 *sums;
+
+	/* Number of frames whose checksum is reported. */
+	volatile a64 frm_nbr;
+
+} _pub_ctx;
+
+/*
+ * Return a checksum of the heatmap at @hmp, sensitive to
+ * the position of cells.
+ */
+static inline f64 _hmp_sum(
+	const f64 *hmp
+)
+{
+	f64 sum = 0;
+	for (u64 cel_id = 0; cel_id < HMP_DIM * HMP_DIM; cel_id++) {
+		sum += hmp[cel_id] * (f64) (cel_id + 1);
+	}
+	return sum;
+}
+
+/*
+ * Writer thread.
+ * Publish frames and report their checksums.
+ */
+static u32 _pub_wrt(
+	_pub_ctx *ctx
+)
+{
+	for (u64 frm_id = 1; frm_id <= FRM_NB; frm_id++) {
+		tb_pub_stp(ctx->pub, TIM_STT + frm_id * TIM_RES);
+		ctx->sums[frm_id] = _hmp_sum(tb_dr1_hmp(ctx->pub->srcs[0].dr1));
+		ns_atm(a64, wrt, rel, &ctx->frm_nbr, frm_id + 1);
+	}
+	return 0;
+}
+
+/*
+ * Unit test for the publisher.
+ */
+static inline void _pub_unt_pub(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	system("rm -rf "PUB_PTH);
+	tb_stg_ini(PUB_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(PUB_PTH, 1);
+	nt_chk(sys);
+	if (!sys) return;
+	_lv1_dat_gen(sys, "PUB", "IST", REC_NB, TCK_STT, TCK_NB, sed);
+
+	/* Publish in a child process that dies while
+	 * writing a frame, holding the write privilege. */
+	pid_t pid = fork();
+	if (!pid) {
+		tb_pub *pub = tb_pub_ctr(sys, 1, TIM_RES, HMP_DIM, HMP_DIM, 0);
+		tb_pub_add(pub, "PUB", "IST", TIM_STT);
+		for (u64 frm_id = 1; frm_id < CHD_NB; frm_id++) {
+			tb_pub_stp(pub, TIM_STT + frm_id * TIM_RES);
+		}
+		ns_atm(a64, wrt, rel, &pub->srcs[0].hdr->seq, pub->srcs[0].seq + 1);
+		_exit(0);
+	}
+	assert(pid > 0);
+	assert(waitpid(pid, 0, 0) == pid);
+
+	/* The last frame is left incomplete. */
+	tb_pub_cns *cns = tb_pub_cns_opn(PUB_PTH, "PUB", "IST", TIM_RES, HMP_DIM, HMP_DIM, 0);
+	const u64 chd_seq = ns_atm(a64, red, acq, &cns->hdr->seq);
+	nt_chk(chd_seq == 2 * CHD_NB + 1);
+
+	/* A new publisher recovers the publication and
+	 * resumes the sequence. */
+	tb_pub *pub = tb_pub_ctr(sys, 1, TIM_RES, HMP_DIM, HMP_DIM, 0);
+	tb_pub_add(pub, "PUB", "IST", TIM_STT);
+	const u64 seq_bas = tb_pub_cns_acq(cns);
+	nt_chk(seq_bas == chd_seq + 3);
+	nt_chk(tb_pub_cns_vld(cns, seq_bas));
+	nt_chk(tb_pub_cns_tim(cns) == TIM_STT);
+
+	/* Publish from a writer thread, consume here.
+	 * Consistent frames must be the published ones,
+	 * in order. */
+	_pub_ctx ctx = {pub, nh_all((FRM_NB + 1) * sizeof(f64)), 1};
+	ctx.sums[0] = _hmp_sum(tb_dr1_hmp(pub->srcs[0].dr1));
+	u8 *thr_blk = nh_all(1024);
+	assert(!nh_thr_run(thr_blk, 1024, 0, (u32 (*)(void *)) &_pub_wrt, &ctx));
+	f64 *hmp = nh_all(HMP_DIM * HMP_DIM * sizeof(f64));
+	u64 frm_lst = 0;
+	u64 vld_nbr = 0;
+	while (frm_lst != FRM_NB) {
+		const u64 seq = tb_pub_cns_acq(cns);
+		const u64 tim = tb_pub_cns_tim(cns);
+		ns_mem_cpy(hmp, tb_pub_cns_hmp(cns), HMP_DIM * HMP_DIM * sizeof(f64));
+		if (!tb_pub_cns_vld(cns, seq)) continue;
+		vld_nbr++;
+		nt_chk(!(seq & 1));
+		nt_chk(seq >= seq_bas);
+		const u64 frm_id = (seq - seq_bas) >> 1;
+		nt_chk(frm_id >= frm_lst);
+		nt_chk(frm_id <= FRM_NB);
+		if ((frm_id < frm_lst) || (frm_id > FRM_NB)) break;
+		frm_lst = frm_id;
+		nt_chk(tim == TIM_STT + frm_id * TIM_RES);
+		while (ns_atm(a64, red, acq, &ctx.frm_nbr) <= frm_id);
+		nt_chk(_hmp_sum(hmp) == ctx.sums[frm_id]);
+	}
+	nt_chk(vld_nbr);
+	while (ns_atm(a64, red, acq, &ctx.frm_nbr) != FRM_NB + 1);
+
+	/* A frame published after a sequence was acquired
+	 * invalidates reads. */
+	const u64 seq = tb_pub_cns_acq(cns);
+	nt_chk(seq == seq_bas + 2 * FRM_NB);
+	nt_chk(tb_pub_cns_vld(cns, seq));
+	tb_pub_stp(pub, TIM_STT + (FRM_NB + 1) * TIM_RES);
+	nt_chk(!tb_pub_cns_vld(cns, seq));
+	nt_chk(tb_pub_cns_acq(cns) == seq + 2);
+	nt_chk(tb_pub_cns_vld(cns, seq + 2));
+	nt_chk(tb_pub_cns_tim(cns) == TIM_STT + (FRM_NB + 1) * TIM_RES);
+
+	/* Cleanup. */
+	nh_fre(hmp, HMP_DIM * HMP_DIM * sizeof(f64));
+	nh_fre(thr_blk, 1024);
+	nh_fre(ctx.sums, (FRM_NB + 1) * sizeof(f64));
+	tb_pub_cns_cls(cns);
+	tb_pub_dtr(pub);
+	tb_stg_dtr(sys);
+	system("rm -rf "PUB_PTH);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _pub_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _pub_unt_pub);
+}
+
+/*
+ * Publisher testing.
+ */
+void tb_tst_pub(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _pub_tsq, arg);
+}
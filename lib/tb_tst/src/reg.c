@@ -0,0 +1,250 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Maximal number of keys of perfect hashes. */
+#define KEY_MAX 1000
+
+/* Number of non-keys looked up. */
+#define NON_NB 1000
+
+/* Number of threads registering, and of names each
+ * one registers. */
+#define THR_NB 4
+#define NAM_NB 256
+
+/*
+ * Registration context.
+ */
+typedef struct {
+
+	/* Seed. */
+	u64 sed;
+
+	/* Number of threads started. */
+	volatile a64 stt_nbr;
+
+	/* Number of threads done. */
+	volatile a64 don_nbr;
+
+	/* Symbols obtained by each thread, by name. */
+	u32 syms[THR_NB][NAM_NB];
+
+	/* Instruments obtained by each thread, by name. */
+	tb_ist *ists[THR_NB][NAM_NB];
+
+} _reg_ctx;
+
+/*
+ * Write at @dst the name of index @nam_id, with
+ * prefix @pfx.
+ */
+static inline void _nam_gen(
+	char *dst,
+	const char *pfx,
+	u32 nam_id
+)
+{
+	while (*pfx) *(dst++) = *(pfx++);
+	for (u8 chr_id = 0; chr_id < 4; chr_id++) {
+		*(dst++) = (char) ('A' + ((nam_id >> (4 * (3 - chr_id))) & 15));
+	}
+	*dst = 0;
+}
+
+/*
+ * Registration thread.
+ * Register all names, in an order of its own.
+ */
+static u32 _reg_thr(
+	_reg_ctx *ctx
+)
+{
+	const u64 thr_id = ns_atm(a64, add_red, aar, &ctx->stt_nbr, 1) - 1;
+	while (ns_atm(a64, red, acq, &ctx->stt_nbr) != THR_NB);
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	const u32 ofs = (u32) (ns_hsh_mas_gen(ctx->sed + thr_id) % NAM_NB);
+	for (u32 cnt = 0; cnt < NAM_NB; cnt++) {
+		const u32 nam_id = (thr_id & 1) ? (ofs + cnt) % NAM_NB : (ofs + NAM_NB - cnt) % NAM_NB;
+		char nam[16];
+		_nam_gen(nam, "REGS", nam_id);
+		ctx->syms[thr_id][nam_id] = tb_sym_get(nam);
+		_nam_gen(nam, "REGI", nam_id);
+		ctx->ists[thr_id][nam_id] = tb_ist_ctr_shr(mkp, nam);
+	}
+	ns_atm(a64, add_red, rel, &ctx->don_nbr, 1);
+	return 0;
+}
+
+/*
+ * Unit test for perfect hashes.
+ */
+static inline void _reg_unt_phf(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	char (*strs)[16] = nh_all(KEY_MAX * 16);
+	const char **keys = nh_all(KEY_MAX * sizeof(char *));
+	u32 *slts = nh_all(KEY_MAX * sizeof(u32));
+	for (u32 key_nbr = 1; key_nbr <= KEY_MAX; key_nbr = 3 * key_nbr + 1) {
+
+		/* Generate distinct keys. */
+		for (u32 key_id = 0; key_id < key_nbr; key_id++) {
+			sed = ns_hsh_mas_gen(sed);
+			_nam_gen(strs[key_id], "K", key_id);
+			strs[key_id][5] = (char) ('a' + sed % 26);
+			strs[key_id][6] = 0;
+			keys[key_id] = strs[key_id];
+		}
+
+		/* Each key has its own slot, the one it
+		 * resolves to. */
+		tb_phf phf;
+		tb_phf_ctr(&phf, keys, key_nbr, slts);
+		const u32 slt_nbr = tb_phf_slt_nbr(&phf);
+		nt_chk(slt_nbr >= key_nbr);
+		u8 *useds = nh_all(slt_nbr);
+		ns_mem_rst(useds, slt_nbr);
+		for (u32 key_id = 0; key_id < key_nbr; key_id++) {
+			const u32 slt = slts[key_id];
+			nt_chk(slt < slt_nbr);
+			if (slt >= slt_nbr) continue;
+			nt_chk(!useds[slt]);
+			useds[slt] = 1;
+			nt_chk(tb_phf_slt(&phf, keys[key_id]) == slt);
+		}
+
+		/* Cleanup. */
+		nh_fre(useds, slt_nbr);
+		tb_phf_dtr(&phf);
+
+	}
+	nh_fre(slts, KEY_MAX * sizeof(u32));
+	nh_fre(keys, KEY_MAX * sizeof(char *));
+	nh_fre(strs, KEY_MAX * 16);
+}
+
+/*
+ * Unit test for currency and marketplace lookups.
+ */
+static inline void _reg_unt_sch(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+
+	/* Every key resolves. */
+	#define TB_CCY(nam, sym) nt_chk(tb_ccy_sch(#sym) == &tb_ccy_##sym);
+	#include <tb_cor/ccys.h>
+	#undef TB_CCY
+	#define TB_MKP(nam, sym, ccy) nt_chk(tb_mkp_sch(#sym) == &tb_mkp_##sym);
+	#include <tb_cor/mkps.h>
+	#undef TB_MKP
+
+	/* Non-keys do not, random ones being lower case
+	 * only. */
+	nt_chk(!tb_ccy_sch(""));
+	nt_chk(!tb_mkp_sch(""));
+	nt_chk(!tb_ccy_sch("usd"));
+	nt_chk(!tb_mkp_sch("NASDAQ_US_"));
+	char str[8];
+	for (u32 non_id = 0; non_id < NON_NB; non_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u8 len = (u8) (sed % 7);
+		for (u8 chr_id = 0; chr_id < len; chr_id++) {
+			str[chr_id] = (char) ('a' + (sed >> (8 * chr_id + 8)) % 26);
+		}
+		str[len] = 0;
+		nt_chk(!tb_ccy_sch(str));
+		nt_chk(!tb_mkp_sch(str));
+	}
+
+}
+
+/*
+ * Unit test for concurrent registrations.
+ */
+static inline void _reg_unt_thr(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	_reg_ctx *ctx = nh_all(sizeof(_reg_ctx));
+	ns_mem_rst(ctx, sizeof(_reg_ctx));
+	ctx->sed = sed;
+	u8 *thr_blks = nh_all(THR_NB * 1024);
+	for (u8 thr_id = 0; thr_id < THR_NB; thr_id++) {
+		assert(!nh_thr_run(thr_blks + thr_id * 1024, 1024, 0, (u32 (*)(void *)) &_reg_thr, ctx));
+	}
+	while (ns_atm(a64, red, acq, &ctx->don_nbr) != THR_NB);
+
+	/* All threads obtained the same symbols and
+	 * instruments. */
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	char nam[16];
+	for (u32 nam_id = 0; nam_id < NAM_NB; nam_id++) {
+		const u32 sym = ctx->syms[0][nam_id];
+		tb_ist *ist = ctx->ists[0][nam_id];
+		for (u8 thr_id = 1; thr_id < THR_NB; thr_id++) {
+			nt_chk(ctx->syms[thr_id][nam_id] == sym);
+			nt_chk(ctx->ists[thr_id][nam_id] == ist);
+		}
+
+		/* They resolve and are complete. */
+		_nam_gen(nam, "REGS", nam_id);
+		nt_chk(sym != TB_SYM_NON);
+		nt_chk(tb_sym_sch(nam) == sym);
+		nt_chk(tb_str_equ(tb_sym_str(sym), nam));
+		_nam_gen(nam, "REGI", nam_id);
+		nt_chk(ist);
+		if (!ist) continue;
+		nt_chk(tb_ist_ctr_shr(mkp, nam) == ist);
+		nt_chk(ist->cls == TB_IST_CLS_SHR);
+		nt_chk(ist->shr.mkp == mkp);
+		nt_chk(tb_str_equ(tb_sym_str(ist->shr.sym), nam));
+		nt_chk(tb_ist_get(ist->id) == ist);
+
+	}
+
+	/* Distinct names have distinct symbols and
+	 * instruments. */
+	for (u32 nam_id = 0; nam_id < NAM_NB; nam_id++) {
+		for (u32 nam_id1 = 0; nam_id1 < nam_id; nam_id1++) {
+			nt_chk(ctx->syms[0][nam_id] != ctx->syms[0][nam_id1]);
+			nt_chk(ctx->ists[0][nam_id] != ctx->ists[0][nam_id1]);
+		}
+	}
+
+	/* Cleanup. */
+	nh_fre(thr_blks, THR_NB * 1024);
+	nh_fre(ctx, sizeof(_reg_ctx));
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _reg_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _reg_unt_phf);
+	NH_TST_UNT(exc, _reg_unt_sch);
+	NH_TST_UNT(exc, _reg_unt_thr);
+}
+
+/*
+ * Registry testing.
+ */
+void tb_tst_reg(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _reg_tsq, arg);
+}
@@ -318,6 +318,61 @@ static u32 _sgm_exc(
 	return 0;
 }
 
+/*
+ * Verify that the write privilege of a process that
+ * died while holding it is recovered.
+ */
+static inline void _sgm_lse(
+	void *dat
+)
+{
+	nh_fs_del_stg(SGM_PTH);
+	tb_sgm *sgm = tb_sgm_fopn(
+		1,
+		dat,
+		128,
+		1,
+		rgn_sizs,
+		1,
+		SGM_ELM_NB,
+		_sgm_elm_sizs,
+		SGM_PTH
+	);
+	assert(sgm);
+	uad off = 0;
+
+	/* Write in a child process that dies while holding
+	 * the write privilege, in the middle of a write. */
+	pid_t pid = fork();
+	if (!pid) {
+		void *dst = 0;
+		assert(!tb_sgm_wrt_get(sgm, &off));
+		tb_sgm_wrt_loc(sgm, 16, &dst, 1);
+		tb_sgm_wrt_don(sgm, 16);
+		tb_sgm_wrt_loc(sgm, 16, &dst, 1);
+		_exit(0);
+	}
+	assert(pid > 0);
+	assert(waitpid(pid, 0, 0) == pid);
+
+	/* The privilege must not be free, but recoverable,
+	 * with reported elements only. */
+	assert(tb_sgm_wrt_get(sgm, &off));
+	assert(!tb_sgm_wrt_rcv(sgm, &off));
+	assert(off == 16);
+
+	/* A live holder must keep it. */
+	assert(tb_sgm_wrt_rcv(sgm, &off));
+	tb_sgm_wrt_cpl(sgm);
+	assert(!tb_sgm_wrt_get(sgm, &off));
+	tb_sgm_wrt_cpl(sgm);
+
+	/* Cleanup. */
+	tb_sgm_cls(sgm);
+	nh_fs_del_stg(SGM_PTH);
+
+}
+
 static inline tb_tst_sgm_dsc *_sgm_dsc_gen(
 	u64 sed,
 	void *dat,
@@ -363,6 +418,9 @@ void tb_tst_sgm(
 	/* Parallel testing. */
 	TST_PRL(prc, _sgm_exc, _sgm_dsc_gen(sed, dat, SGM_PTH, wrk_nb));	
 
+	/* Write privilege recovery. */
+	_sgm_lse(dat);
+
 	/* Clean. */
 	nh_fs_del_stg(SGM_PTH);
 
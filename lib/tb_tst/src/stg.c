@@ -103,6 +103,46 @@ static void _blk_val(
 	ns_atm(a64, inc_red, acq, arg);
 }	
 
+/*
+ * Parallel scan block function.
+ */
+static void _scn_blk(
+	void *_ctx,
+	const void **arrs,
+	u64 elm_nbr,
+	const void *obs,
+	void *arg
+)
+{
+	tb_tst_stg_scn *ctx = _ctx;
+	const u64 *tims = arrs[0];
+	for (u64 elm_id = 0; elm_id < elm_nbr; elm_id++) {
+		if (ctx->nbr && (tims[elm_id] < ctx->end)) ctx->err++;
+		if (!ctx->nbr) ctx->stt = tims[elm_id];
+		ctx->end = tims[elm_id];
+		ctx->nbr++;
+	}
+}
+
+/*
+ * Parallel scan reduction.
+ */
+static void _scn_red(
+	void *_dst,
+	void *_src,
+	void *arg
+)
+{
+	tb_tst_stg_scn *dst = _dst;
+	tb_tst_stg_scn *src = _src;
+	if (!src->nbr) return;
+	if (dst->nbr && (src->stt < dst->end)) dst->err++;
+	if (!dst->nbr) dst->stt = src->stt;
+	dst->end = src->end;
+	dst->nbr += src->nbr;
+	dst->err += src->err;
+}
+
 /*
  * Per-thread level-specific entrypoint.
  */
@@ -296,6 +336,14 @@ static void _stg_exc_lvl(
 
 	}
 
+	/* Everyone scans the whole range in parallel. */
+	tb_tst_stg_scn ctxs[4] = {};
+	tb_stg_scn(idx, tim_stt, tim_end, 4, _scn_blk, _scn_red, ctxs, sizeof(tb_tst_stg_scn), 0);
+	assert(ctxs[0].nbr == wrt_id);
+	assert(ctxs[0].stt == tim_stt);
+	assert(ctxs[0].end == tim_end);
+	assert(!ctxs[0].err);
+
 	/* Unload. */
 	tb_stg_cls(idx, dsc->key);
 	tb_stg_dtr(sys);
@@ -316,6 +364,87 @@ static u32 _stg_exc(
 	return 0;
 }
 
+/*
+ * Verify that an index whose writer died in the middle
+ * of a write is recovered with all reported data.
+ */
+static inline void _stg_rcv(
+	u64 *dat
+)
+{
+	/* Strictly increasing times, 12 blocks. */
+	const u64 elm_nb = 3 * 12;
+	u64 tims[elm_nb];
+	for (u64 elm_id = 0; elm_id < elm_nb; elm_id++) {
+		tims[elm_id] = 1000 + 10 * elm_id;
+	}
+	#define SRCS(id) (const void *[]) {tims + (id), dat + (id), dat + (id), dat + (id), dat + (id)}
+
+	system("rm -rf "STG_PTH);
+	tb_stg_ini(STG_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(STG_PTH, 1);
+	assert(sys);
+	u64 key = 0;
+	a64 val_cnt = 0;
+
+	/* Write 10 full blocks and one element in a child
+	 * process, then write a second element in the last
+	 * block without reporting it in the index table, and
+	 * die while holding the index's write privilege. */
+	pid_t pid = fork();
+	if (!pid) {
+		tb_stg_idx *idx = tb_stg_opn(sys, "MKP", "RCV", 0, TB_STG_WRT, &key);
+		assert(idx);
+		tb_stg_wrt(idx, 31, SRCS(0), 5, _blk_val, &val_cnt);
+		tb_stg_blk *blk = tb_stg_lod_tim(idx, tims[30]);
+		assert(blk);
+		uad off = 0;
+		void *dsts[5];
+		assert(!tb_sgm_wrt_get(blk->sgm, &off));
+		assert(off == 1);
+		tb_sgm_wrt_loc(blk->sgm, 1, dsts, 5);
+		for (u8 arr_id = 0; arr_id < 5; arr_id++) {
+			*(u64 *) dsts[arr_id] = ((const u64 *) SRCS(31)[arr_id])[0];
+		}
+		tb_sgm_wrt_don(blk->sgm, 1);
+		_exit(0);
+	}
+	assert(pid > 0);
+	assert(waitpid(pid, 0, 0) == pid);
+
+	/* The write privilege is not free, but recoverable. */
+	assert(!tb_stg_opn(sys, "MKP", "RCV", 0, TB_STG_WRT, &key));
+	tb_stg_idx *idx = tb_stg_opn(sys, "MKP", "RCV", 0, TB_STG_RCV, &key);
+	assert(idx);
+	assert(key);
+
+	/* Recovery reports the unreported element. */
+	tb_stg_rcv(idx, _blk_val, &val_cnt);
+	assert(tb_sgm_elm_nbr(idx->sgm) == 11);
+	assert(idx->tbl[10][0] == tims[30]);
+	assert(idx->tbl[10][1] == tims[31]);
+
+	/* Writes resume after it. */
+	tb_stg_wrt(idx, elm_nb - 32, SRCS(32), 5, _blk_val, &val_cnt);
+	assert(tb_sgm_elm_nbr(idx->sgm) == 12);
+	assert(ns_atm(a64, red, acq, &val_cnt) == 2);
+	const void *dsts[5];
+	u64 red_id = 0;
+	tb_stg_red(idx, tims[0], tims[elm_nb - 1], dsts, 5) {
+		assert(((const u64 *) dsts[0])[blk_id] == tims[red_id]);
+		assert(((const u64 *) dsts[4])[blk_id] == dat[red_id]);
+		red_id++;
+	}
+	assert(red_id == elm_nb);
+	#undef SRCS
+
+	/* Cleanup. */
+	tb_stg_cls(idx, key);
+	tb_stg_dtr(sys);
+	system("rm -rf "STG_PTH);
+
+}
+
 /*
  * Storage testing.
  */
@@ -344,6 +473,9 @@ void tb_tst_stg(
 	/* Parallel testing. */
 	TST_PRL(prc, _stg_exc, _stg_dsc_gen(sed, dat, tims, STG_PTH, wrk_nb, mkp, ist, tst_prl_mst));	
 
+	/* Writer death recovery. */
+	_stg_rcv(dat);
+
 	/* Clean if needed. */
 	system("rm -rf "STG_PTH);
 
@@ -0,0 +1,219 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of latency samples and their bound. */
+#define SMP_NB 10000
+#define SMP_MAX 8192
+
+/* Number of threads claiming pages. */
+#define THR_NB 4
+
+/* Number of events counted by each thread. */
+#define EVT_NB 1000
+
+/*
+ * Page claim context.
+ */
+typedef struct {
+
+	/* Number of threads started. */
+	volatile a64 stt_nbr;
+
+	/* Number of threads done. */
+	volatile a64 don_nbr;
+
+	/* Page of each thread. */
+	tb_stt_pag *pags[THR_NB];
+
+} _stt_ctx;
+
+/*
+ * Page claim thread.
+ * Count events on the page of the calling thread.
+ */
+static u32 _stt_thr(
+	_stt_ctx *ctx
+)
+{
+	const u64 thr_id = ns_atm(a64, add_red, aar, &ctx->stt_nbr, 1) - 1;
+	tb_stt_pag *pag = tb_stt_pag_get();
+	ctx->pags[thr_id] = pag;
+	for (u64 evt_id = 0; evt_id < EVT_NB; evt_id++) {
+		ns_atm(a64, add_red, rel, &tb_stt_pag_get()->evts[TB_STT_EVT_LV1_UPD], 1);
+	}
+	ns_atm(a64, add_red, rel, &ctx->don_nbr, 1);
+	return 0;
+}
+
+/*
+ * Unit test for latency buckets.
+ */
+static inline void _stt_unt_bkt(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+
+	/* Small latencies have their own bucket. */
+	for (u64 val = 0; val < 64; val++) {
+		nt_chk(tb_stt_lat_bkt(val) == val);
+		nt_chk(tb_stt_lat_low(val) == val);
+	}
+
+	/* Then, buckets double every 2 ^ TB_STT_LAT_SUB. */
+	nt_chk(tb_stt_lat_bkt(65) == 64);
+	nt_chk(tb_stt_lat_bkt(66) == 65);
+	nt_chk(tb_stt_lat_low(65) == 66);
+	nt_chk(tb_stt_lat_bkt(127) == 95);
+	nt_chk(tb_stt_lat_bkt(128) == 96);
+	nt_chk(tb_stt_lat_low(96) == 128);
+	nt_chk(tb_stt_lat_bkt((u64) -1) == TB_STT_LAT_BKT_NBR - 1);
+
+	/* Each value lies in its bucket, whose width is
+	 * bounded relatively to its low bound. */
+	u64 bkt_prv = 0;
+	for (u64 val = 0; val < (1 << 16); val++) {
+		const u64 bkt = tb_stt_lat_bkt(val);
+		nt_chk(bkt >= bkt_prv);
+		nt_chk(tb_stt_lat_low(bkt) <= val);
+		nt_chk(val < tb_stt_lat_low(bkt + 1));
+		bkt_prv = bkt;
+	}
+	for (u64 smp_id = 0; smp_id < SMP_NB; smp_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u64 val = sed >> (sed & 63);
+		const u64 bkt = tb_stt_lat_bkt(val);
+		nt_chk(bkt < TB_STT_LAT_BKT_NBR);
+		const u64 low = tb_stt_lat_low(bkt);
+		nt_chk(low <= val);
+		if (bkt + 1 < TB_STT_LAT_BKT_NBR) {
+			const u64 hgh = tb_stt_lat_low(bkt + 1);
+			nt_chk(val < hgh);
+			if (bkt >= (1 << TB_STT_LAT_SUB)) nt_chk(((hgh - low) << TB_STT_LAT_SUB) <= low);
+		}
+	}
+
+}
+
+/*
+ * Unit test for latency percentiles.
+ */
+static inline void _stt_unt_pct(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_stt_lat *lat = nh_all(sizeof(tb_stt_lat));
+	ns_mem_rst(lat, sizeof(tb_stt_lat));
+
+	/* No samples. */
+	nt_chk(tb_stt_lat_pct(lat, 1, 2) == 0);
+
+	/* Samples 1 to 100. */
+	for (u64 val = 1; val <= 100; val++) {
+		lat->bkts[tb_stt_lat_bkt(val)]++;
+		lat->sum += val;
+		lat->cnt++;
+	}
+	nt_chk(tb_stt_lat_pct(lat, 1, 2) == 51);
+	nt_chk(tb_stt_lat_pct(lat, 99, 100) == 100);
+	nt_chk(tb_stt_lat_pct(lat, 1, 1) == 102);
+	nt_chk(tb_stt_lat_pct(lat, 0, 1) == 1);
+
+	/* Random samples, compare with the exact ranks. */
+	ns_mem_rst(lat, sizeof(tb_stt_lat));
+	u64 *cnts = nh_all(SMP_MAX * sizeof(u64));
+	ns_mem_rst(cnts, SMP_MAX * sizeof(u64));
+	for (u64 smp_id = 0; smp_id < SMP_NB; smp_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u64 val = sed % SMP_MAX;
+		cnts[val]++;
+		lat->bkts[tb_stt_lat_bkt(val)]++;
+	}
+	const u64 pcts[][2] = {{1, 100}, {1, 2}, {9, 10}, {99, 100}, {999, 1000}, {1, 1}};
+	for (u8 pct_id = 0; pct_id < sizeof(pcts) / sizeof(pcts[0]); pct_id++) {
+		const u64 rnk = (SMP_NB * pcts[pct_id][0] + pcts[pct_id][1] - 1) / pcts[pct_id][1];
+		u64 cum = 0;
+		u64 val = 0;
+		while ((cum += cnts[val]) < rnk) val++;
+		nt_chk(tb_stt_lat_pct(lat, pcts[pct_id][0], pcts[pct_id][1]) == tb_stt_lat_low(tb_stt_lat_bkt(val) + 1));
+	}
+
+	/* Cleanup. */
+	nh_fre(cnts, SMP_MAX * sizeof(u64));
+	nh_fre(lat, sizeof(tb_stt_lat));
+
+}
+
+/*
+ * Unit test for per-thread pages.
+ */
+static inline void _stt_unt_pag(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	void *sum_blk = nh_all(sizeof(tb_stt_pag) + 64);
+	tb_stt_pag *sum = (tb_stt_pag *) (((uad) sum_blk + 63) & ~(uad) 63);
+	const tb_stt_set *set = tb_stt_set_cur;
+
+	/* Count events from multiple threads. */
+	tb_stt_sum(sum, set);
+	const u64 evt_nbr = sum->evts[TB_STT_EVT_LV1_UPD];
+	const u64 clm_nbr = ns_atm(a64, red, acq, &set->clm_nbr);
+	_stt_ctx ctx = {0};
+	u8 *thr_blks = nh_all(THR_NB * 1024);
+	for (u8 thr_id = 0; thr_id < THR_NB; thr_id++) {
+		assert(!nh_thr_run(thr_blks + thr_id * 1024, 1024, 0, (u32 (*)(void *)) &_stt_thr, &ctx));
+	}
+	while (ns_atm(a64, red, acq, &ctx.don_nbr) != THR_NB);
+
+	/* Threads have their own page, unless pages
+	 * were exhausted. */
+	if (clm_nbr + THR_NB <= TB_STT_PAG_NBR) {
+		for (u8 thr_id = 0; thr_id < THR_NB; thr_id++) {
+			nt_chk(set->pags <= ctx.pags[thr_id]);
+			nt_chk(ctx.pags[thr_id] < set->pags + TB_STT_PAG_NBR);
+			for (u8 thr_id1 = 0; thr_id1 < thr_id; thr_id1++) {
+				nt_chk(ctx.pags[thr_id] != ctx.pags[thr_id1]);
+			}
+		}
+	}
+
+	/* Their counts are summed. */
+	tb_stt_sum(sum, set);
+	nt_chk(sum->evts[TB_STT_EVT_LV1_UPD] >= evt_nbr + THR_NB * EVT_NB);
+
+	/* Cleanup. */
+	nh_fre(thr_blks, THR_NB * 1024);
+	nh_fre(sum_blk, sizeof(tb_stt_pag) + 64);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _stt_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _stt_unt_bkt);
+	NH_TST_UNT(exc, _stt_unt_pct);
+	NH_TST_UNT(exc, _stt_unt_pag);
+}
+
+/*
+ * Statistics testing.
+ */
+void tb_tst_stt(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _stt_tsq, arg);
+}
@@ -0,0 +1,193 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of level 1 records. */
+#define REC_NB 3000
+
+/* First tick and tick range. */
+#define TCK_STT 100000
+#define TCK_NB 64
+
+/* Replay resolution and heatmap dimensions. */
+#define TIM_RES 100
+#define HMP_DIM 32
+
+/* Time of the first step. */
+#define TIM_STT 5000
+
+/* Number of steps. */
+#define STP_NB 6
+
+/* Number of instances, not a multiple of the batch
+ * size, and of worker threads. */
+#define INS_NB 37
+#define THR_NB 3
+
+/* Broker tick size, latency and capacity. */
+#define TCK_SIZ 0.01
+#define LAT 10
+#define ORD_MAX 4
+
+/* Initial amounts. */
+#define PRM_INI 10
+#define SEC_INI 1000000
+
+/*
+ * Strategy context.
+ */
+typedef struct {
+
+	/* Primary instrument. */
+	tb_ist *prm;
+
+	/* Secondary instrument. */
+	tb_ist *sec;
+
+} _swp_ctx;
+
+/*
+ * Scripted strategy, volume in parameter 0.
+ * Step 1 : pass a buy resting far below the market,
+ * then a marketable buy.
+ * Step 2 : report the primary held in state 0.
+ * Step 3 : pass a marketable sell, cancel the resting
+ * buy.
+ * Step 4 : report the primary held in state 1.
+ * Failed passes are counted in state 2.
+ */
+static void _swp_stp(
+	tb_swp *swp,
+	u32 ins_stt,
+	u32 ins_end,
+	u64 tim,
+	_swp_ctx *ctx
+)
+{
+	const u64 stp_id = (tim - TIM_STT) / TIM_RES;
+	const f64 *vols = tb_swp_prm(swp, 0);
+	f64 *fais = tb_swp_stt(swp, 2);
+	for (u32 ins = ins_stt; ins < ins_end; ins++) {
+		tb_ord ord;
+		if (stp_id == 1) {
+			tb_ord_ctr(&ord, ctx->prm, ctx->sec, TB_ORD_TYP_LIM_BUY, 1, 1000 * TCK_SIZ, 0, 0, TB_ORD_STS_IDL);
+			fais[ins] += tb_swp_ord_pas(swp, ins, &ord);
+			tb_ord_ctr(&ord, ctx->prm, ctx->sec, TB_ORD_TYP_LIM_BUY, vols[ins], (TCK_STT + 2 * TCK_NB) * TCK_SIZ, 0, 0, TB_ORD_STS_IDL);
+			fais[ins] += tb_swp_ord_pas(swp, ins, &ord);
+		} else if (stp_id == 2) {
+			tb_swp_stt(swp, 0)[ins] = tb_wlt_get(tb_swp_wlt(swp, ins), ctx->prm);
+		} else if (stp_id == 3) {
+			tb_ord_ctr(&ord, ctx->prm, ctx->sec, TB_ORD_TYP_LIM_SEL, vols[ins], (TCK_STT - TCK_NB) * TCK_SIZ, 0, 0, TB_ORD_STS_IDL);
+			fais[ins] += tb_swp_ord_pas(swp, ins, &ord);
+			tb_bkr_ord_ccl(tb_swp_bkr(swp, ins), 0);
+		} else if (stp_id == 4) {
+			tb_swp_stt(swp, 1)[ins] = tb_wlt_get(tb_swp_wlt(swp, ins), ctx->prm);
+		}
+	}
+}
+
+/*
+ * Unit test for settlements.
+ * Each instance keeps an order open while the ones
+ * passed after it complete.
+ */
+static inline void _swp_unt_stl(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	system("rm -rf "SWP_PTH);
+	tb_stg_ini(SWP_PTH);
+	tb_stg_sys *sys = tb_stg_ctr(SWP_PTH, 1);
+	nt_chk(sys);
+	if (!sys) return;
+	_lv1_dat_gen(sys, "SWP", "IST", REC_NB, TCK_STT, TCK_NB, sed);
+
+	/* Construct the runner, fund instances. */
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	_swp_ctx ctx = {
+		tb_ist_ctr_shr(mkp, "SWPA"),
+		tb_ist_ctr_ccy(mkp, &tb_ccy_USD)
+	};
+	tb_dr1 *dr1 = tb_dr1_ctr(sys, "SWP", "IST", TIM_RES, HMP_DIM, HMP_DIM, 0, 1, TIM_STT);
+	tb_swp *swp = tb_swp_ctr(
+		dr1,
+		INS_NB,
+		1,
+		3,
+		TCK_SIZ,
+		LAT,
+		ORD_MAX,
+		THR_NB,
+		(void (*)(tb_swp *, u32, u32, u64, void *)) &_swp_stp,
+		&ctx
+	);
+	for (u32 ins = 0; ins < INS_NB; ins++) {
+		tb_swp_prm(swp, 0)[ins] = (f64) (1 + (ins % 4));
+		tb_wlt_sim_add(tb_swp_wlt(swp, ins), ctx.sec, SEC_INI);
+		tb_wlt_sim_add(tb_swp_wlt(swp, ins), ctx.prm, PRM_INI);
+	}
+
+	/* Run. */
+	tb_swp_run(swp, TIM_STT + STP_NB * TIM_RES, TIM_RES, 0);
+
+	/* Check each instance. */
+	for (u32 ins = 0; ins < INS_NB; ins++) {
+		const f64 vol = tb_swp_prm(swp, 0)[ins];
+		tb_bks *bks = ns_cnt_of(tb_swp_bkr(swp, ins), tb_bks, bkr);
+		nt_chk(tb_swp_stt(swp, 2)[ins] == 0);
+		nt_chk(bks->ord_nbr == 3);
+		if (bks->ord_nbr != 3) continue;
+		const tb_ord *rst = &bks->ords[0].ord;
+		const tb_ord *buy = &bks->ords[1].ord;
+		const tb_ord *sel = &bks->ords[2].ord;
+		nt_chk(rst->sts == TB_ORD_STS_CCL);
+		nt_chk(buy->sts == TB_ORD_STS_CPL);
+		nt_chk(sel->sts == TB_ORD_STS_CPL);
+
+		/* The marketable buy was settled while the
+		 * resting one was open. */
+		nt_chk(tb_swp_stt(swp, 0)[ins] == PRM_INI + vol);
+
+		/* All were settled, the cancelled one
+		 * refunded. */
+		nt_chk(tb_swp_stt(swp, 1)[ins] == PRM_INI);
+		tb_wlt *wlt = tb_swp_wlt(swp, ins);
+		nt_chk(tb_wlt_get(wlt, ctx.prm) == PRM_INI);
+		const f64 sec = SEC_INI - buy->rsp_vol_sec + sel->rsp_vol_sec;
+		const f64 dif = tb_wlt_get(wlt, ctx.sec) - sec;
+		nt_chk((-1e-6 < dif) && (dif < 1e-6));
+
+	}
+
+	/* Cleanup. */
+	tb_swp_dtr(swp);
+	tb_dr1_dtr(dr1);
+	tb_stg_dtr(sys);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _swp_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _swp_unt_stl);
+}
+
+/*
+ * Sweep runner testing.
+ */
+void tb_tst_swp(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _swp_tsq, arg);
+}
@@ -0,0 +1,86 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of strings. */
+#define STR_NB 1000
+
+/*
+ * Generate the string of index @idx of seed @sed
+ * at @dst.
+ */
+static inline void _str_gen(
+	char *dst,
+	u64 sed,
+	u64 idx
+)
+{
+	dst[0] = 's';
+	dst[1] = 'y';
+	dst[2] = 'm';
+	char *end = ns_u64_to_str_hex(sed ^ idx, dst + 3, 16);
+	*end = 0;
+}
+
+/*
+ * Unit test for symbols.
+ */
+static inline void _sym_unt_itn(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	u32 *syms = nh_all(STR_NB * sizeof(u32));
+	tb_str str;
+
+	/* Intern, symbols must be distinct and map
+	 * back to their strings. */
+	for (u64 idx = 0; idx < STR_NB; idx++) {
+		_str_gen(str, sed, idx);
+		const u32 sym = syms[idx] = tb_sym_get(str);
+		nt_chk(sym != TB_SYM_NON);
+		nt_chk(tb_str_equ(tb_sym_str(sym), str));
+		for (u64 prv = 0; prv < idx; prv++) {
+			nt_chk(syms[prv] != sym);
+		}
+	}
+
+	/* Interning again must return the same symbols. */
+	for (u64 idx = 0; idx < STR_NB; idx++) {
+		_str_gen(str, sed, idx);
+		nt_chk(tb_sym_get(str) == syms[idx]);
+		nt_chk(tb_sym_sch(str) == syms[idx]);
+	}
+
+	/* Unknown strings have no symbol. */
+	_str_gen(str, sed, STR_NB);
+	nt_chk(tb_sym_sch(str) == TB_SYM_NON);
+
+	nh_fre(syms, STR_NB * sizeof(u32));
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _sym_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _sym_unt_itn);
+}
+
+/*
+ * Symbols testing.
+ */
+void tb_tst_sym(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _sym_tsq, arg);
+}
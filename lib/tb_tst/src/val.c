@@ -0,0 +1,171 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/* Number of shares per marketplace. */
+#define SHR_NB 37
+
+/* Number of instruments. */
+#define IST_NB (2 * SHR_NB + 2)
+
+/* Number of wallets. */
+#define WLT_NB 50
+
+/* Number of updates. */
+#define UPD_NB 200
+
+/*
+ * Return 1 if @val and @ref differ beyond rounding.
+ */
+static inline u8 _val_dif(
+	f64 val,
+	f64 ref
+)
+{
+	const f64 dif = val - ref;
+	const f64 mag = (ref < 0) ? -ref : ref;
+	return ((dif < 0) ? -dif : dif) > 1e-9 * (1 + mag);
+}
+
+/*
+ * Verify the valuations of @val against a brute force
+ * valuation of @wlts over @ists.
+ */
+static inline void _val_chk(
+	tb_val *val,
+	tb_wlt **wlts,
+	tb_ist **ists,
+	const f64 *prcs,
+	const f64 *rats,
+	const f64 *mrts,
+	u64 *nt_err_cnt
+)
+{
+	for (u32 wlt_id = 0; wlt_id < WLT_NB; wlt_id++) {
+		f64 nav = 0;
+		f64 mrg = 0;
+		f64 exp_usd = 0;
+		f64 exp_eur = 0;
+		for (u32 ist_id = 0; ist_id < IST_NB; ist_id++) {
+			const f64 amt = tb_wlt_get(wlts[wlt_id], ists[ist_id]);
+			const u8 eur = (ist_id >= SHR_NB) && (ist_id != IST_NB - 2);
+			const f64 loc = amt * prcs[ist_id];
+			const f64 ref = loc * rats[eur];
+			nav += ref;
+			mrg += ((ref < 0) ? -ref : ref) * mrts[ist_id];
+			if (eur) exp_eur += loc;
+			else exp_usd += loc;
+		}
+		nt_chk(!_val_dif(tb_val_nav(val, wlt_id), nav));
+		nt_chk(!_val_dif(tb_val_mrg(val, wlt_id), mrg));
+		nt_chk(!_val_dif(tb_val_exp(val, wlt_id, &tb_ccy_USD), exp_usd));
+		nt_chk(!_val_dif(tb_val_exp(val, wlt_id, &tb_ccy_EUR), exp_eur));
+	}
+}
+
+/*
+ * Unit test for incremental valuation.
+ */
+static inline void _val_unt_inc(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+
+	/* Create US and EU shares, then the USD and EUR
+	 * currencies. */
+	tb_mkp *mkp_us = tb_mkp_sch("NASDAQ_US");
+	tb_mkp *mkp_eu = tb_mkp_sch("ENX_EU");
+	tb_ist *ists[IST_NB];
+	for (u32 shr_id = 0; shr_id < SHR_NB; shr_id++) {
+		const char sym[6] = {'V', 'A', 'L', (char) ('A' + shr_id / 26), (char) ('A' + shr_id % 26), 0};
+		ists[shr_id] = tb_ist_ctr_shr(mkp_us, sym);
+		ists[SHR_NB + shr_id] = tb_ist_ctr_shr(mkp_eu, sym);
+	}
+	ists[IST_NB - 2] = tb_ist_ctr_ccy(mkp_us, &tb_ccy_USD);
+	ists[IST_NB - 1] = tb_ist_ctr_ccy(mkp_eu, &tb_ccy_EUR);
+
+	/* Reference prices and rates. */
+	f64 prcs[IST_NB];
+	f64 mrts[IST_NB];
+	f64 rats[2] = {1, 1};
+	for (u32 ist_id = 0; ist_id < IST_NB; ist_id++) {
+		prcs[ist_id] = (ist_id >= IST_NB - 2) ? 1 : 0;
+		mrts[ist_id] = 1;
+	}
+
+	/* Create wallets with random holdings. */
+	tb_val *val = tb_val_ctr(WLT_NB);
+	tb_wlt *wlts[WLT_NB];
+	for (u32 wlt_id = 0; wlt_id < WLT_NB; wlt_id++) {
+		wlts[wlt_id] = tb_wlt_ctr();
+		for (u32 ist_id = 0; ist_id < IST_NB; ist_id++) {
+			sed = ns_hsh_mas_gen(sed);
+			if (sed & 1) tb_wlt_sim_add(wlts[wlt_id], ists[ist_id], (f64) ((sed >> 8) % 1000));
+		}
+		nt_chk(tb_val_wlt_add(val, wlts[wlt_id]) == wlt_id);
+	}
+	_val_chk(val, wlts, ists, prcs, rats, mrts, nt_err_cnt);
+
+	/* Move a few prices per update, sometimes change
+	 * a rate, or credit a wallet before the update. */
+	for (u32 upd_id = 0; upd_id < UPD_NB; upd_id++) {
+		sed = ns_hsh_mas_gen(sed);
+		const u32 mov_nb = 1 + (u32) (sed % 5);
+		for (u32 mov_id = 0; mov_id < mov_nb; mov_id++) {
+			sed = ns_hsh_mas_gen(sed);
+			const u32 ist_id = (u32) (sed % (2 * SHR_NB));
+			prcs[ist_id] = (f64) ((sed >> 16) % 10000) / 100;
+			tb_val_prc_set(val, ists[ist_id], prcs[ist_id]);
+		}
+		sed = ns_hsh_mas_gen(sed);
+		if (!(sed % 17)) {
+			rats[1] = 1 + (f64) ((sed >> 8) % 100) / 100;
+			tb_val_rat_set(val, &tb_ccy_EUR, rats[1]);
+		}
+		if (!(sed % 13)) {
+			const u32 ist_id = (u32) ((sed >> 8) % IST_NB);
+			mrts[ist_id] = (f64) ((sed >> 16) % 100) / 100;
+			tb_val_mrt_set(val, ists[ist_id], mrts[ist_id]);
+		}
+		if (!(sed % 7)) {
+			const u32 wlt_id = (u32) ((sed >> 24) % WLT_NB);
+			tb_wlt_sim_add(wlts[wlt_id], ists[(sed >> 32) % IST_NB], 10);
+			tb_val_wlt_upd(val, wlt_id);
+		}
+		tb_val_upd(val);
+		_val_chk(val, wlts, ists, prcs, rats, mrts, nt_err_cnt);
+	}
+
+	/* Cleanup. */
+	for (u32 wlt_id = 0; wlt_id < WLT_NB; wlt_id++) {
+		tb_wlt_dtr(wlts[wlt_id]);
+	}
+	tb_val_dtr(val);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _val_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _val_unt_inc);
+}
+
+/*
+ * Valuation engine testing.
+ */
+void tb_tst_val(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _val_tsq, arg);
+}
@@ -0,0 +1,198 @@
+/* Copyright 2025 Raphael Outhier - confidential - proprietary - no copy - no diffusion. */
+
+#include <tb_tst/tb_tst.all.h>
+
+/*
+ * Construct at @ord an order of type @typ of @prm in
+ * @sec for @vol at limit @lim, filled @fil_prm for
+ * @fil_sec.
+ */
+static inline void _wlt_ord(
+	tb_ord *ord,
+	tb_ist *prm,
+	tb_ist *sec,
+	u8 typ,
+	f64 vol,
+	f64 lim,
+	f64 fil_prm,
+	f64 fil_sec
+)
+{
+	tb_ord_ctr(ord, prm, sec, typ, vol, lim, 0, 0, TB_ORD_STS_IDL);
+	ord->rsp_vol_prm = fil_prm;
+	ord->rsp_vol_sec = fil_sec;
+}
+
+/*
+ * Unit test for order resources.
+ * Amounts are chosen to be exact in binary.
+ */
+static inline void _wlt_unt_res(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prm = tb_ist_ctr_shr(mkp, "WLTA");
+	tb_ist *oth = tb_ist_ctr_shr(mkp, "WLTB");
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	tb_wlt *wlt = tb_wlt_ctr();
+	tb_wlt_sim_add(wlt, sec, 1000);
+	tb_wlt_sim_add(wlt, prm, 10);
+	tb_ord ord;
+
+	/* A buy takes its volume at its limit, and gives
+	 * back what it did not spend. */
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_BUY, 4, 10.5, 4, 40);
+	nt_chk(!tb_wlt_ord_res_tak(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, sec) == 958);
+	nt_chk(!tb_wlt_ord_res_col(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, prm) == 14);
+	nt_chk(tb_wlt_get(wlt, sec) == 960);
+
+	/* Partially filled. */
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_BUY, 4, 10, 1, 9.5);
+	nt_chk(!tb_wlt_ord_res_tak(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, sec) == 920);
+	nt_chk(!tb_wlt_ord_res_col(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, prm) == 15);
+	nt_chk(tb_wlt_get(wlt, sec) == 950.5);
+
+	/* A sell takes its volume, and gives back what
+	 * it did not sell along with the proceeds. */
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_SEL, 5, 10, 3, 31.5);
+	nt_chk(!tb_wlt_ord_res_tak(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, prm) == 10);
+	nt_chk(!tb_wlt_ord_res_col(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, prm) == 12);
+	nt_chk(tb_wlt_get(wlt, sec) == 982);
+
+	/* Cancellations refund what was taken. */
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_BUY, 2, 20, 0, 0);
+	nt_chk(!tb_wlt_ord_res_tak(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, sec) == 942);
+	nt_chk(!tb_wlt_ord_res_rel(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, sec) == 982);
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_SEL, 6, 10, 0, 0);
+	nt_chk(!tb_wlt_ord_res_tak(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, prm) == 6);
+	nt_chk(!tb_wlt_ord_res_rel(wlt, &ord));
+	nt_chk(tb_wlt_get(wlt, prm) == 12);
+	nt_chk(tb_wlt_get(wlt, sec) == 982);
+
+	/* Orders that need more than held fail and leave
+	 * the wallet unchanged. */
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_BUY, 100, 10, 0, 0);
+	nt_chk(tb_wlt_ord_res_tak(wlt, &ord));
+	_wlt_ord(&ord, prm, sec, TB_ORD_TYP_LIM_SEL, 13, 10, 0, 0);
+	nt_chk(tb_wlt_ord_res_tak(wlt, &ord));
+	_wlt_ord(&ord, oth, sec, TB_ORD_TYP_LIM_SEL, 1, 10, 0, 0);
+	nt_chk(tb_wlt_ord_res_tak(wlt, &ord));
+
+	/* Compare with the expected wallet. */
+	tb_wlt *ref = tb_wlt_ctr();
+	tb_wlt_sim_add(ref, sec, 982);
+	tb_wlt_sim_add(ref, prm, 12);
+	nt_chk(!tb_wlt_cmp(wlt, ref));
+	nt_chk(!tb_wlt_cmp(ref, wlt));
+
+	/* Cleanup. */
+	tb_wlt_dtr(ref);
+	tb_wlt_dtr(wlt);
+
+}
+
+/*
+ * Unit test for clones and comparisons, across
+ * growths.
+ */
+static inline void _wlt_unt_cmp(
+	u64 sed,
+	u64 *nt_err_cnt
+)
+{
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prm = tb_ist_ctr_shr(mkp, "WLTA");
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, &tb_ccy_USD);
+	tb_wlt *wlt0 = tb_wlt_ctr();
+	tb_wlt_sim_add(wlt0, sec, 100);
+	tb_wlt_sim_add(wlt0, prm, 3);
+
+	/* Clones are equal. */
+	tb_wlt *wlt1 = tb_wlt_cln(wlt0);
+	nt_chk(wlt1->amt_nbr == wlt0->amt_nbr);
+	nt_chk(!tb_wlt_cmp(wlt0, wlt1));
+
+	/* Create an instrument beyond the amounts. */
+	tb_ist *lat = 0;
+	char sym[8] = "WLT";
+	for (u32 ist_id = 0; (!lat) || (lat->id < wlt0->amt_nbr); ist_id++) {
+		sym[3] = (char) ('A' + (ist_id / 26) % 26);
+		sym[4] = (char) ('A' + ist_id % 26);
+		sym[5] = 0;
+		lat = tb_ist_ctr_shr(mkp, sym);
+	}
+	nt_chk(lat->id < tb_ist_nbr());
+
+	/* Adding it grows the wallet, that differs. */
+	tb_wlt_sim_add(wlt0, lat, 5);
+	nt_chk(wlt0->amt_nbr > lat->id);
+	nt_chk(wlt1->amt_nbr <= lat->id);
+	nt_chk(tb_wlt_get(wlt0, lat) == 5);
+	nt_chk(tb_wlt_get(wlt1, lat) == 0);
+	nt_chk(tb_wlt_cmp(wlt0, wlt1));
+	nt_chk(tb_wlt_cmp(wlt1, wlt0));
+
+	/* Once null, amounts covered by one wallet only
+	 * do not matter. */
+	tb_ord ord;
+	tb_ord_ctr(&ord, lat, sec, TB_ORD_TYP_LIM_SEL, 5, 1, 0, 0, TB_ORD_STS_IDL);
+	nt_chk(!tb_wlt_ord_res_tak(wlt0, &ord));
+	nt_chk(tb_wlt_get(wlt0, lat) == 0);
+	nt_chk(!tb_wlt_cmp(wlt0, wlt1));
+	nt_chk(!tb_wlt_cmp(wlt1, wlt0));
+
+	/* Common amounts matter. */
+	tb_wlt_sim_add(wlt1, sec, 1);
+	nt_chk(tb_wlt_cmp(wlt0, wlt1));
+	nt_chk(tb_wlt_cmp(wlt1, wlt0));
+
+	/* Clones of grown wallets are equal. */
+	tb_wlt *wlt2 = tb_wlt_cln(wlt0);
+	nt_chk(wlt2->amt_nbr == wlt0->amt_nbr);
+	nt_chk(!tb_wlt_cmp(wlt0, wlt2));
+	tb_wlt_sim_add(wlt2, lat, 1);
+	nt_chk(tb_wlt_cmp(wlt0, wlt2));
+
+	/* Cleanup. */
+	tb_wlt_dtr(wlt2);
+	tb_wlt_dtr(wlt1);
+	tb_wlt_dtr(wlt0);
+
+}
+
+/*
+ * Test sequence.
+ */
+static inline void _wlt_tsq(
+	nh_tst_exc *exc,
+	void *_
+)
+{
+	NH_TST_UNT(exc, _wlt_unt_res);
+	NH_TST_UNT(exc, _wlt_unt_cmp);
+}
+
+/*
+ * Wallet testing.
+ */
+void tb_tst_wlt(
+	nh_tst_sys *sys,
+	u64 sed,
+	u8 wrk_nb,
+	u8 prc
+)
+{
+	void *arg = 0;
+	nh_tst_psh__(sys, sed, _wlt_tsq, arg);
+}
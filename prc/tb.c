@@ -40,7 +40,20 @@ static u32 _mux_one(
 		(0, flg, stg, (stg), "run storage tests."),
 		(0, flg, obk, (obk), "run orderbook computation tests."),
 		(0, flg, lvl, (lvl), "run level constants check tests."),
-		(0, flg, lv1, (lv1), "run level 1 reconstruction tests.")
+		(0, flg, lv1, (lv1), "run level 1 reconstruction tests."),
+		(0, flg, mrg, (mrg), "run merge reader tests."),
+		(0, flg, iox, (iox), "run level IO tests."),
+		(0, flg, pub, (pub), "run publisher tests."),
+		(0, flg, stt, (stt), "run statistics tests."),
+		(0, flg, bks, (bks), "run simulation broker tests."),
+		(0, flg, bkp, (bkp), "run broker protocol tests."),
+		(0, flg, otb, (otb), "run order table tests."),
+		(0, flg, wlt, (wlt), "run wallet tests."),
+		(0, flg, val, (val), "run valuation engine tests."),
+		(0, flg, swp, (swp), "run sweep runner tests."),
+		(0, flg, reg, (reg), "run registry tests."),
+		(0, flg, sym, (sym), "run symbols tests."),
+		(0, flg, jrn, (jrn), "run journal tests.")
 	);
 	u32 tst_cnt = 0;
 	nh_tst_sys *sys = nh_tst_sys_ctr();
@@ -50,6 +63,19 @@ static u32 _mux_one(
 	if (obk__flg) tst(obk, thr_nb, prc); 
 	if (lvl__flg) tst(lvl, thr_nb, prc); 
 	if (lv1__flg) tst(lv1, thr_nb, prc); 
+	if (mrg__flg) tst(mrg, thr_nb, prc); 
+	if (iox__flg) tst(iox, thr_nb, prc); 
+	if (pub__flg) tst(pub, thr_nb, prc); 
+	if (stt__flg) tst(stt, thr_nb, prc); 
+	if (bks__flg) tst(bks, thr_nb, prc); 
+	if (bkp__flg) tst(bkp, thr_nb, prc); 
+	if (otb__flg) tst(otb, thr_nb, prc); 
+	if (wlt__flg) tst(wlt, thr_nb, prc); 
+	if (val__flg) tst(val, thr_nb, prc); 
+	if (swp__flg) tst(swp, thr_nb, prc); 
+	if (reg__flg) tst(reg, thr_nb, prc); 
+	if (sym__flg) tst(sym, thr_nb, prc); 
+	if (jrn__flg) tst(jrn, thr_nb, prc); 
 	assert(nh_tst_don(sys));
 	debug("tb tests : %u testbenches ran, %U sequences, %U unit tests, %U errors.\n", tst_cnt, sys->seq_cnt, sys->unt_cnt, sys->err_cnt);
 	u32 ret = sys->err_cnt != 0;
@@ -76,6 +102,19 @@ static u32 _mux_all(
 	tst(obk, thr_nb, prc);
 	tst(lvl, thr_nb, prc);
 	tst(lv1, thr_nb, prc);
+	tst(mrg, thr_nb, prc);
+	tst(iox, thr_nb, prc);
+	tst(pub, thr_nb, prc);
+	tst(stt, thr_nb, prc);
+	tst(bks, thr_nb, prc);
+	tst(bkp, thr_nb, prc);
+	tst(otb, thr_nb, prc);
+	tst(wlt, thr_nb, prc);
+	tst(val, thr_nb, prc);
+	tst(swp, thr_nb, prc);
+	tst(reg, thr_nb, prc);
+	tst(sym, thr_nb, prc);
+	tst(jrn, thr_nb, prc);
 	assert(nh_tst_don(sys));
 	debug("tb tests : %u testbenches ran, %U sequences, %U unit tests, %U errors.\n", tst_cnt, sys->seq_cnt, sys->unt_cnt, sys->err_cnt);
 	u32 ret = sys->err_cnt != 0;
@@ -130,6 +169,245 @@ static u32 _tst_main(
 
 }
 
+/**********
+ * Export *
+ **********/
+
+/*
+ * Export a time range of stored data as an Arrow
+ * stream and describe its chunks.
+ */
+static u32 _arw_main(
+	u32 argc,
+	char **argv
+)
+{
+	NS_ARG_EXTR(
+		"arw", argc, argv,
+		return 1;,
+		" arrow export entrypoint",
+		(0, str, pth, (p, pth), "storage path."),
+		(0, str, mkp, (m, mkp), "marketplace."),
+		(0, str, ist, (i, ist), "instrument."),
+		(0, (dbu8, 1, 0, 2), lvl, (l, lvl), "level (default 1)."),
+		(0, u64, stt, (s, stt), "start time (default 0)."),
+		(0, u64, end, (e, end), "end time (default max).")
+	);
+	if ((!pth__flg) || (!mkp__flg) || (!ist__flg)) {
+		error("storage path, marketplace and instrument required.\n");
+		return 1;
+	}
+	if (lvl > 2) {
+		error("bad level %u.\n", lvl);
+		return 1;
+	}
+	if (!stt__flg) stt = 0;
+	if (!end__flg) end = (u64) -1;
+
+	/* Opening an index creates it, check that it exists. */
+	nh_stt fst;
+	if (nh_fs_ftst(NH_FIL_TYP_STM, 0, &fst, "%s/%s/%s/%u/idx", pth, mkp, ist, lvl)) {
+		error("no index at %s/%s/%s/%u/idx.\n", pth, mkp, ist, lvl);
+		return 1;
+	}
+
+	/* Open the index. */
+	tb_stg_sys *sys = tb_stg_ctr(pth, 0);
+	if (!sys) return 1;
+	tb_stg_idx *idx = tb_stg_opn(sys, mkp, ist, lvl, 0, 0);
+
+	/* Describe the schema. */
+	struct ArrowArrayStream stm;
+	struct ArrowSchema sch;
+	tb_arw_exp(idx, stt, end, &stm);
+	assert(!stm.get_schema(&stm, &sch));
+	for (s64 col_id = 0; col_id < sch.n_children; col_id++) {
+		info("column %s : %s.\n", sch.children[col_id]->name, sch.children[col_id]->format);
+	}
+	sch.release(&sch);
+
+	/* Describe chunks. */
+	u64 chk_nbr = 0;
+	u64 elm_nbr = 0;
+	while (1) {
+		struct ArrowArray arr;
+		assert(!stm.get_next(&stm, &arr));
+		if (!arr.release) break;
+		const u64 *tims = arr.children[0]->buffers[1];
+		info("chunk %U : %U elements, [%U, %U].\n", chk_nbr, (u64) arr.length, tims[0], tims[arr.length - 1]);
+		chk_nbr++;
+		elm_nbr += (u64) arr.length;
+		arr.release(&arr);
+	}
+	info("%U chunks, %U elements.\n", chk_nbr, elm_nbr);
+	stm.release(&stm);
+
+	/* Cleanup. */
+	tb_stg_cls(idx, 0);
+	tb_stg_dtr(sys);
+	return 0;
+
+}
+
+/**************
+ * Statistics *
+ **************/
+
+/*
+ * Print the stats page exported at a path.
+ */
+static u32 _stt_main(
+	u32 argc,
+	char **argv
+)
+{
+	NS_ARG_EXTR(
+		"stt", argc, argv,
+		return 1;,
+		" statistics entrypoint",
+		(0, str, pth, (p, pth), "stats page path.")
+	);
+	if (!pth__flg) {
+		error("stats page path required.\n");
+		return 1;
+	}
+
+	/* Open, sum pages. */
+	tb_sgm *sgm;
+	const tb_stt_set *set = tb_stt_opn(pth, &sgm);
+	if (!set) {
+		error("no stats page at %s.\n", pth);
+		return 1;
+	}
+	static tb_stt_pag sum;
+	const tb_stt_pag *pag = &sum;
+	tb_stt_sum(&sum, set);
+
+	/* Events. */
+	for (u8 evt_id = 0; evt_id < TB_STT_EVT_NBR; evt_id++) {
+		info("%s : %U.\n", tb_stt_evt_nam(evt_id), (u64) pag->evts[evt_id]);
+	}
+
+	/* Functions. */
+	for (u8 fnc_id = 0; fnc_id < TB_STT_FNC_NBR; fnc_id++) {
+		const tb_stt_fnc *fnc = pag->fncs + fnc_id;
+		const u64 cal = fnc->cal;
+		const u64 cyc = fnc->cyc;
+		info("%s : %U calls, %U cycles, %U cycles per call.\n", tb_stt_fnc_nam(fnc_id), cal, cyc, cal ? cyc / cal : 0);
+		for (u8 hwc_id = 0; hwc_id < TB_STT_HWC_NBR; hwc_id++) {
+			const u64 hwc = fnc->hwcs[hwc_id];
+			if (hwc) info("  %s : %U, %U per call.\n", tb_stt_hwc_nam(hwc_id), hwc, cal ? hwc / cal : 0);
+		}
+	}
+
+	/* Latencies. */
+	for (u8 lat_id = 0; lat_id < TB_STT_LAT_NBR; lat_id++) {
+		const tb_stt_lat *lat = pag->lats + lat_id;
+		const u64 cnt = lat->cnt;
+		if (!cnt) continue;
+		info("%s : %U samples, mean %Uns, p50 %Uns, p99 %Uns, p999 %Uns.\n",
+			tb_stt_lat_nam(lat_id), cnt, lat->sum / cnt,
+			tb_stt_lat_pct(lat, 1, 2),
+			tb_stt_lat_pct(lat, 99, 100),
+			tb_stt_lat_pct(lat, 999, 1000)
+		);
+	}
+
+	/* Cleanup. */
+	tb_sgm_cls(sgm);
+	return 0;
+
+}
+
+/**********
+ * Broker *
+ **********/
+
+/* Benchmark bridge state : 0 if running, 1 if it must
+ * stop, 2 if stopped. */
+static volatile a64 _bkp_stp = 0;
+
+/*
+ * Serve the benchmark bridge @srv until stopped.
+ */
+static u32 _bkp_srv(
+	tb_bkp_srv *srv
+)
+{
+	while (!ns_atm(a64, red, acq, &_bkp_stp)) tb_bkp_srv_stp(srv);
+	ns_atm(a64, wrt, rel, &_bkp_stp, 2);
+	return 0;
+}
+
+/*
+ * Measure the round trip latency of the binary
+ * broker protocol against a loopback bridge.
+ */
+static u32 _bkp_main(
+	u32 argc,
+	char **argv
+)
+{
+	NS_ARG_EXTR(
+		"bkp", argc, argv,
+		return 1;,
+		" broker protocol benchmark entrypoint",
+		(0, str, pth, (p, pth), "bridge segment path."),
+		(0, u64, nbr, (n, nbr), "number of round trips (default 100000).")
+	);
+	if (!pth__flg) {
+		error("bridge segment path required.\n");
+		return 1;
+	}
+	if (!nbr__flg) nbr = 100000;
+
+	/* Serve a simulation broker over an empty history. */
+	tb_lv1_hst *hst = tb_lv1_ctr(1, 2, 2, 0, TB_LV1_FMT_F64, 1);
+	spb_bkr *sim = tb_bks_ctr(hst, 0.01, 0, nbr);
+	tb_bkp_srv *srv = tb_bkp_srv_ctr(pth, sim);
+	_bkp_stp = 0;
+	void *thr_blk = nh_all(1024);
+	assert(!nh_thr_run(thr_blk, 1024, 0, (u32 (*)(void *)) &_bkp_srv, srv));
+
+	/* Connect. */
+	spb_bkr *bkr = assert(tb_bkp_cln_opn(pth, 1), "bridge at %s not serving.\n", pth);
+	tb_mkp *mkp = tb_mkp_sch("NASDAQ_US");
+	tb_ist *prm = tb_ist_ctr_shr(mkp, "AAPL");
+	tb_ist *sec = tb_ist_ctr_ccy(mkp, tb_ccy_sch("USD"));
+	spb_bkr_tim_rst(bkr, 0);
+
+	/* Pass orders and read their status. */
+	u64 min = (u64) -1;
+	u64 max = 0;
+	u64 sum = 0;
+	for (u64 ord_id = 0; ord_id < nbr; ord_id++) {
+		tb_ord req;
+		tb_ord_ctr(&req, prm, sec, TB_ORD_TYP_LIM_BUY, 1, 100, 0, 0, TB_ORD_STS_IDL);
+		const u64 stt = tb_stt_tim();
+		tb_ord rsp = tb_bkr_ord_pas(bkr, &req);
+		tb_bkr_ord_sts(bkr, rsp.id, &rsp);
+		const u64 lat = (tb_stt_tim() - stt) >> 1;
+		assert(rsp.id == ord_id);
+		assert(rsp.prm == prm);
+		if (lat < min) min = lat;
+		if (lat > max) max = lat;
+		sum += lat;
+	}
+	info("%U round trips : min %Uns, mean %Uns, max %Uns.\n", 2 * nbr, min, nbr ? sum / nbr : 0, max);
+
+	/* Cleanup. */
+	spb_bkr_sht(bkr);
+	spb_bkr_dtor(bkr);
+	ns_atm(a64, wrt, rel, &_bkp_stp, 1);
+	while (ns_atm(a64, red, acq, &_bkp_stp) != 2);
+	nh_fre(thr_blk, 1024);
+	tb_bkp_srv_dtr(srv);
+	spb_bkr_dtor(sim);
+	tb_lv1_dtr(hst);
+	return 0;
+
+}
+
 /********
  * Main *
  ********/
@@ -155,7 +433,10 @@ u32 prc_tb_main(
 	}
 	u32 ret = 0;
 	NS_ARG_SEL(argc, argv, "tb", , ret,
-		("tst", _tst_main, "run tests.")
+		("tst", _tst_main, "run tests."),
+		("arw", _arw_main, "describe an arrow export of stored data."),
+		("stt", _stt_main, "print exported statistics."),
+		("bkp", _bkp_main, "benchmark the binary broker protocol.")
 	);
 	return ret;
 }